@@ -0,0 +1,268 @@
+/*
+* EDDL Library - European Distributed Deep Learning Library.
+* Version: 0.7
+* copyright (c) 2020, Universidad Politécnica de Valencia (UPV), PRHLT Research Centre
+* Date: April 2020
+* Author: PRHLT Research Centre, UPV, (rparedes@prhlt.upv.es), (jon@prhlt.upv.es)
+* All rights reserved
+*/
+
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+#include "eddl/tensor/tensor.h"
+#include "eddl/tensor/nn/tensor_nn.h"
+#include "eddl/descriptors/descriptors.h"
+#include "eddl/layers/core/layer_core.h"
+#include "eddl/layers/normalization/layer_normalization.h"
+#include "eddl/layers/recurrent/layer_recurrent.h"
+
+using namespace std;
+
+
+static string shape_str(const vector<int> &shape){
+    string s;
+    for (int i = 0; i < shape.size(); i++) s += (i ? "x" : "") + to_string(shape[i]);
+    return s;
+}
+
+
+// Convolutions of the first, middle and last blocks of a small CIFAR net, and a 1x1 projection
+static void conv_benchmarks(BenchmarkRunner &runner){
+    struct ConvShape { int b, z, r, c, filters, k; };
+    vector<ConvShape> shapes = {{32, 3, 32, 32, 32, 3}, {32, 64, 16, 16, 64, 3},
+                                {32, 128, 8, 8, 256, 3}, {32, 256, 8, 8, 256, 1}};
+
+    for (auto &s : shapes) {
+        if (!runner.selected_any({"conv2D", "conv2D_grad", "conv2D_back", "conv2D_nhwc", "conv2D_grad_nhwc",
+                                  "conv2D_back_nhwc"})) return;
+
+        Tensor *I = Tensor::randn({s.b, s.z, s.r, s.c});
+        auto *cd = new ConvolDescriptor(s.filters, {s.k, s.k}, {1, 1}, "same", true);
+        cd->build(I);
+        cd->K->rand_normal(0.0f, 0.1f);
+        cd->bias->fill_(0.0f);
+        cd->D = Tensor::randn(cd->O->shape);
+        cd->ID = Tensor::zeros(I->shape);
+
+        string shape = shape_str(I->shape) + "_k" + to_string(s.k) + "_f" + to_string(s.filters);
+        double flops = 2.0 * s.b * cd->r * cd->c * cd->nk * cd->kr * cd->kc * cd->kz;
+
+        runner.run("conv2D", shape, flops, s.b, [&]() { tensorNN::Conv2D(cd); });
+        runner.run("conv2D_grad", shape, flops, s.b, [&]() { tensorNN::Conv2D_grad(cd); });
+        runner.run("conv2D_back", shape, flops, s.b, [&]() { tensorNN::Conv2D_back(cd); });
+
+        // Same shapes with the input and the output channels last (see set_layout)
+        cd->layout = cd->in_layout = LAYOUT_NHWC;
+        runner.run("conv2D_nhwc", shape, flops, s.b, [&]() { tensorNN::Conv2D(cd); });
+        runner.run("conv2D_grad_nhwc", shape, flops, s.b, [&]() { tensorNN::Conv2D_grad(cd); });
+        runner.run("conv2D_back_nhwc", shape, flops, s.b, [&]() { tensorNN::Conv2D_back(cd); });
+
+        // The descriptor maps its matrices onto K and gK, and it is never released (as in LConv)
+        delete cd->D; delete cd->ID;
+        delete I;
+    }
+}
+
+static void pool_benchmarks(BenchmarkRunner &runner){
+    vector<vector<int>> shapes = {{32, 32, 32, 32}, {32, 128, 8, 8}};
+
+    for (auto &s : shapes) {
+        if (!runner.selected_any({"mpool2D", "mpool2D_back", "mpool2D_nhwc", "mpool2D_back_nhwc"})) return;
+
+        Tensor *I = Tensor::randn(s);
+        auto *pd = new PoolDescriptor({2, 2}, {2, 2}, "none");
+        pd->build(I);
+        pd->indX = new Tensor(pd->O->shape);
+        pd->indY = new Tensor(pd->O->shape);
+        pd->D = Tensor::randn(pd->O->shape);
+        pd->ID = Tensor::zeros(I->shape);
+
+        runner.run("mpool2D", shape_str(s), 0.0, s[0], [&]() { tensorNN::MPool2D(pd); });
+        runner.run("mpool2D_back", shape_str(s), 0.0, s[0], [&]() { tensorNN::MPool2D_back(pd); });
+
+        pd->layout = pd->in_layout = LAYOUT_NHWC;
+        runner.run("mpool2D_nhwc", shape_str(s), 0.0, s[0], [&]() { tensorNN::MPool2D(pd); });
+        runner.run("mpool2D_back_nhwc", shape_str(s), 0.0, s[0], [&]() { tensorNN::MPool2D_back(pd); });
+
+        delete pd->D; delete pd->ID;
+        delete pd->indX; delete pd->indY;
+        delete I;
+    }
+}
+
+static void mult2D_benchmarks(BenchmarkRunner &runner){
+    // {m, k, n}: square products and the first layer of the MNIST MLP
+    vector<vector<int>> shapes = {{256, 256, 256}, {1024, 1024, 1024}, {128, 784, 1024}};
+
+    for (auto &s : shapes) {
+        if (!runner.selected_any({"mult2D"})) return;
+
+        Tensor *A = Tensor::randn({s[0], s[1]});
+        Tensor *B = Tensor::randn({s[1], s[2]});
+        Tensor *C = Tensor::empty({s[0], s[2]});
+        double flops = 2.0 * s[0] * s[1] * s[2];
+
+        runner.run("mult2D", shape_str(s), flops, s[0], [&]() { Tensor::mult2D(A, 0, B, 0, C, 0); });
+
+        delete A; delete B; delete C;
+    }
+}
+
+static void reduction_benchmarks(BenchmarkRunner &runner){
+    if (!runner.selected_any({"reduce_sum", "reduce_sum2D_axis0", "reduce_sum2D_axis1"})) return;
+
+    Tensor *A = Tensor::randn({1024, 1024});
+    Tensor *rows = Tensor::empty({1024});
+    Tensor *cols = Tensor::empty({1024});
+    volatile float total = 0.0f;
+
+    runner.run("reduce_sum", shape_str(A->shape), A->size, A->size, [&]() { total = A->sum(); });
+    runner.run("reduce_sum2D_axis0", shape_str(A->shape), A->size, A->size, [&]() { Tensor::reduce_sum2D(A, cols, 0, 0); });
+    runner.run("reduce_sum2D_axis1", shape_str(A->shape), A->size, A->size, [&]() { Tensor::reduce_sum2D(A, rows, 1, 0); });
+
+    delete A; delete rows; delete cols;
+}
+
+static void softmax_benchmarks(BenchmarkRunner &runner){
+    if (!runner.selected_any({"softmax"})) return;
+
+    Tensor *A = Tensor::randn({128, 1000});
+    Tensor *B = Tensor::empty(A->shape);
+
+    runner.run("softmax", shape_str(A->shape), 0.0, A->shape[0], [&]() { tensorNN::Softmax(A, B); });
+
+    delete A; delete B;
+}
+
+static void batchnorm_benchmarks(BenchmarkRunner &runner){
+    if (!runner.selected_any({"batchnorm_forward", "batchnorm_backward"})) return;
+
+    // The input layer owns X
+    Tensor *X = Tensor::randn({32, 64, 16, 16});
+    auto *in = new LInput(X, "input", DEV_CPU, 0);
+    auto *bn = new LBatchNorm(in, 0.99f, 0.001f, true, "batchnorm", DEV_CPU, 0);
+    bn->setmode(TRMODE);
+    bn->initialize();
+
+    in->mem_delta();
+    bn->mem_delta();
+    bn->delta->rand_normal(0.0f, 1.0f);
+
+    runner.run("batchnorm_forward", shape_str(X->shape), 0.0, X->shape[0], [&]() { bn->forward(); });
+    runner.run("batchnorm_backward", shape_str(X->shape), 0.0, X->shape[0], [&]() { bn->backward(); });
+
+    delete bn; delete in;
+}
+
+static void lstm_benchmarks(BenchmarkRunner &runner){
+    if (!runner.selected_any({"lstm_step_forward", "lstm_step_train"})) return;
+
+    // A single step (the first of a sequence, without previous states)
+    int batch = 64, dim = 256, units = 256;
+    Tensor *X = Tensor::randn({batch, dim});  // Owned by the input layer
+    auto *in = new LInput(X, "input", DEV_CPU, 0);
+    auto *lstm = new LLSTM({in}, units, false, false, "lstm", DEV_CPU, 0);
+    for (auto p : lstm->params) p->rand_normal(0.0f, 0.05f);
+
+    in->mem_delta();
+    lstm->mem_delta();
+    lstm->delta->rand_normal(0.0f, 1.0f);
+
+    // Four gates: input and recurrent products
+    double flops = 2.0 * 4 * batch * units * (dim + units);
+    string shape = shape_str(X->shape) + "_u" + to_string(units);
+
+    // The gates computed in training mode are kept until the backward releases them
+    lstm->setmode(TSMODE);
+    runner.run("lstm_step_forward", shape, flops, batch, [&]() { lstm->forward(); });
+    lstm->setmode(TRMODE);
+    runner.run("lstm_step_train", shape, 3.0 * flops, batch, [&]() { lstm->forward(); lstm->backward(); });
+
+    delete lstm; delete in;
+}
+
+static void optimizer_benchmarks(BenchmarkRunner &runner){
+    if (!runner.selected_any({"sgd_step", "adam_step", "rmsprop_step"})) return;
+
+    vector<int> shape = {1024, 1024};
+    Tensor *W = Tensor::randn(shape);
+    Tensor *G = Tensor::randn(shape);
+    Tensor *M = Tensor::zeros(shape);
+    Tensor *V = Tensor::zeros(shape);
+    int t = 0;
+
+    // Tiny learning rates, so that the weights stay in range along the iterations
+    runner.run("sgd_step", shape_str(shape), 0.0, W->size, [&]() {
+        tensorNN::sgd_step(W, G, M, 1e-6f, 0.9f, 0.0f, 0.0001f);
+    });
+    runner.run("adam_step", shape_str(shape), 0.0, W->size, [&]() {
+        tensorNN::adam_step(W, G, M, V, nullptr, nullptr, 1e-6f, 0.9f, 0.999f, 1e-7f, ++t, 0.0f, 0.0001f);
+    });
+    runner.run("rmsprop_step", shape_str(shape), 0.0, W->size, [&]() {
+        tensorNN::rmsprop_step(W, G, M, nullptr, 1e-6f, 0.9f, 1e-7f, 0.0f, 0.0001f);
+    });
+
+    delete W; delete G; delete M; delete V;
+}
+
+// INT8 inference (see quantize) against the fp32 kernels on the same shapes. The scales do not
+// change the work, so they are all 1/64 (inputs of about [-2, 2])
+static void quantize_benchmarks(BenchmarkRunner &runner){
+    struct ConvShape { int b, z, r, c, filters, k; };
+    vector<ConvShape> convs = {{32, 64, 16, 16, 64, 3}, {32, 256, 8, 8, 256, 1}};
+
+    for (auto &s : convs) {
+        if (!runner.selected_any({"quant_conv2D_fp32", "quant_conv2D_int8"})) break;
+
+        Tensor *I = Tensor::randn({s.b, s.z, s.r, s.c});
+        auto *cd = new ConvolDescriptor(s.filters, {s.k, s.k}, {1, 1}, "same", true);
+        cd->build(I);
+        cd->K->rand_normal(0.0f, 0.1f);
+        cd->bias->fill_(0.0f);
+        vector<int8_t> K(cd->K->size);
+        vector<float> scales(cd->nk, 1.0f / 64);
+        for (long i = 0; i < K.size(); i++) K[i] = (int8_t)(cd->K->ptr[i] * 64);
+
+        string shape = shape_str(I->shape) + "_k" + to_string(s.k) + "_f" + to_string(s.filters);
+        double flops = 2.0 * s.b * cd->r * cd->c * cd->nk * cd->kr * cd->kc * cd->kz;
+
+        runner.run("quant_conv2D_fp32", shape, flops, s.b, [&]() { tensorNN::Conv2D(cd); });
+        runner.run("quant_conv2D_int8", shape, flops, s.b, [&]() { tensorNN::Conv2D_s8(cd, K.data(), scales.data(), 1.0f / 64); });
+
+        delete I;
+    }
+
+    // {batch, inputs, outputs}: the first and a hidden layer of the MNIST MLP
+    vector<vector<int>> denses = {{128, 784, 1024}, {128, 1024, 1024}};
+    for (auto &s : denses) {
+        if (!runner.selected_any({"quant_dense_fp32", "quant_dense_int8"})) break;
+
+        Tensor *A = Tensor::randn({s[0], s[1]});
+        Tensor *W = Tensor::randn({s[1], s[2]});
+        Tensor *B = Tensor::empty({s[0], s[2]});
+        vector<int8_t> Wq((long)s[2] * s[1]);  // Outputs x inputs
+        vector<float> scales(s[2], 1.0f / 64);
+        for (long i = 0; i < Wq.size(); i++) Wq[i] = (int8_t)((i * 37) % 255 - 127);
+        double flops = 2.0 * s[0] * s[1] * s[2];
+
+        runner.run("quant_dense_fp32", shape_str(s), flops, s[0], [&]() { Tensor::mult2D(A, 0, W, 0, B, 0); });
+        runner.run("quant_dense_int8", shape_str(s), flops, s[0], [&]() { tensorNN::Dense_s8(A, Wq.data(), scales.data(), 1.0f / 64, nullptr, B); });
+
+        delete A; delete W; delete B;
+    }
+}
+
+
+void kernel_benchmarks(BenchmarkRunner &runner){
+    conv_benchmarks(runner);
+    pool_benchmarks(runner);
+    mult2D_benchmarks(runner);
+    reduction_benchmarks(runner);
+    softmax_benchmarks(runner);
+    batchnorm_benchmarks(runner);
+    lstm_benchmarks(runner);
+    optimizer_benchmarks(runner);
+    quantize_benchmarks(runner);
+}
@@ -0,0 +1,106 @@
+/*
+* EDDL Library - European Distributed Deep Learning Library.
+* Version: 0.7
+* copyright (c) 2020, Universidad Politécnica de Valencia (UPV), PRHLT Research Centre
+* Date: April 2020
+* Author: PRHLT Research Centre, UPV, (rparedes@prhlt.upv.es), (jon@prhlt.upv.es)
+* All rights reserved
+*/
+
+#include <string>
+#include <vector>
+
+#include "benchmark.h"
+#include "eddl/apis/eddl.h"
+
+using namespace std;
+using namespace eddl;
+
+
+// Same nets as the examples (nn/1_mnist/1_mnist_mlp, nn/2_cifar10/1_cifar_conv and
+// nn/2_cifar10/5_cifar_resnet), trained on random batches so that no dataset is needed
+
+static model mnist_mlp(){
+    layer in = Input({784});
+    layer l = in;
+    l = LeakyReLu(Dense(l, 1024));
+    l = LeakyReLu(Dense(l, 1024));
+    l = LeakyReLu(Dense(l, 1024));
+    layer out = Softmax(Dense(l, 10));
+    return Model({in}, {out});
+}
+
+static model cifar_conv(){
+    layer in = Input({3, 32, 32});
+    layer l = in;
+    l = MaxPool(ReLu(Conv(l, 32, {3, 3}, {1, 1})), {2, 2});
+    l = MaxPool(ReLu(Conv(l, 64, {3, 3}, {1, 1})), {2, 2});
+    l = MaxPool(ReLu(Conv(l, 128, {3, 3}, {1, 1})), {2, 2});
+    l = GlobalMaxPool(l);
+    l = Flatten(l);
+    l = Activation(Dense(l, 128), "relu");
+    layer out = Activation(Dense(l, 10), "softmax");
+    return Model({in}, {out});
+}
+
+static model cifar_conv_nhwc(){
+    model net = cifar_conv();
+    set_layout(net, "nhwc");
+    return net;
+}
+
+static layer ResBlock(layer l, int filters, int nconv, int half){
+    layer in = l;
+
+    if (half) l = ReLu(Conv(l, filters, {3, 3}, {2, 2}));
+    else l = ReLu(Conv(l, filters, {3, 3}, {1, 1}));
+
+    for (int i = 0; i < nconv - 1; i++) l = ReLu(Conv(l, filters, {3, 3}, {1, 1}));
+
+    if (half) return Sum(Conv(in, filters, {1, 1}, {2, 2}), l);
+    else return Sum(l, in);
+}
+
+static model cifar_resnet18(){
+    layer in = Input({3, 32, 32});
+    layer l = in;
+    l = ReLu(Conv(l, 64, {3, 3}, {1, 1}));
+    l = ResBlock(l, 64, 2, 1);
+    l = ResBlock(l, 64, 2, 0);
+    l = ResBlock(l, 128, 2, 1);
+    l = ResBlock(l, 128, 2, 0);
+    l = ResBlock(l, 256, 2, 1);
+    l = ResBlock(l, 256, 2, 0);
+    l = ResBlock(l, 512, 2, 1);
+    l = ResBlock(l, 512, 2, 0);
+    l = Reshape(l, {-1});
+    l = Activation(Dense(l, 512), "relu");
+    layer out = Activation(Dense(l, 10), "softmax");
+    return Model({in}, {out});
+}
+
+
+static void train_batch_benchmark(BenchmarkRunner &runner, const string &name, model (*create)(), vector<int> xshape, int batch){
+    if (!runner.selected(name)) return;
+
+    model net = create();
+    build(net, sgd(0.01f, 0.9f), {"soft_cross_entropy"}, {"categorical_accuracy"}, CS_CPU(runner.threads), true);
+
+    xshape.insert(xshape.begin(), batch);
+    Tensor *x = Tensor::randn(xshape);
+    Tensor *y = Tensor::zeros({batch, 10});
+    for (int i = 0; i < batch; i++) y->ptr[i * 10 + i % 10] = 1.0f;
+
+    string shape = "batch" + to_string(batch);
+    runner.run(name, shape, 0.0, batch, [&]() { train_batch(net, {x}, {y}); });
+
+    delete net;
+    delete x; delete y;
+}
+
+void model_benchmarks(BenchmarkRunner &runner){
+    train_batch_benchmark(runner, "train_batch_mnist_mlp", mnist_mlp, {784}, 100);
+    train_batch_benchmark(runner, "train_batch_cifar_conv", cifar_conv, {3, 32, 32}, 32);
+    train_batch_benchmark(runner, "train_batch_cifar_conv_nhwc", cifar_conv_nhwc, {3, 32, 32}, 32);
+    train_batch_benchmark(runner, "train_batch_cifar_resnet18", cifar_resnet18, {3, 32, 32}, 16);
+}
@@ -0,0 +1,106 @@
+/*
+* EDDL Library - European Distributed Deep Learning Library.
+* Version: 0.7
+* copyright (c) 2020, Universidad Politécnica de Valencia (UPV), PRHLT Research Centre
+* Date: April 2020
+* Author: PRHLT Research Centre, UPV, (rparedes@prhlt.upv.es), (jon@prhlt.upv.es)
+* All rights reserved
+*/
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+#include "benchmark.h"
+#include "eddl/utils.h"
+
+using namespace std;
+
+
+BenchmarkRunner::BenchmarkRunner(){
+    min_time = 0.5;
+    min_iters = 3;
+    threads = -1;
+}
+
+bool BenchmarkRunner::selected(const string &name) const {
+    return filter.empty() || name.find(filter) != string::npos;
+}
+
+bool BenchmarkRunner::selected_any(const vector<string> &names) const {
+    for (auto &name : names) {
+        if (selected(name)) return true;
+    }
+    return false;
+}
+
+void BenchmarkRunner::run(const string &name, const string &shape, double flops, double items, const std::function<void()> &fn){
+    if (!selected(name)) return;
+
+    // Warm-up (first touch of the buffers, lazy allocations...)
+    fn();
+
+    long iterations = 0;
+    double total = 0.0, best = 1e30;
+    while (iterations < min_iters || total < min_time) {
+        auto start = std::chrono::steady_clock::now();
+        fn();
+        double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        total += t;
+        best = std::min(best, t);
+        iterations++;
+    }
+
+    BenchmarkResult r = {name, shape, iterations, 1000.0 * total / iterations, 1000.0 * best, flops, items};
+    results.push_back(r);
+
+    cout << setw(28) << left << name << setw(28) << left << shape;
+    cout << fixed << setprecision(3) << setw(12) << right << r.mean_ms << " ms";
+    if (flops > 0.0) cout << setprecision(2) << setw(10) << right << flops / (r.mean_ms * 1e6) << " GFLOP/s";
+    cout << endl;
+    cout.unsetf(std::ios::fixed);
+}
+
+void BenchmarkRunner::print_table() const {
+    cout << "-----------------------------------------------------------------------------------------------------" << endl;
+    cout << setw(28) << left << "Benchmark" << setw(28) << left << "Shape" << setw(8) << right << "Iters";
+    cout << setw(12) << right << "Mean ms" << setw(12) << right << "Min ms" << setw(10) << right << "GFLOP/s";
+    cout << setw(12) << right << "Items/s" << endl;
+    cout << "-----------------------------------------------------------------------------------------------------" << endl;
+    for (auto &r : results) {
+        cout << setw(28) << left << r.name << setw(28) << left << r.shape << setw(8) << right << r.iterations;
+        cout << fixed << setprecision(3) << setw(12) << right << r.mean_ms << setw(12) << right << r.min_ms;
+        cout << setprecision(2);
+        if (r.flops > 0.0) cout << setw(10) << right << r.flops / (r.mean_ms * 1e6);
+        else cout << setw(10) << right << "-";
+        cout << setprecision(0) << setw(12) << right << r.items / (r.mean_ms / 1000.0) << endl;
+        cout.unsetf(std::ios::fixed);
+    }
+    cout << "-----------------------------------------------------------------------------------------------------" << endl;
+}
+
+void BenchmarkRunner::save_json(const string &filename) const {
+    std::ofstream ofs(filename, std::ios::out);
+    if (!ofs.good()) msg("Error creating " + filename, "BenchmarkRunner::save_json");
+
+    char date[64];
+    time_t now = time(nullptr);
+    strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+
+    ofs << "{\n  \"context\": {\"date\": \"" << date << "\", \"threads\": " << threads;
+    ofs << ", \"min_time\": " << min_time << "},\n  \"benchmarks\": [";
+    ofs << fixed;
+    for (int i = 0; i < results.size(); i++) {
+        const BenchmarkResult &r = results[i];
+        ofs << (i ? ",\n" : "\n") << "    {\"name\": \"" << r.name << "\", \"shape\": \"" << r.shape << "\"";
+        ofs << ", \"iterations\": " << r.iterations;
+        ofs << setprecision(6) << ", \"mean_ms\": " << r.mean_ms << ", \"min_ms\": " << r.min_ms;
+        ofs << setprecision(3) << ", \"gflops\": " << (r.flops > 0.0 ? r.flops / (r.mean_ms * 1e6) : 0.0);
+        ofs << ", \"items_per_second\": " << r.items / (r.mean_ms / 1000.0) << "}";
+    }
+    ofs << "\n  ]\n}\n";
+}
@@ -0,0 +1,52 @@
+/*
+* EDDL Library - European Distributed Deep Learning Library.
+* Version: 0.7
+* copyright (c) 2020, Universidad Politécnica de Valencia (UPV), PRHLT Research Centre
+* Date: April 2020
+* Author: PRHLT Research Centre, UPV, (rparedes@prhlt.upv.es), (jon@prhlt.upv.es)
+* All rights reserved
+*/
+
+#ifndef EDDL_BENCHMARK_H
+#define EDDL_BENCHMARK_H
+
+#include <functional>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+struct BenchmarkResult {
+    string name;
+    string shape;
+    long iterations;
+    double mean_ms;
+    double min_ms;
+    double flops;      // Per iteration (0 if not estimated)
+    double items;      // Samples (or elements) per iteration
+};
+
+class BenchmarkRunner {
+public:
+    double min_time;   // Seconds per benchmark
+    int min_iters;
+    string filter;     // Only the benchmarks whose name contains it
+    int threads;
+    vector<BenchmarkResult> results;
+
+    BenchmarkRunner();
+
+    bool selected(const string &name) const;
+    bool selected_any(const vector<string> &names) const;  // Any of them (to skip the setup of a group)
+
+    // Times fn() after a warm-up call, until min_time and min_iters are reached
+    void run(const string &name, const string &shape, double flops, double items, const std::function<void()> &fn);
+
+    void print_table() const;
+    void save_json(const string &filename) const;
+};
+
+void kernel_benchmarks(BenchmarkRunner &runner);
+void model_benchmarks(BenchmarkRunner &runner);
+
+#endif //EDDL_BENCHMARK_H
@@ -0,0 +1,60 @@
+/*
+* EDDL Library - European Distributed Deep Learning Library.
+* Version: 0.7
+* copyright (c) 2020, Universidad Politécnica de Valencia (UPV), PRHLT Research Centre
+* Date: April 2020
+* Author: PRHLT Research Centre, UPV, (rparedes@prhlt.upv.es), (jon@prhlt.upv.es)
+* All rights reserved
+*/
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "benchmark.h"
+
+using namespace std;
+
+//////////////////////////////////
+// benchmarks:
+// Throughput of the CPU kernels and of full training steps
+//
+//   benchmarks [--filter=conv] [--json=results.json] [--min-time=0.5] [--threads=4] [--kernels|--models]
+//////////////////////////////////
+
+int main(int argc, char **argv){
+    BenchmarkRunner runner;
+    string json;
+    bool kernels = true, models = true;
+
+    for (int i = 1; i < argc; i++) {
+        string arg = argv[i];
+        if (arg.find("--filter=") == 0) runner.filter = arg.substr(9);
+        else if (arg.find("--json=") == 0) json = arg.substr(7);
+        else if (arg.find("--min-time=") == 0) runner.min_time = atof(arg.substr(11).c_str());
+        else if (arg.find("--threads=") == 0) runner.threads = atoi(arg.substr(10).c_str());
+        else if (arg == "--kernels") models = false;
+        else if (arg == "--models") kernels = false;
+        else {
+            cerr << "Usage: " << argv[0] << " [--filter=name] [--json=file] [--min-time=secs] [--threads=n] [--kernels|--models]" << endl;
+            return 1;
+        }
+    }
+
+#ifdef _OPENMP
+    if (runner.threads > 0) omp_set_num_threads(runner.threads);
+    else runner.threads = omp_get_max_threads();
+#endif
+
+    if (kernels) kernel_benchmarks(runner);
+    if (models) model_benchmarks(runner);
+
+    runner.print_table();
+    if (!json.empty()) runner.save_json(json);
+
+    return 0;
+}
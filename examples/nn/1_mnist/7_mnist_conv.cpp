@@ -64,15 +64,12 @@ int main(int argc, char **argv) {
     summary(net);
 
     // Load dataset
-    Tensor* x_train = Tensor::load("mnist_trX.bin");
+    // Images are kept as uint8 and normalised (/255) only when batches are selected
+    Tensor* x_train = Tensor::load_compact("mnist_trX.bin", DTYPE_UINT8, 1.0f/255.0f);
     Tensor* y_train = Tensor::load("mnist_trY.bin");
-    Tensor* x_test = Tensor::load("mnist_tsX.bin");
+    Tensor* x_test = Tensor::load_compact("mnist_tsX.bin", DTYPE_UINT8, 1.0f/255.0f);
     Tensor* y_test = Tensor::load("mnist_tsY.bin");
 
-    // Preprocessing
-    x_train->div_(255.0f);
-    x_test->div_(255.0f);
-
     // Train model
     fit(net, {x_train}, {y_train}, batch_size, epochs);
 
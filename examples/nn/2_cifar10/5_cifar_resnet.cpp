@@ -94,14 +94,13 @@ int main(int argc, char **argv){
   summary(net);
 
   // Load and preprocess training data
-  Tensor* x_train = Tensor::load("cifar_trX.bin");
+  // Images are kept as uint8 and normalised (/255) only when batches are selected
+  Tensor* x_train = Tensor::load_compact("cifar_trX.bin", DTYPE_UINT8, 1.0f/255.0f);
   Tensor* y_train = Tensor::load("cifar_trY.bin");
-  x_train->div_(255.0f);
 
   // Load and preprocess test data
-  Tensor* x_test = Tensor::load("cifar_tsX.bin");
+  Tensor* x_test = Tensor::load_compact("cifar_tsX.bin", DTYPE_UINT8, 1.0f/255.0f);
   Tensor* y_test = Tensor::load("cifar_tsY.bin");
-  x_test->div_(255.0f);
 
   for(int i=0;i<epochs;i++) {
     // training, list of input and output tensors, batch, epochs
@@ -22,6 +22,7 @@
 #include "eddl/regularizers/regularizer.h"
 #include "eddl/losses/loss.h"
 #include "eddl/metrics/metric.h"
+#include "eddl/dataset/image_folder.h"
 
 #include "eddl/layers/layer.h"
 #include "eddl/layers/conv/layer_conv.h"
@@ -87,7 +88,7 @@ typedef NetLoss * metric;
       *
       *  @param net  Model
       *  @param g  Vector with gpu ids to allocate the model
-      *  @param lsb  Number of batches to sync model weights
+      *  @param lsb  Number of batches to sync model weights (unused with several GPUs: their gradients are averaged after every batch)
       *  @return     (void)
     */
     void toGPU(model net, vector<int> g, int lsb);
@@ -160,7 +161,7 @@ typedef NetLoss * metric;
       *  @brief Executes de code in the GPU.
       *
       *  @param g  Vector of bools to set which GPUs will be used (1=on, 0=off)
-      *  @param lsb  (Multi-gpu setting) Number of batches to run before synchronizing the weights of the different GPUs
+      *  @param lsb  (Multi-gpu setting) Unused: the gradients of the different GPUs are averaged after every batch
       *  @param mem  Indicates de memory consumption of the model. One of "full_mem" (default), "mid_mem" or "low_mem".
       *  @return     The computer service itself.
     */
@@ -170,7 +171,7 @@ typedef NetLoss * metric;
       *  @brief Executes de code in the GPU.
       *
       *  @param g  Vector of bools to set which GPUs will be used (1=on, 0=off)
-      *  @param lsb  (Multi-gpu setting) Number of batches to run before synchronizing the weights of the different GPUs
+      *  @param lsb  (Multi-gpu setting) Unused: the gradients of the different GPUs are averaged after every batch
       *  @param mem  Indicates de memory consumption of the model. One of "full_mem" (default), "mid_mem" or "low_mem".
       *  @return     The computer service itself.
     */
@@ -187,7 +188,12 @@ typedef NetLoss * metric;
     compserv CS_FGPA(const vector<int> &f,int lsb=1);
 
     /**
-      *  @brief Executes de code through the COMP Superscalar (COMPSs) framework.
+      *  @brief Executes de code in several processes, which average their gradients after every batch.
+      *
+      *  Rank 0 runs the other ranks of its host (the same program by default), and every rank builds the same
+      *  model. The setup file has one "key value" per line: ranks, transport (unix or tcp), address (unix: prefix
+      *  of the socket files), hosts (tcp: host:port of each rank), threads, timeout, spawn and command.
+      *  Ranks on other hosts are started by the user, with their rank in the EDDL_RANK environment variable.
       *
       *  @param filename  File with the setup specification
       *  @return     The computer service itself.
@@ -205,6 +211,65 @@ typedef NetLoss * metric;
       *  @return     (void) Outputs log to the given file.
     */
     void setlogfile(model net,string fname);
+
+    /**
+      *  @brief  Augment an input of the model in the data pipeline of ``fit``. The next batch is selected and
+      *  augmented by background threads while the current one is trained, so the augmentation is not in the step time.
+      *
+      *  @param net  Model
+      *  @param spec  Ranges of the geometric operations (same as the RandomAffine layer)
+      *  @param input  Index of the input layer
+      *  @param workers  Number of threads of the augmentation
+      *  @return     (void)
+    */
+    void set_augmentation(model net, const AffineDescriptor &spec, int input=0, int workers=2);
+    /**
+      *  @brief  Trains every batch in chunks, accumulating their gradients, and applies the optimizer once per batch.
+      *  The activations only take the memory of a chunk, so the batches can be larger than the memory allows.
+      *
+      *  @param net  Model
+      *  @param chunks  Number of micro-batches of every batch (1 to disable)
+      *  @return     (void)
+    */
+    void set_micro_batches(model net, int chunks);
+    /**
+      *  @brief  Trains with the tensors kept for the backward (convolution lowering, batchnorm, LSTM gates) in 16 bits
+      *  on CPU. The layer outputs, the weights, the gradients and the accumulation of the products stay in fp32.
+      *  The memory saved is half of those buffers, of which the convolution lowering (batch x output size x kernel
+      *  size) is usually the largest. In exchange, the convolutions are lowered and multiplied one sample at a time
+      *  (so that no fp32 lowering of the whole batch is kept), and the buffers are converted on every forward and
+      *  backward, so the steps are slower than in fp32.
+      *
+      *  @param net  Model (built)
+      *  @param storage  "bf16", "fp16" or "fp32" (disabled)
+      *  @param loss_scale  Factor of the loss (the gradients are divided by it before the step). fp16 needs it (e.g. 65536), bf16 does not
+      *  @param dynamic  Skips the steps with inf or nan gradients halving the scale, and doubles it after 2000 steps without them
+      *  @return     (void)
+    */
+    void set_mixed_precision(model net, const string& storage="bf16", float loss_scale=1.0f, bool dynamic=false);
+    /**
+      *  @brief  Quantizes the Conv and Dense layers for inference on CPU: int8 weights with a scale per output channel,
+      *  int8 inputs and int32 accumulation. The scales of the inputs are calibrated with their maximum over the samples.
+      *  predict and evaluate use the int8 kernels. Training or loading fp32 weights drops the quantization (quantize again after it).
+      *
+      *  @param net  Model (built, CPU)
+      *  @param in  Calibration samples
+      *  @param batch_size  Samples per forward of the calibration
+      *  @return     (void)
+    */
+    void quantize(model net, const vector<Tensor *> &in, int batch_size=32);
+    /**
+      *  @brief  Memory layout of the 4D tensors between the layers on CPU. With "nhwc" the channels of each pixel are
+      *  contiguous from the first conv, pooling or batchnorm to the last one, and the elementwise layers in between.
+      *  The inputs, the outputs and the other layers keep NCHW, so only the layers at the borders convert the data.
+      *  The shapes do not change, but the outputs of the intermediate layers (getOutput) are in the layout of each layer.
+      *  The quantized convolutions (see quantize) stay in NCHW.
+      *
+      *  @param net  Model
+      *  @param layout  "nhwc" or "nchw" (default)
+      *  @return     (void)
+    */
+    void set_layout(model net, const string& layout="nhwc");
     /**
       *  @brief  Prints a summary representation of your model.
       *
@@ -212,6 +277,29 @@ typedef NetLoss * metric;
       *  @return     (void) Prints the model
     */
     void summary(model m);
+    /**
+      *  @brief  Starts (or stops) recording the time, the memory allocated and the estimated FLOPs of every forward, backward and optimizer step.
+      *
+      *  @param m  Model
+      *  @param enable  Start (true) or stop and discard the records (false)
+      *  @return     (void)
+    */
+    void profile(model m, bool enable=true);
+    /**
+      *  @brief  Prints the time spent in every layer since the profiling was enabled.
+      *
+      *  @param m  Model
+      *  @return     (void) Prints the table
+    */
+    void profile_summary(model m);
+    /**
+      *  @brief  Saves the recorded events as a Chrome trace (open it in chrome://tracing or ui.perfetto.dev).
+      *
+      *  @param m  Model
+      *  @param fname  Output file (.json)
+      *  @return     (void)
+    */
+    void save_profile(model m, const string& fname);
     /**
       *  @brief  Plots a representation of your model.
       *
@@ -227,6 +315,8 @@ typedef NetLoss * metric;
       *
       *  @param m  Model
       *  @param fname  Where are the model weights
+      *  @param format  "bin", "mmap" to map the weights saved with that format instead of reading them (copy-on-write, shared between processes),
+      *  or "int8" for the weights of a quantized model (the model is quantized when loaded)
       *  @return     (void) Load the weights
     */
     void load(model m, const string& fname, string format="bin");
@@ -235,9 +325,68 @@ typedef NetLoss * metric;
       *
       *  @param m  Model
       *  @param fname  Where the model weights will be saved
+      *  @param format  "bin", "mmap" to store page-aligned weights that can be loaded without copies, or "int8" for a quantized model
       *  @return     (void) Save the weights
     */
     void save(model m, const string& fname, string format="bin");
+    /**
+      *  @brief  Save the full training state of a model (weights, optimizer state, counters and random state).
+      *  The state is copied to memory and written to disk in a background thread.
+      *
+      *  @param m  Model
+      *  @param fname  Where the checkpoint will be saved
+      *  @param async  Write the file in a background thread
+      *  @return     (void) Save the checkpoint
+    */
+    void save_checkpoint(model m, const string& fname, bool async=true);
+    /**
+      *  @brief  Restore the full training state of a model saved with save_checkpoint.
+      *
+      *  @param m  Model (built with the same architecture and optimizer)
+      *  @param fname  Checkpoint file
+      *  @return     (void) Load the checkpoint
+    */
+    void load_checkpoint(model m, const string& fname);
+
+    // Distributed training
+    /**
+      *  @brief  Size of the buffer needed by serialize_exchange.
+      *
+      *  @param m  Model
+      *  @param gradients  Accumulated gradients (true) or weights (false)
+      *  @return     Size in bytes
+    */
+    size_t exchange_size(model m, bool gradients=true);
+    /**
+      *  @brief  Copy the accumulated gradients (or the weights) of the model to a compact binary buffer.
+      *  The buffer can be reused between rounds, so that the exchange only costs one copy per tensor.
+      *
+      *  @param m  Model (with enable_distributed for the gradients)
+      *  @param buffer  Buffer of at least exchange_size bytes. If nullptr, a new char[] buffer is allocated
+      *  @param gradients  Accumulated gradients (true) or weights (false)
+      *  @return     Size in bytes of the serialized data
+    */
+    size_t serialize_exchange(model m, void *&buffer, bool gradients=true);
+    /**
+      *  @brief  Apply a buffer written by serialize_exchange on a model with the same architecture.
+      *  The gradients are accumulated to the weights, and the weights are copied, reading the buffer in place.
+      *  The whole buffer is checked first: a malformed buffer throws and leaves the model unchanged.
+      *
+      *  @param m  Model
+      *  @param buffer  Serialized data
+      *  @param size  Size in bytes of the buffer
+      *  @return     (void)
+    */
+    void apply_exchange(model m, const void *buffer, size_t size);
+    /**
+      *  @brief  Compression of the gradients written by serialize_exchange.
+      *
+      *  @param m  Model
+      *  @param codec  "fp32", "fp16", "bf16", "int8" (stochastic rounding) or "topk" (largest values, the rest is kept for the next rounds)
+      *  @param ratio  Fraction of the values sent by "topk"
+      *  @return     (void)
+    */
+    void set_exchange_codec(model m, const string& codec, float ratio=0.01f);
 
     // Optimizer
     /**
@@ -668,7 +817,7 @@ typedef NetLoss * metric;
       *  @param strides  Vector of 2 integers, specifying the strides of the convolution along the height and width
       *  @param padding  One of "none", "valid" or "same"
       *  @param use_bias  Boolean, whether the layer uses a bias vector.
-      *  @param groups  Number of blocked connections from input channels to output channels
+      *  @param groups  Number of blocked connections from input channels to output channels. The channels and the filters must be multiples of it, and each group of filters only sees its group of channels. With as many groups as channels and filters it is a depthwise convolution (CPU only)
       *  @param dilation_rate  Vector of 2 integers, specifying the dilation rate to use for dilated convolution
       *  @param name  A name for the operation
       *  @return     Convolution layer
@@ -978,13 +1127,24 @@ typedef NetLoss * metric;
       *
       *  @param parent  Parent layer
       *  @param angle  Angle factor range
-      *  @param translate  Translate factor range
+      *  @param translate_x  Horizontal translate factor range (fraction of the width)
+      *  @param translate_y  Vertical translate factor range (fraction of the height)
       *  @param scale  Scaling factor range
       *  @param shear  Shear factor range
       *  @param name  A name for the operation
       *  @return     Output of affine transformation
     */
-    layer RandomAffine(layer parent, vector<float> angle, vector<float> translate, vector<float> scale, vector<float> shear, string name="");  // TODO: Implement
+    layer RandomAffine(layer parent, vector<float> angle, vector<float> translate_x, vector<float> translate_y, vector<float> scale, vector<float> shear, string name="");
+
+    /**
+      *  @brief Random geometric augmentation. All the operations (shift, rotation, zoom, shear, crop-scale and flips) of a sample are composed and the image is resampled only once, instead of once per DA layer.
+      *
+      *  @param parent  Parent layer
+      *  @param spec  Ranges of the operations, interpolation and wrapping mode (see AffineDescriptor). The same spec can be given to the data loaders
+      *  @param name  A name for the operation
+      *  @return     Output of the affine transformation
+    */
+    layer RandomAffine(layer parent, const AffineDescriptor &spec, string name="");
 
     /**
       *  @brief Crop the given image at a random location with size `[height, width]`.
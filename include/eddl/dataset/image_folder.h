@@ -0,0 +1,128 @@
+/*
+* EDDL Library - European Distributed Deep Learning Library.
+* Version: 0.7
+* copyright (c) 2020, Universidad Politécnica de Valencia (UPV), PRHLT Research Centre
+* Date: April 2020
+* Author: PRHLT Research Centre, UPV, (rparedes@prhlt.upv.es), (jon@prhlt.upv.es)
+* All rights reserved
+*/
+
+#ifndef EDDL_IMAGE_FOLDER_H
+#define EDDL_IMAGE_FOLDER_H
+
+#include <string>
+#include <vector>
+#include <deque>
+#include <map>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+#include "eddl/tensor/tensor.h"
+
+using namespace std;
+
+/**
+ * Image dataset read from disk by a pool of decode threads.
+ *
+ * The samples are either a directory with one subdirectory per class (labels follow the sorted
+ * subdirectory names) or a list file with one "image_path label" per line (paths relative to
+ * the list file). Workers decode, resize and convert the images to NCHW floats straight into a
+ * fixed set of batch buffers, so at most ``queue_size`` batches are in memory and ``next_batch``
+ * only waits when decoding is slower than training.
+ */
+class ImageFolder {
+private:
+    struct Batch {
+        Tensor *x;
+        Tensor *y;
+        int index;
+        string error;                  // Image of the batch that could not be decoded
+    };
+
+    vector<Batch> buffers;
+    deque<Batch *> free_buffers;
+    map<int, Batch *> ready;          // Decoded batches, by batch index
+
+    vector<std::thread> workers;
+    std::mutex mtx;
+    std::condition_variable cv_free;   // A buffer was released
+    std::condition_variable cv_ready;  // A batch was decoded
+
+    vector<int> order;                 // Sample order of the current epoch
+    int next_decode;                   // Next batch index to be taken by a worker
+    int next_read;                     // Next batch index to be returned
+    bool running;
+
+    bool augment;                      // Apply "augmentation" to the decoded samples
+    AffineDescriptor augmentation;
+    vector<float> matrices;            // Augmentation of every sample of the epoch (drawn by start)
+
+    void index_directory(const string &path);
+    void index_list(const string &filename);
+    void worker();
+    string decode(Batch *batch);
+    void release(Batch *batch);
+
+public:
+    vector<string> files;
+    vector<int> labels;
+    vector<string> classes;
+
+    int height;
+    int width;
+    int channels;
+    int batch_size;
+    bool shuffle;
+    int num_workers;
+    int queue_size;
+    float scale;
+
+    /**
+      *  @brief Index an image dataset.
+      *
+      *  @param path  Directory with one subdirectory per class, or list file ("image_path label" per line)
+      *  @param height  Height of the samples (images are resized)
+      *  @param width  Width of the samples (images are resized)
+      *  @param channels  Number of channels (1: grayscale, 3: RGB)
+      *  @param batch_size  Samples per batch. The last incomplete batch is dropped
+      *  @param shuffle  Shuffle the samples at the beginning of every epoch
+      *  @param num_workers  Number of decode threads
+      *  @param queue_size  Number of batches decoded ahead
+      *  @param scale  Factor applied to the pixel values (e.g. 1/255)
+    */
+    ImageFolder(const string &path, int height, int width, int channels=3, int batch_size=32, bool shuffle=true,
+                int num_workers=4, int queue_size=4, float scale=1.0f/255.0f);
+    ~ImageFolder();
+
+    int num_samples();
+    int num_classes();
+    int num_batches();
+
+    /**
+      *  @brief Augment the samples in the decode threads (same operations as the RandomAffine layer).
+      *
+      *  @param spec  Ranges of the geometric operations
+    */
+    void set_augmentation(const AffineDescriptor &spec);
+
+    /**
+      *  @brief Start an epoch. The samples are shuffled (if requested) and the workers start decoding.
+    */
+    void start();
+
+    /**
+      *  @brief Stop the workers. Pending batches are discarded.
+    */
+    void stop();
+
+    /**
+      *  @brief Copy the next batch of the epoch to x ({batch, channels, height, width}) and y (one-hot
+      *  {batch, classes}). Both can be in any device.
+      *
+      *  @return  false when the epoch is over, or the reader was stopped
+    */
+    bool next_batch(Tensor *x, Tensor *y);
+};
+
+#endif //EDDL_IMAGE_FOLDER_H
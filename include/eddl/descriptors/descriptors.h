@@ -11,6 +11,7 @@
 #define EDDL_DESCRIPTORS_H
 
 #include <cstdio>
+#include <cstdint>
 #include <vector>
 #include <string>
 #include <mutex>
@@ -58,6 +59,11 @@ public:
 
 };
 
+// Memory layout of the 4D tensors (see Net::set_layout). The shape is always {batch, channels, rows, cols},
+// LAYOUT_NHWC stores the channels of each pixel contiguously
+#define LAYOUT_NCHW 0
+#define LAYOUT_NHWC 1
+
 class ConvolDescriptor {
 public:
     vector<int> ksize;
@@ -74,6 +80,7 @@ public:
     int size;
     bool use_bias;
     int mem_level; // see CS
+    int groups = 1; // The filters of group g only see the input channels of group g (kz = iz / groups)
 
     Tensor *I= nullptr; // Input map
     Tensor *ID= nullptr;// Delta input map
@@ -86,13 +93,20 @@ public:
     Tensor *D = nullptr; // Delta
     Tensor *O= nullptr; // Outputmap
 
+    int layout = LAYOUT_NCHW;     // Of O and D
+    int in_layout = LAYOUT_NCHW;  // Of I and ID
+
     // CPU implementation
-    float *ptrI;
+    float *ptrI = nullptr;      // Not allocated for depthwise convolutions, which do not lower the input
+    int storage = MP_FP32;      // MP_BF16, MP_FP16: ptrI is the lowering of a sample, and the batch is in ptrI16
+    vector<uint16_t> ptrI16;
     Eigen::MatrixXf matI; // input
     Eigen::MatrixXf matK; // kernels
     Eigen::MatrixXf matO; // output
     Eigen::MatrixXf matD; // Delta
     Eigen::MatrixXf matgK; // gradient kernels
+    vector<float> Kt;      // Channels last lowering: K as {nk, kr, kc, kz}. Depthwise: {kr, kc, nk}
+    bool Kt_stale = true;  // K changed since Kt was built (see Net::drop_quantization)
 
     // GPU implementation
     Tensor *gpuI; // input
@@ -105,12 +119,14 @@ public:
 
     ConvolDescriptor();
 
-    ConvolDescriptor(int filters, const vector<int> &ks, const vector<int> &st, const string& p, bool use_bias, int mem=0);
+    ConvolDescriptor(int filters, const vector<int> &ks, const vector<int> &st, const string& p, bool use_bias, int mem=0, int groups=1);
 
-    ConvolDescriptor(const vector<int> &ks, const vector<int> &st, const vector<int> &p, int mem=0);
+    ConvolDescriptor(const vector<int> &ks, const vector<int> &st, const vector<int> &p, int mem=0, int groups=1);
 
     void build(Tensor *A);
     void resize(int b);
+    void set_storage(int s);
+    bool depthwise() const { return groups == iz && nk == iz; }
 	void enable_distributed();
 
 	static int compute_output(const string& padding, int input_size, int kerkel_size, int stride, int dilation_rate=1);
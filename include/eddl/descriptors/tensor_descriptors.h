@@ -15,6 +15,8 @@
 #include <string>
 #include <mutex>
 
+#include "eddl/utils.h"
+
 
 using namespace std;
 
@@ -89,4 +91,73 @@ public:
 };
 
 
+/*
+ * Random geometric augmentation of 2D images. All the operations of a sample (crop-scale, zoom,
+ * rotation, shear, shift and flips) are composed into a single 2x3 matrix, so every image is
+ * resampled only once (see Tensor::affine).
+ */
+class AffineDescriptor {
+public:
+    vector<float> factor_x;      // Shift range (fraction of the width)
+    vector<float> factor_y;      // Shift range (fraction of the height)
+    vector<float> angle;         // Rotation range (degrees)
+    vector<float> scale;         // Zoom range (>1 enlarges the image)
+    vector<float> shear;         // Horizontal shear range (degrees)
+    vector<float> crop;          // Side of a random crop that is scaled back to the full size (fraction)
+    bool flip_x;                 // Flip horizontally with probability 0.5
+    bool flip_y;                 // Flip vertically with probability 0.5
+    bool bilinear;               // Bilinear or nearest interpolation
+    WrappingMode da_mode;
+    float cval;
+
+    AffineDescriptor(vector<float> factor_x={0.0f, 0.0f}, vector<float> factor_y={0.0f, 0.0f},
+                     vector<float> angle={0.0f, 0.0f}, vector<float> scale={1.0f, 1.0f},
+                     vector<float> shear={0.0f, 0.0f}, vector<float> crop={1.0f, 1.0f},
+                     bool flip_x=false, bool flip_y=false, const string& interpolation="bilinear",
+                     WrappingMode da_mode=WrappingMode::Constant, float cval=0.0f);
+
+    // Draws the parameters of one sample and writes the matrix that maps output coordinates
+    // (row, col) to input coordinates: {m0, m1, m2, m3, m4, m5} -> (m0*r + m1*c + m2, m3*r + m4*c + m5)
+    void sample(int height, int width, float *m) const;
+
+    // Matrices of a whole batch (6 floats per sample)
+    vector<float> sample_batch(int batch, int height, int width) const;
+};
+
+
+// Elementwise ops of a fused chain. Each op reads the running value x (and a side input s for the
+// binary ones) and writes the new running value
+enum FusedOpCode {
+    FUSED_ADD_SCALAR,       // x + val
+    FUSED_MULT_SCALAR,      // x * val
+    FUSED_RDIFF_SCALAR,     // val - x
+    FUSED_RDIV_SCALAR,      // val / x
+    FUSED_ADD,              // x + s
+    FUSED_DIFF,             // x - s (s - x if right)
+    FUSED_MULT,             // x * s
+    FUSED_DIV,              // x / s (s / x if right)
+    FUSED_EXP,
+    FUSED_LOG,
+    FUSED_LOG2,
+    FUSED_LOG10,
+    FUSED_SQRT,
+    FUSED_ABS,
+    FUSED_RELU,
+    FUSED_THRESHOLDED_RELU, // param: val
+    FUSED_LEAKY_RELU,       // param: val
+    FUSED_ELU,              // param: val
+    FUSED_LINEAR,           // param: val
+    FUSED_SIGMOID,
+    FUSED_HARD_SIGMOID,
+    FUSED_TANH
+};
+
+struct FusedOp {
+    FusedOpCode code;
+    float val = 0.0f;       // Scalar operand or activation param
+    int side = -1;          // Index of the side input (binary ops)
+    bool right = false;     // The running value is the right operand (binary ops)
+};
+
+
 #endif //EDDL_TENSOR_DESCRIPTORS_H
@@ -0,0 +1,209 @@
+/*
+* EDDL Library - European Distributed Deep Learning Library.
+* Version: 0.7
+* copyright (c) 2020, Universidad Politécnica de Valencia (UPV), PRHLT Research Centre
+* Date: April 2020
+* Author: PRHLT Research Centre, UPV, (rparedes@prhlt.upv.es), (jon@prhlt.upv.es)
+* All rights reserved
+*/
+
+#ifndef EDDL_CPU_STRIDED_H
+#define EDDL_CPU_STRIDED_H
+
+#include <vector>
+#include <algorithm>
+
+#include "eddl/tensor/tensor.h"
+#include "eddl/utils.h"
+
+using namespace std;
+
+// Number of elements of the inner loop given to each thread
+#define CPU_STRIDED_CHUNK 16384
+
+// Address (in elements, relative to ptr) of the i-th element of A in row-major order
+inline long cpu_strided_address(Tensor *A, long i){
+    long address = 0;
+    for (int d = (int)A->ndim - 1; d >= 0; d--) {
+        address += (i % A->shape[d]) * (long)A->stride[d];
+        i /= A->shape[d];
+    }
+    return address;
+}
+
+// Strides of A when it is broadcast to "shape" (NumPy rules). Missing and stretched
+// dimensions get stride 0, so the same element is read along them
+inline vector<int> cpu_broadcast_strides(Tensor *A, const vector<int> &shape){
+    vector<int> strides(shape.size(), 0);
+    int offset = (int)shape.size() - A->ndim;
+    for (int d = 0; d < A->ndim; d++) {
+        if (A->shape[d] != 1) strides[offset + d] = A->stride[d];
+    }
+    return strides;
+}
+
+// Compact tensors keep no float data (ptr is null) until they are selected or copied
+inline void cpu_check_compact(Tensor *A){
+    if (A->is_compact()) msg("Compact tensors can only be selected or copied", "cpu_check_compact");
+}
+
+/*
+ * Walks N operands that share the same (iteration) shape but may have different strides.
+ * Dimensions of size 1 are dropped and consecutive dimensions that are contiguous for all
+ * the operands are merged, so most calls end up with a single long inner loop.
+ * The inner loop is given to "kernel(float **p, const int *s, int n)", where p[k] points to
+ * the first element of the operand k and s[k] is its stride (0 means broadcasting).
+ */
+template<int N, typename F>
+void cpu_strided_loop(const vector<int> &shape, float *const ptrs[N], const vector<int> *strides, F kernel){
+    vector<int> cshape;
+    vector<int> cstride[N];
+
+    // Collapse dimensions
+    for (int d = 0; d < (int)shape.size(); d++) {
+        if (shape[d] == 1) continue;
+
+        bool merge = !cshape.empty();
+        for (int k = 0; k < N && merge; k++) {
+            if (cstride[k].back() != strides[k][d] * shape[d]) merge = false;
+        }
+
+        if (merge) {
+            cshape.back() *= shape[d];
+            for (int k = 0; k < N; k++) { cstride[k].back() = strides[k][d]; }
+        } else {
+            cshape.push_back(shape[d]);
+            for (int k = 0; k < N; k++) { cstride[k].push_back(strides[k][d]); }
+        }
+    }
+    if (cshape.empty()) {  // Scalar
+        cshape.push_back(1);
+        for (int k = 0; k < N; k++) { cstride[k].push_back(0); }
+    }
+
+    int cdim = (int)cshape.size();
+    int n_inner = cshape[cdim-1];
+    int s_inner[N];
+    for (int k = 0; k < N; k++) { s_inner[k] = cstride[k][cdim-1]; }
+
+    long n_outer = 1;
+    for (int d = 0; d < cdim-1; d++) { n_outer *= cshape[d]; }
+
+    // Long inner loops are split in chunks so that contiguous tensors are also processed in parallel
+    long n_chunks = (n_inner + CPU_STRIDED_CHUNK - 1) / CPU_STRIDED_CHUNK;
+    long n_tasks = n_outer * n_chunks;
+
+#pragma omp parallel for if(n_tasks > 1)
+    for (long t = 0; t < n_tasks; t++) {
+        long o = t / n_chunks;
+        long c = t % n_chunks;
+
+        float *p[N];
+        for (int k = 0; k < N; k++) { p[k] = ptrs[k]; }
+        for (int d = cdim - 2; d >= 0; d--) {
+            long idx = o % cshape[d];
+            o /= cshape[d];
+            for (int k = 0; k < N; k++) { p[k] += idx * cstride[k][d]; }
+        }
+
+        long first = c * CPU_STRIDED_CHUNK;
+        int n = (int)std::min((long)CPU_STRIDED_CHUNK, (long)n_inner - first);
+        for (int k = 0; k < N; k++) { p[k] += first * s_inner[k]; }
+
+        kernel(p, s_inner, n);
+    }
+}
+
+// B = f(A). A and B may be views, and A may be broadcast to the shape of B
+template<typename F>
+void cpu_strided_unary(Tensor *A, Tensor *B, F f){
+    cpu_check_compact(A); cpu_check_compact(B);
+    float *const ptrs[2] = {B->ptr, A->ptr};
+    const vector<int> strides[2] = {B->stride, cpu_broadcast_strides(A, B->shape)};
+
+    cpu_strided_loop<2>(B->shape, ptrs, strides, [&f](float **p, const int *s, int n){
+        float *b = p[0];
+        const float *a = p[1];
+        if (s[0] == 1 && s[1] == 1) {
+            for (int i = 0; i < n; i++) b[i] = f(a[i]);
+        } else if (s[0] == 1 && s[1] == 0) {
+            const float va = f(*a);
+            for (int i = 0; i < n; i++) b[i] = va;
+        } else {
+            for (int i = 0; i < n; i++) b[i * s[0]] = f(a[i * s[1]]);
+        }
+    });
+}
+
+// C = f(A, B) (or C += f(A, B) if incC). Operands may be views, and A and B may be
+// broadcast to the shape of C
+template<typename F>
+void cpu_strided_binary(Tensor *A, Tensor *B, Tensor *C, int incC, F f){
+    cpu_check_compact(A); cpu_check_compact(B); cpu_check_compact(C);
+    float *const ptrs[3] = {C->ptr, A->ptr, B->ptr};
+    const vector<int> strides[3] = {C->stride, cpu_broadcast_strides(A, C->shape), cpu_broadcast_strides(B, C->shape)};
+
+    cpu_strided_loop<3>(C->shape, ptrs, strides, [&f, incC](float **p, const int *s, int n){
+        float *c = p[0];
+        const float *a = p[1];
+        const float *b = p[2];
+        if (s[0] == 1 && s[1] == 1 && s[2] == 1) {
+            if (incC) { for (int i = 0; i < n; i++) c[i] += f(a[i], b[i]); }
+            else { for (int i = 0; i < n; i++) c[i] = f(a[i], b[i]); }
+        } else if (s[0] == 1 && s[1] == 1 && s[2] == 0) {  // B broadcast along the inner loop
+            const float vb = *b;
+            if (incC) { for (int i = 0; i < n; i++) c[i] += f(a[i], vb); }
+            else { for (int i = 0; i < n; i++) c[i] = f(a[i], vb); }
+        } else if (s[0] == 1 && s[1] == 0 && s[2] == 1) {  // A broadcast along the inner loop
+            const float va = *a;
+            if (incC) { for (int i = 0; i < n; i++) c[i] += f(va, b[i]); }
+            else { for (int i = 0; i < n; i++) c[i] = f(va, b[i]); }
+        } else {
+            if (incC) { for (int i = 0; i < n; i++) c[i * s[0]] += f(a[i * s[1]], b[i * s[2]]); }
+            else { for (int i = 0; i < n; i++) c[i * s[0]] = f(a[i * s[1]], b[i * s[2]]); }
+        }
+    });
+}
+
+// Sum of f(a) over all the elements of A. A may be a view
+template<typename F>
+float cpu_strided_sum(Tensor *A, F f){
+    cpu_check_compact(A);
+    float sum = 0.0f;
+    float *const ptrs[1] = {A->ptr};
+    const vector<int> strides[1] = {A->stride};
+
+    cpu_strided_loop<1>(A->shape, ptrs, strides, [&f, &sum](float **p, const int *s, int n){
+        const float *a = p[0];
+        float partial = 0.0f;
+        if (s[0] == 1) {
+            for (int i = 0; i < n; i++) partial += f(a[i]);
+        } else {
+            for (int i = 0; i < n; i++) partial += f(a[i * s[0]]);
+        }
+#pragma omp atomic
+        sum += partial;
+    });
+
+    return sum;
+}
+
+// Kernels that walk the data through address maps (reductions, selections,...) were built for
+// row-major data, so views are materialised while the guard is alive
+class ContiguousGuard {
+public:
+    Tensor *t;
+    bool owned;
+
+    explicit ContiguousGuard(Tensor *A) {
+        cpu_check_compact(A);
+        owned = !A->is_contiguous();
+        t = owned ? Tensor::contiguous(A) : A;
+    }
+
+    ~ContiguousGuard() {
+        if (owned) delete t;
+    }
+};
+
+#endif //EDDL_CPU_STRIDED_H
@@ -36,6 +36,11 @@ void cpu_set_select(Tensor *A, Tensor *B, SelDescriptor *sd);
 void cpu_set_select_back(Tensor *A, Tensor *B, SelDescriptor *sd);
 
 void cpu_select(Tensor *A, Tensor *B, vector<int> sind, int ini, int end,bool mask_zeros=false); // TODO: Legacy
+void cpu_select_compact(Tensor *A, Tensor *B, vector<int> sind, int ini, int end, bool mask_zeros=false);
+void cpu_compact(const float *A, void *B, long size, int dtype);
+int cpu_dtype_size(int dtype);
+void cpu_to_half(const float *A, uint16_t *B, long size, bool bf16);  // fp16 (or bf16), round to nearest even
+void cpu_from_half(const uint16_t *A, float *B, long size, bool bf16);
 void cpu_deselect(Tensor *A, Tensor *B, vector<int> sind, int ini, int end,int inc=0,bool mask_zeros=false); // TODO: Legacy
 
 void cpu_concat(Tensor *A, vector<Tensor*> t, unsigned int axis, bool derivative);
@@ -60,6 +65,9 @@ void cpu_scale(Tensor *A, Tensor *B, vector<int> new_shape, int mode, float cons
 void cpu_flip(Tensor *A, Tensor *B, int axis);
 void cpu_crop(Tensor *A, Tensor *B, vector<int> coords_from, vector<int> coords_to, float constant, bool inverse);
 void cpu_crop_scale(Tensor *A, Tensor *B, vector<int> coords_from, vector<int> coords_to, int mode, float constant);
+void cpu_single_affine(const float *A, float *B, int channels, int height, int width, const float *m, bool bilinear, int mode, float constant);
+void cpu_affine(Tensor *A, Tensor *B, const float *matrices, bool bilinear, int mode, float constant);
+void cpu_image_to_chw(const unsigned char *pixels, int height, int width, int channels, float *B, int new_height, int new_width, float scale);
 
 // CPU: Data augmentations (2D Optimized) ********************************************
 void cpu_shift_random(Tensor *A, Tensor *B, vector<float> factor_x, vector<float> factor_y, int mode, float constant);
@@ -97,6 +105,7 @@ void cpu_round(Tensor *A, Tensor *B);
 void cpu_rsqrt(Tensor *A, Tensor *B);
 void cpu_sigmoid(Tensor *A, Tensor *B);
 void cpu_sign(Tensor *A, Tensor *B, float zero_sign=0.0f);
+void cpu_regularize(Tensor *A, Tensor *B, float l1, float l2);
 void cpu_sin(Tensor *A, Tensor *B);
 void cpu_sinh(Tensor *A, Tensor *B);
 void cpu_sqr(Tensor *A, Tensor *B);
@@ -109,6 +118,9 @@ void cpu_trunc(Tensor *A, Tensor *B);
 void cpu_add(float scA, Tensor *A, float scB, Tensor *B, Tensor *C, int incC);
 void cpu_inc(Tensor *A, Tensor *B);
 void cpu_mult2D(Tensor *A, int tA, Tensor *B, int tB, Tensor *C, int incC);
+void cpu_mult2D_batched(const vector<Tensor*> &A, int tA, const vector<Tensor*> &B, int tB, const vector<Tensor*> &C, int incC);
+void cpu_gemm(int tA, int tB, int m, int n, int k, float *A, float *B, float *C, int incC);
+void cpu_gemm_strided_batched(int tA, int tB, int m, int n, int k, float *A, long sA, float *B, long sB, float *C, long sC, int batch, int incC);
 void cpu_el_div(Tensor *A, Tensor *B, Tensor *C, int incC);
 void cpu_el_mult(Tensor *A, Tensor *B, Tensor *C, int incC);
 void cpu_sum2D_rowwise(Tensor *A, Tensor *B, Tensor *C);
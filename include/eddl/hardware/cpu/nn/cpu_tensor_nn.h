@@ -68,14 +68,24 @@ int cpu_bin_accuracy(Tensor *A, Tensor *B);
 void cpu_conv2D(ConvolDescriptor *D);
 void cpu_conv2D_grad(ConvolDescriptor *D);
 void cpu_conv2D_back(ConvolDescriptor *D);
+void cpu_conv2D_nhwc(ConvolDescriptor *D);
+void cpu_conv2D_grad_nhwc(ConvolDescriptor *D);
+void cpu_conv2D_back_nhwc(ConvolDescriptor *D);
+void cpu_conv2D_grouped(ConvolDescriptor *D);
+void cpu_conv2D_grad_grouped(ConvolDescriptor *D);
+void cpu_conv2D_back_grouped(ConvolDescriptor *D);
 
 // MaxPool
 void cpu_mpool2D(PoolDescriptor*D);
 void cpu_mpool2D_back(PoolDescriptor *D);
+void cpu_mpool2D_nhwc(PoolDescriptor *D);
+void cpu_mpool2D_back_nhwc(PoolDescriptor *D);
 
 // AvgPool
 void cpu_avgpool2D(PoolDescriptor*D);
 void cpu_avgpool2D_back(PoolDescriptor *D);
+void cpu_avgpool2D_nhwc(PoolDescriptor *D);
+void cpu_avgpool2D_back_nhwc(PoolDescriptor *D);
 
 // Tensor (special functions that deal with 4D tensors)
 void cpu_repeat_nn(Tensor *A, Tensor *B, vector<int> size);
@@ -86,6 +96,24 @@ void cpu_select_back_nn(Tensor *A, Tensor *B, SelDescriptor *sd);
 void cpu_set_select_nn(Tensor *A, Tensor *B, SelDescriptor *sd);
 void cpu_set_select_back_nn(Tensor *A, Tensor *B, SelDescriptor *sd);
 
+// Optimizers
+void cpu_sgd_step(Tensor *W, Tensor *G, Tensor *M, float lr, float mu, float l1, float l2);
+void cpu_adam_step(Tensor *W, Tensor *G, Tensor *M, Tensor *V, float lr, float beta_1, float beta_2, float epsilon, int t, float l1, float l2);
+void cpu_rmsprop_step(Tensor *W, Tensor *G, Tensor *G1, float lr, float rho, float epsilon, float l1, float l2);
+
+// Fused elementwise chains
+void cpu_fused_forward(const vector<FusedOp> &ops, Tensor *X, const vector<Tensor *> &S, Tensor *Y);
+void cpu_fused_backward(const vector<FusedOp> &ops, Tensor *X, const vector<Tensor *> &S, Tensor *Y, Tensor *D,
+                        Tensor *PD, const vector<Tensor *> &SD);
+
+// INT8 inference
+void cpu_quantize_s8(const float *x, int8_t *q, long n, float scale);
+// C_b (m x n) = A (m x k) * op(B_b), op(B_b) = B_b (k x n, rows of ldb) or B_b' (n x k) with transB, for batch samples
+void cpu_gemm_s8(int m, int n, int k, const int8_t *A, const int8_t *B, long ldb, long strideB, bool transB,
+                 int32_t *C, long strideC, int batch);
+void cpu_dense_s8(Tensor *A, const int8_t *W, const float *scales, float input_scale, Tensor *bias, Tensor *B);
+void cpu_conv2D_s8(ConvolDescriptor *D, const int8_t *K, const float *scales, float input_scale);
+
 // BN
 void cpu_permute_channels_first(Tensor *A,Tensor *B);
 void cpu_permute_channels_last(Tensor *A,Tensor *B);
@@ -98,6 +98,7 @@ void gpu_round(Tensor *A, Tensor *B);
 void gpu_rsqrt(Tensor *A, Tensor *B);
 void gpu_sigmoid(Tensor *A, Tensor *B);
 void gpu_sign(Tensor *A, Tensor *B, float zero_sign=0.0f);
+void gpu_regularize(Tensor *A, Tensor *B, float l1, float l2);
 void gpu_sin(Tensor *A, Tensor *B);
 void gpu_sinh(Tensor *A, Tensor *B);
 void gpu_sqr(Tensor *A, Tensor *B);
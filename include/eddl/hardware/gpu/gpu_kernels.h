@@ -94,6 +94,7 @@ __global__ void gpu_round(float *A, float *B, long int size);
 __global__ void gpu_rsqrt(float *A, float *B, long int size);
 __global__ void gpu_sigmoid(float *A, float *B, long int size);
 __global__ void gpu_sign(float *A, float *B, long int size, float zero_sign);
+__global__ void gpu_regularize(float *A, float *B, long int size, float l1, float l2);
 __global__ void gpu_sin(float *A, float *B, long int size);
 __global__ void gpu_sinh(float *A, float *B, long int size);
 __global__ void gpu_sqr(float *A, float *B, long int size);
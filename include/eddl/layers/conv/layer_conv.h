@@ -32,7 +32,7 @@ public:
     ConvolDescriptor *cd;
 
     // constructors and clones
-    LConv(Layer *parent, const vector<int> &ks, const vector<int> &st, const vector<int> &p, string name, int dev, int mem);
+    LConv(Layer *parent, const vector<int> &ks, const vector<int> &st, const vector<int> &p, string name, int dev, int mem, int groups=1);
 
     LConv(Layer *parent, int filters, const vector<int> &ks, const vector<int> &st,const vector<int> &p, string name, int dev, int mem);
 
@@ -54,6 +54,8 @@ public:
 
     void resize(int batch) override;
 
+    void set_storage(int s) override;
+
 	void update_weights(Tensor* w, Tensor* bias=nullptr) override;
 
 	void accumulate_accumulated_gradients(Tensor* gw, Tensor* gbias=nullptr) override;
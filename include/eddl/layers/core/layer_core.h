@@ -286,6 +286,9 @@ public:
 
     void resize(int b) override;
 
+    // Permutation (or its inverse) including the batch axis
+    vector<int> batch_dims(bool inverse);
+
     Layer *share(int c, int bs, vector<Layer *> p) override;
 
     Layer *clone(int c, int bs, vector<Layer *> p, int todev) override;
@@ -330,4 +330,23 @@ public:
     string plot(int c) override;
 };
 
+/// Affine Layer (all the geometric augmentations in a single resample)
+class LAffineRandom : public LDataAugmentation {
+public:
+    static int total_layers;
+    AffineDescriptor spec;
+
+    LAffineRandom(Layer *parent, const AffineDescriptor &spec, string name, int dev, int mem);
+
+    Layer *share(int c, int bs, vector<Layer *> p) override;
+
+    Layer *clone(int c, int bs, vector<Layer *> p, int todev) override;
+
+    void forward() override;
+
+    void backward() override;
+
+    string plot(int c) override;
+};
+
 #endif //EDDL_LAYER_DA_H
@@ -13,6 +13,7 @@
 
 #include <string>
 #include <cstdio>
+#include <cstdint>
 
 #include "eddl/initializers/initializer.h"
 
@@ -29,6 +30,23 @@ using namespace std;
 
 class Net;
 
+// INT8 weights of a LConv or LDense (see Net::quantize). Each output channel has its k weights
+// quantized with its own scale (max |w| / 127), and the input is quantized with input_scale
+class Quantization {
+public:
+    int channels;
+    int k;
+    vector<int8_t> weights;     // channels x k
+    vector<float> scales;       // Per channel
+    float input_scale;          // Calibrated max |input| / 127
+
+    // W holds the k weights of each channel, or (transposed) the channels weights of each k
+    Quantization(const float *W, int channels, int k, bool transposed, float input_scale);
+    Quantization(int channels, int k, float input_scale);
+
+    void dequantize(float *W, bool transposed);
+};
+
 class Layer {
 public:
     string name;
@@ -40,6 +58,9 @@ public:
     Net *net;
     bool trainable;
     int mem_level; // See CS
+    int storage;   // MP_FP32, MP_BF16 or MP_FP16 (see Net::set_mixed_precision)
+    Quantization *quant;  // INT8 inference, nullptr in fp32 (see Net::quantize)
+    int layout;    // Memory layout of the output and the delta (see Net::set_layout)
     bool isrecurrent;
     bool isshared;
     bool iscloned;
@@ -60,6 +81,7 @@ public:
     vector<Layer *> clones;
 
     Regularizer *reg;
+    int reg_params;  // The regularizer decays the first reg_params params (applied by the optimizer)
     Initializer *init;
 
     int mode;
@@ -93,6 +115,10 @@ public:
 
     void set_mem_level(int mem);
 
+    // Tensors kept for the backward, in 16 bits with mixed precision (CPU)
+    void pack(Tensor *t, vector<uint16_t> &buf);
+    Tensor *unpack(vector<uint16_t> &buf, const vector<int> &shape);
+
     virtual void mem_delta_parent();
     virtual void mem_delta();
     virtual void free_delta();
@@ -103,6 +129,7 @@ public:
 
     virtual void resize(int batch);
     virtual void set_trainable(bool value);
+    virtual void set_storage(int s) { storage = s; }
 
     virtual void save(std::ofstream &ofs, string format="");
     virtual void load(std::ifstream &ifs, string format="");
@@ -25,10 +25,6 @@ using namespace std;
 
 void BN_forward(Tensor *input, Tensor *bn_mean, Tensor *bn_var, Tensor *mean, Tensor *variance,float momentum, float epsilon, int trmode);
 void BN_backward(Tensor *delta, Tensor *bn_var, Tensor *opa);
-void rsum(Tensor *A, Tensor *b, Tensor *ones, Tensor *mem,int p=1);
-void rdiff(Tensor *A, Tensor *b, Tensor *ones,Tensor *mem,int p=1);
-void rmult(Tensor *A, Tensor *b, Tensor *ones,Tensor *mem,int p=1);
-void rdiv(Tensor *A, Tensor *b, Tensor *ones,Tensor *mem,int p=1);
 void cmean(Tensor *A, Tensor *b,Tensor *ones,int p=1);
 
 
@@ -46,6 +42,7 @@ public:
     Tensor *gbn_g;
     Tensor *gbn_b;
     Tensor *opa; //output pre-affine
+    vector<uint16_t> opa16; // opa in 16 bits (mixed precision), opa is nullptr
 
     bool init;
     vector<int> shape;
@@ -67,6 +64,8 @@ public:
 
     void resize(int batch) override;
 
+    void set_storage(int s) override;
+
     int get_trainable_params_count() override;
 
     string plot(int c) override;
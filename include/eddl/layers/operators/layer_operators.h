@@ -252,6 +252,29 @@ public:
     Layer *clone(int c, int bs, vector<Layer *> p, int todev) override;
 };
 
+/// Fused chain of elementwise layers (see Net::fuse)
+/// Runs the ops of all the layers of the chain in a single pass. Only the last layer of the chain
+/// keeps its output (and its delta); the rest of them are not executed
+class LFused : public Layer {
+public:
+    vector<Layer *> layers;   // Layers of the chain, in order
+    vector<FusedOp> ops;      // One op per layer
+    Layer *head;              // Input of the chain
+    vector<Layer *> sides;    // Side inputs of the binary ops
+
+    LFused(vector<Layer *> layers, vector<FusedOp> ops, Layer *head, vector<Layer *> sides);
+    ~LFused() override;
+
+    // Op of layer "l" when its running input is the output of "in". Returns false if the layer can not be fused
+    static bool get_op(Layer *l, Layer *in, FusedOp &op, Layer *&side);
+
+    void free_delta() override;
+
+    void forward() override;
+
+    void backward() override;
+};
+
 /// Var Layer
 /*class LVar : public OperatorLayer {
 public:
@@ -111,6 +111,7 @@ public:
 
     Tensor *incn,*cn1fn;
     Tensor *sh;
+    vector<uint16_t> packed[5];  // in, fn, on, cn and sh in 16 bits (mixed precision)
 
     Tensor *mask;
     Tensor *psh;
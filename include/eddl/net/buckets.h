@@ -0,0 +1,68 @@
+/*
+* EDDL Library - European Distributed Deep Learning Library.
+* Version: 0.7
+* copyright (c) 2020, Universidad Politécnica de Valencia (UPV), PRHLT Research Centre
+* Date: April 2020
+* Author: PRHLT Research Centre, UPV, (rparedes@prhlt.upv.es), (jon@prhlt.upv.es)
+* All rights reserved
+*/
+
+#ifndef EDDL_BUCKETS_H
+#define EDDL_BUCKETS_H
+
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "eddl/tensor/tensor.h"
+
+using namespace std;
+
+class Net;
+class Layer;
+
+typedef vector<Tensor *> vtensor;
+
+// Gradients of the replicas of a net (one per device, see Net::split), averaged layer by layer.
+// Each layer is a bucket, which is averaged by a background thread as soon as every replica has
+// done its backward, while the replicas go on with the backward of the previous layers. The running
+// statistics of BatchNorm are averaged with the gradients of their layer, so the replicas keep the
+// same state. Only tested with CPU nets standing in for the replicas of the GPUs
+class GradientBuckets {
+public:
+    // The replicas have the same layers in the same order
+    explicit GradientBuckets(const vector<Net *> &replicas);
+    ~GradientBuckets();
+
+    void ready(Layer *l);   // Called by the replica of l after its backward
+    void wait();            // Called by every replica before applying the gradients
+
+private:
+    vector<Net *> replicas;
+    map<Layer *, int> index;            // Layer of a replica -> bucket
+    vector<vector<vtensor>> tensors;    // [bucket][replica], gradients and running statistics
+    vector<vtensor> sum;                // [bucket], on CPU
+    vector<vtensor> tmp;
+
+    thread worker;
+    mutex mtx;
+    condition_variable cv;
+    deque<int> queue;
+    vector<int> count;      // Replicas done with each bucket
+    int reduced;
+    int arrived;
+    unsigned long generation;
+    bool stop;
+    string error;
+
+    static vtensor bucket_tensors(Layer *l);
+    void reduce(int b);
+    void finish();
+    void run();
+};
+
+#endif //EDDL_BUCKETS_H
@@ -17,6 +17,8 @@
 
 using namespace std;
 
+class Ring;
+
 class CompServ {
 public:
     string type;
@@ -36,10 +38,20 @@ public:
     // 2: low memory. save memory as much as possible
     int mem_level;
 
+    // for Distributed (see CS_COMPSS): one process per rank, connected in a ring
+    int rank;
+    int world;
+    string transport;           // unix or tcp
+    vector<string> addresses;   // unix: prefix of the socket files, tcp: host:port of each rank
+    vector<string> command;     // Command run by the spawned ranks (the same program by default)
+    int timeout;
+    Ring *ring;
+    vector<int> workers;        // Processes spawned by rank 0
 
 
     CompServ();
-    CompServ * share();
+    ~CompServ();
+    CompServ * share();  // Shares the ring (owned by the original)
 
     // for local
     CompServ(int threads, const vector<int> g, const vector<int> &f,int lsb=1, int mem=0);
@@ -47,6 +59,9 @@ public:
     // for Distributed
     explicit CompServ(string filename);
 
+    // Waits for the spawned ranks, and returns how many of them failed
+    int wait_workers();
+
 
 };
 
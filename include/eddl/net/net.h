@@ -13,12 +13,21 @@
 
 #include <string>
 #include <vector>
+#include <random>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <exception>
+#include <pthread.h>
 
 #include "eddl/layers/layer.h"
 #include "eddl/optimizers/optim.h"
 #include "eddl/losses/loss.h"
 #include "eddl/metrics/metric.h"
 #include "eddl/net/compserv.h"
+#include "eddl/net/ring.h"
+#include "eddl/net/buckets.h"
+#include "eddl/net/profiler.h"
 
 using namespace std;
 
@@ -38,6 +47,13 @@ int isInorig(Layer *l, vlayer vl, int &ind);
 
 #define MAX_THREADS 1024
 
+// Codecs of the exchanged gradients (see Net::set_exchange_codec)
+#define XCHG_FP32 0
+#define XCHG_FP16 1
+#define XCHG_BF16 2
+#define XCHG_INT8 3     // Stochastic rounding, with a scale per tensor
+#define XCHG_TOPK 4     // Largest values and their positions, with error feedback
+
 class Net {
 private:
 	void build(Optimizer *opt, vloss lo, vmetrics me, bool initialize=true);
@@ -48,7 +64,9 @@ public:
 	string name;
 	int dev;
 	int batch_size;
+	int tr_epochs;
 	int tr_batches;
+	std::mt19937 rng;  // Batches drawn by fit, seeded with rand() at build
 	int inferenced_samples;
 	int trmode;
 	int mem_level; // see Computing Service
@@ -62,6 +80,9 @@ public:
 
 	vector<int> devsel;
 	CompServ *cs;
+	Ring *ring;     // Distributed computing service (shared with cs)
+	GradientBuckets *buckets;   // Gradients averaged across the snets (shared with them)
+	vector<vtensor> sync_stage; // Host copies of the params of each snet, reused by sync_weights
 
 	vlayer layers;
 	vlayer lin;
@@ -69,6 +90,9 @@ public:
 	vlayer lout;
 	vlayer vfts;
 	vlayer vbts;
+	vlayer ffts;    // vfts and vbts with the elementwise chains fused (see fuse)
+	vlayer fbts;
+	vlayer vfused;
 	vlayer netinput;
 
 	vloss losses;
@@ -84,6 +108,56 @@ public:
 	vector<Net *> mnets;
 	Net* rnet;
 
+	// Asynchronous checkpoints
+	pthread_t ckpt_thread;
+	bool ckpt_pending;
+	string ckpt_filename;
+	vector<char> ckpt_buffer;
+
+	// Weights mapped from disk (format "mmap")
+	void *mmap_ptr;
+	size_t mmap_size;
+
+	// Compression of the exchanged gradients
+	int xchg_codec;
+	float xchg_ratio;               // Fraction of the values sent by top-k
+	vtensor xchg_residuals;         // Values not sent by top-k, per acc_gradients tensor
+	unsigned long xchg_round;       // Seed of the stochastic rounding
+
+	// Data augmentation of the inputs, done by a background thread in fit (see set_augmentation)
+	vector<AffineDescriptor> da_specs;
+	vector<int> da_inputs;
+	int da_workers;
+	std::thread da_thread;             // Started by the first prefetch, stopped by free_prefetch
+	std::mutex da_mtx;
+	std::condition_variable da_cv;
+	bool da_running;
+	bool da_pending;                   // A batch is being filled
+	std::exception_ptr da_error;       // Raised by wait_prefetch
+	int da_slot;                       // Buffer being filled
+	vtensor da_src_X, da_src_Y;        // Dataset of the batch being filled
+	vind da_sind;
+	vector<vector<float>> da_matrices;
+	vtensor da_X[2], da_Y[2];          // Batches, double buffered
+	vtensor da_raw;                    // Selected samples before the augmentation
+
+	// Per-layer timings (see enable_profiling). Shared by the computing services
+	Profiler *profiler;
+
+	// Gradient accumulation: every training batch is computed in micro_batches chunks, and the
+	// optimizer is applied once after the last one (see set_micro_batches)
+	int micro_batches;
+	bool acc_first;     // The chunk being trained starts the batch (the gradients are reset)
+	bool acc_last;      // The chunk being trained ends the batch (the gradients are applied)
+	float acc_scale;    // Size of the chunk relative to the whole batch
+
+	// Mixed precision: the tensors kept for the backward stored in 16 bits, with fp32 outputs, weights
+	// and GEMM accumulation (see set_mixed_precision)
+	int mp_storage;
+
+	// Memory layout of the 4D tensors between the layers (see set_layout)
+	int layout;
+
 	vtensor Xs[MAX_THREADS];
 	vtensor Ys[MAX_THREADS];
 
@@ -100,6 +174,7 @@ public:
 	void fts();
 	void bts();
 	void split(int c, int todev);
+	void fuse();
 	Net *unroll(int inl, int outl);
 	Net *unroll_enc(int inl, int outl);
 	Net *unroll_enc_dec(int inl, int outl);
@@ -124,7 +199,33 @@ public:
 
 	void save(const string& filename, string format="");
 	void load(const string& filename, string format="");
+	void save_mmap(const string& filename);
+	void load_mmap(const string& filename);
+	void save_int8(const string& filename);
+	void load_int8(const string& filename);
+	void save_checkpoint(const string& filename, bool async=true);
+	void load_checkpoint(const string& filename);
+	void wait_checkpoint();
+	size_t exchange_size(bool gradients);
+	size_t serialize_exchange(void *buffer, size_t size, bool gradients);
+	void apply_exchange(const void *buffer, size_t size);
+	void set_exchange_codec(const string& codec, float ratio=0.01f);
 	void setlogfile(string fname);
+	void set_augmentation(const AffineDescriptor &spec, int input=0, int workers=2);
+	void prefetch_batch(vtensor X, vtensor Y, vind sind, int slot);
+	void wait_prefetch();
+	void free_prefetch();
+
+	void set_micro_batches(int chunks);
+	void set_mixed_precision(const string& storage, float loss_scale=1.0f, bool dynamic=false);
+	void quantize(vtensor tin, int batch_size=32);
+	void drop_quantization();
+	void set_layout(const string& layout);
+	void propagate_layout();
+
+	void enable_profiling(bool enable=true);
+	string profile_summary();
+	void save_profile(const string &filename);
 
 
 	//Func
@@ -169,6 +270,7 @@ public:
 
 	void fit_recurrent(vtensor tin, vtensor tout, int batch_size, int epochs);
 	void train_batch(vtensor X, vtensor Y, vind sind, int eval = 0);
+	void train_step(vtensor X, vtensor Y, vind sind, int eval = 0);
 	void evaluate(vtensor tin, vtensor tout);
 	void evaluate_recurrent(vtensor tin, vtensor tout);
 	vtensor predict_recurrent(vtensor tin);
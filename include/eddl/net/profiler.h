@@ -0,0 +1,77 @@
+/*
+* EDDL Library - European Distributed Deep Learning Library.
+* Version: 0.7
+* copyright (c) 2020, Universidad Politécnica de Valencia (UPV), PRHLT Research Centre
+* Date: April 2020
+* Author: PRHLT Research Centre, UPV, (rparedes@prhlt.upv.es), (jon@prhlt.upv.es)
+* All rights reserved
+*/
+
+#ifndef EDDL_PROFILER_H
+#define EDDL_PROFILER_H
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "eddl/layers/layer.h"
+
+using namespace std;
+
+class Net;
+
+// Wall time, host memory allocated and estimated FLOPs of every forward, backward and optimizer
+// step of a net (see Net::enable_profiling). The totals are aggregated per layer and phase, and
+// the individual events are kept for the trace (up to max_events)
+class Profiler {
+public:
+    struct Event {
+        string name;                // Layer (or "update" for the optimizer)
+        string phase;               // forward, backward, update
+        int tid;                    // Computing service
+        double start;               // Microseconds since the profiler was created
+        double duration;            // Microseconds
+        unsigned long long bytes;   // Bytes allocated by get_fmem during the event
+        double flops;               // Estimated floating point operations (0 if unknown)
+    };
+
+    struct Total {
+        string name;
+        string phase;
+        long calls;
+        double duration;
+        unsigned long long bytes;
+        double flops;
+    };
+
+    vector<Event> events;
+    vector<Total> totals;
+    long max_events;
+
+    explicit Profiler(long max_events=1000000);
+
+    // Microseconds since the profiler was created
+    double now() const;
+
+    void record(Net *net, const string &name, const string &phase, double start, unsigned long long bytes0, double flops);
+    void clear();
+
+    // Table with the totals, sorted by time
+    string summary();
+
+    // Trace for chrome://tracing (or https://ui.perfetto.dev)
+    void save_trace(const string &filename);
+
+    // Rough number of floating point operations of the forward (or backward) of a layer
+    static double estimate_flops(Layer *l, bool backward);
+
+private:
+    std::chrono::steady_clock::time_point origin;
+    std::mutex mtx;
+    map<string, int> index;     // name + phase -> totals
+    vector<Net *> nets;         // Computing service of each tid
+};
+
+#endif //EDDL_PROFILER_H
@@ -0,0 +1,67 @@
+/*
+* EDDL Library - European Distributed Deep Learning Library.
+* Version: 0.7
+* copyright (c) 2020, Universidad Politécnica de Valencia (UPV), PRHLT Research Centre
+* Date: April 2020
+* Author: PRHLT Research Centre, UPV, (rparedes@prhlt.upv.es), (jon@prhlt.upv.es)
+* All rights reserved
+*/
+
+#ifndef EDDL_RING_H
+#define EDDL_RING_H
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "eddl/tensor/tensor.h"
+
+using namespace std;
+
+// Ring of processes of the distributed computing service (see CS_COMPSS). Each process is connected
+// to the next one, and the reductions go around the ring in chunks (reduce-scatter and all-gather),
+// so that every process sends 2 (n-1)/n times the data whatever the number of processes
+class Ring {
+public:
+    int rank;
+    int world;
+    int timeout;    // Seconds waiting for a peer
+
+    // transport "unix": addresses = {prefix of the socket files}, "tcp": addresses = {host:port of each rank}
+    Ring(int rank, int world, const string &transport, const vector<string> &addresses, int timeout=60);
+    ~Ring();
+
+    void allreduce(float *data, long size);  // Sum
+    void broadcast(float *data, long size, int root=0);
+
+    // The gradients are averaged by a background thread, in the order they are posted, while the
+    // backward goes on, so a gradient must not change once posted. wait() returns when all of them are done
+    void post(const vector<Tensor *> &tensors);
+    void wait();
+
+private:
+    int fd_next;
+    int fd_prev;
+    string socket_path;
+    vector<float> recv_buffer;
+
+    thread worker;
+    mutex mtx;
+    condition_variable cv;
+    deque<vector<Tensor *>> queue;
+    set<Tensor *> posted;       // Shared tensors are averaged once per step
+    int pending;
+    bool stop;
+    string error;
+    vector<float> bucket;
+
+    void connect_ring(const string &transport, const vector<string> &addresses);
+    void sendrecv(const char *sbuf, size_t sbytes, char *rbuf, size_t rbytes);
+    void run();
+};
+
+#endif //EDDL_RING_H
@@ -32,11 +32,26 @@ public:
     float clip_val;
     Optimizer *orig;
 
+    // Loss scaling: the deltas are multiplied by loss_scale, and the gradients are divided before the step.
+    // Dynamic: a step with inf or nan gradients is skipped and the scale halved, and the scale is doubled
+    // after scale_window steps without them
+    float loss_scale;
+    bool dynamic_scale;
+    int scale_window;
+    int good_steps;
+
     Optimizer();
 
     void set_clip_val(float v);
     void clip();
 
+    void set_loss_scale(float scale, bool dynamic=false, int window=2000);
+    float get_loss_scale();
+    bool unscale();  // False if the step has to be skipped
+
+    // Factors of the regularizer that decays params[j] of the layer (0 if it is not regularized)
+    static void get_decay(Layer *l, int j, float &l1, float &l2);
+
     virtual void setlayers(vlayer l) {}
 
     virtual void applygrads(int batch) {}
@@ -46,6 +61,10 @@ public:
 
     virtual void change(vector<float> &p) {}
 
+    // Training state (moments and step counters) saved in checkpoints
+    virtual vtensor get_state() { return vtensor(); }
+    virtual vector<int> get_counters() { return vector<int>(); }
+    virtual void set_counters(const vector<int> &c) {}
 };
 
 class SGD : public Optimizer {
@@ -68,6 +87,8 @@ public:
     void applygrads(int batch) override;
 
     void change(vector<float> &p) override;
+
+    vtensor get_state() override;
 };
 
 // ---- Adam ----
@@ -97,6 +118,12 @@ public:
     void applygrads(int batch) override;
 
     void change(vector<float> &p) override;
+
+    vtensor get_state() override;
+
+    vector<int> get_counters() override;
+
+    void set_counters(const vector<int> &c) override;
 };
 
 
@@ -208,6 +235,8 @@ public:
     void applygrads(int batch) override;
 
     void change(vector<float> &p) override;
+
+    vtensor get_state() override;
 };
 #endif
 
@@ -10,14 +10,21 @@
 #ifndef EDDL_RANDOM_H
 #define EDDL_RANDOM_H
 
+#include <string>
+
 float gaussgen();
 void build_randn_table();
 
 float uniform(float min=0.0f, float max=1.0f);
+int rand_int();  // Non-negative, from the engine of uniform (unlike rand(), its state can be saved)
 float signed_uniform();
 
 float slow_randn(float mean, float sd);
 float fast_randn(float mean, float sd, int seed);
 
+// Serialized state of the random generators (for checkpoints)
+std::string get_rng_state();
+void set_rng_state(const std::string &state);
+
 
 #endif //EDDL_RANDOM_H
@@ -18,37 +18,36 @@
 using namespace std;
 
 
+/*
+ * Decay of the weights: W = W - l1*sign(W) - l2*W.
+ * During training it is applied by the optimizers in the same pass as the update, to the first
+ * Layer::reg_params params of the layer (the weights, not the biases).
+ */
 class Regularizer {
 public:
     string name;
-    // Todo: Implement
-    explicit Regularizer(string name);
-    virtual void apply(Tensor *T) = 0;
+    float l1; // L1 regularization factor (0 if unused)
+    float l2; // L2 regularization factor (0 if unused)
+
+    Regularizer(string name, float l1, float l2);
+
+    // Decays T in place (without temporaries)
+    void apply(Tensor *T);
 };
 
 class RL1 : public Regularizer {
 public:
-    float l1; // regularization factor
-
     explicit RL1(float l1);
-    void apply(Tensor *T) override;
 };
 
 class RL2 : public Regularizer {
 public:
-    float l2; // regularization factor
-
     explicit RL2(float l2);
-    void apply(Tensor *T) override;
 };
 
 class RL1L2 : public Regularizer {
 public:
-    float l1;
-    float l2;
-
     explicit RL1L2(float l1, float l2);
-    void apply(Tensor *T) override;
 };
 
 #endif //EDDL_REGULARIZER_H
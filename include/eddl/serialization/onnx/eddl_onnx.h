@@ -22,6 +22,8 @@
 	//Importing module
 	//------------------------------------------------------------------------------
 
+	// Imports a model from an ONNX file, parsed as a stream. The file must be below 2GB (the protobuf
+	// message limit) and keep its initializers inline; throws if it cannot be opened or parsed
 	Net* import_net_from_onnx_file(std::string path, int mem=0);
 
 	Net* import_net_from_onnx_pointer(void* serialized_model, size_t model_size, int mem=0); 
@@ -29,7 +31,7 @@
 	Net* import_net_from_onnx_string(std::string* model_string, int mem=0);
 
 //#if defined(cPROTO)
-//	Net* build_net_onnx(onnx::ModelProto model, int mem);
+//	Net* build_net_onnx(const onnx::ModelProto &model, int mem);
 //#endif
 
 	// Exporting module
@@ -95,6 +95,28 @@ int bin_accuracy(Tensor *A, Tensor *B);
     void set_select(Tensor *A, Tensor *B, SelDescriptor *sd);
     void set_select_back(Tensor *A, Tensor* B, SelDescriptor *sd);
 
+// ***** Optimizers *****************************
+// Single-pass updates of a param W with gradient G. The weight decay (W -= l1*sign(W) + l2*W) of the
+// regularizers is applied in the same pass. M, V and G1 are the optimizer state; mCap, vCap and S are
+// scratch tensors only used on devices without a fused kernel (can be nullptr on CPU)
+    void sgd_step(Tensor *W, Tensor *G, Tensor *M, float lr, float mu, float l1, float l2);
+    void adam_step(Tensor *W, Tensor *G, Tensor *M, Tensor *V, Tensor *mCap, Tensor *vCap,
+                   float lr, float beta_1, float beta_2, float epsilon, int t, float l1, float l2);
+    void rmsprop_step(Tensor *W, Tensor *G, Tensor *G1, Tensor *S, float lr, float rho, float epsilon, float l1, float l2);
+
+// ***** Fused elementwise chains *****************************
+// Y = ops(X, S). The backward adds the gradient of the chain (D is dL/dY) to PD and the ones of the
+// side inputs to SD. The intermediate values are recomputed
+    void fused_forward(const vector<FusedOp> &ops, Tensor *X, const vector<Tensor *> &S, Tensor *Y);
+    void fused_backward(const vector<FusedOp> &ops, Tensor *X, const vector<Tensor *> &S, Tensor *Y, Tensor *D,
+                        Tensor *PD, const vector<Tensor *> &SD);
+
+// ***** INT8 inference *****************************
+// W and K hold the int8 weights of each output channel (k values per channel), with their scales. The input
+// is quantized with input_scale, the products are accumulated in int32 and the output is in fp32 (see Net::quantize)
+    void Dense_s8(Tensor *A, const int8_t *W, const float *scales, float input_scale, Tensor *bias, Tensor *B);
+    void Conv2D_s8(ConvolDescriptor *D, const int8_t *K, const float *scales, float input_scale);
+
 // ***** Permutations for BatchNorm ********************
     void permute_channels_last(Tensor *A,Tensor *B);
     void permute_channels_first(Tensor *A,Tensor *B);
@@ -27,6 +27,11 @@
 
 #define DEV_CPU 0
 
+// Precision of the activations and of the tensors kept for the backward (see Net::set_mixed_precision)
+#define MP_FP32 0
+#define MP_BF16 1
+#define MP_FP16 2
+
 #define DEV_GPU 1000
 #define DEV_GPU_0 1000
 #define DEV_GPU_1 1001
@@ -49,6 +54,11 @@
 #define DEV_FPGA_7 2007
 #define DEV_FPGA_8 2008
 
+// Storage of compact (dataset) tensors
+#define DTYPE_FLOAT32 0
+#define DTYPE_UINT8 1
+#define DTYPE_UINT16 2
+
 #define MAX_GPUS 8
 
 using namespace std;
@@ -79,6 +89,13 @@ public:
     unsigned long int size;
     vector<int> shape;
     vector<int> stride;
+    bool isview;  // Non-owning tensor. Its data belongs to another tensor and may be strided
+
+    // Compact storage (datasets). The values are kept as integers in cptr and read as cptr[i]*cscale when
+    // they are selected or copied. ptr is null while the tensor is compact
+    int dtype;
+    void *cptr;
+    float cscale;
 
     // Data pointers
     float *ptr;
@@ -205,6 +222,30 @@ public:
     vector<int> getShape();
     unsigned int numel();
 
+    /**
+      *  @brief Check if the elements of the tensor are stored contiguously in row-major order.
+      *
+      *  @return    bool
+    */
+    bool is_contiguous();
+
+    /**
+      *  @brief Check if the tensor keeps its values in a compact (integer) storage.
+      *
+      *  @return    bool
+    */
+    bool is_compact();
+
+    /**
+      *  @brief Convert the tensor to a compact storage. Values are rounded (and saturated) to integers, and
+      *  selecting (batching) or copying the tensor gives value*scale. Only selections and copies read compact tensors.
+      *
+      *  @param dtype  DTYPE_UINT8 or DTYPE_UINT16
+      *  @param scale  Scale applied when the values are read (e.g. 1/255 to normalise images)
+      *  @return    void
+    */
+    void compact_(int dtype, float scale=1.0f);
+
     /**
       *  @brief Check if all dimensions in the tensor are the same.
       *
@@ -224,6 +265,15 @@ public:
     */
     static Tensor* loadfs(std::ifstream &ifs, string format="");
 
+    /**
+      *  @brief Load tensor data from filestream into this tensor (in-place).
+      *  The stored shape must match the shape of the tensor. Binary data is read straight into CPU tensors.
+      *
+      *  @param ifs  Filestream
+      *  @param format    File format. Accepted formats are: bin, onnx, csv, tsv, txt.
+    */
+    void loadfs_(std::ifstream &ifs, string format="");
+
     /**
       *  @brief Load tensor from file.
       *
@@ -237,6 +287,18 @@ public:
     static Tensor* load(const string& filename, string format="");
     template<typename T> static Tensor* load(const string& filename, string format="");
 
+    /**
+      *  @brief Load a dataset from a bin file into a compact storage (see compact_). The file is converted
+      *  while it is read, so the float version is never held in memory.
+      *
+      *  @param filename  Name of the file to load the tensor from.
+      *  @param dtype  DTYPE_UINT8 or DTYPE_UINT16
+      *  @param scale  Scale applied when the values are read (e.g. 1/255 to normalise images)
+      *  @param format    File format. Only bin is accepted.
+      *  @return    Tensor
+    */
+    static Tensor* load_compact(const string& filename, int dtype, float scale=1.0f, string format="");
+
     /**
       *  @brief Load data from a text file
       *
@@ -1457,6 +1519,15 @@ public:
     Tensor* sign(float zero_sign=0.0f);
     static void sign(Tensor *A, Tensor *B, float zero_sign=0.0f);
 
+    /**
+    *   @brief Element-wise weight decay: B = A - l1*sign(A) - l2*A (in a single pass).
+    *   @param A The tensor where the operation is applied.
+    *   @param B The output tensor (can be A).
+    *   @param l1 L1 factor.
+    *   @param l2 L2 factor.
+    */
+    static void regularize(Tensor *A, Tensor *B, float l1, float l2);
+
     /**
     *   @brief Inplace element-wise sin operation.
     */
@@ -1742,6 +1813,62 @@ public:
     void swapaxis_(int axis1, int axis2);
     static Tensor* swapaxis(Tensor* A, int axis1, int axis2);
 
+    // ***** Views *****************************
+
+    /**
+    *   @brief Non-owning strided view of the data of A. No data is copied.
+    *   @param A Tensor that owns the data. It must outlive the view.
+    *   @param shape Shape of the view.
+    *   @param stride Stride (in elements) of each dimension of the view.
+    *   @param offset Offset (in elements) from the beginning of A.
+    *   @return A view of A
+    */
+    static Tensor* view(Tensor* A, const vector<int>& shape, const vector<int>& stride, int offset=0);
+
+    /**
+    *   @brief Permutation of tensor dimensions without copying data.
+    *   @param A Input tensor.
+    *   @param dims A vector containing the new order of the dimensions.
+    *   @return A (strided) view of A
+    */
+    static Tensor* permute_view(Tensor* A, const vector<int>& dims);
+
+    /**
+    *   @brief Slice of A at a given index of an axis. The axis is removed from the shape. No data is copied.
+    *   @param A Input tensor.
+    *   @param axis Axis to index.
+    *   @param index Index in the axis.
+    *   @return A (strided) view of A
+    */
+    static Tensor* select_view(Tensor* A, int axis, int index);
+
+    /**
+    *   @brief Range [start, end) of an axis of A. No data is copied.
+    *   @param A Input tensor.
+    *   @param axis Axis to slice.
+    *   @param start First index (inclusive).
+    *   @param end Last index (exclusive).
+    *   @return A (strided) view of A
+    */
+    static Tensor* slice_view(Tensor* A, int axis, int start, int end);
+
+    /**
+    *   @brief Contiguous copy of A. Views are materialised in row-major order.
+    *   @param A Input tensor.
+    *   @return A new tensor that owns its data
+    */
+    static Tensor* contiguous(Tensor* A);
+
+    /**
+    *   @brief Materialises A broadcast (NumPy rules) to the given shape.
+    *   Elementwise binary operations broadcast their operands on the fly, so this is only needed
+    *   when the expanded data is required.
+    *   @param A Input tensor.
+    *   @param shape Target shape.
+    *   @return A new tensor with the expanded data
+    */
+    static Tensor* expand(Tensor* A, const vector<int>& shape);
+
     /**
     *   @brief Set a new shape to a tensor inplace.
     *   @param new_shape A vector containing the new shape.
@@ -1977,6 +2104,31 @@ public:
     */
     static void cutout_random(Tensor *A, Tensor *B, vector<float> factor_x, vector<float> factor_y, float cval=0.0f);
 
+    /**
+    *   @brief Resample each image through its own affine matrix (a single interpolation per image, whatever the number of geometric operations composed in the matrix).
+    *   @param A Input tensor (NCHW).
+    *   @param B Output tensor. Same shape as A.
+    *   @param matrices 6 floats per sample mapping output coordinates (row, col) to input coordinates: (m0*row + m1*col + m2, m3*row + m4*col + m5).
+    *   @param bilinear Bilinear (true) or nearest (false) interpolation.
+    *   @param mode Must be one of the following:
+    *        - ``WrappingMode::Constant``: Input extended by the value in ``cval`` (v v v v | a b c d | v v v v)
+    *        - ``WrappingMode::Reflect``: Input extended by reflecting about the edge of the last pixel (d c b a | a b c d | d c b a)
+    *        - ``WrappingMode::Nearest``: Input extended by replicating the last pixel (a a a a | a b c d | d d d d)
+    *        - ``WrappingMode::Mirror``: Input extended by reflecting about the center of the las pixel (d c b | a b c d | c b a)
+    *        - ``WrappingMode::Wrap``: Input extended by wrapping around the oposite edge (a b c d | a b c d | a b c d)
+    *        - ``WrappingMode::Original``: Input extended by placing the original image in the background.
+    *   @param cval Value to fill past edges of input if mode is ``WrappingMode::Constant``
+    */
+    static void affine(Tensor *A, Tensor *B, const vector<float> &matrices, bool bilinear=true, WrappingMode mode=WrappingMode::Constant, float cval=0.0f);
+
+    /**
+    *   @brief Apply a random geometric augmentation (shift, rotation, zoom, shear, crop-scale and flips) with a single resample per image.
+    *   @param A Input tensor (NCHW).
+    *   @param B Output tensor. Same shape as A.
+    *   @param D Ranges of the operations (see AffineDescriptor).
+    */
+    static void affine_random(Tensor *A, Tensor *B, const AffineDescriptor &D);
+
 
     // Linear algebra *****************************
 
@@ -2669,6 +2821,7 @@ public:
     *   @param B Input tensor.
     *   @param C Output tensor. C = sc*A + scB*B
     *   @param incC if ``incC`` is 1, C += sc*A + scB*B
+    *   ``A`` and ``B`` are broadcast (NumPy rules) to the shape of ``C``.
     */
     static void add(float scA, Tensor *A, float scB, Tensor *B, Tensor *C, int incC); // C = a*A+b*B
 
@@ -2685,6 +2838,7 @@ public:
     *   @param B Input tensor.
     *   @param C Output tensor. C = A./B
     *   @param incC if ``incC`` is 1, C += A./B
+    *   ``A`` and ``B`` are broadcast (NumPy rules) to the shape of ``C``.
     */
     static void el_div(Tensor *A, Tensor *B, Tensor *C, int incC);
 
@@ -2694,6 +2848,7 @@ public:
     *   @param B Input tensor.
     *   @param C Output tensor. C = A*B
     *   @param incC if ``incC`` is 1, C += A*B
+    *   ``A`` and ``B`` are broadcast (NumPy rules) to the shape of ``C``.
     */
     static void el_mult(Tensor *A, Tensor *B, Tensor *C, int incC);
 
@@ -2708,6 +2863,17 @@ public:
     */
     static void mult2D(Tensor *A, int tA, Tensor *B, int tB, Tensor *C, int incC);
 
+    /**
+    *   @brief Independent matrix multiplications of 2D tensors, C[i] = A[i]·B[i], dispatched as one batch.
+    *   @param A Input tensors.
+    *   @param tA If 1, every ``A[i]`` is trasposed.
+    *   @param B Input tensors.
+    *   @param tB If 1, every ``B[i]`` is trasposed.
+    *   @param C Output tensors (all different). C[i] = A[i]·B[i]
+    *   @param incC if ``incC`` is 1, C[i] += A[i]·B[i]
+    */
+    static void mult2D_batched(const vector<Tensor*> &A, int tA, const vector<Tensor*> &B, int tB, const vector<Tensor*> &C, int incC);
+
     /**
     *   @brief Matrix sum row-wise of two 2D tensors.
     *   @param A Input tensor.
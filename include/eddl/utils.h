@@ -18,7 +18,28 @@ using namespace std;
 
 void msg(const string& text, const string& title="");
 
+// Memory for CPU tensors (64-byte aligned). The released blocks are cached and reused
 float *get_fmem(unsigned long int size, const string &str);
+void free_fmem(float *ptr);
+
+// Returns the cached blocks of the calling thread and of the shared pool to the system. The caches of
+// other threads are only reachable by them (they go to the pool when the thread exits)
+void trim_fmem();
+
+// Bytes requested to get_fmem since the start of the program (used by the profiler)
+unsigned long long get_fmem_total();
+
+struct FMemStats {
+    unsigned long long requests;        // Calls to get_fmem
+    unsigned long long cache_hits;      // Served with a cached block
+    unsigned long long system_allocs;   // Served by the system
+    unsigned long long system_frees;    // Blocks returned to the system (trim_fmem)
+    long long bytes_in_use;
+    long long bytes_cached;
+    long long peak_bytes_in_use;
+};
+
+FMemStats get_fmem_stats();
 
 string bytes2human(unsigned long long int bytes, int decimals=2);
 
@@ -36,6 +57,8 @@ vector<int> shape2stride(const vector<int>& shape);
 
 vector<int> permute_shape(const vector<int>& ishape, const vector<int>& dims);
 
+vector<int> broadcast_shape(const vector<int>& ishape1, const vector<int>& ishape2);
+
 int* permute_indices(const vector<int>& ishape, const vector<int>& dims);
 
 int* ranges2indices(vector<int> ishape, vector<vector<int>> ranges);
@@ -181,9 +181,38 @@ namespace eddl {
     {
         net->setlogfile(fname);
     }
+    void set_augmentation(model net, const AffineDescriptor &spec, int input, int workers)
+    {
+        net->set_augmentation(spec, input, workers);
+    }
+    void set_micro_batches(model net, int chunks)
+    {
+        net->set_micro_batches(chunks);
+    }
+    void set_mixed_precision(model net, const string& storage, float loss_scale, bool dynamic)
+    {
+        net->set_mixed_precision(storage, loss_scale, dynamic);
+    }
+    void quantize(model net, const vector<Tensor *> &in, int batch_size)
+    {
+        net->quantize(in, batch_size);
+    }
+    void set_layout(model net, const string& layout)
+    {
+        net->set_layout(layout);
+    }
     void summary(model m){
         cout<<m->summary()<<"\n";
     }
+    void profile(model m, bool enable){
+        m->enable_profiling(enable);
+    }
+    void profile_summary(model m){
+        cout<<m->profile_summary()<<"\n";
+    }
+    void save_profile(model m, const string& fname){
+        m->save_profile(fname);
+    }
     void plot(model m, string fname,string mode){
         m->plot(fname,mode);
     }
@@ -197,6 +226,33 @@ namespace eddl {
         m->save(fname,format);
     }
 
+    void save_checkpoint(model m, const string&  fname, bool async){
+        m->save_checkpoint(fname,async);
+    }
+
+    void load_checkpoint(model m, const string&  fname){
+        m->load_checkpoint(fname);
+    }
+
+    // Distributed training
+    size_t exchange_size(model m, bool gradients){
+        return m->exchange_size(gradients);
+    }
+
+    size_t serialize_exchange(model m, void *&buffer, bool gradients){
+        size_t size = m->exchange_size(gradients);
+        if (buffer == nullptr) buffer = new char[size];
+        return m->serialize_exchange(buffer, size, gradients);
+    }
+
+    void apply_exchange(model m, const void *buffer, size_t size){
+        m->apply_exchange(buffer, size);
+    }
+
+    void set_exchange_codec(model m, const string& codec, float ratio){
+        m->set_exchange_codec(codec, ratio);
+    }
+
     // Optimizer
     void setlr(model net,vector<float>p)
     {
@@ -704,6 +760,15 @@ namespace eddl {
         return new LCutoutRandom(parent, factor_x, factor_y, constant, name, DEV_CPU, 0);
     }
 
+    layer RandomAffine(layer parent, vector<float> angle, vector<float> translate_x, vector<float> translate_y, vector<float> scale, vector<float> shear, string name){
+        AffineDescriptor spec(translate_x, translate_y, angle, scale, shear);
+        return new LAffineRandom(parent, spec, name, DEV_CPU, 0);
+    }
+
+    layer RandomAffine(layer parent, const AffineDescriptor &spec, string name){
+        return new LAffineRandom(parent, spec, name, DEV_CPU, 0);
+    }
+
     // Merge Layers
     layer Add(const vector<layer> &layers, string name){
         return new LAdd(layers, name, DEV_CPU, 0);
@@ -1115,6 +1180,7 @@ namespace eddl {
         collectTensor(l1,"param",p);
         Tensor::copy(l1->params[p],l2->params[p]);
         distributeTensor(l2,"param",p);
+        if (l2->net != nullptr) l2->net->drop_quantization();
     }
 
     void copyGradient(Layer *l1,Layer *l2, int p)
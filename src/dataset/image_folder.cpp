@@ -0,0 +1,275 @@
+/*
+* EDDL Library - European Distributed Deep Learning Library.
+* Version: 0.7
+* copyright (c) 2020, Universidad Politécnica de Valencia (UPV), PRHLT Research Centre
+* Date: April 2020
+* Author: PRHLT Research Centre, UPV, (rparedes@prhlt.upv.es), (jon@prhlt.upv.es)
+* All rights reserved
+*/
+
+#include <cstdlib>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <dirent.h>
+#include <sys/stat.h>
+
+#include "eddl/dataset/image_folder.h"
+#include "eddl/hardware/cpu/cpu_tensor.h"
+#include "eddl/utils.h"
+
+#include "tensor/stb/stb_image.h"
+
+using namespace std;
+
+
+static bool is_directory(const string &path){
+    struct stat st;
+    return (stat(path.c_str(), &st) == 0) && S_ISDIR(st.st_mode);
+}
+
+// Sorted entries of a directory (hidden entries are skipped)
+static vector<string> list_directory(const string &path){
+    vector<string> entries;
+    DIR *dir = opendir(path.c_str());
+    if (dir == nullptr) msg("Cannot open " + path, "ImageFolder::ImageFolder");
+
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != nullptr) {
+        string name = entry->d_name;
+        if (!name.empty() && name[0] != '.') entries.push_back(name);
+    }
+    closedir(dir);
+
+    std::sort(entries.begin(), entries.end());
+    return entries;
+}
+
+static bool is_image(const string &name){
+    string ext = get_extension(name);
+    std::transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+    return ext=="jpg" || ext=="jpeg" || ext=="png" || ext=="bmp" || ext=="tga" || ext=="gif" ||
+           ext=="psd" || ext=="hdr" || ext=="pic" || ext=="pgm" || ext=="ppm";
+}
+
+
+ImageFolder::ImageFolder(const string &path, int height, int width, int channels, int batch_size, bool shuffle,
+                         int num_workers, int queue_size, float scale) {
+    if (channels < 1 || channels > 4) msg("Channels must be between 1 and 4", "ImageFolder::ImageFolder");
+    if (num_workers < 1 || queue_size < 1) msg("At least one worker and one buffer are needed", "ImageFolder::ImageFolder");
+
+    this->height = height;
+    this->width = width;
+    this->channels = channels;
+    this->batch_size = batch_size;
+    this->shuffle = shuffle;
+    this->num_workers = num_workers;
+    this->queue_size = queue_size;
+    this->scale = scale;
+    this->running = false;
+    this->next_decode = this->next_read = 0;
+    this->augment = false;
+
+    if (is_directory(path)) index_directory(path);
+    else index_list(path);
+
+    if (files.empty()) msg("No images found in " + path, "ImageFolder::ImageFolder");
+
+    // Batch buffers, reused along the epochs
+    buffers.resize(queue_size);
+    for (auto &b : buffers) {
+        b.x = new Tensor({batch_size, channels, height, width}, DEV_CPU);
+        b.y = new Tensor({batch_size, num_classes()}, DEV_CPU);
+        b.index = -1;
+    }
+
+    order.resize(files.size());
+    for (int i = 0; i < order.size(); i++) order[i] = i;
+}
+
+ImageFolder::~ImageFolder() {
+    stop();
+    for (auto &b : buffers) {
+        delete b.x;
+        delete b.y;
+    }
+}
+
+void ImageFolder::index_directory(const string &path) {
+    for (auto &c : list_directory(path)) {
+        string cpath = path + "/" + c;
+        if (!is_directory(cpath)) continue;
+
+        int label = classes.size();
+        classes.push_back(c);
+        for (auto &f : list_directory(cpath)) {
+            if (!is_image(f)) continue;
+            files.push_back(cpath + "/" + f);
+            labels.push_back(label);
+        }
+    }
+}
+
+void ImageFolder::index_list(const string &filename) {
+    std::ifstream ifs(filename);
+    if (!ifs.good()) msg("File not found: " + filename, "ImageFolder::ImageFolder");
+
+    string base;
+    size_t pos = filename.find_last_of('/');
+    if (pos != string::npos) base = filename.substr(0, pos + 1);
+
+    int max_label = -1;
+    string line;
+    while (std::getline(ifs, line)) {
+        std::istringstream iss(line);
+        string f;
+        int label;
+        if (!(iss >> f >> label)) continue;  // Blank or malformed lines
+        if (label < 0) msg("Negative label in " + filename, "ImageFolder::ImageFolder");
+
+        files.push_back(f[0] == '/' ? f : base + f);
+        labels.push_back(label);
+        max_label = std::max(max_label, label);
+    }
+
+    for (int i = 0; i <= max_label; i++) classes.push_back(to_string(i));
+}
+
+int ImageFolder::num_samples() { return files.size(); }
+
+int ImageFolder::num_classes() { return classes.size(); }
+
+int ImageFolder::num_batches() { return files.size() / batch_size; }
+
+
+void ImageFolder::set_augmentation(const AffineDescriptor &spec) {
+    stop();
+    augmentation = spec;
+    augment = true;
+}
+
+void ImageFolder::start() {
+    stop();
+
+    // Fisher-Yates
+    if (shuffle) {
+        for (int i = (int)order.size() - 1; i > 0; i--) {
+            std::swap(order[i], order[rand() % (i + 1)]);
+        }
+    }
+
+    // The random parameters are drawn here, so the workers do not share the generator
+    if (augment) matrices = augmentation.sample_batch(num_batches() * batch_size, height, width);
+
+    free_buffers.clear();
+    ready.clear();
+    for (auto &b : buffers) free_buffers.push_back(&b);
+    next_decode = next_read = 0;
+    running = true;
+
+    for (int i = 0; i < num_workers; i++) workers.emplace_back(&ImageFolder::worker, this);
+}
+
+void ImageFolder::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        running = false;
+    }
+    cv_free.notify_all();
+    cv_ready.notify_all();
+
+    for (auto &w : workers) w.join();
+    workers.clear();
+}
+
+void ImageFolder::worker() {
+    while (true) {
+        Batch *batch;
+        {
+            // Batch indices and buffers are taken together, so the next batch to be read always has a buffer
+            std::unique_lock<std::mutex> lock(mtx);
+            cv_free.wait(lock, [this]{ return !running || next_decode >= num_batches() || !free_buffers.empty(); });
+            if (!running || next_decode >= num_batches()) return;
+
+            batch = free_buffers.front();
+            free_buffers.pop_front();
+            batch->index = next_decode++;
+        }
+
+        batch->error = decode(batch);
+
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            ready[batch->index] = batch;
+        }
+        cv_ready.notify_all();
+    }
+}
+
+void ImageFolder::release(Batch *batch) {
+    {
+        std::lock_guard<std::mutex> lock(mtx);
+        free_buffers.push_back(batch);
+    }
+    cv_free.notify_all();
+}
+
+// Returns the file that could not be decoded (if any). Errors are raised by the reader thread
+string ImageFolder::decode(Batch *batch) {
+    long sample_size = (long)channels * height * width;
+    batch->y->fill_(0.0f);
+
+    vector<float> sample;
+    if (augment) sample.resize(sample_size);
+
+    for (int i = 0; i < batch_size; i++) {
+        int k = batch->index * batch_size + i;
+        int s = order[k];
+
+        int w, h, c;
+        unsigned char *pixels = stbi_load(files[s].c_str(), &w, &h, &c, channels);
+        if (pixels == nullptr) return files[s];
+
+        float *x = batch->x->ptr + i * sample_size;
+        if (augment) {
+            cpu_image_to_chw(pixels, h, w, channels, sample.data(), height, width, scale);
+            cpu_single_affine(sample.data(), x, channels, height, width, &matrices[k * 6],
+                              augmentation.bilinear, augmentation.da_mode, augmentation.cval);
+        } else {
+            cpu_image_to_chw(pixels, h, w, channels, x, height, width, scale);
+        }
+        stbi_image_free(pixels);
+
+        batch->y->ptr[i * num_classes() + labels[s]] = 1.0f;
+    }
+    return "";
+}
+
+bool ImageFolder::next_batch(Tensor *x, Tensor *y) {
+    if (next_read >= num_batches()) return false;
+    if (!running) msg("Call start() at the beginning of every epoch", "ImageFolder::next_batch");
+
+    Batch *batch;
+    {
+        std::unique_lock<std::mutex> lock(mtx);
+        cv_ready.wait(lock, [this]{ return !running || ready.count(next_read) > 0; });
+        if (ready.count(next_read) == 0) return false;  // Stopped while waiting
+        batch = ready[next_read];
+        ready.erase(next_read);
+        next_read++;
+    }
+
+    // The buffer goes back to the workers even if the batch can not be used. Only this batch fails
+    try {
+        if (!batch->error.empty()) msg("Error decoding " + batch->error, "ImageFolder::next_batch");
+        Tensor::copy(batch->x, x);
+        Tensor::copy(batch->y, y);
+    } catch (...) {
+        release(batch);
+        throw;
+    }
+    release(batch);
+
+    return true;
+}
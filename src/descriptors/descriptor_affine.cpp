@@ -0,0 +1,99 @@
+/*
+* EDDL Library - European Distributed Deep Learning Library.
+* Version: 0.7
+* copyright (c) 2020, Universidad Politécnica de Valencia (UPV), PRHLT Research Centre
+* Date: April 2020
+* Author: PRHLT Research Centre, UPV, (rparedes@prhlt.upv.es), (jon@prhlt.upv.es)
+* All rights reserved
+*/
+
+
+#include <cmath>
+#include <utility>
+
+#include "eddl/descriptors/tensor_descriptors.h"
+#include "eddl/random.h"
+#include "eddl/utils.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+
+AffineDescriptor::AffineDescriptor(vector<float> factor_x, vector<float> factor_y, vector<float> angle,
+                                   vector<float> scale, vector<float> shear, vector<float> crop,
+                                   bool flip_x, bool flip_y, const string& interpolation,
+                                   WrappingMode da_mode, float cval){
+    for (auto &r : {factor_x, factor_y, angle, scale, shear, crop}) {
+        if (r.size() != 2) msg("The ranges must have two values (min, max)", "AffineDescriptor::AffineDescriptor");
+    }
+    if (scale[0] <= 0.0f || scale[1] <= 0.0f) {
+        msg("The scaling factor must be a positive number", "AffineDescriptor::AffineDescriptor");
+    }
+    if (crop[0] <= 0.0f || crop[0] > 1.0f || crop[1] <= 0.0f || crop[1] > 1.0f) {
+        msg("The crop factor must fall within the range (0.0, 1.0]", "AffineDescriptor::AffineDescriptor");
+    }
+
+    if (interpolation == "bilinear") this->bilinear = true;
+    else if (interpolation == "nearest") this->bilinear = false;
+    else msg("Unknown interpolation (" + interpolation + ")", "AffineDescriptor::AffineDescriptor");
+
+    this->factor_x = std::move(factor_x);
+    this->factor_y = std::move(factor_y);
+    this->angle = std::move(angle);
+    this->scale = std::move(scale);
+    this->shear = std::move(shear);
+    this->crop = std::move(crop);
+    this->flip_x = flip_x;
+    this->flip_y = flip_y;
+    this->da_mode = da_mode;
+    this->cval = cval;
+}
+
+
+void AffineDescriptor::sample(int height, int width, float *m) const {
+    // Output pixel d is taken from the input at:
+    //    src = center_crop + k * R * Sh * (F * (d - center) - t)
+    // where F flips, t shifts, Sh undoes the shear, R undoes the rotation and k = crop / zoom
+    float ci = (height - 1) / 2.0f;
+    float cj = (width - 1) / 2.0f;
+
+    // Draw the parameters (always in the same order, so the results are reproducible)
+    float ty = height * uniform(factor_y[0], factor_y[1]);
+    float tx = width * uniform(factor_x[0], factor_x[1]);
+    float a = (float)(-uniform(angle[0], angle[1]) * M_PI / 180.0f);
+    float sh = ::tanf((float)(uniform(shear[0], shear[1]) * M_PI / 180.0f));
+    float zoom = uniform(scale[0], scale[1]);
+    float c = uniform(crop[0], crop[1]);
+    float fy = (flip_y && uniform(0.0f, 1.0f) >= 0.5f) ? -1.0f : 1.0f;
+    float fx = (flip_x && uniform(0.0f, 1.0f) >= 0.5f) ? -1.0f : 1.0f;
+
+    // Center of the crop window (the window always falls inside the image)
+    float wi = ci + (uniform(0.0f, 1.0f) - 0.5f) * height * (1.0f - c);
+    float wj = cj + (uniform(0.0f, 1.0f) - 0.5f) * width * (1.0f - c);
+
+    // Same convention as cpu_single_rotate
+    float k = c / zoom;
+    float cs = ::cosf(a), sn = ::sinf(a);
+    float r00 = k * cs, r01 = k * sn;
+    float r10 = -k * sn, r11 = k * cs;
+
+    // L = k * R * Sh, with Sh = [[1, 0], [-sh, 1]]
+    float l00 = r00 - r01 * sh, l01 = r01;
+    float l10 = r10 - r11 * sh, l11 = r11;
+
+    // M = L * F
+    m[0] = l00 * fy; m[1] = l01 * fx;
+    m[3] = l10 * fy; m[4] = l11 * fx;
+
+    // b = w - L * t - M * center
+    m[2] = wi - (l00 * ty + l01 * tx) - (m[0] * ci + m[1] * cj);
+    m[5] = wj - (l10 * ty + l11 * tx) - (m[3] * ci + m[4] * cj);
+}
+
+
+vector<float> AffineDescriptor::sample_batch(int batch, int height, int width) const {
+    vector<float> matrices(batch * 6);
+    for (int b = 0; b < batch; b++) sample(height, width, &matrices[b * 6]);
+    return matrices;
+}
@@ -19,11 +19,12 @@
 
 ConvolDescriptor::ConvolDescriptor() {}
 
-ConvolDescriptor::ConvolDescriptor(const vector<int> &ks, const vector<int> &st, const vector<int> &p, int mem) {
+ConvolDescriptor::ConvolDescriptor(const vector<int> &ks, const vector<int> &st, const vector<int> &p, int mem, int groups) {
     ksize = vector<int>(ks.begin(), ks.end());
     stride = vector<int>(st.begin(), st.end());
     pad = vector<int>(p.begin(), p.end());
     mem_level=mem;
+    this->groups=groups;
 
     this->padding = "custom";
 
@@ -31,7 +32,7 @@ ConvolDescriptor::ConvolDescriptor(const vector<int> &ks, const vector<int> &st,
     if (stride.size() != 2) msg("Strides must have 2 dimensions", "ConvolDescriptor::ConvolDescriptor");
 }
 
-ConvolDescriptor::ConvolDescriptor(int filters, const vector<int> &ks, const vector<int> &st, const string& p, bool ub, int mem) {
+ConvolDescriptor::ConvolDescriptor(int filters, const vector<int> &ks, const vector<int> &st, const string& p, bool ub, int mem, int groups) {
     if (ks.size() != 2) { msg("Kernels must have 3 dimensions", "ConvolDescriptor::ConvolDescriptor"); }
     if (st.size() != 2) { msg("Strides must have 2 dimensions", "ConvolDescriptor::ConvolDescriptor"); }
 
@@ -41,6 +42,7 @@ ConvolDescriptor::ConvolDescriptor(int filters, const vector<int> &ks, const vec
     stride = vector<int>(st.begin(), st.end());
     use_bias=ub;
     mem_level=mem;
+    this->groups=groups;
 
     if (p=="same" || p =="none" || p =="valid" || p =="zeros" || p=="same,none" || p=="none,same") {
         this->padding=p;
@@ -61,7 +63,11 @@ void ConvolDescriptor::build(Tensor *A) {
     nk = ksize[0];
     kr = ksize[1];
     kc = ksize[2];
-    kz = A->shape[1];
+
+    if (groups < 1 || A->shape[1] % groups != 0 || nk % groups != 0)
+        msg("The channels (" + to_string(A->shape[1]) + ") and the filters (" + to_string(nk) + ") must be multiples of the groups (" + to_string(groups) + ")", "ConvolDescriptor::build");
+    if (groups > 1 && !A->isCPU()) msg("Grouped convolutions are only available on CPU", "ConvolDescriptor::build");
+    kz = A->shape[1] / groups;
 
     sr = stride[0];
     sc = stride[1];
@@ -119,7 +125,7 @@ void ConvolDescriptor::build(Tensor *A) {
 
     if (I->isCPU()) {
         // mem for ptr, lowering im2col
-        ptrI=get_fmem(A->shape[0] * r * c * kr * kc * kz,"ConvolDescriptor::build");
+        if (!depthwise()) ptrI=get_fmem(A->shape[0] * r * c * kr * kc * iz,"ConvolDescriptor::build");
         new(&matK) Eigen::Map<Eigen::MatrixXf>(K->ptr, kr * kc * kz, nk);
         new(&matgK) Eigen::Map<Eigen::MatrixXf>(gK->ptr, kr * kc * kz, nk);
         // convolution: matC=matA*matK
@@ -165,9 +171,12 @@ void ConvolDescriptor::resize(int b)
     O->resize(b);
 //    if (!mem_level) D->resize(b);
 
-    if (I->isCPU()) {
-        delete ptrI;
-        ptrI=get_fmem(b * r * c * kr * kc * kz, "ConvolDescriptor::build");
+    if (I->isCPU() && !depthwise()) {
+        if (storage != MP_FP32) ptrI16.resize((long)b * r * c * kr * kc * iz);
+        else {
+            free_fmem(ptrI);
+            ptrI=get_fmem(b * r * c * kr * kc * iz, "ConvolDescriptor::build");
+        }
     }
 #ifdef cGPU
     else if (I->isGPU()) {
@@ -182,6 +191,22 @@ void ConvolDescriptor::resize(int b)
 
 }
 
+void ConvolDescriptor::set_storage(int s) {
+    if (!I->isCPU() || s == storage) return;
+
+    // The lowering of the batch is kept in 16 bits, and each sample is lowered in ptrI
+    storage = s;
+    if (depthwise()) return;
+    free_fmem(ptrI);
+    if (storage != MP_FP32) {
+        ptrI=get_fmem(r * c * kr * kc * iz, "ConvolDescriptor::set_storage");
+        ptrI16.resize((long)O->shape[0] * r * c * kr * kc * iz);
+    } else {
+        ptrI=get_fmem(O->shape[0] * r * c * kr * kc * iz, "ConvolDescriptor::set_storage");
+        vector<uint16_t>().swap(ptrI16);
+    }
+}
+
 void ConvolDescriptor::enable_distributed() {
     // Create and initialize the tensors for accumulating gradients in distributed training
     acc_gK = new Tensor(vector<int>{nk, kz, kr, kc}, I->device);
@@ -9,29 +9,24 @@
 
 
 #include "eddl/hardware/cpu/cpu_tensor.h"
+#include "eddl/hardware/cpu/cpu_strided.h"
 #include <algorithm>
+#include <cstring>
 #include <numeric>
 
 
 void cpu_transpose(Tensor * A, Tensor * B) {
-#pragma omp parallel for
-    for (int i = 0; i < A->size; i++){
-        B->ptr[i] = A->ptr[i];
-    }
+    // A is a permuted view of the source tensor (see Tensor::transpose), so walking
+    // it in B's order performs the actual transposition
+    cpu_strided_unary(A, B, [](float a){ return a; });
 }
 
 void cpu_copy(Tensor * A, Tensor * B){
-#pragma omp parallel for
-    for (int i = 0; i < A->size; i++){
-        B->ptr[i] = A->ptr[i];
-    }
+    cpu_strided_unary(A, B, [](float a){ return a; });
 }
 
 void cpu_fill_(Tensor *A, float v){
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i){
-        A->ptr[i] = v;
-    }
+    cpu_strided_unary(A, A, [v](float a){ return v; });
 }
 
 void cpu_fill(Tensor * A, int aini, int aend, Tensor * B, int bini, int bend, int inc){
@@ -59,9 +54,10 @@ void cpu_fill(Tensor * A, int aini, int aend, Tensor * B, int bini, int bend, in
 
 
 void cpu_select(Tensor *A, Tensor *B, SelDescriptor *sd){
+    ContiguousGuard Ac(A);
 #pragma omp parallel for
     for (int i = 0; i < B->size; i++) {
-        B->ptr[i] = A->ptr[sd->cpu_addresses[i]];
+        B->ptr[i] = Ac.t->ptr[sd->cpu_addresses[i]];
     }
 }
 
@@ -89,13 +85,152 @@ void cpu_set_select_back(Tensor *A, Tensor *B, SelDescriptor *sd){
 void cpu_select(Tensor * A, Tensor * B, vector<int> sind, int ini, int end,bool mask_zeros){
     int s = A->size / A->shape[0];
 
+    // Samples are located through the stride of the first axis so that (strided) views of a
+    // dataset, such as the time steps of a sequence, can be batched without materialising them
+    bool inner_contiguous = true;
+    int expected = 1;
+    for (int d = A->ndim - 1; d > 0; d--) {
+        if (A->shape[d] != 1 && A->stride[d] != expected) { inner_contiguous = false; break; }
+        expected *= A->shape[d];
+    }
+
+    vector<int> row_shape(A->shape.begin() + 1, A->shape.end());
+    vector<int> row_stride(A->stride.begin() + 1, A->stride.end());
+
 #pragma omp parallel for
     for (int i = ini; i < end; i++) {
-        int p  = sind[i] * s;
-        int pb = (i - ini) * s;
-        for (int j = 0; j < s; j++, p++, pb++)
-            if ((mask_zeros)&&(sind[i]==0)) B->ptr[p]=0;
-            else B->ptr[pb] = A->ptr[p];
+        long p  = (long)sind[i] * A->stride[0];
+        long pb = (long)(i - ini) * s;
+        if ((mask_zeros)&&(sind[i]==0)) {
+            for (int j = 0; j < s; j++) B->ptr[pb + j] = 0;
+        } else if (inner_contiguous) {
+            for (int j = 0; j < s; j++) B->ptr[pb + j] = A->ptr[p + j];
+        } else {
+            for (int j = 0; j < s; j++) {
+                long address = 0, k = j;
+                for (int d = (int)row_shape.size() - 1; d >= 0; d--) {
+                    address += (k % row_shape[d]) * (long)row_stride[d];
+                    k /= row_shape[d];
+                }
+                B->ptr[pb + j] = A->ptr[p + address];
+            }
+        }
+    }
+}
+
+// Rows of a compact tensor are decoded (and scaled) straight into the float batch
+template<typename T>
+static void cpu_select_compact_t(Tensor *A, Tensor *B, const vector<int> &sind, int ini, int end, bool mask_zeros){
+    long s = A->size / A->shape[0];
+    const T *data = (const T *)A->cptr;
+    const float scale = A->cscale;
+
+#pragma omp parallel for
+    for (int i = ini; i < end; i++) {
+        const T *a = data + (long)sind[i] * s;
+        float *b = B->ptr + (long)(i - ini) * s;
+        if ((mask_zeros)&&(sind[i]==0)) {
+            for (long j = 0; j < s; j++) b[j] = 0.0f;
+        } else {
+            for (long j = 0; j < s; j++) b[j] = (float)a[j] * scale;
+        }
+    }
+}
+
+void cpu_select_compact(Tensor *A, Tensor *B, vector<int> sind, int ini, int end, bool mask_zeros){
+    if (A->dtype == DTYPE_UINT8) cpu_select_compact_t<uint8_t>(A, B, sind, ini, end, mask_zeros);
+    else if (A->dtype == DTYPE_UINT16) cpu_select_compact_t<uint16_t>(A, B, sind, ini, end, mask_zeros);
+    else msg("Unsupported storage type", "cpu_select_compact");
+}
+
+// Values are rounded and saturated to the range of the storage type
+template<typename T>
+static void cpu_compact_t(const float *A, T *B, long size, float max_value){
+#pragma omp parallel for
+    for (long i = 0; i < size; i++) {
+        float v = ::roundf(A[i]);
+        B[i] = (T)std::min(std::max(v, 0.0f), max_value);
+    }
+}
+
+void cpu_compact(const float *A, void *B, long size, int dtype){
+    if (dtype == DTYPE_UINT8) cpu_compact_t<uint8_t>(A, (uint8_t *)B, size, 255.0f);
+    else if (dtype == DTYPE_UINT16) cpu_compact_t<uint16_t>(A, (uint16_t *)B, size, 65535.0f);
+    else msg("Unsupported storage type", "cpu_compact");
+}
+
+int cpu_dtype_size(int dtype){
+    if (dtype == DTYPE_UINT8) return sizeof(uint8_t);
+    else if (dtype == DTYPE_UINT16) return sizeof(uint16_t);
+    return sizeof(float);
+}
+
+// Conversions to 16 bits without branches on the common path, so that the loops are vectorized
+static inline uint16_t float_to_half(float f){
+    uint32_t x;
+    memcpy(&x, &f, sizeof(x));
+    uint32_t sign = (x >> 16) & 0x8000;
+    uint32_t a = x & 0x7fffffff;
+
+    if (a >= 0x47800000) return sign | (a > 0x7f800000 ? 0x7e00 : 0x7c00);  // Overflow (inf) and nan
+    if (a < 0x38800000) {  // Subnormal: the addition of 0.5 leaves the rounded mantissa in the low bits
+        float v;
+        memcpy(&v, &a, sizeof(v));
+        v += 0.5f;
+        memcpy(&a, &v, sizeof(a));
+        return sign | (a - 0x3f000000);
+    }
+    a += 0xc8000fff + ((a >> 13) & 1);  // Rebias the exponent (15 - 127) and round
+    return sign | (a >> 13);
+}
+
+static inline float half_to_float(uint16_t h){
+    uint32_t sign = (uint32_t)(h & 0x8000) << 16;
+    uint32_t em = h & 0x7fff;
+    uint32_t x;
+    if (em >= 0x7c00) x = 0x7f800000 | ((em & 0x3ff) << 13);  // inf and nan
+    else if (em >= 0x0400) x = (em << 13) + 0x38000000;       // Rebias the exponent (127 - 15)
+    else {
+        float v = (float)em * 5.9604644775390625e-08f;  // Subnormal: em * 2^-24
+        memcpy(&x, &v, sizeof(x));
+    }
+    x |= sign;
+    float f;
+    memcpy(&f, &x, sizeof(f));
+    return f;
+}
+
+static inline uint16_t float_to_bfloat(float f){
+    uint32_t x;
+    memcpy(&x, &f, sizeof(x));
+    if ((x & 0x7fffffff) > 0x7f800000) return (x >> 16) | 0x40;  // Quiet nan
+    return (x + 0x7fff + ((x >> 16) & 1)) >> 16;
+}
+
+static inline float bfloat_to_float(uint16_t h){
+    uint32_t x = (uint32_t)h << 16;
+    float f;
+    memcpy(&f, &x, sizeof(f));
+    return f;
+}
+
+void cpu_to_half(const float *A, uint16_t *B, long size, bool bf16){
+    if (bf16) {
+#pragma omp parallel for
+        for (long i = 0; i < size; i++) B[i] = float_to_bfloat(A[i]);
+    } else {
+#pragma omp parallel for
+        for (long i = 0; i < size; i++) B[i] = float_to_half(A[i]);
+    }
+}
+
+void cpu_from_half(const uint16_t *A, float *B, long size, bool bf16){
+    if (bf16) {
+#pragma omp parallel for
+        for (long i = 0; i < size; i++) B[i] = bfloat_to_float(A[i]);
+    } else {
+#pragma omp parallel for
+        for (long i = 0; i < size; i++) B[i] = half_to_float(A[i]);
     }
 }
 
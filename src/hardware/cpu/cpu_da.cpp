@@ -12,8 +12,10 @@
 #include <iostream>
 #include <utility>
 #include <cmath>
+#include <algorithm>
 
 #include "eddl/hardware/cpu/cpu_tensor.h"
+#include "eddl/hardware/cpu/cpu_strided.h"
 #include "eddl/random.h"
 
 #ifndef M_PI
@@ -52,7 +54,8 @@ void cpu_single_rotate(int b, Tensor *A, Tensor *B, float angle, vector<int> off
     float side_b = A->shape[3]/2.0f;
     int center[2] = {(int)side_a+offset_center[0], (int)side_b+offset_center[1]};
     float angle_rad = (float)((-angle) * M_PI/180.0f);  // Convert to radians
-
+    float sin_a = ::sinf(angle_rad);
+    float cos_a = ::cosf(angle_rad);
 
     for(int c=0; c<B->shape[1]; c++) {
         for (int Bi = 0; Bi < B->shape[2]; Bi++) {
@@ -60,8 +63,8 @@ void cpu_single_rotate(int b, Tensor *A, Tensor *B, float angle, vector<int> off
                 int Bi_c = Bi - center[0];
                 int Bj_c = Bj - center[1];
 
-                int Ai = ::sinf(angle_rad) * Bj_c + ::cosf(angle_rad) * Bi_c + center[0];
-                int Aj = ::cosf(angle_rad) * Bj_c - ::sinf(angle_rad) * Bi_c + center[1];
+                int Ai = sin_a * Bj_c + cos_a * Bi_c + center[0];
+                int Aj = cos_a * Bj_c - sin_a * Bi_c + center[1];
 
                 int B_pos = b*B->stride[0] + c*B->stride[1] + Bi*B->stride[2] + Bj*B->stride[3];
                 if (Ai >= 0 && Ai < A->shape[2] && Aj >= 0 && Aj < A->shape[3]){
@@ -255,6 +258,150 @@ void cpu_crop_scale(Tensor *A, Tensor *B, vector<int> coords_from, vector<int> c
     }
 }
 
+// Index of the input row/column read for the coordinate x, or -1 if the value must be filled
+static inline int cpu_affine_index(int x, int n, int mode){
+    if (x >= 0 && x < n) return x;
+
+    if (mode == WrappingMode::Nearest) {  // (a a a a | a b c d | d d d d)
+        return x < 0 ? 0 : n - 1;
+    } else if (mode == WrappingMode::Reflect) {  // (d c b a | a b c d | d c b a)
+        int period = 2 * n;
+        x %= period; if (x < 0) x += period;
+        return x < n ? x : period - 1 - x;
+    } else if (mode == WrappingMode::Mirror) {  // (d c b | a b c d | c b a)
+        if (n == 1) return 0;
+        int period = 2 * n - 2;
+        x %= period; if (x < 0) x += period;
+        return x < n ? x : period - x;
+    } else if (mode == WrappingMode::Wrap) {  // (a b c d | a b c d | a b c d)
+        x %= n; if (x < 0) x += n;
+        return x;
+    }
+    return -1;  // Constant and Original
+}
+
+// Resamples one CxHxW sample through the matrix m (output (r, c) reads the input at
+// (m0*r + m1*c + m2, m3*r + m4*c + m5)). The taps and weights of each output row are computed
+// once and reused by all the channels. Runs on a single thread (it is also called by the loaders)
+void cpu_single_affine(const float *A, float *B, int channels, int height, int width, const float *m, bool bilinear, int mode, float constant){
+    int taps = bilinear ? 4 : 1;
+    long plane = (long)height * width;
+
+    vector<int> offset(4 * width);
+    vector<float> weight(4 * width);
+    vector<float> fill(width);  // Weight of the filling value
+
+    for(int Bi=0; Bi<height; Bi++) {
+        for(int Bj=0; Bj<width; Bj++) {
+            float y = m[0] * Bi + m[1] * Bj + m[2];
+            float x = m[3] * Bi + m[4] * Bj + m[5];
+
+            int y0, x0;
+            float wy, wx;
+            if (bilinear) {
+                float fy = ::floorf(y), fx = ::floorf(x);
+                y0 = (int)fy; x0 = (int)fx;
+                wy = y - fy; wx = x - fx;
+            } else {
+                y0 = (int)::floorf(y + 0.5f); x0 = (int)::floorf(x + 0.5f);
+                wy = 0.0f; wx = 0.0f;
+            }
+
+            float f = 0.0f;
+            for(int t=0; t<taps; t++) {
+                int dy = t >> 1, dx = t & 1;
+                float w = (dy ? wy : 1.0f - wy) * (dx ? wx : 1.0f - wx);
+                int Ai = cpu_affine_index(y0 + dy, height, mode);
+                int Aj = cpu_affine_index(x0 + dx, width, mode);
+
+                if (Ai < 0 || Aj < 0) {
+                    f += w;
+                    offset[t * width + Bj] = 0;
+                    weight[t * width + Bj] = 0.0f;
+                } else {
+                    offset[t * width + Bj] = Ai * width + Aj;
+                    weight[t * width + Bj] = w;
+                }
+            }
+            fill[Bj] = f;
+        }
+
+        for(int c=0; c<channels; c++) {
+            const float *a = A + c * plane;
+            float *b = B + c * plane + (long)Bi * width;
+
+            // Filled values take the constant or the input pixel at the same position
+            if (mode == WrappingMode::Original) {
+                const float *orig = a + (long)Bi * width;
+#pragma omp simd
+                for(int Bj=0; Bj<width; Bj++) b[Bj] = fill[Bj] * orig[Bj];
+            } else {
+#pragma omp simd
+                for(int Bj=0; Bj<width; Bj++) b[Bj] = fill[Bj] * constant;
+            }
+
+            for(int t=0; t<taps; t++) {
+                const int *o = &offset[t * width];
+                const float *w = &weight[t * width];
+#pragma omp simd
+                for(int Bj=0; Bj<width; Bj++) b[Bj] += w[Bj] * a[o[Bj]];
+            }
+        }
+    }
+}
+
+void cpu_affine(Tensor *A, Tensor *B, const float *matrices, bool bilinear, int mode, float constant){
+    ContiguousGuard ga(A);
+    int channels = B->shape[1], height = B->shape[2], width = B->shape[3];
+    long sample = (long)channels * height * width;
+
+#pragma omp parallel for
+    for(int b=0; b<B->shape[0]; b++) {
+        cpu_single_affine(ga.t->ptr + b * sample, B->ptr + b * sample, channels, height, width, &matrices[b * 6], bilinear, mode, constant);
+    }
+}
+
+// Decoded image (HxWxC, 8 bits) to a CxHxW float sample, resized (bilinear) to new_height x new_width and
+// multiplied by scale in the same pass. Runs on a single thread (it is called per sample by the loaders)
+void cpu_image_to_chw(const unsigned char *pixels, int height, int width, int channels, float *B, int new_height, int new_width, float scale){
+    if (height == new_height && width == new_width) {
+        for(int c=0; c<channels; c++) {
+            float *b = B + (long)c * height * width;
+            for(int i=0; i<height*width; i++) b[i] = pixels[(long)i*channels + c] * scale;
+        }
+        return;
+    }
+
+    // Pixel centers are aligned (as in the usual image resize functions)
+    float ratio_y = (float)height / new_height;
+    float ratio_x = (float)width / new_width;
+
+    for(int Bi=0; Bi<new_height; Bi++) {
+        float y = std::max((Bi + 0.5f) * ratio_y - 0.5f, 0.0f);
+        int y0 = std::min((int)y, height - 1);
+        int y1 = std::min(y0 + 1, height - 1);
+        float wy = y - y0;
+
+        for(int Bj=0; Bj<new_width; Bj++) {
+            float x = std::max((Bj + 0.5f) * ratio_x - 0.5f, 0.0f);
+            int x0 = std::min((int)x, width - 1);
+            int x1 = std::min(x0 + 1, width - 1);
+            float wx = x - x0;
+
+            const unsigned char *p00 = pixels + ((long)y0*width + x0)*channels;
+            const unsigned char *p01 = pixels + ((long)y0*width + x1)*channels;
+            const unsigned char *p10 = pixels + ((long)y1*width + x0)*channels;
+            const unsigned char *p11 = pixels + ((long)y1*width + x1)*channels;
+
+            for(int c=0; c<channels; c++) {
+                float top = p00[c] + (p01[c] - p00[c]) * wx;
+                float bottom = p10[c] + (p11[c] - p10[c]) * wx;
+                B[((long)c*new_height + Bi)*new_width + Bj] = (top + (bottom - top) * wy) * scale;
+            }
+        }
+    }
+}
+
 
 // CPU: Data augmentation (2D Optimized) ********************************************
 void cpu_shift_random(Tensor *A, Tensor *B, vector<float> factor_x, vector<float> factor_y, int mode, float constant) {
@@ -32,7 +32,7 @@ void cpu_rand_binary(Tensor * A, float v)
 }
 
 void cpu_rand_normal(Tensor * A, float m, float s, bool fast_math) {
-    int r = rand();
+    int r = rand_int();
 
     if (fast_math) {
         for (int i = 0; i < A->size; ++i) A->ptr[i] = fast_randn(m, s, r++);
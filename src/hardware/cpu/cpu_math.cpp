@@ -9,212 +9,180 @@
 
 
 #include "eddl/hardware/cpu/cpu_tensor.h"
+#include "eddl/hardware/cpu/cpu_strided.h"
 #include <unordered_map>
 
 // CPU: Math (in-place) ********************************************
+// Elementwise kernels walk their operands through cpu_strided_* so they also accept (strided) views
 
 void cpu_abs(Tensor *A, Tensor *B) {
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i) B->ptr[i] = ::fabs(A->ptr[i]);
+    cpu_strided_unary(A, B, [](float a){ return ::fabsf(a); });
 }
 
 void cpu_acos(Tensor *A, Tensor *B){
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i) B->ptr[i] = ::acosf(A->ptr[i]);
+    cpu_strided_unary(A, B, [](float a){ return ::acosf(a); });
 }
 
 void cpu_add(Tensor *A, Tensor *B, float v) {
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i) B->ptr[i] = A->ptr[i] + v;
+    cpu_strided_unary(A, B, [v](float a){ return a + v; });
 }
 
 
 void cpu_asin(Tensor *A, Tensor *B){
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i) B->ptr[i] = ::asinf(A->ptr[i]);
+    cpu_strided_unary(A, B, [](float a){ return ::asinf(a); });
 }
 
 void cpu_atan(Tensor *A, Tensor *B){
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i) B->ptr[i] = ::atanf(A->ptr[i]);
+    cpu_strided_unary(A, B, [](float a){ return ::atanf(a); });
 }
 
 void cpu_ceil(Tensor *A, Tensor *B){
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i) B->ptr[i] = ::ceilf(A->ptr[i]);
+    cpu_strided_unary(A, B, [](float a){ return ::ceilf(a); });
 }
 
 void cpu_clamp(Tensor *A, Tensor *B, float min, float max){
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i){
-        if (A->ptr[i] < min){
-            B->ptr[i] = min;
-        } else if(A->ptr[i] > max){
-            B->ptr[i] = max;
+    cpu_strided_unary(A, B, [min, max](float a){
+        if (a < min){
+            return min;
+        } else if(a > max){
+            return max;
         }else {
-            B->ptr[i] = A->ptr[i];
+            return a;
         }
-    }
+    });
 }
 
 
 void cpu_cos(Tensor *A, Tensor *B){
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i) B->ptr[i] = ::cosf(A->ptr[i]);
+    cpu_strided_unary(A, B, [](float a){ return ::cosf(a); });
 }
 
 void cpu_cosh(Tensor *A, Tensor *B){
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i) B->ptr[i] = ::coshf(A->ptr[i]);
+    cpu_strided_unary(A, B, [](float a){ return ::coshf(a); });
 }
 
 void cpu_exp(Tensor *A, Tensor *B) {
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i) B->ptr[i] = ::expf(A->ptr[i]);
+    cpu_strided_unary(A, B, [](float a){ return ::expf(a); });
 }
 
 void cpu_floor(Tensor *A, Tensor *B){
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i) B->ptr[i] = ::floorf(A->ptr[i]);
+    cpu_strided_unary(A, B, [](float a){ return ::floorf(a); });
 }
 
 void cpu_inv(Tensor *A, Tensor *B, float v){
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i) B->ptr[i] = v/A->ptr[i];
+    cpu_strided_unary(A, B, [v](float a){ return v/a; });
 }
 
 void cpu_log(Tensor *A, Tensor *B) {
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i) B->ptr[i] = ::logf(A->ptr[i]);
+    cpu_strided_unary(A, B, [](float a){ return ::logf(a); });
 }
 
 void cpu_log2(Tensor *A, Tensor *B) {
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i) B->ptr[i] = ::log2f(A->ptr[i]);
+    cpu_strided_unary(A, B, [](float a){ return ::log2f(a); });
 }
 
 void cpu_log10(Tensor *A, Tensor *B) {
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i) B->ptr[i] = ::log10f(A->ptr[i]);
+    cpu_strided_unary(A, B, [](float a){ return ::log10f(a); });
 }
 
 void cpu_logn(Tensor *A, Tensor *B, float n) {
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i) B->ptr[i] = ::logf(A->ptr[i])/::logf(n);
+    float log_n = ::logf(n);
+    cpu_strided_unary(A, B, [log_n](float a){ return ::logf(a)/log_n; });
 }
 
 
 void cpu_mod(Tensor *A, Tensor *B, float v){
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i) B->ptr[i] = ::fmod(A->ptr[i], v);
+    cpu_strided_unary(A, B, [v](float a){ return ::fmodf(a, v); });
 }
 
 void cpu_mult(Tensor *A, Tensor *B, float v) {
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i) B->ptr[i] = A->ptr[i] * v;
+    cpu_strided_unary(A, B, [v](float a){ return a * v; });
 }
 
 void cpu_normalize(Tensor *A, Tensor *B, float min, float max){
     // Normalize in range: 423 from [23, 562], to range [-1, 1] => 0.4842
     // (max2-min2)/(max1-min1) * (x-min1) + min2
-    float max_ori = A->max();
-    float min_ori = A->min();
+    float max_ori = cpu_max(A);
+    float min_ori = cpu_min(A);
 
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i) {
-        B->ptr[i] = (max-min)/(max_ori-min_ori) * (A->ptr[i]-min_ori) + min;
-    }
+    cpu_strided_unary(A, B, [=](float a){ return (max-min)/(max_ori-min_ori) * (a-min_ori) + min; });
 }
 
 void cpu_pow(Tensor *A, Tensor *B, float exp) {
     // To compute the power, std uses real floating-point number with the formurla: e^(y*log_(x))
     // Quite inefficient (x100 slower) in g++ except for pow_(x, 2) which is inlined as x*x
     // speed: 0.057887s
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i) B->ptr[i] = ::powf(A->ptr[i], exp);
+    cpu_strided_unary(A, B, [exp](float a){ return ::powf(a, exp); });
 }
 
 void cpu_powb(Tensor *A, Tensor *B, float base) {
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i) B->ptr[i] = ::powf(base, A->ptr[i]);
+    cpu_strided_unary(A, B, [base](float a){ return ::powf(base, a); });
 }
 
 void cpu_remainder(Tensor *A, Tensor *B, float v) {
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i) B->ptr[i] = fmod((v + fmod(A->ptr[i], v)), v);
+    cpu_strided_unary(A, B, [v](float a){ return (float)fmod((v + fmod(a, v)), v); });
 }
 
 void cpu_round(Tensor *A, Tensor *B){
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i) B->ptr[i] = ::roundf(A->ptr[i]);
+    cpu_strided_unary(A, B, [](float a){ return ::roundf(a); });
 }
 
 void cpu_rsqrt(Tensor *A, Tensor *B){
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i) B->ptr[i] = 1.0f/::sqrtf(A->ptr[i]);
+    cpu_strided_unary(A, B, [](float a){ return 1.0f/::sqrtf(a); });
 }
 
 void cpu_sigmoid(Tensor *A, Tensor *B){
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i) B->ptr[i] = 1.0f/(1.0f + ::expf(-A->ptr[i]));
+    cpu_strided_unary(A, B, [](float a){ return 1.0f/(1.0f + ::expf(-a)); });
+}
+
+void cpu_regularize(Tensor *A, Tensor *B, float l1, float l2){
+    cpu_strided_unary(A, B, [l1, l2](float a){
+        float s = (a > 0.0f) ? 1.0f : ((a < 0.0f) ? -1.0f : 0.0f);
+        return a - l1 * s - l2 * a;
+    });
 }
 
 void cpu_sign(Tensor *A, Tensor *B, float zero_sign){
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i) {
-        if(A->ptr[i] > 0.0f){
-            B->ptr[i] = 1.0f;
-        }else if(A->ptr[i] < 0.0f){
-            B->ptr[i] = -1.0f;
+    cpu_strided_unary(A, B, [zero_sign](float a){
+        if(a > 0.0f){
+            return 1.0f;
+        }else if(a < 0.0f){
+            return -1.0f;
         }else{
-            B->ptr[i] = zero_sign;  // 0.0f recommended
+            return zero_sign;  // 0.0f recommended
         }
-    };
+    });
 }
 
 
 void cpu_sin(Tensor *A, Tensor *B){
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i) B->ptr[i] = ::sinf(A->ptr[i]);
+    cpu_strided_unary(A, B, [](float a){ return ::sinf(a); });
 }
 
 void cpu_sinh(Tensor *A, Tensor *B){
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i) B->ptr[i] = ::sinhf(A->ptr[i]);
+    cpu_strided_unary(A, B, [](float a){ return ::sinhf(a); });
 }
 
 void cpu_sqr(Tensor *A, Tensor *B) {
     // pow(x, 2) == x*x  To know more, read comments in pow_'s function
     // speed: 0.000497s
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i) B->ptr[i] = A->ptr[i] * A->ptr[i];
+    cpu_strided_unary(A, B, [](float a){ return a * a; });
 }
 
 void cpu_sqrt(Tensor *A, Tensor *B) {
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i) B->ptr[i] = ::sqrtf(A->ptr[i]);
+    cpu_strided_unary(A, B, [](float a){ return ::sqrtf(a); });
 }
 
 void cpu_tan(Tensor *A, Tensor *B){
-//    #pragma omp parallel for
-    for (int i = 0; i < A->size; ++i) {
-        float r1 = A->ptr[i];
-        B->ptr[i] = ::tanf(A->ptr[i]);
-        float r2 = B->ptr[i];
-        if(::abs(r2)> 1000){
-            int asdasd = 33;
-        }
-    }
+    cpu_strided_unary(A, B, [](float a){ return ::tanf(a); });
 }
 
 void cpu_tanh(Tensor *A, Tensor *B){
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i) B->ptr[i] = ::tanhf(A->ptr[i]);
+    cpu_strided_unary(A, B, [](float a){ return ::tanhf(a); });
 }
 
 void cpu_trunc(Tensor *A, Tensor *B){
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i) B->ptr[i] = ::truncf(A->ptr[i]);
+    cpu_strided_unary(A, B, [](float a){ return ::truncf(a); });
 }
 
 
@@ -222,57 +190,94 @@ void cpu_trunc(Tensor *A, Tensor *B){
 // CPU: Math (static) ***************************
 
 void cpu_add(float scA, Tensor *A, float scB, Tensor *B, Tensor *C, int incC) {
-#pragma omp parallel for
-    for (int i = 0; i < A->size; i++)
-        if (incC) C->ptr[i] += scA * A->ptr[i] + scB * B->ptr[i];
-        else C->ptr[i] = scA * A->ptr[i] + scB * B->ptr[i];
+    cpu_strided_binary(A, B, C, incC, [scA, scB](float a, float b){ return scA * a + scB * b; });
 }
 
 
 void cpu_inc(Tensor *A, Tensor *B) {
     B->tsem->lock();
 
-#pragma omp parallel for
-    for (int i = 0; i < A->size; i++){
-        B->ptr[i] += A->ptr[i];
-    }
+    cpu_strided_binary(A, B, B, 0, [](float a, float b){ return a + b; });
 
     B->tsem->unlock();
 }
 
-void cpu_mult2D(Tensor *A, int tA, Tensor *B, int tB, Tensor *C, int incC) {
-    if (!tB) {
-        if (!tA) {
-            if (!incC) *(C->ptr2) = *(B->ptr2) * (*(A->ptr2));
-            else *(C->ptr2) += *(B->ptr2) * (*(A->ptr2));
+// Products smaller than this (in multiply-adds) are run in parallel with each other instead of
+// letting Eigen split each one among the threads
+#define CPU_GEMM_SMALL (1 << 20)
+
+// C = op(A)*op(B) (or C += op(A)*op(B) if incC) with column-major (Eigen) matrices, where op(A) is m x k,
+// op(B) is k x n and C is m x n. The product is evaluated straight into C (noalias), so C must not
+// overlap A or B
+void cpu_gemm(int tA, int tB, int m, int n, int k, float *A, float *B, float *C, int incC) {
+    Eigen::Map<Eigen::MatrixXf> mA(A, tA ? k : m, tA ? m : k);
+    Eigen::Map<Eigen::MatrixXf> mB(B, tB ? n : k, tB ? k : n);
+    Eigen::Map<Eigen::MatrixXf> mC(C, m, n);
+
+    if (!tA) {
+        if (!tB) {
+            if (!incC) mC.noalias() = mA * mB;
+            else mC.noalias() += mA * mB;
         } else {
-            if (!incC) *(C->ptr2) = *(B->ptr2) * ((*(A->ptr2)).transpose());
-            else *(C->ptr2) += *(B->ptr2) * ((*(A->ptr2)).transpose());
+            if (!incC) mC.noalias() = mA * mB.transpose();
+            else mC.noalias() += mA * mB.transpose();
         }
     } else {
-        if (!tA) {
-            if (!incC) *(C->ptr2) = (*(B->ptr2)).transpose() * (*(A->ptr2));
-            else *(C->ptr2) += (*(B->ptr2)).transpose() * (*(A->ptr2));
+        if (!tB) {
+            if (!incC) mC.noalias() = mA.transpose() * mB;
+            else mC.noalias() += mA.transpose() * mB;
         } else {
-            if (!incC) *(C->ptr2) = (*(B->ptr2)).transpose() * ((*(A->ptr2)).transpose());
-            else *(C->ptr2) += (*(B->ptr2)).transpose() * ((*(A->ptr2)).transpose());
+            if (!incC) mC.noalias() = mA.transpose() * mB.transpose();
+            else mC.noalias() += mA.transpose() * mB.transpose();
+        }
+    }
+}
+
+// C_b = op(A_b)*op(B_b) for b in [0, batch), where X_b starts at X + b*sX (cpu_gemm layout). A stride
+// of 0 shares the operand among the products. If sC is 0 the products are accumulated into C
+void cpu_gemm_strided_batched(int tA, int tB, int m, int n, int k, float *A, long sA, float *B, long sB, float *C, long sC, int batch, int incC) {
+    if (sC == 0) {
+        for (int b = 0; b < batch; b++) {
+            cpu_gemm(tA, tB, m, n, k, A + b * sA, B + b * sB, C, (b > 0) || incC);
         }
+        return;
+    }
+
+#pragma omp parallel for if(batch > 1)
+    for (int b = 0; b < batch; b++) {
+        cpu_gemm(tA, tB, m, n, k, A + b * sA, B + b * sB, C + b * sC, incC);
+    }
+}
+
+// Row-major tensors are seen by Eigen as their transpose, so C = A·B is computed as C' = B'·A'
+void cpu_mult2D(Tensor *A, int tA, Tensor *B, int tB, Tensor *C, int incC) {
+    ContiguousGuard gA(A), gB(B);
+    int k = tA ? A->shape[0] : A->shape[1];
+    cpu_gemm(tB, tA, C->shape[1], C->shape[0], k, gB.t->ptr, gA.t->ptr, C->ptr, incC);
+}
+
+// Independent products C[i] = A[i]·B[i] (see cpu_mult2D). Small products run in parallel with
+// each other, large ones one after the other with a parallel GEMM
+void cpu_mult2D_batched(const vector<Tensor*> &A, int tA, const vector<Tensor*> &B, int tB, const vector<Tensor*> &C, int incC) {
+    long work = 0;
+    for (int i = 0; i < C.size(); i++) {
+        long k = tA ? A[i]->shape[0] : A[i]->shape[1];
+        work = std::max(work, (long)C[i]->size * k);
+    }
+
+#pragma omp parallel for if(C.size() > 1 && work < CPU_GEMM_SMALL)
+    for (int i = 0; i < C.size(); i++) {
+        cpu_mult2D(A[i], tA, B[i], tB, C[i], incC);
     }
 }
 
 void cpu_el_div(Tensor *A, Tensor *B, Tensor *C, int incC) {
-#pragma omp parallel for
-    for (int i = 0; i < A->size; i++)
-        if (incC) C->ptr[i] += A->ptr[i] / B->ptr[i];
-        else C->ptr[i] = A->ptr[i] / B->ptr[i];
+    cpu_strided_binary(A, B, C, incC, [](float a, float b){ return a / b; });
 }
 
 
 void cpu_el_mult(Tensor *A, Tensor *B, Tensor *C, int incC) {
-#pragma omp parallel for
-    for (int i = 0; i < A->size; i++)
-        if (incC) C->ptr[i] += A->ptr[i] * B->ptr[i];
-        else C->ptr[i] = A->ptr[i] * B->ptr[i];
+    cpu_strided_binary(A, B, C, incC, [](float a, float b){ return a * b; });
 }
 
 
@@ -297,31 +302,19 @@ void cpu_sum2D_colwise(Tensor *A, Tensor *B, Tensor *C) {
 
 
 void cpu_maximum(Tensor* A, Tensor* B, float v){
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i) {
-        B->ptr[i] = ::max(A->ptr[i], v);
-    }
+    cpu_strided_unary(A, B, [v](float a){ return ::max(a, v); });
 }
 
 void cpu_maximum(Tensor* A, Tensor* B, Tensor* C){
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i) {
-        C->ptr[i] = ::max(A->ptr[i], B->ptr[i]);
-    }
+    cpu_strided_binary(A, B, C, 0, [](float a, float b){ return ::max(a, b); });
 }
 
 void cpu_minimum(Tensor* A, Tensor* B, float v){
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i) {
-        B->ptr[i] = ::min(A->ptr[i], v);
-    }
+    cpu_strided_unary(A, B, [v](float a){ return ::min(a, v); });
 }
 
 void cpu_minimum(Tensor* A, Tensor* B, Tensor* C){
-#pragma omp parallel for
-    for (int i = 0; i < A->size; ++i) {
-        C->ptr[i] = ::min(A->ptr[i], B->ptr[i]);
-    }
+    cpu_strided_binary(A, B, C, 0, [](float a, float b){ return ::min(a, b); });
 }
 
 
@@ -329,29 +322,33 @@ void cpu_minimum(Tensor* A, Tensor* B, Tensor* C){
 
 
 float cpu_max(Tensor *A) {
-    auto t = cpu_max(A->ptr, A->size, nullptr);
+    ContiguousGuard Ac(A);
+    auto t = cpu_max(Ac.t->ptr, A->size, nullptr);
     return std::get<0>(t);  // get max
 }
 
 
 void cpu_max(Tensor *A, Tensor *B, ReduceDescriptor2 *rd){
+    ContiguousGuard Ac(A);
     #pragma omp parallel for
     for(int i=0; i<rd->index.size(); i++){
-        auto t = cpu_max(A->ptr, rd->index[i].size(), rd->index[i].data());
+        auto t = cpu_max(Ac.t->ptr, rd->index[i].size(), rd->index[i].data());
         B->ptr[i] = std::get<0>(t);  // get max
     }
 }
 
 int cpu_argmax(Tensor *A) {
-    auto t = cpu_max(A->ptr, A->size, nullptr);
+    ContiguousGuard Ac(A);
+    auto t = cpu_max(Ac.t->ptr, A->size, nullptr);
     return std::get<1>(t);  // get argmax
 }
 
 
 void cpu_argmax(Tensor *A, Tensor *B, ReduceDescriptor2 *rd){
+    ContiguousGuard Ac(A);
     #pragma omp parallel for
     for(int i=0; i<rd->index.size(); i++){
-        auto t = cpu_max(A->ptr, rd->index[i].size(), rd->index[i].data());
+        auto t = cpu_max(Ac.t->ptr, rd->index[i].size(), rd->index[i].data());
         B->ptr[i] = std::get<1>(t);  // get argmax
     }
 }
@@ -399,30 +396,34 @@ std::tuple<float, int> cpu_max(float *ptr, int size, int *map) {
 
 
 float cpu_min(Tensor *A) {
-    auto t = cpu_min(A->ptr, A->size, nullptr);
+    ContiguousGuard Ac(A);
+    auto t = cpu_min(Ac.t->ptr, A->size, nullptr);
     return std::get<0>(t);  // get min
 }
 
 
 void cpu_min(Tensor *A, Tensor *B, ReduceDescriptor2 *rd){
+    ContiguousGuard Ac(A);
     #pragma omp parallel for
     for(int i=0; i<rd->index.size(); i++){
-        auto t = cpu_min(A->ptr, rd->index[i].size(), rd->index[i].data());
+        auto t = cpu_min(Ac.t->ptr, rd->index[i].size(), rd->index[i].data());
         B->ptr[i] = std::get<0>(t);  // get min
     }
 }
 
 
 int cpu_argmin(Tensor *A) {
-    auto t = cpu_min(A->ptr, A->size, nullptr);
+    ContiguousGuard Ac(A);
+    auto t = cpu_min(Ac.t->ptr, A->size, nullptr);
     return std::get<1>(t);  // get argmin
 }
 
 
 void cpu_argmin(Tensor *A, Tensor *B, ReduceDescriptor2 *rd){
+    ContiguousGuard Ac(A);
     #pragma omp parallel for
     for(int i=0; i<rd->index.size(); i++){
-        auto t = cpu_min(A->ptr, rd->index[i].size(), rd->index[i].data());
+        auto t = cpu_min(Ac.t->ptr, rd->index[i].size(), rd->index[i].data());
         B->ptr[i] = std::get<1>(t);  // get argmmin
     }
 }
@@ -471,14 +472,17 @@ std::tuple<float, int> cpu_min(float *ptr, int size, int *map) {
 
 
 float cpu_sum(Tensor *A) {
+    cpu_check_compact(A);
+    if (!A->is_contiguous()) { return cpu_strided_sum(A, [](float a){ return a; }); }
     return cpu_sum(A->ptr, A->size, nullptr);
 }
 
 
 void cpu_sum(Tensor *A, Tensor *B, ReduceDescriptor2 *rd){
+    ContiguousGuard Ac(A);
     #pragma omp parallel for
     for(int i=0; i<rd->index.size(); i++){
-        B->ptr[i] = cpu_sum(A->ptr, rd->index[i].size(), rd->index[i].data());
+        B->ptr[i] = cpu_sum(Ac.t->ptr, rd->index[i].size(), rd->index[i].data());
     }
 }
 
@@ -499,14 +503,16 @@ float cpu_sum(float *ptr, int size, int *map) {
 
 
 float cpu_sum_abs(Tensor *A) {
+    if (!A->is_contiguous()) { return cpu_strided_sum(A, [](float a){ return ::fabsf(a); }); }
     return cpu_sum_abs(A->ptr, A->size, nullptr);
 }
 
 
 void cpu_sum_abs(Tensor *A, Tensor *B, ReduceDescriptor2 *rd){
+    ContiguousGuard Ac(A);
 #pragma omp parallel for
     for(int i=0; i<rd->index.size(); i++){
-        B->ptr[i] = cpu_sum_abs(A->ptr, rd->index[i].size(), rd->index[i].data());
+        B->ptr[i] = cpu_sum_abs(Ac.t->ptr, rd->index[i].size(), rd->index[i].data());
     }
 }
 
@@ -527,14 +533,16 @@ float cpu_sum_abs(float *ptr, int size, int *map) {
 
 
 float cpu_prod(Tensor *A) {
-    return cpu_prod(A->ptr, A->size, nullptr);
+    ContiguousGuard Ac(A);
+    return cpu_prod(Ac.t->ptr, A->size, nullptr);
 }
 
 
 void cpu_prod(Tensor *A, Tensor *B, ReduceDescriptor2 *rd){
+    ContiguousGuard Ac(A);
 #pragma omp parallel for
     for(int i=0; i<rd->index.size(); i++){
-        B->ptr[i] = cpu_prod(A->ptr, rd->index[i].size(), rd->index[i].data());
+        B->ptr[i] = cpu_prod(Ac.t->ptr, rd->index[i].size(), rd->index[i].data());
     }
 }
 
@@ -554,27 +562,30 @@ float cpu_prod(float *ptr, int size, int *map) {
 }
 
 float cpu_mean(Tensor *A) {
-    return cpu_sum(A->ptr, A->size, nullptr) / A->size;
+    return cpu_sum(A) / A->size;
 }
 
 
 void cpu_mean(Tensor *A, Tensor *B, ReduceDescriptor2 *rd){
+    ContiguousGuard Ac(A);
     #pragma omp parallel for
     for(int i=0; i<rd->index.size(); i++){
-        B->ptr[i] = cpu_sum(A->ptr, rd->index[i].size(), rd->index[i].data()) / rd->index[i].size();
+        B->ptr[i] = cpu_sum(Ac.t->ptr, rd->index[i].size(), rd->index[i].data()) / rd->index[i].size();
     }
 }
 
 
 float cpu_var(Tensor *A, bool unbiased){
-    return cpu_var(A->ptr, A->size, nullptr, unbiased);
+    ContiguousGuard Ac(A);
+    return cpu_var(Ac.t->ptr, A->size, nullptr, unbiased);
 }
 
 
 void cpu_var(Tensor *A, Tensor *B, ReduceDescriptor2 *rd, bool unbiased){
+    ContiguousGuard Ac(A);
 #pragma omp parallel for
     for(int i=0; i<rd->index.size(); i++){
-        B->ptr[i] = cpu_var(A->ptr, rd->index[i].size(), rd->index[i].data(), unbiased);
+        B->ptr[i] = cpu_var(Ac.t->ptr, rd->index[i].size(), rd->index[i].data(), unbiased);
     }
 }
 
@@ -601,26 +612,30 @@ float cpu_var(float *ptr, int size, int *map, bool unbiased){
 
 
 float cpu_std(Tensor *A, bool unbiased) {
-    return ::sqrtf(cpu_var(A->ptr, A->size, nullptr, unbiased));
+    ContiguousGuard Ac(A);
+    return ::sqrtf(cpu_var(Ac.t->ptr, A->size, nullptr, unbiased));
 }
 
 void cpu_std(Tensor *A, Tensor *B, ReduceDescriptor2 *rd, bool unbiased){
+    ContiguousGuard Ac(A);
 #pragma omp parallel for
     for(int i=0; i<rd->index.size(); i++){
-        B->ptr[i] = ::sqrtf(cpu_var(A->ptr, rd->index[i].size(), rd->index[i].data(), unbiased));
+        B->ptr[i] = ::sqrtf(cpu_var(Ac.t->ptr, rd->index[i].size(), rd->index[i].data(), unbiased));
     }
 }
 
 
 int cpu_mode(Tensor *A) {
-    return cpu_mode(A->ptr, A->size, nullptr);
+    ContiguousGuard Ac(A);
+    return cpu_mode(Ac.t->ptr, A->size, nullptr);
 }
 
 
 void cpu_mode(Tensor *A, Tensor *B, ReduceDescriptor2 *rd){
+    ContiguousGuard Ac(A);
 #pragma omp parallel for
     for(int i=0; i<rd->index.size(); i++){
-        B->ptr[i] = cpu_mode(A->ptr, rd->index[i].size(), rd->index[i].data());
+        B->ptr[i] = cpu_mode(Ac.t->ptr, rd->index[i].size(), rd->index[i].data());
     }
 }
 
@@ -650,14 +665,16 @@ int cpu_mode(float *ptr, int size, int *map) {
 
 
 float cpu_median(Tensor *A) {
-    return cpu_median(A->ptr, A->size, nullptr);
+    ContiguousGuard Ac(A);
+    return cpu_median(Ac.t->ptr, A->size, nullptr);
 }
 
 
 void cpu_median(Tensor *A, Tensor *B, ReduceDescriptor2 *rd){
+    ContiguousGuard Ac(A);
     #pragma omp parallel for
     for(int i=0; i<rd->index.size(); i++){
-        B->ptr[i] = cpu_median(A->ptr, rd->index[i].size(), rd->index[i].data());
+        B->ptr[i] = cpu_median(Ac.t->ptr, rd->index[i].size(), rd->index[i].data());
     }
 }
 
@@ -12,6 +12,7 @@
 #include <iostream>
 
 #include "eddl/hardware/cpu/nn/cpu_tensor_nn.h"
+#include "eddl/hardware/cpu/cpu_tensor.h"
 
 
 float get_pixel(int b,int px,int py,int pz,ConvolDescriptor *D,int isize,int irsize) {
@@ -59,10 +60,10 @@ void im2col(int b,ConvolDescriptor *D,float *ptrI,int col2im)
   px=-D->padcl;
 
 
-  for(j=0;j<D->matI.rows();j++) {
+  for(j=0;j<orsize;j++) {
     k=j;
 
-    for(i=0;i<D->matI.cols();i++,k+=orsize) {
+    for(i=0;i<D->kz*ksize;i++,k+=orsize) {
       pz=i/ksize;
       y=py+(i%ksize)/D->kc;
       x=px+(i%D->kc);
@@ -94,19 +95,24 @@ void cpu_conv2D(ConvolDescriptor *D)
   new(&D->matK) Eigen::Map<Eigen::MatrixXf>(D->K->ptr, D->kr * D->kc * D->kz, D->nk);
   new(&D->matI) Eigen::Map<Eigen::MatrixXf>(D->ptrI, D->r*D->c,D->kz*D->kr*D->kc);
 
-  #pragma omp parallel for
-  for(int b=0;b<D->I->shape[0];b++){
-
-    float *ptrO=D->O->ptr+(b*osize);
-    float *ptrI=D->ptrI+(b*isize);
-
-    Eigen::Map<Eigen::MatrixXf> matI=Eigen::Map<Eigen::MatrixXf>(ptrI,D->r*D->c,D->kz*D->kr*D->kc);
-    Eigen::Map<Eigen::MatrixXf> matO=Eigen::Map<Eigen::MatrixXf>(ptrO,D->r*D->c,D->z);
-
-    im2col(b,D,ptrI,0);
+  if (D->storage != MP_FP32) {
+    // Sample by sample, keeping the lowering in 16 bits for the gradient
+    for(int b=0;b<D->I->shape[0];b++){
+      im2col(b,D,D->ptrI,0);
+      cpu_gemm_strided_batched(0, 0, D->r*D->c, D->z, D->kz*D->kr*D->kc,
+                               D->ptrI, isize, D->K->ptr, 0, D->O->ptr+(b*osize), osize, 1, 0);
+      cpu_to_half(D->ptrI, D->ptrI16.data()+((long)b*isize), isize, D->storage == MP_BF16);
+    }
+  } else {
+    #pragma omp parallel for
+    for(int b=0;b<D->I->shape[0];b++){
+      im2col(b,D,D->ptrI+(b*isize),0);
+    }// batch
 
-    matO=matI*D->matK;
-  }// batch
+    // O_b = I_b * K for every sample, with the kernels shared by the batch
+    cpu_gemm_strided_batched(0, 0, D->r*D->c, D->z, D->kz*D->kr*D->kc,
+                             D->ptrI, isize, D->K->ptr, 0, D->O->ptr, osize, D->I->shape[0], 0);
+  }
 
   //bias
   if (D->use_bias) {
@@ -131,17 +137,17 @@ void cpu_conv2D_grad(ConvolDescriptor *D)
   // Map memory to Eigen
   new(&D->matgK) Eigen::Map<Eigen::MatrixXf>(D->gK->ptr, D->kr * D->kc * D->kz, D->nk);
 
-  //#pragma omp parallel for
-  for(int b=0;b<D->I->shape[0];b++){
-
-    float *ptrD=D->D->ptr+(b*osize);
-    float *ptrI=D->ptrI+(b*isize);
-
-    Eigen::Map<Eigen::MatrixXf> matI=Eigen::Map<Eigen::MatrixXf>(ptrI,D->r*D->c,D->kz*D->kr*D->kc);
-    Eigen::Map<Eigen::MatrixXf> matD=Eigen::Map<Eigen::MatrixXf>(ptrD,D->r*D->c,D->z);
-
-    D->matgK+=matI.transpose()*matD;
-  }// batch
+  // gK += sum_b I_b' * D_b (accumulated over the batch)
+  if (D->storage != MP_FP32) {
+    for(int b=0;b<D->I->shape[0];b++){
+      cpu_from_half(D->ptrI16.data()+((long)b*isize), D->ptrI, isize, D->storage == MP_BF16);
+      cpu_gemm_strided_batched(1, 0, D->kz*D->kr*D->kc, D->z, D->r*D->c,
+                               D->ptrI, isize, D->D->ptr+(b*osize), osize, D->gK->ptr, 0, 1, 1);
+    }
+  } else {
+    cpu_gemm_strided_batched(1, 0, D->kz*D->kr*D->kc, D->z, D->r*D->c,
+                             D->ptrI, isize, D->D->ptr, osize, D->gK->ptr, 0, D->I->shape[0], 1);
+  }
 
   //bias
 
@@ -170,18 +176,516 @@ void cpu_conv2D_back(ConvolDescriptor *D)
   new(&D->matK) Eigen::Map<Eigen::MatrixXf>(D->K->ptr, D->kr * D->kc * D->kz, D->nk);
   new (&(D->matI)) Eigen::Map<Eigen::MatrixXf>(ptrI,D->r*D->c,D->kz*D->kr*D->kc);
 
+  // I_b = D_b * K' for every sample, then scattered back to the input
+  if (D->storage != MP_FP32) {
+    for(int b=0;b<D->I->shape[0];b++){
+      cpu_gemm_strided_batched(0, 1, D->r*D->c, D->kz*D->kr*D->kc, D->z,
+                               D->D->ptr+(b*osize), osize, D->K->ptr, 0, D->ptrI, isize, 1, 0);
+      im2col(b,D,D->ptrI,1);
+    }
+    return;
+  }
+
+  cpu_gemm_strided_batched(0, 1, D->r*D->c, D->kz*D->kr*D->kc, D->z,
+                           D->D->ptr, osize, D->K->ptr, 0, D->ptrI, isize, D->I->shape[0], 0);
+
   #pragma omp parallel for
   for(int b=0;b<D->I->shape[0];b++){
+    im2col(b,D,D->ptrI+(b*isize),1);
+  }// batch
+}
 
-    float *ptrD=D->D->ptr+(b*osize);
-    float *ptrI=D->ptrI+(b*isize);
 
-    Eigen::Map<Eigen::MatrixXf> matI=Eigen::Map<Eigen::MatrixXf>(ptrI,D->r*D->c,D->kz*D->kr*D->kc);
-    Eigen::Map<Eigen::MatrixXf> matD=Eigen::Map<Eigen::MatrixXf>(ptrD,D->r*D->c,D->z);
+// Channels last lowering (D->in_layout or D->layout is LAYOUT_NHWC): row p of L (rc x ksz, row-major)
+// holds the window of the output position p as kr x kc vectors of kz channels, contiguous in the
+// input when it is NHWC. The kernels are used as Kt {nk, kr, kc, kz} and the output (rc x nk) is
+// produced by the GEMM already in the layout of D->O
+static void im2col_nhwc(int b, ConvolDescriptor *D, float *L, int col2im)
+{
+  int ksz=D->kr*D->kc*D->kz;
+  long isize=(long)D->ir*D->ic*D->iz;
+  int irsize=D->ir*D->ic;
+  bool last=D->in_layout==LAYOUT_NHWC;
+  float *ptr=(col2im ? D->ID->ptr : D->I->ptr)+b*isize;
+
+  for(int p=0;p<D->r*D->c;p++) {
+    int y0=(p/D->c)*D->sr-D->padrt;
+    int x0=(p%D->c)*D->sc-D->padcl;
+    float *row=L+(long)p*ksz;
+
+    for(int ky=0;ky<D->kr;ky++)
+    for(int kx=0;kx<D->kc;kx++) {
+      int y=y0+ky, x=x0+kx;
+      float *v=row+(ky*D->kc+kx)*D->kz;
+      bool inside=(y>=0)&&(y<D->ir)&&(x>=0)&&(x<D->ic);
+
+      if (col2im) {
+        if (!inside) continue;
+        if (last) { float *px=ptr+(long)(y*D->ic+x)*D->iz; for(int z=0;z<D->kz;z++) px[z]+=v[z]; }
+        else for(int z=0;z<D->kz;z++) ptr[(long)z*irsize+y*D->ic+x]+=v[z];
+      }
+      else {
+        if (!inside) { for(int z=0;z<D->kz;z++) v[z]=0.0f; }
+        else if (last) { const float *px=ptr+(long)(y*D->ic+x)*D->iz; for(int z=0;z<D->kz;z++) v[z]=px[z]; }
+        else for(int z=0;z<D->kz;z++) v[z]=ptr[(long)z*irsize+y*D->ic+x];
+      }
+    }
+  }
+}
 
-    matI=matD*D->matK.transpose();
+// 1x1 convolutions of NHWC inputs are a GEMM of the input itself
+static bool conv_direct(ConvolDescriptor *D)
+{
+  return D->in_layout==LAYOUT_NHWC && D->kr==1 && D->kc==1 && D->sr==1 && D->sc==1 &&
+         D->padrt==0 && D->padrb==0 && D->padcl==0 && D->padcr==0;
+}
 
-    im2col(b,D,ptrI,1);
+// out = op(L)·Kt (NCHW) or Kt'·L (NHWC), for batch samples of L starting every sL floats
+static void conv_gemm_nhwc(ConvolDescriptor *D, float *L, long sL, float *O, int batch, int incC)
+{
+  int rc=D->r*D->c, ksz=D->kr*D->kc*D->kz;
+  long osize=(long)D->z*rc;
+  if (D->layout==LAYOUT_NHWC)
+    cpu_gemm_strided_batched(1, 0, D->nk, rc, ksz, D->Kt.data(), 0, L, sL, O, osize, batch, incC);
+  else
+    cpu_gemm_strided_batched(1, 0, rc, D->nk, ksz, L, sL, D->Kt.data(), 0, O, osize, batch, incC);
+}
 
-  }// batch
+void cpu_conv2D_nhwc(ConvolDescriptor *D)
+{
+  int rc=D->r*D->c, ksz=D->kr*D->kc*D->kz;
+  long osize=(long)D->z*rc;
+  long lsize=(long)rc*ksz;
+  long isize=(long)D->ir*D->ic*D->iz;
+  int batch=D->I->shape[0];
+
+  // Kt[n][ky][kx][z] = K[n][z][ky][kx], rebuilt only after the weights change
+  if (D->Kt_stale) {
+    D->Kt.resize((long)D->nk*ksz);
+    int ks=D->kr*D->kc;
+    #pragma omp parallel for
+    for(int n=0;n<D->nk;n++)
+      for(int z=0;z<D->kz;z++)
+        for(int k=0;k<ks;k++)
+          D->Kt[(long)n*ksz+k*D->kz+z]=D->K->ptr[(long)n*ksz+z*ks+k];
+    D->Kt_stale=false;
+  }
+
+  if (conv_direct(D)) {
+    conv_gemm_nhwc(D, D->I->ptr, isize, D->O->ptr, batch, 0);
+  }
+  else if (D->storage != MP_FP32) {
+    for(int b=0;b<batch;b++){
+      im2col_nhwc(b,D,D->ptrI,0);
+      conv_gemm_nhwc(D, D->ptrI, 0, D->O->ptr+b*osize, 1, 0);
+      cpu_to_half(D->ptrI, D->ptrI16.data()+b*lsize, lsize, D->storage == MP_BF16);
+    }
+  }
+  else {
+    #pragma omp parallel for
+    for(int b=0;b<batch;b++) im2col_nhwc(b,D,D->ptrI+b*lsize,0);
+    conv_gemm_nhwc(D, D->ptrI, lsize, D->O->ptr, batch, 0);
+  }
+
+  if (D->use_bias) {
+    bool last=D->layout==LAYOUT_NHWC;
+    #pragma omp parallel for
+    for(int b=0;b<batch;b++) {
+      float *ptrO=D->O->ptr+b*osize;
+      for(int p=0;p<rc;p++)
+        for(int n=0;n<D->nk;n++)
+          ptrO[last ? (long)p*D->nk+n : (long)n*rc+p]+=D->bias->ptr[n];
+    }
+  }
+}
+
+void cpu_conv2D_grad_nhwc(ConvolDescriptor *D)
+{
+  int rc=D->r*D->c, ksz=D->kr*D->kc*D->kz;
+  long osize=(long)D->z*rc;
+  long lsize=(long)rc*ksz;
+  long isize=(long)D->ir*D->ic*D->iz;
+  int batch=D->I->shape[0];
+  int tB=D->layout==LAYOUT_NHWC;
+
+  // gKt = sum_b L_b·D_b, then added to gK with the channels first
+  vector<float> gKt((long)ksz*D->nk);
+  if (conv_direct(D)) {
+    cpu_gemm_strided_batched(0, tB, ksz, D->nk, rc, D->I->ptr, isize, D->D->ptr, osize, gKt.data(), 0, batch, 0);
+  }
+  else if (D->storage != MP_FP32) {
+    for(int b=0;b<batch;b++){
+      cpu_from_half(D->ptrI16.data()+b*lsize, D->ptrI, lsize, D->storage == MP_BF16);
+      cpu_gemm_strided_batched(0, tB, ksz, D->nk, rc, D->ptrI, 0, D->D->ptr+b*osize, 0, gKt.data(), 0, 1, b>0);
+    }
+  }
+  else {
+    cpu_gemm_strided_batched(0, tB, ksz, D->nk, rc, D->ptrI, lsize, D->D->ptr, osize, gKt.data(), 0, batch, 0);
+  }
+
+  int ks=D->kr*D->kc;
+  #pragma omp parallel for
+  for(int n=0;n<D->nk;n++)
+    for(int z=0;z<D->kz;z++)
+      for(int k=0;k<ks;k++)
+        D->gK->ptr[(long)n*ksz+z*ks+k]+=gKt[(long)n*ksz+k*D->kz+z];
+
+  if (D->use_bias) {
+    bool last=D->layout==LAYOUT_NHWC;
+    for(int b=0;b<batch;b++) {
+      float *ptrD=D->D->ptr+b*osize;
+      for(int p=0;p<rc;p++)
+        for(int n=0;n<D->nk;n++)
+          D->gbias->ptr[n]+=ptrD[last ? (long)p*D->nk+n : (long)n*rc+p];
+    }
+  }
+}
+
+void cpu_conv2D_back_nhwc(ConvolDescriptor *D)
+{
+  int rc=D->r*D->c, ksz=D->kr*D->kc*D->kz;
+  long osize=(long)D->z*rc;
+  long lsize=(long)rc*ksz;
+  long isize=(long)D->ir*D->ic*D->iz;
+  int batch=D->I->shape[0];
+  int tB=D->layout!=LAYOUT_NHWC;
+
+  // L_b = Kt·D_b, scattered back to the input (or added to it when it is the lowering)
+  if (conv_direct(D)) {
+    cpu_gemm_strided_batched(0, tB, ksz, rc, D->nk, D->Kt.data(), 0, D->D->ptr, osize, D->ID->ptr, isize, batch, 1);
+  }
+  else if (D->storage != MP_FP32) {
+    for(int b=0;b<batch;b++){
+      cpu_gemm_strided_batched(0, tB, ksz, rc, D->nk, D->Kt.data(), 0, D->D->ptr+b*osize, 0, D->ptrI, lsize, 1, 0);
+      im2col_nhwc(b,D,D->ptrI,1);
+    }
+  }
+  else {
+    cpu_gemm_strided_batched(0, tB, ksz, rc, D->nk, D->Kt.data(), 0, D->D->ptr, osize, D->ptrI, lsize, batch, 0);
+    #pragma omp parallel for
+    for(int b=0;b<batch;b++) im2col_nhwc(b,D,D->ptrI+b*lsize,1);
+  }
+}
+
+
+// Grouped convolutions (D->groups > 1), in any layout. The depthwise ones (a filter per channel) are
+// computed directly from the input, without lowering; the others are a GEMM per group
+
+// Element strides of a {Z, R, C} sample
+struct ConvStrides { long z, y, x; };
+
+static ConvStrides conv_strides(int layout, int Z, int R, int C)
+{
+  if (layout==LAYOUT_NHWC) return {1, (long)C*Z, Z};
+  return {(long)R*C, C, 1};
+}
+
+static bool conv_depthwise(ConvolDescriptor *D)
+{
+  return D->depthwise();
+}
+
+// Kt[k][z] = K[z][k], so that the channels are the inner loop with NHWC tensors
+static void depthwise_kernels_last(ConvolDescriptor *D)
+{
+  if (!D->Kt_stale) return;
+  D->Kt_stale=false;
+  int ks=D->kr*D->kc;
+  D->Kt.resize((long)ks*D->nk);
+  for(int z=0;z<D->nk;z++)
+    for(int k=0;k<ks;k++)
+      D->Kt[(long)k*D->nk+z]=D->K->ptr[(long)z*ks+k];
+}
+
+// KR, KC: window known at compile time (0: D->kr, D->kc)
+template<int KR, int KC>
+static void depthwise_forward(ConvolDescriptor *D)
+{
+  const int kr=KR ? KR : D->kr, kc=KC ? KC : D->kc;
+  int Z=D->iz, batch=D->I->shape[0];
+  long isize=(long)Z*D->ir*D->ic, osize=(long)Z*D->r*D->c;
+  const float *K=D->K->ptr;
+  const float *bias=D->use_bias ? D->bias->ptr : nullptr;
+
+  if (D->in_layout==LAYOUT_NHWC && D->layout==LAYOUT_NHWC) {
+    depthwise_kernels_last(D);
+    const float *Kt=D->Kt.data();
+
+    #pragma omp parallel for
+    for(int br=0;br<batch*D->r;br++) {
+      int b=br/D->r, oy=br%D->r;
+      for(int ox=0;ox<D->c;ox++) {
+        float *o=D->O->ptr+b*osize+((long)oy*D->c+ox)*Z;
+        for(int z=0;z<Z;z++) o[z]=bias ? bias[z] : 0.0f;
+
+        for(int ky=0;ky<kr;ky++) {
+          int y=oy*D->sr-D->padrt+ky;
+          if (y<0 || y>=D->ir) continue;
+          for(int kx=0;kx<kc;kx++) {
+            int x=ox*D->sc-D->padcl+kx;
+            if (x<0 || x>=D->ic) continue;
+            const float *in=D->I->ptr+b*isize+((long)y*D->ic+x)*Z;
+            const float *w=Kt+(long)(ky*kc+kx)*Z;
+            #pragma omp simd
+            for(int z=0;z<Z;z++) o[z]+=w[z]*in[z];
+          }
+        }
+      }
+    }
+    return;
+  }
+
+  // Plane by plane
+  ConvStrides si=conv_strides(D->in_layout, Z, D->ir, D->ic);
+  ConvStrides so=conv_strides(D->layout, Z, D->r, D->c);
+  #pragma omp parallel for
+  for(int bz=0;bz<batch*Z;bz++) {
+    int b=bz/Z, z=bz%Z;
+    const float *in=D->I->ptr+b*isize+z*si.z;
+    const float *w=K+(long)z*kr*kc;
+    float *o=D->O->ptr+b*osize+z*so.z;
+
+    for(int oy=0;oy<D->r;oy++)
+      for(int ox=0;ox<D->c;ox++) {
+        float sum=bias ? bias[z] : 0.0f;
+        int y0=oy*D->sr-D->padrt, x0=ox*D->sc-D->padcl;
+        for(int ky=0;ky<kr;ky++) {
+          int y=y0+ky;
+          if (y<0 || y>=D->ir) continue;
+          for(int kx=0;kx<kc;kx++) {
+            int x=x0+kx;
+            if (x<0 || x>=D->ic) continue;
+            sum+=w[ky*kc+kx]*in[y*si.y+x*si.x];
+          }
+        }
+        o[oy*so.y+ox*so.x]=sum;
+      }
+  }
+}
+
+template<int KR, int KC>
+static void depthwise_grad(ConvolDescriptor *D)
+{
+  const int kr=KR ? KR : D->kr, kc=KC ? KC : D->kc;
+  int Z=D->iz, batch=D->I->shape[0];
+  long isize=(long)Z*D->ir*D->ic, osize=(long)Z*D->r*D->c;
+  ConvStrides si=conv_strides(D->in_layout, Z, D->ir, D->ic);
+  ConvStrides so=conv_strides(D->layout, Z, D->r, D->c);
+
+  // Every channel is independent: gK[z] and gbias[z] are only written by their thread
+  #pragma omp parallel for
+  for(int z=0;z<Z;z++) {
+    float *gw=D->gK->ptr+(long)z*kr*kc;
+    float gb=0.0f;
+    for(int b=0;b<batch;b++) {
+      const float *in=D->I->ptr+b*isize+z*si.z;
+      const float *d=D->D->ptr+b*osize+z*so.z;
+      for(int oy=0;oy<D->r;oy++)
+        for(int ox=0;ox<D->c;ox++) {
+          float dv=d[oy*so.y+ox*so.x];
+          gb+=dv;
+          int y0=oy*D->sr-D->padrt, x0=ox*D->sc-D->padcl;
+          for(int ky=0;ky<kr;ky++) {
+            int y=y0+ky;
+            if (y<0 || y>=D->ir) continue;
+            for(int kx=0;kx<kc;kx++) {
+              int x=x0+kx;
+              if (x<0 || x>=D->ic) continue;
+              gw[ky*kc+kx]+=dv*in[y*si.y+x*si.x];
+            }
+          }
+        }
+    }
+    if (D->use_bias) D->gbias->ptr[z]+=gb;
+  }
+}
+
+template<int KR, int KC>
+static void depthwise_back(ConvolDescriptor *D)
+{
+  const int kr=KR ? KR : D->kr, kc=KC ? KC : D->kc;
+  int Z=D->iz, batch=D->I->shape[0];
+  long isize=(long)Z*D->ir*D->ic, osize=(long)Z*D->r*D->c;
+
+  if (D->in_layout==LAYOUT_NHWC && D->layout==LAYOUT_NHWC) {
+    depthwise_kernels_last(D);
+    const float *Kt=D->Kt.data();
+
+    // The windows overlap, so each sample is scattered by a single thread
+    #pragma omp parallel for
+    for(int b=0;b<batch;b++)
+      for(int oy=0;oy<D->r;oy++)
+        for(int ox=0;ox<D->c;ox++) {
+          const float *d=D->D->ptr+b*osize+((long)oy*D->c+ox)*Z;
+          for(int ky=0;ky<kr;ky++) {
+            int y=oy*D->sr-D->padrt+ky;
+            if (y<0 || y>=D->ir) continue;
+            for(int kx=0;kx<kc;kx++) {
+              int x=ox*D->sc-D->padcl+kx;
+              if (x<0 || x>=D->ic) continue;
+              float *id=D->ID->ptr+b*isize+((long)y*D->ic+x)*Z;
+              const float *w=Kt+(long)(ky*kc+kx)*Z;
+              #pragma omp simd
+              for(int z=0;z<Z;z++) id[z]+=w[z]*d[z];
+            }
+          }
+        }
+    return;
+  }
+
+  ConvStrides si=conv_strides(D->in_layout, Z, D->ir, D->ic);
+  ConvStrides so=conv_strides(D->layout, Z, D->r, D->c);
+  #pragma omp parallel for
+  for(int bz=0;bz<batch*Z;bz++) {
+    int b=bz/Z, z=bz%Z;
+    float *id=D->ID->ptr+b*isize+z*si.z;
+    const float *w=D->K->ptr+(long)z*kr*kc;
+    const float *d=D->D->ptr+b*osize+z*so.z;
+
+    for(int oy=0;oy<D->r;oy++)
+      for(int ox=0;ox<D->c;ox++) {
+        float dv=d[oy*so.y+ox*so.x];
+        int y0=oy*D->sr-D->padrt, x0=ox*D->sc-D->padcl;
+        for(int ky=0;ky<kr;ky++) {
+          int y=y0+ky;
+          if (y<0 || y>=D->ir) continue;
+          for(int kx=0;kx<kc;kx++) {
+            int x=x0+kx;
+            if (x<0 || x>=D->ic) continue;
+            id[y*si.y+x*si.x]+=w[ky*kc+kx]*dv;
+          }
+        }
+      }
+  }
+}
+
+
+// Lowering of the kz channels of group g of sample b: rc x (kz*kr*kc), column-major as im2col
+static void im2col_group(int b, int g, ConvolDescriptor *D, float *L, int col2im)
+{
+  int rc=D->r*D->c, ks=D->kr*D->kc;
+  long isize=(long)D->iz*D->ir*D->ic;
+  ConvStrides si=conv_strides(D->in_layout, D->iz, D->ir, D->ic);
+  float *ptr=(col2im ? D->ID->ptr : D->I->ptr)+b*isize+(long)g*D->kz*si.z;
+
+  for(int i=0;i<D->kz*ks;i++) {
+    int z=i/ks, ky=(i%ks)/D->kc, kx=i%D->kc;
+    float *l=L+(long)i*rc;
+    for(int p=0;p<rc;p++) {
+      int y=(p/D->c)*D->sr-D->padrt+ky;
+      int x=(p%D->c)*D->sc-D->padcl+kx;
+      bool inside=(y>=0)&&(y<D->ir)&&(x>=0)&&(x<D->ic);
+      if (col2im) { if (inside) ptr[z*si.z+y*si.y+x*si.x]+=l[p]; }
+      else l[p]=inside ? ptr[z*si.z+y*si.y+x*si.x] : 0.0f;
+    }
+  }
+}
+
+// O (or D) of group g of sample b as rc x ng (column-major), to or from the tensor in its layout
+static void conv_group_output(int b, int g, ConvolDescriptor *D, Tensor *T, float *G, int to_tensor)
+{
+  int rc=D->r*D->c, ng=D->nk/D->groups;
+  ConvStrides so=conv_strides(D->layout, D->z, D->r, D->c);
+  float *ptr=T->ptr+(long)b*D->z*rc;
+
+  for(int n=0;n<ng;n++) {
+    int z=g*ng+n;
+    float bias=(to_tensor && D->use_bias) ? D->bias->ptr[z] : 0.0f;
+    for(int p=0;p<rc;p++) {
+      long k=z*so.z+(p/D->c)*so.y+(p%D->c)*so.x;
+      if (to_tensor) ptr[k]=G[(long)n*rc+p]+bias;
+      else G[(long)n*rc+p]=ptr[k];
+    }
+  }
+}
+
+void cpu_conv2D_grouped(ConvolDescriptor *D)
+{
+  if (conv_depthwise(D)) {
+    if (D->kr==3 && D->kc==3) depthwise_forward<3,3>(D);
+    else depthwise_forward<0,0>(D);
+    return;
+  }
+
+  int rc=D->r*D->c, ng=D->nk/D->groups;
+  long ksg=(long)D->kz*D->kr*D->kc;
+  long lsize=rc*ksg*D->groups;
+  int batch=D->I->shape[0];
+  bool packed=D->storage != MP_FP32;
+
+  #pragma omp parallel for if(!packed)
+  for(int b=0;b<batch;b++) {
+    float *L=packed ? D->ptrI : D->ptrI+b*lsize;
+    vector<float> G((long)rc*ng);
+    for(int g=0;g<D->groups;g++) {
+      float *Lg=L+g*rc*ksg;
+      im2col_group(b,g,D,Lg,0);
+      cpu_gemm(0, 0, rc, ng, ksg, Lg, D->K->ptr+g*ng*ksg, G.data(), 0);
+      conv_group_output(b,g,D,D->O,G.data(),1);
+    }
+    if (packed) cpu_to_half(L, D->ptrI16.data()+b*lsize, lsize, D->storage == MP_BF16);
+  }
+}
+
+void cpu_conv2D_grad_grouped(ConvolDescriptor *D)
+{
+  if (conv_depthwise(D)) {
+    if (D->kr==3 && D->kc==3) depthwise_grad<3,3>(D);
+    else depthwise_grad<0,0>(D);
+    return;
+  }
+
+  int rc=D->r*D->c, ng=D->nk/D->groups;
+  long ksg=(long)D->kz*D->kr*D->kc;
+  long lsize=rc*ksg*D->groups;
+  int batch=D->I->shape[0];
+  bool packed=D->storage != MP_FP32;
+
+  for(int b=0;b<batch;b++) {
+    float *L=packed ? D->ptrI : D->ptrI+b*lsize;
+    if (packed) cpu_from_half(D->ptrI16.data()+b*lsize, L, lsize, D->storage == MP_BF16);
+
+    // gK_g += L_g'·D_g. The groups write disjoint filters
+    #pragma omp parallel for
+    for(int g=0;g<D->groups;g++) {
+      vector<float> G((long)rc*ng);
+      conv_group_output(b,g,D,D->D,G.data(),0);
+      cpu_gemm(1, 0, ksg, ng, rc, L+g*rc*ksg, G.data(), D->gK->ptr+g*ng*ksg, 1);
+      if (D->use_bias)
+        for(int n=0;n<ng;n++)
+          for(int p=0;p<rc;p++) D->gbias->ptr[g*ng+n]+=G[(long)n*rc+p];
+    }
+  }
+}
+
+void cpu_conv2D_back_grouped(ConvolDescriptor *D)
+{
+  if (conv_depthwise(D)) {
+    if (D->kr==3 && D->kc==3) depthwise_back<3,3>(D);
+    else depthwise_back<0,0>(D);
+    return;
+  }
+
+  int rc=D->r*D->c, ng=D->nk/D->groups;
+  long ksg=(long)D->kz*D->kr*D->kc;
+  long lsize=rc*ksg*D->groups;
+  int batch=D->I->shape[0];
+  bool packed=D->storage != MP_FP32;
+
+  // The lowering of the forward is already consumed by the grad, so ptrI holds L.
+  // The groups scatter to disjoint channels of the sample
+  #pragma omp parallel if(!packed)
+  {
+    vector<float> G((long)rc*ng);
+    #pragma omp for
+    for(int b=0;b<batch;b++) {
+      float *L=packed ? D->ptrI : D->ptrI+b*lsize;
+      for(int g=0;g<D->groups;g++) {
+        float *Lg=L+g*rc*ksg;
+        conv_group_output(b,g,D,D->D,G.data(),0);
+        cpu_gemm(0, 1, rc, ksg, ng, G.data(), D->K->ptr+g*ng*ksg, Lg, 0);
+        im2col_group(b,g,D,Lg,1);
+      }
+    }
+  }
 }
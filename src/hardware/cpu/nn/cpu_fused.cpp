@@ -0,0 +1,298 @@
+/*
+* EDDL Library - European Distributed Deep Learning Library.
+* Version: 0.7
+* copyright (c) 2020, Universidad Politécnica de Valencia (UPV), PRHLT Research Centre
+* Date: April 2020
+* Author: PRHLT Research Centre, UPV, (rparedes@prhlt.upv.es), (jon@prhlt.upv.es)
+* All rights reserved
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "eddl/hardware/cpu/nn/cpu_tensor_nn.h"
+
+// The chain is evaluated on blocks that stay in the L1 cache: every op is a tight loop over the
+// block, so the intermediate values are never written to memory
+#define FUSED_BLOCK 256
+
+
+// y = op(x, s). x and y can be the same buffer
+static void cpu_fused_op(const FusedOp &op, const float *x, const float *s, float *y, int n){
+    const float v = op.val;
+
+    switch (op.code) {
+        case FUSED_ADD_SCALAR:
+#pragma omp simd
+            for (int i = 0; i < n; i++) y[i] = x[i] + v;
+            break;
+        case FUSED_MULT_SCALAR:
+#pragma omp simd
+            for (int i = 0; i < n; i++) y[i] = x[i] * v;
+            break;
+        case FUSED_RDIFF_SCALAR:
+#pragma omp simd
+            for (int i = 0; i < n; i++) y[i] = v - x[i];
+            break;
+        case FUSED_RDIV_SCALAR:
+#pragma omp simd
+            for (int i = 0; i < n; i++) y[i] = v * (1.0f / x[i]);
+            break;
+        case FUSED_ADD:
+#pragma omp simd
+            for (int i = 0; i < n; i++) y[i] = x[i] + s[i];
+            break;
+        case FUSED_DIFF:
+            if (op.right) {
+#pragma omp simd
+                for (int i = 0; i < n; i++) y[i] = s[i] - x[i];
+            } else {
+#pragma omp simd
+                for (int i = 0; i < n; i++) y[i] = x[i] - s[i];
+            }
+            break;
+        case FUSED_MULT:
+#pragma omp simd
+            for (int i = 0; i < n; i++) y[i] = x[i] * s[i];
+            break;
+        case FUSED_DIV:
+            if (op.right) {
+#pragma omp simd
+                for (int i = 0; i < n; i++) y[i] = s[i] / x[i];
+            } else {
+#pragma omp simd
+                for (int i = 0; i < n; i++) y[i] = x[i] / s[i];
+            }
+            break;
+        case FUSED_EXP:
+            for (int i = 0; i < n; i++) y[i] = ::expf(x[i]);
+            break;
+        case FUSED_LOG:
+            for (int i = 0; i < n; i++) y[i] = ::logf(x[i]);
+            break;
+        case FUSED_LOG2:
+            for (int i = 0; i < n; i++) y[i] = ::log2f(x[i]);
+            break;
+        case FUSED_LOG10:
+            for (int i = 0; i < n; i++) y[i] = ::log10f(x[i]);
+            break;
+        case FUSED_SQRT:
+#pragma omp simd
+            for (int i = 0; i < n; i++) y[i] = ::sqrtf(x[i]);
+            break;
+        case FUSED_ABS:
+#pragma omp simd
+            for (int i = 0; i < n; i++) y[i] = ::fabsf(x[i]);
+            break;
+        case FUSED_RELU:
+#pragma omp simd
+            for (int i = 0; i < n; i++) y[i] = (x[i] > 0.0f) ? x[i] : 0.0f;
+            break;
+        case FUSED_THRESHOLDED_RELU:
+#pragma omp simd
+            for (int i = 0; i < n; i++) y[i] = (x[i] > v) ? x[i] : 0.0f;
+            break;
+        case FUSED_LEAKY_RELU:
+#pragma omp simd
+            for (int i = 0; i < n; i++) y[i] = (x[i] > 0.0f) ? x[i] : v * x[i];
+            break;
+        case FUSED_ELU:
+            for (int i = 0; i < n; i++) y[i] = (x[i] > 0.0f) ? x[i] : v * (::expf(x[i]) - 1.0f);
+            break;
+        case FUSED_LINEAR:
+#pragma omp simd
+            for (int i = 0; i < n; i++) y[i] = v * x[i];
+            break;
+        case FUSED_SIGMOID:
+            for (int i = 0; i < n; i++) y[i] = 1.0f / (1.0f + ::expf(-x[i]));
+            break;
+        case FUSED_HARD_SIGMOID:
+#pragma omp simd
+            for (int i = 0; i < n; i++) {
+                if (x[i] > 2.5f) y[i] = 1.0f;
+                else if (x[i] < -2.5f) y[i] = 0.0f;
+                else y[i] = 0.2f * x[i] + 0.5f;
+            }
+            break;
+        case FUSED_TANH:
+            for (int i = 0; i < n; i++) y[i] = ::tanhf(x[i]);
+            break;
+    }
+}
+
+// Chain rule of y = op(x, s): g (dL/dy) becomes dL/dx, and dL/ds is added to gs
+static void cpu_fused_op_backward(const FusedOp &op, const float *x, const float *y, const float *s,
+                                  float *g, float *gs, int n){
+    const float v = op.val;
+
+    switch (op.code) {
+        case FUSED_ADD_SCALAR:
+            break;
+        case FUSED_MULT_SCALAR:
+        case FUSED_LINEAR:
+#pragma omp simd
+            for (int i = 0; i < n; i++) g[i] *= v;
+            break;
+        case FUSED_RDIFF_SCALAR:
+#pragma omp simd
+            for (int i = 0; i < n; i++) g[i] = -g[i];
+            break;
+        case FUSED_RDIV_SCALAR:
+#pragma omp simd
+            for (int i = 0; i < n; i++) g[i] = -v * (g[i] / x[i] / x[i]);
+            break;
+        case FUSED_ADD:
+#pragma omp simd
+            for (int i = 0; i < n; i++) gs[i] += g[i];
+            break;
+        case FUSED_DIFF:
+            if (op.right) {
+#pragma omp simd
+                for (int i = 0; i < n; i++) { gs[i] += g[i]; g[i] = -g[i]; }
+            } else {
+#pragma omp simd
+                for (int i = 0; i < n; i++) gs[i] -= g[i];
+            }
+            break;
+        case FUSED_MULT:
+#pragma omp simd
+            for (int i = 0; i < n; i++) { gs[i] += g[i] * x[i]; g[i] *= s[i]; }
+            break;
+        case FUSED_DIV:
+            if (op.right) {
+#pragma omp simd
+                for (int i = 0; i < n; i++) { gs[i] += g[i] / x[i]; g[i] = -(g[i] * s[i] / x[i] / x[i]); }
+            } else {
+#pragma omp simd
+                for (int i = 0; i < n; i++) { gs[i] -= g[i] * x[i] / s[i] / s[i]; g[i] /= s[i]; }
+            }
+            break;
+        case FUSED_EXP:
+#pragma omp simd
+            for (int i = 0; i < n; i++) g[i] *= y[i];
+            break;
+        case FUSED_LOG:
+#pragma omp simd
+            for (int i = 0; i < n; i++) g[i] /= x[i];
+            break;
+        case FUSED_LOG2: {
+            const float c = 1.0f / ::logf(2.0f);
+#pragma omp simd
+            for (int i = 0; i < n; i++) g[i] = g[i] * c / x[i];
+            break;
+        }
+        case FUSED_LOG10: {
+            const float c = 1.0f / ::logf(10.0f);
+#pragma omp simd
+            for (int i = 0; i < n; i++) g[i] = g[i] * c / x[i];
+            break;
+        }
+        case FUSED_SQRT:
+#pragma omp simd
+            for (int i = 0; i < n; i++) g[i] = g[i] / y[i] / 2.0f;
+            break;
+        case FUSED_ABS:
+#pragma omp simd
+            for (int i = 0; i < n; i++) g[i] *= (x[i] > 0.0f) ? 1.0f : ((x[i] < 0.0f) ? -1.0f : 0.0f);
+            break;
+        case FUSED_RELU:
+#pragma omp simd
+            for (int i = 0; i < n; i++) g[i] = (x[i] > 0.0f) ? g[i] : 0.0f;
+            break;
+        case FUSED_THRESHOLDED_RELU:
+#pragma omp simd
+            for (int i = 0; i < n; i++) g[i] = (x[i] > v) ? g[i] : 0.0f;
+            break;
+        case FUSED_LEAKY_RELU:
+#pragma omp simd
+            for (int i = 0; i < n; i++) g[i] = (x[i] > 0.0f) ? g[i] : v * g[i];
+            break;
+        case FUSED_ELU:
+            for (int i = 0; i < n; i++) g[i] = (x[i] > 0.0f) ? g[i] : g[i] * (v * ::expf(x[i]));
+            break;
+        case FUSED_SIGMOID:
+#pragma omp simd
+            for (int i = 0; i < n; i++) g[i] *= (1.0f - y[i]) * y[i];
+            break;
+        case FUSED_HARD_SIGMOID:
+#pragma omp simd
+            for (int i = 0; i < n; i++) g[i] = (x[i] < -2.5f || x[i] > 2.5f) ? 0.0f : g[i] * 0.2f;
+            break;
+        case FUSED_TANH:
+#pragma omp simd
+            for (int i = 0; i < n; i++) g[i] *= 1.0f - y[i] * y[i];
+            break;
+    }
+}
+
+
+void cpu_fused_forward(const vector<FusedOp> &ops, Tensor *X, const vector<Tensor *> &S, Tensor *Y){
+    long size = Y->size;
+    long nblocks = (size + FUSED_BLOCK - 1) / FUSED_BLOCK;
+
+#pragma omp parallel for
+    for (long b = 0; b < nblocks; b++) {
+        long off = b * FUSED_BLOCK;
+        int n = (int)std::min((long)FUSED_BLOCK, size - off);
+
+        // The first op reads the input of the chain, the rest run in place on the (cached) output block
+        float *y = Y->ptr + off;
+        const float *x = X->ptr + off;
+        for (const auto &op : ops) {
+            const float *s = (op.side >= 0) ? S[op.side]->ptr + off : nullptr;
+            cpu_fused_op(op, x, s, y, n);
+            x = y;
+        }
+    }
+}
+
+
+void cpu_fused_backward(const vector<FusedOp> &ops, Tensor *X, const vector<Tensor *> &S, Tensor *Y, Tensor *D,
+                        Tensor *PD, const vector<Tensor *> &SD){
+    long size = Y->size;
+    long nblocks = (size + FUSED_BLOCK - 1) / FUSED_BLOCK;
+    int nops = ops.size();
+
+#pragma omp parallel
+    {
+        // Inputs of the ops 1..n-1 (recomputed) and the running gradient
+        std::vector<float> buffer(nops * FUSED_BLOCK);
+        vector<const float *> xs(nops + 1);
+
+#pragma omp for
+        for (long b = 0; b < nblocks; b++) {
+            long off = b * FUSED_BLOCK;
+            int n = (int)std::min((long)FUSED_BLOCK, size - off);
+
+            // Forward: xs[k] is the input of op k, and xs[n] the output of the chain (kept by the layer)
+            xs[0] = X->ptr + off;
+            for (int k = 0; k < nops - 1; k++) {
+                float *y = &buffer[k * FUSED_BLOCK];
+                const float *s = (ops[k].side >= 0) ? S[ops[k].side]->ptr + off : nullptr;
+                cpu_fused_op(ops[k], xs[k], s, y, n);
+                xs[k + 1] = y;
+            }
+            xs[nops] = Y->ptr + off;
+
+            // Backward
+            float *g = &buffer[(nops - 1) * FUSED_BLOCK];
+            const float *d = D->ptr + off;
+            for (int i = 0; i < n; i++) g[i] = d[i];
+
+            for (int k = nops - 1; k >= 0; k--) {
+                const float *s = nullptr;
+                float *gs = nullptr;
+                if (ops[k].side >= 0) {
+                    s = S[ops[k].side]->ptr + off;
+                    gs = SD[ops[k].side]->ptr + off;
+                }
+                cpu_fused_op_backward(ops[k], xs[k], xs[k + 1], s, g, gs, n);
+            }
+
+            float *pd = PD->ptr + off;
+#pragma omp simd
+            for (int i = 0; i < n; i++) pd[i] += g[i];
+        }
+    }
+}
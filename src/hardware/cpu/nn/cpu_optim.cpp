@@ -0,0 +1,64 @@
+/*
+* EDDL Library - European Distributed Deep Learning Library.
+* Version: 0.7
+* copyright (c) 2020, Universidad Politécnica de Valencia (UPV), PRHLT Research Centre
+* Date: April 2020
+* Author: PRHLT Research Centre, UPV, (rparedes@prhlt.upv.es), (jon@prhlt.upv.es)
+* All rights reserved
+*/
+
+#include <cmath>
+
+#include "eddl/hardware/cpu/nn/cpu_tensor_nn.h"
+
+// Weight after the decay of the regularizer
+static inline float cpu_decay(float w, float l1, float l2){
+    float s = (w > 0.0f) ? 1.0f : ((w < 0.0f) ? -1.0f : 0.0f);
+    return w - l1 * s - l2 * w;
+}
+
+void cpu_sgd_step(Tensor *W, Tensor *G, Tensor *M, float lr, float mu, float l1, float l2){
+    float *w = W->ptr;
+    const float *g = G->ptr;
+    float *m = M->ptr;
+
+#pragma omp parallel for simd
+    for(long i=0; i<W->size; i++){
+        float mi = lr * g[i] + mu * m[i];
+        m[i] = mi;
+        w[i] = cpu_decay(w[i], l1, l2) - mi;
+    }
+}
+
+void cpu_adam_step(Tensor *W, Tensor *G, Tensor *M, Tensor *V, float lr, float beta_1, float beta_2, float epsilon, int t, float l1, float l2){
+    float *w = W->ptr;
+    const float *g = G->ptr;
+    float *m = M->ptr;
+    float *v = V->ptr;
+
+    // Bias corrections
+    float c1 = 1.0f / (1.0f - ::powf(beta_1, t));
+    float c2 = 1.0f / (1.0f - ::powf(beta_2, t));
+
+#pragma omp parallel for simd
+    for(long i=0; i<W->size; i++){
+        float mi = beta_1 * m[i] + (1.0f - beta_1) * g[i];
+        float vi = beta_2 * v[i] + (1.0f - beta_2) * g[i] * g[i];
+        m[i] = mi;
+        v[i] = vi;
+        w[i] = cpu_decay(w[i], l1, l2) - lr * (mi * c1) / ::sqrtf(vi * c2 + epsilon);
+    }
+}
+
+void cpu_rmsprop_step(Tensor *W, Tensor *G, Tensor *G1, float lr, float rho, float epsilon, float l1, float l2){
+    float *w = W->ptr;
+    const float *g = G->ptr;
+    float *g1 = G1->ptr;
+
+#pragma omp parallel for simd
+    for(long i=0; i<W->size; i++){
+        float s = (1.0f - rho) * g[i] * g[i] + rho * g1[i] * g1[i];
+        g1[i] = g[i];
+        w[i] = cpu_decay(w[i], l1, l2) - lr * g[i] / ::sqrtf(s + epsilon);
+    }
+}
@@ -135,3 +135,134 @@ void cpu_avgpool2D_back(PoolDescriptor *D){
         } // depth
     } // batch
 }
+
+
+// Pooling with the input (D->in_layout) or the output (D->layout) in LAYOUT_NHWC. For each output
+// position, the window is scanned with the channels as the inner loop, which are contiguous in NHWC.
+// The results are those of the NCHW kernels (padding read as 0, first maximum of the window)
+static inline long pool_index(int layout, int b, int z, int y, int x, int Z, int R, int C){
+    if (layout == LAYOUT_NHWC) return (((long)b * R + y) * C + x) * Z + z;
+    return (((long)b * Z + z) * R + y) * C + x;
+}
+
+// Distance between the channels of a pixel
+static inline long pool_channel_stride(int layout, int R, int C){
+    return layout == LAYOUT_NHWC ? 1 : (long)R * C;
+}
+
+void cpu_mpool2D_nhwc(PoolDescriptor *D){
+    long os = pool_channel_stride(D->layout, D->r, D->c);
+    long is = pool_channel_stride(D->in_layout, D->ir, D->ic);
+
+    #pragma omp parallel for
+    for(int b=0; b<D->I->shape[0]; b++){
+        for(int oy=0; oy<D->r; oy++) {
+            for(int ox=0; ox<D->c; ox++) {
+                int i = oy*D->sr - D->padrt;
+                int j = ox*D->sc - D->padcl;
+                long p = pool_index(D->layout, b, 0, oy, ox, D->z, D->r, D->c);
+                float *O = D->O->ptr + p;
+                float *indX = D->indX->ptr + p;
+                float *indY = D->indY->ptr + p;
+
+                for(int k=0; k<D->iz; k++) O[k*os] = std::numeric_limits<float>::min();
+                for(int ki=0; ki<D->kr; ki++){
+                    for(int kj=0; kj<D->kc; kj++) {
+                        int y = i+ki, x = j+kj;
+                        if (y>=0 && y<D->ir && x>=0 && x<D->ic) {
+                            const float *I = D->I->ptr + pool_index(D->in_layout, b, 0, y, x, D->iz, D->ir, D->ic);
+                            for(int k=0; k<D->iz; k++) {
+                                if (I[k*is]>O[k*os]) {
+                                    O[k*os] = I[k*is];
+                                    indX[k*os] = x;
+                                    indY[k*os] = y;
+                                }
+                            }
+                        } else {
+                            for(int k=0; k<D->iz; k++) {
+                                if (0.0f>O[k*os]) {
+                                    O[k*os] = 0.0f;
+                                    indX[k*os] = x;
+                                    indY[k*os] = y;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+void cpu_mpool2D_back_nhwc(PoolDescriptor *D){
+    #pragma omp parallel for
+    for(int b=0; b<D->I->shape[0]; b++){
+        for(int oy=0; oy<D->r; oy++) {
+            for(int ox=0; ox<D->c; ox++) {
+                for(int k=0; k<D->iz; k++) {
+                    long p = pool_index(D->layout, b, k, oy, ox, D->z, D->r, D->c);
+                    int x = D->indX->ptr[p];
+                    int y = D->indY->ptr[p];
+                    if (y>=0 && y<D->ir && x>=0 && x<D->ic)
+                        D->ID->ptr[pool_index(D->in_layout, b, k, y, x, D->iz, D->ir, D->ic)] += D->D->ptr[p];
+                }
+            }
+        }
+    }
+}
+
+void cpu_avgpool2D_nhwc(PoolDescriptor *D){
+    float ksize = D->kr*D->kc;
+    long os = pool_channel_stride(D->layout, D->r, D->c);
+    long is = pool_channel_stride(D->in_layout, D->ir, D->ic);
+
+    #pragma omp parallel for
+    for(int b=0; b<D->I->shape[0]; b++){
+        for(int oy=0; oy<D->r; oy++) {
+            for(int ox=0; ox<D->c; ox++) {
+                int i = oy*D->sr - D->padrt;
+                int j = ox*D->sc - D->padcl;
+                float *O = D->O->ptr + pool_index(D->layout, b, 0, oy, ox, D->z, D->r, D->c);
+
+                for(int k=0; k<D->iz; k++) O[k*os] = 0.0f;
+                for(int ki=0; ki<D->kr; ki++){
+                    for(int kj=0; kj<D->kc; kj++) {
+                        int y = i+ki, x = j+kj;
+                        if (y>=0 && y<D->ir && x>=0 && x<D->ic) {
+                            const float *I = D->I->ptr + pool_index(D->in_layout, b, 0, y, x, D->iz, D->ir, D->ic);
+                            for(int k=0; k<D->iz; k++) O[k*os] += I[k*is];
+                        }
+                    }
+                }
+                for(int k=0; k<D->iz; k++) O[k*os] /= ksize;
+            }
+        }
+    }
+}
+
+void cpu_avgpool2D_back_nhwc(PoolDescriptor *D){
+    float ksize = D->kr*D->kc;
+    long os = pool_channel_stride(D->layout, D->r, D->c);
+    long is = pool_channel_stride(D->in_layout, D->ir, D->ic);
+
+    #pragma omp parallel for
+    for(int b=0; b<D->I->shape[0]; b++){
+        for(int oy=0; oy<D->r; oy++) {
+            for(int ox=0; ox<D->c; ox++) {
+                int i = oy*D->sr - D->padrt;
+                int j = ox*D->sc - D->padcl;
+                const float *G = D->D->ptr + pool_index(D->layout, b, 0, oy, ox, D->z, D->r, D->c);
+
+                for(int ki=0; ki<D->kr; ki++){
+                    for(int kj=0; kj<D->kc; kj++) {
+                        int y = i+ki, x = j+kj;
+                        if (y>=0 && y<D->ir && x>=0 && x<D->ic) {
+                            float *ID = D->ID->ptr + pool_index(D->in_layout, b, 0, y, x, D->iz, D->ir, D->ic);
+                            for(int k=0; k<D->iz; k++) ID[k*is] += G[k*os]/ksize;
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,191 @@
+/*
+* EDDL Library - European Distributed Deep Learning Library.
+* Version: 0.7
+* copyright (c) 2020, Universidad Politécnica de Valencia (UPV), PRHLT Research Centre
+* Date: April 2020
+* Author: PRHLT Research Centre, UPV, (rparedes@prhlt.upv.es), (jon@prhlt.upv.es)
+* All rights reserved
+*/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "eddl/hardware/cpu/nn/cpu_tensor_nn.h"
+
+// Lowering of the convolutions (cpu_conv.cpp)
+void im2col(int b, ConvolDescriptor *D, float *ptrI, int col2im);
+
+
+// q = round(x / scale), saturated to [-127, 127] so that the range is symmetric
+void cpu_quantize_s8(const float *x, int8_t *q, long n, float scale){
+    const float inv = 1.0f / scale;
+    #pragma omp parallel for
+    for (long i = 0; i < n; i++) {
+        float v = nearbyintf(x[i] * inv);
+        if (v > 127.0f) v = 127.0f;
+        else if (v < -127.0f) v = -127.0f;
+        q[i] = (int8_t)v;
+    }
+}
+
+// Blocking of the int8 GEMM. A is packed in panels of S8_MR rows and B in panels of S8_NR columns,
+// both interleaved along k in blocks of S8_KC, so that the kernel reads them contiguously. Each task
+// computes a block of S8_MC x S8_NC outputs of a sample, with its own packed copy of B.
+// The values are widened to float when packed: a product of int8 is at most 127^2, and the sum of a
+// k-block at most S8_KC * 127^2 < 2^24, so every partial sum is exact and the result is the int32 one.
+// This runs on the float multiply-adds that every target vectorizes, while the int8 dot products
+// would need instructions (VNNI) that the portable build cannot assume
+#define S8_MR 4
+#define S8_NR 16
+#define S8_KC 512
+#define S8_MC 128
+#define S8_NC 256
+
+// Panels of the rows of A (m x k, row-major), zero padded: the k-block starting at k0 is at
+// Ap + k0 * mp, and in it the panel i at i * kc, as kc groups of S8_MR values
+static void pack_a_s8(const int8_t *A, int m, int k, float *Ap){
+    int mp = (m + S8_MR - 1) / S8_MR * S8_MR;
+    #pragma omp parallel for
+    for (int i0 = 0; i0 < mp; i0 += S8_MR) {
+        for (int k0 = 0; k0 < k; k0 += S8_KC) {
+            int kc = std::min(S8_KC, k - k0);
+            float *dst = Ap + (long)k0 * mp + (long)i0 * kc;
+            for (int l = 0; l < kc; l++)
+                for (int r = 0; r < S8_MR; r++)
+                    dst[l * S8_MR + r] = (i0 + r < m) ? A[(long)(i0 + r) * k + k0 + l] : 0.0f;
+        }
+    }
+}
+
+// Panels of S8_NR columns of the block [k0, k0+kc) x [n0, n0+nc) of op(B), zero padded. op(B) is B
+// (k x n, rows of ldb) or B' (B is n x k)
+static void pack_b_s8(const int8_t *B, long ldb, bool transB, int n, int k0, int kc, int n0, int nc, float *Bp){
+    for (int j0 = 0; j0 < nc; j0 += S8_NR) {
+        float *dst = Bp + (long)j0 * kc;
+        int nr = std::min(S8_NR, n - n0 - j0);
+        for (int l = 0; l < kc; l++) {
+            float *d = dst + l * S8_NR;
+            if (transB) {
+                for (int c = 0; c < nr; c++) d[c] = B[(long)(n0 + j0 + c) * ldb + k0 + l];
+            } else {
+                const int8_t *src = B + (long)(k0 + l) * ldb + n0 + j0;
+                for (int c = 0; c < nr; c++) d[c] = src[c];
+            }
+            for (int c = nr; c < S8_NR; c++) d[c] = 0.0f;
+        }
+    }
+}
+
+// S8_MR x S8_NR outputs of a k-block, added to the int32 ones of the previous blocks
+static inline void gemm_s8_kernel(int kc, const float *a, const float *b, int32_t *C, long ldc, int mr, int nr, bool first){
+    float acc[S8_MR][S8_NR] = {};
+    for (int l = 0; l < kc; l++) {
+        const float *bl = b + l * S8_NR;
+        for (int r = 0; r < S8_MR; r++) {
+            float av = a[l * S8_MR + r];
+            #pragma omp simd
+            for (int c = 0; c < S8_NR; c++) acc[r][c] += av * bl[c];
+        }
+    }
+    for (int r = 0; r < mr; r++) {
+        int32_t *c = C + r * ldc;
+        if (first) for (int j = 0; j < nr; j++) c[j] = (int32_t)acc[r][j];
+        else for (int j = 0; j < nr; j++) c[j] += (int32_t)acc[r][j];
+    }
+}
+
+// C_b (m x n) = A (m x k) * op(B_b) for the batch of samples b, with A shared by the batch (see pack_b_s8)
+void cpu_gemm_s8(int m, int n, int k, const int8_t *A, const int8_t *B, long ldb, long strideB, bool transB,
+                 int32_t *C, long strideC, int batch){
+    int mp = (m + S8_MR - 1) / S8_MR * S8_MR;
+    vector<float> Ap((long)mp * k);
+    pack_a_s8(A, m, k, Ap.data());
+
+    int mblocks = (m + S8_MC - 1) / S8_MC;
+    int nblocks = (n + S8_NC - 1) / S8_NC;
+    long tasks = (long)batch * mblocks * nblocks;
+
+    #pragma omp parallel
+    {
+        vector<float> Bp((long)S8_KC * S8_NC);
+
+        #pragma omp for schedule(dynamic)
+        for (long t = 0; t < tasks; t++) {
+            int b = t / (mblocks * nblocks);
+            int i0 = (t / nblocks) % mblocks * S8_MC;
+            int n0 = t % nblocks * S8_NC;
+            int mc = std::min(S8_MC, m - i0);
+            int nc = std::min(S8_NC, n - n0);
+            const int8_t *Bb = B + b * strideB;
+            int32_t *Cb = C + b * strideC;
+
+            for (int k0 = 0; k0 < k; k0 += S8_KC) {
+                int kc = std::min(S8_KC, k - k0);
+                pack_b_s8(Bb, ldb, transB, n, k0, kc, n0, nc, Bp.data());
+                const float *Ak = Ap.data() + (long)k0 * mp;
+
+                for (int i = i0; i < i0 + mc; i += S8_MR)
+                    for (int j = 0; j < nc; j += S8_NR)
+                        gemm_s8_kernel(kc, Ak + (long)i * kc, Bp.data() + (long)j * kc,
+                                       Cb + (long)i * n + n0 + j, n,
+                                       std::min(S8_MR, m - i), std::min(S8_NR, nc - j), k0 == 0);
+            }
+        }
+    }
+}
+
+
+void cpu_dense_s8(Tensor *A, const int8_t *W, const float *scales, float input_scale, Tensor *bias, Tensor *B){
+    int batch = A->shape[0];
+    int k = A->shape[1];
+    int n = B->shape[1];
+
+    // The weights are n x k, so the product is qA * W'
+    vector<int8_t> qA((long)batch * k);
+    vector<int32_t> acc((long)batch * n);
+    cpu_quantize_s8(A->ptr, qA.data(), qA.size(), input_scale);
+    cpu_gemm_s8(batch, n, k, qA.data(), W, k, 0, true, acc.data(), 0, 1);
+
+    #pragma omp parallel for
+    for (int b = 0; b < batch; b++) {
+        float *out = B->ptr + (long)b * n;
+        const int32_t *a = acc.data() + (long)b * n;
+        for (int j = 0; j < n; j++) {
+            out[j] = (float)a[j] * input_scale * scales[j];
+            if (bias != nullptr) out[j] += bias->ptr[j];
+        }
+    }
+}
+
+
+void cpu_conv2D_s8(ConvolDescriptor *D, const int8_t *K, const float *scales, float input_scale){
+    int batch = D->I->shape[0];
+    int rc = D->r * D->c;
+    long isize = (long)rc * D->kz * D->kr * D->kc;
+    long osize = (long)D->z * rc;
+
+    // The whole batch is lowered (ptrI only holds one sample with mixed precision), quantized in one
+    // contiguous pass and multiplied by a single GEMM. The lowering of a sample is ksz x rc
+    // (row-major), which is the B operand of O_b (z x rc) = K (z x ksz) * I_b
+    int nb = D->storage == MP_FP32 ? batch : 1;
+    vector<int8_t> qI(nb * isize);
+    vector<int32_t> acc(nb * osize);
+    for (int b0 = 0; b0 < batch; b0 += nb) {
+        #pragma omp parallel for
+        for (int b = 0; b < nb; b++) im2col(b0 + b, D, D->ptrI + b * isize, 0);
+        cpu_quantize_s8(D->ptrI, qI.data(), nb * isize, input_scale);
+        cpu_gemm_s8(D->z, rc, isize / rc, K, qI.data(), rc, isize, false, acc.data(), osize, nb);
+
+        #pragma omp parallel for
+        for (int bz = 0; bz < nb * D->z; bz++) {
+            int z = bz % D->z;
+            float s = input_scale * scales[z];
+            float bias = D->use_bias ? D->bias->ptr[z] : 0.0f;
+            float *out = D->O->ptr + (b0 * osize) + (long)bz * rc;
+            const int32_t *a = acc.data() + (long)bz * rc;
+            for (int p = 0; p < rc; p++) out[p] = (float)a[p] * s + bias;
+        }
+    }
+}
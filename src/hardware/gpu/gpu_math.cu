@@ -346,6 +346,16 @@ void gpu_sigmoid(Tensor *A, Tensor *B){
     check_cuda(cudaDeviceSynchronize(), "sigmoid");
 }
 
+void gpu_regularize(Tensor *A, Tensor *B, float l1, float l2){
+    int device=A->gpu_device;
+    cudaSetDevice(device);
+
+    setDims(A);
+
+    gpu_regularize<<<dimGrid,dimBlock>>>(A->ptr, B->ptr, A->size, l1, l2);
+    check_cuda(cudaDeviceSynchronize(), "regularize");
+}
+
 void gpu_sign(Tensor *A, Tensor *B, float zero_sign){
     int device=A->gpu_device;
     cudaSetDevice(device);
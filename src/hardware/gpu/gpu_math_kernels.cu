@@ -223,6 +223,16 @@
     }
 }
 
+ __global__ void gpu_regularize(float *A, float *B, long int size, float l1, float l2){
+    long int thread_id_x = threadIdx.x+blockIdx.x*blockDim.x;
+
+    if (thread_id_x < size){
+        float a = A[thread_id_x];
+        float s = (a > 0.0f) ? 1.0f : ((a < 0.0f) ? -1.0f : 0.0f);
+        B[thread_id_x] = a - l1 * s - l2 * a;
+    }
+}
+
  __global__ void gpu_sign(float *A, float *B, long int size, float zero_sign){
     long int thread_id_x = threadIdx.x+blockIdx.x*blockDim.x;
 
@@ -22,11 +22,11 @@ int LConv::total_layers = 0;
 // constructors and clones
 
 LConv::LConv(Layer *parent, const vector<int> &ks, const vector<int> &st,
-             const vector<int> &p, string name, int dev, int mem) : LConv(parent, new ConvolDescriptor(ks, st, p, mem), name, dev, mem) {}
+             const vector<int> &p, string name, int dev, int mem, int groups) : LConv(parent, new ConvolDescriptor(ks, st, p, mem, groups), name, dev, mem) {}
 
 LConv::LConv(Layer *parent, int filters, const vector<int> &kernel_size, const vector<int> &strides, string padding,
-             int groups, const vector<int> &dilation_rate, bool use_bias, string name, int dev, int mem) : LConv(parent, new ConvolDescriptor(filters, kernel_size, strides, padding, use_bias, mem), name, dev, mem) {
-    // TODO: Implement (Fix initialization)
+             int groups, const vector<int> &dilation_rate, bool use_bias, string name, int dev, int mem) : LConv(parent, new ConvolDescriptor(filters, kernel_size, strides, padding, use_bias, mem, groups), name, dev, mem) {
+    // TODO: Implement dilation
 };
 
 LConv::LConv(Layer *parent, ConvolDescriptor *D, string name, int dev, int mem) : LinLayer(name, dev, mem) {
@@ -49,6 +49,7 @@ LConv::LConv(Layer *parent, ConvolDescriptor *D, string name, int dev, int mem)
 
     params.push_back(cd->K);
     params.push_back(cd->bias);
+    reg_params = 1;
 
     gradients.push_back(cd->gK);
     gradients.push_back(cd->gbias);
@@ -68,6 +69,11 @@ void LConv::resize(int batch){
 
 }
 
+void LConv::set_storage(int s){
+    Layer::set_storage(s);
+    cd->set_storage(s);
+}
+
 void LConv::mem_delta(){
     if(this->delta == nullptr) {
         // Reserve parent's delta
@@ -84,6 +90,10 @@ void LConv::mem_delta(){
 }
 
 void LConv::forward() {
+    if (quant != nullptr && mode == TSMODE && input->isCPU() && cd->layout == LAYOUT_NCHW && cd->in_layout == LAYOUT_NCHW) {
+        tensorNN::Conv2D_s8(this->cd, quant->weights.data(), quant->scales.data(), quant->input_scale);
+        return;
+    }
     tensorNN::Conv2D(this->cd);
 }
 
@@ -95,19 +105,18 @@ void LConv::backward() {
     if (this->parent.size()) {
         tensorNN::Conv2D_back(this->cd);
     }
-
-    // Regularizer
-    if (trainable) if(reg!= nullptr) {reg->apply(cd->K);}
 }
 
 void LConv::update_weights(Tensor* w, Tensor* bias) {
     Tensor::copy( w, cd->K );
     if ( bias != nullptr ) Tensor::copy( bias, cd->bias );
+    cd->Kt_stale = true;
 }
 
 void LConv::accumulate_accumulated_gradients(Tensor* gw, Tensor* gbias) {
     cd->K->add_( gw );
     if ( gbias != nullptr ) cd->bias->add_( gbias );
+    cd->Kt_stale = true;
 }
 
 void LConv::reset_accumulated_gradients() {
@@ -118,14 +127,11 @@ void LConv::reset_accumulated_gradients() {
 void LConv::apply_accumulated_gradients() {
     cd->K->add_( cd->acc_gK );
     cd->bias->add_( cd->acc_gbias );
-
-    // Regularizer
-    if(reg!= nullptr) {reg->apply(cd->K);}
 }
 
 Layer *LConv::share(int c, int bs, vector<Layer *> p) {
     // TODO: share ComvDescriptor
-    LConv *n = new LConv(p[0], cd->ksize, cd->stride, cd->pad,  name, dev,mem_level);
+    LConv *n = new LConv(p[0], cd->ksize, cd->stride, cd->pad,  name, dev,mem_level, cd->groups);
     n->orig = this;
     n->isshared=true;
     n->trainable = trainable;
@@ -173,7 +179,7 @@ Layer *LConv::share(int c, int bs, vector<Layer *> p) {
 
 Layer *LConv::clone(int c, int bs, vector<Layer *> p, int todev) {
 
-    LConv *n = new LConv(p[0], cd->ksize, cd->stride, cd->pad,  name, todev, this->mem_level);
+    LConv *n = new LConv(p[0], cd->ksize, cd->stride, cd->pad,  name, todev, this->mem_level, cd->groups);
     n->trainable = trainable;
 
     n->orig = this;
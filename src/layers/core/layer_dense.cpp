@@ -33,6 +33,7 @@ LDense::LDense(Layer *parent, int ndim, bool use_bias, string name, int dev, int
     if (use_bias) bias = new Tensor(vector<int>{ndim}, dev);
     params.push_back(W);
     if (use_bias) params.push_back(bias);
+    reg_params = 1;
 
     gW = new Tensor(vector<int>{input->shape[1], ndim}, dev);
     if (use_bias) gbias = new Tensor(vector<int>{ndim}, dev);
@@ -49,6 +50,11 @@ LDense::LDense(Layer *parent, int ndim, bool use_bias, string name, int dev, int
 
 
 void LDense::forward() {
+    if (quant != nullptr && mode == TSMODE && input->isCPU()) {
+        tensorNN::Dense_s8(input, quant->weights.data(), quant->scales.data(), quant->input_scale,
+                           use_bias ? bias : nullptr, output);
+        return;
+    }
     Tensor::mult2D(input, 0, W, 0, output, 0);
     if (use_bias) Tensor::sum2D_rowwise(output, bias, output);
 }
@@ -62,9 +68,6 @@ void LDense::backward() {
 
     //1: note that increment parent delta
     Tensor::mult2D(delta, 0, W, 1, parent[0]->delta, 1);
-
-    // Regularizer
-    if (trainable) if(reg != nullptr) {reg->apply(this->W);}
 }
 
 void LDense::update_weights(Tensor* w, Tensor* bias) {
@@ -75,9 +78,6 @@ void LDense::update_weights(Tensor* w, Tensor* bias) {
 void LDense::accumulate_accumulated_gradients(Tensor* gw, Tensor* gbias) {
     W->add_( gw );
     if ( gbias != nullptr ) bias->add_( gbias );
-
-    // Regularizer
-    if(reg != nullptr) { reg->apply(this->W); }
 }
 
 void LDense::reset_accumulated_gradients() {
@@ -88,9 +88,6 @@ void LDense::reset_accumulated_gradients() {
 void LDense::apply_accumulated_gradients() {
     W->add_( acc_gW );
     if ( use_bias ) bias->add_( acc_gbias );
-
-    // Regularizer
-    if(reg != nullptr) { reg->apply(this->W); }
 }
 
 
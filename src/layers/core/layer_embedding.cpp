@@ -58,6 +58,7 @@ LEmbedding::LEmbedding(Layer *parent, int vocsize, int length, int dim, bool mas
 
     E=new Tensor({vocsize,dim},dev);
     params.push_back(E);
+    reg_params = 1;
 
     gE=new Tensor({vocsize,dim},dev);
     gradients.push_back(gE);
@@ -117,8 +118,6 @@ void LEmbedding::backward()
      Tensor::deselect(delta,gE, sind, 0,sind.size(),1, mask_zeros); //1=inc
 
      delta->reshape_({b,length*dim});
-
-     if(reg!= nullptr) {reg->apply(E);}
    }
 }
 
@@ -58,11 +58,37 @@ void LPermute::resize(int b){
 }
 
 void LPermute::forward(){
-    tensorNN::select(this->input, this->output, sd);
+    if (input->isCPU()) {
+        // Walk the input through a permuted view instead of an address table
+        Tensor *view = Tensor::permute_view(this->input, batch_dims(false));
+        Tensor::copy(view, this->output);
+        delete view;
+    } else {
+        tensorNN::select(this->input, this->output, sd);
+    }
 }
 
 void LPermute::backward(){
-    tensorNN::select_back(this->delta, this->parent[0]->delta, sd);
+    if (delta->isCPU()) {
+        Tensor *view = Tensor::permute_view(this->delta, batch_dims(true));
+        Tensor::inc(view, this->parent[0]->delta);
+        delete view;
+    } else {
+        tensorNN::select_back(this->delta, this->parent[0]->delta, sd);
+    }
+}
+
+vector<int> LPermute::batch_dims(bool inverse){
+    // The descriptor dims do not include the batch, which is kept in place
+    vector<int> dims = {0};
+    for(auto &d : sd->dims){ dims.push_back(d+1); }
+
+    if (inverse) {
+        vector<int> rdims(dims.size());
+        for(int i=0; i<dims.size(); i++){ rdims[dims[i]] = i; }
+        return rdims;
+    }
+    return dims;
 }
 
 Layer *LPermute::share(int c, int bs, vector<Layer *> p) {
@@ -70,11 +96,8 @@ Layer *LPermute::share(int c, int bs, vector<Layer *> p) {
 }
 
 Layer *LPermute::clone(int c, int bs, vector<Layer *> p, int todev) {
-    // Remove batch index
-    vector<int> dims_batch = vector<int>(sd->dims.begin()+1, sd->dims.end());
-    for(auto &d : dims_batch){ d-=1; }
-
-    auto *n = new LPermute(p[0], dims_batch,  name, todev, this->mem_level);
+    // The descriptor dims do not include the batch index
+    auto *n = new LPermute(p[0], sd->dims,  name, todev, this->mem_level);
     n->orig = this;
     return n;
 }
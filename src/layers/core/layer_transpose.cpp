@@ -15,6 +15,7 @@
 #include <iostream>
 
 #include "eddl/layers/core/layer_core.h"
+#include "eddl/utils.h"
 
 using namespace std;
 
@@ -25,7 +26,13 @@ LTranspose::LTranspose(Layer *parent, vector<int> dims, string name, int dev, in
     this->dims = dims;
 
     input=parent->output;
-    output=new Tensor(input->getShape(),dev);
+    if (dims.size() != input->ndim) msg("The number of dimensions to transpose does not match the input", "LTranspose::LTranspose");
+
+    // Inverse permutation, used to bring the delta back to the parent layout
+    rdims = vector<int>(dims.size());
+    for(int i=0; i<dims.size(); i++) rdims[dims[i]] = i;
+
+    output=new Tensor(permute_shape(input->getShape(), dims),dev);
 //    delta=new Tensor(input->getShape(),dev);
 
     parent->addchild(this);
@@ -38,8 +45,16 @@ void LTranspose::forward() {
 
 
 void LTranspose::backward() {
-   //Tensor::transpose(delta,delta,rdims);
-   //Tensor::inc(delta,parent[0]->delta);
+   if (delta->isCPU()) {
+       Tensor *view = Tensor::permute_view(delta, rdims);
+       Tensor::inc(view, parent[0]->delta);
+       delete view;
+   } else {
+       Tensor *t = new Tensor(parent[0]->delta->getShape(), delta->device);
+       Tensor::transpose(delta, t, rdims);
+       Tensor::inc(t, parent[0]->delta);
+       delete t;
+   }
 }
 
 
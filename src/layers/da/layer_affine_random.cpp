@@ -0,0 +1,69 @@
+/*
+* EDDL Library - European Distributed Deep Learning Library.
+* Version: 0.7
+* copyright (c) 2020, Universidad Politécnica de Valencia (UPV), PRHLT Research Centre
+* Date: April 2020
+* Author: PRHLT Research Centre, UPV, (rparedes@prhlt.upv.es), (jon@prhlt.upv.es)
+* All rights reserved
+*/
+
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <utility>
+
+#include "eddl/layers/da/layer_da.h"
+
+
+using namespace std;
+
+int LAffineRandom::total_layers = 0;
+
+LAffineRandom::LAffineRandom(Layer *parent, const AffineDescriptor &spec, string name, int dev, int mem) : LDataAugmentation(parent, name, dev, mem), spec(spec) {
+    if(name.empty()) this->name = "affine_random" + to_string(++total_layers);
+
+    output = new Tensor(input->shape, dev);
+
+    parent->addchild(this);
+    addparent(parent);
+
+}
+
+
+void LAffineRandom::forward() {
+  if (mode == TRMODE) {
+    Tensor::affine_random(input, output, spec);
+  } else {
+    Tensor::copy(input, output);
+  }
+}
+
+void LAffineRandom::backward() {
+
+}
+
+
+Layer *LAffineRandom::share(int c, int bs, vector<Layer *> p) {
+    LAffineRandom *n = new LAffineRandom(p[0], this->spec, "share_"+to_string(c)+this->name, this->dev, this->mem_level);
+    n->orig = this;
+
+    return n;
+}
+
+Layer *LAffineRandom::clone(int c, int bs, vector<Layer *> p, int todev) {
+    LAffineRandom *n = new LAffineRandom(p[0], this->spec, name, todev, this->mem_level);
+    n->orig = this;
+
+    return n;
+}
+
+
+string LAffineRandom::plot(int c) {
+    string s;
+
+    if (c) s = name + " [label=" + "\"" + name + "\",style=filled,fontsize=12,fillcolor=bisque4,shape=box]";
+    else s = name + " [label=" + "\"" + name + "\",style=filled,fontsize=12,fillcolor=White,shape=box]";
+
+    return s;
+}
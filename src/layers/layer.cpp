@@ -9,15 +9,50 @@
 
 
 #include <cstdio>
+#include <algorithm>
+#include <cmath>
 #include <cstdlib>
 #include <iostream>
 
 #include "eddl/layers/layer.h"
 #include "eddl/layers/operators/layer_operators.h"
+#include "eddl/hardware/cpu/cpu_tensor.h"
 
 using namespace std;
 
 
+Quantization::Quantization(int channels, int k, float input_scale){
+    this->channels = channels;
+    this->k = k;
+    this->input_scale = input_scale;
+    weights.resize((long)channels * k);
+    scales.resize(channels);
+}
+
+Quantization::Quantization(const float *W, int channels, int k, bool transposed, float input_scale)
+    : Quantization(channels, k, input_scale){
+    for (int c = 0; c < channels; c++) {
+        auto w = [&](int i) { return transposed ? W[(long)i * channels + c] : W[(long)c * k + i]; };
+
+        float amax = 0.0f;
+        for (int i = 0; i < k; i++) amax = std::max(amax, std::fabs(w(i)));
+        scales[c] = amax > 0.0f ? amax / 127.0f : 1.0f;
+
+        int8_t *q = weights.data() + (long)c * k;
+        for (int i = 0; i < k; i++) q[i] = (int8_t)nearbyintf(w(i) / scales[c]);
+    }
+}
+
+void Quantization::dequantize(float *W, bool transposed){
+    for (int c = 0; c < channels; c++)
+        for (int i = 0; i < k; i++) {
+            float v = (float)weights[(long)c * k + i] * scales[c];
+            if (transposed) W[(long)i * channels + c] = v;
+            else W[(long)c * k + i] = v;
+        }
+}
+
+
 ////////////////////////////////////
 ///// BASE LAYER CLASS
 ////////////////////////////////////
@@ -28,6 +63,9 @@ Layer::Layer(string name, int dev, int mem) {
     this->name = name;
     this->dev = dev;
     this->mem_level = mem;
+    storage = MP_FP32;
+    quant = nullptr;
+    layout = LAYOUT_NCHW;
     lin = lout = 0;
     delta_bp = 0;
     detached=false;
@@ -42,6 +80,7 @@ Layer::Layer(string name, int dev, int mem) {
     net=nullptr;
 
     reg = nullptr;
+    reg_params = 0;
     init=new IGlorotNormal(1234);
     //init=new IGlorotUniform(1234);  // Has problems with the drive dataset
 }
@@ -50,6 +89,7 @@ Layer::~Layer(){
     if (output!=nullptr) delete output;
     if (delta!=nullptr) delete delta;
     if (target!=nullptr) delete target;
+    if (quant!=nullptr) delete quant;
 
 //    if (orig!=nullptr) delete this->orig;
 //    if (net!=nullptr) delete this->net;
@@ -101,6 +141,12 @@ void Layer::mem_delta_parent(){
 }
 
 void Layer::mem_delta(){
+    // Layers that keep their delta (inputs) reserve it again when the batch changes
+    if(this->delta != nullptr && this->delta->shape != this->output->shape){
+        delete this->delta;
+        this->delta = nullptr;
+    }
+
     // Reserve space for the delta
     if(this->delta == nullptr){
         this->delta = Tensor::zeros(this->output->shape, this->output->device);
@@ -127,6 +173,17 @@ void Layer::set_mem_level(int mem){
     mem_level=mem;
 }
 
+void Layer::pack(Tensor *t, vector<uint16_t> &buf){
+    buf.resize(t->size);
+    cpu_to_half(t->ptr, buf.data(), t->size, storage == MP_BF16);
+}
+
+Tensor *Layer::unpack(vector<uint16_t> &buf, const vector<int> &shape){
+    auto *t = new Tensor(shape, DEV_CPU);
+    cpu_from_half(buf.data(), t->ptr, t->size, storage == MP_BF16);
+    return t;
+}
+
 void Layer::resize(int batch){
 //    cout<<name<<" resizing\n";
     if (output!=nullptr) output->resize(batch);
@@ -185,9 +242,7 @@ void Layer::save(std::ofstream &ofs, string format){
 
 void Layer::load(std::ifstream &ifs, string format){
     for (int i = 0; i != params.size(); i++){
-        Tensor* t=params[i]->loadfs(ifs, format);
-        Tensor::copy(t,params[i]);
-        delete t;
+        params[i]->loadfs_(ifs, format);
     }
 }
 
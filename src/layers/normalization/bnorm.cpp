@@ -18,78 +18,8 @@
 using namespace std;
 
 
-// Different reductions operations using matrices routines
+// Means computed with matrices routines
 // CuBlas in GPU and Eigen for CPU
-void rsum(Tensor *A, Tensor *b, Tensor *ones, Tensor *mem,int p)
-{
-  int s;
-
-  s=A->shape[p];
-
-  if (p) b->reshape_({1,s});
-  else b->reshape_({s,1});
-
-  if (p) Tensor::mult2D(ones,0,b,0,mem,0);
-  else Tensor::mult2D(b,0,ones,0,mem,0);
-
-  A->Tensor::add(1.0,A,1.0,mem,A,0);
-  b->reshape_({s});
-
-}
-
-void rdiff(Tensor *A, Tensor *b, Tensor *ones,Tensor *mem,int p)
-{
-  int s;
-
-  s=A->shape[p];
-
-  if (p) b->reshape_({1,s});
-  else b->reshape_({s,1});
-
-  if (p) Tensor::mult2D(ones,0,b,0,mem,0);
-  else Tensor::mult2D(b,0,ones,0,mem,0);
-
-  A->Tensor::add(1.0,A,-1.0,mem,A,0);
-  b->reshape_({s});
-
-}
-
-void rmult(Tensor *A, Tensor *b, Tensor *ones,Tensor *mem,int p)
-{
-  int s;
-
-  s=A->shape[p];
-
-
-  if (p) b->reshape_({1,s});
-  else b->reshape_({s,1});
-
-  if (p) Tensor::mult2D(ones,0,b,0,mem,0);
-  else Tensor::mult2D(b,0,ones,0,mem,0);
-
-  Tensor::el_mult(A,mem,A,0);
-  b->reshape_({s});
-
-}
-
-void rdiv(Tensor *A, Tensor *b, Tensor *ones,Tensor *mem,int p)
-{
-  int s;
-
-  s=A->shape[p];
-
-
-  if (p) b->reshape_({1,s});
-  else b->reshape_({s,1});
-
-  if (p) Tensor::mult2D(ones,0,b,0,mem,0);
-  else Tensor::mult2D(b,0,ones,0,mem,0);
-
-  Tensor::el_div(A,mem,A,0);
-  b->reshape_({s});
-
-}
-
 void cmean(Tensor *A, Tensor *b,Tensor *ones,int p)
 {
   int N,M;
@@ -141,7 +71,7 @@ void BN_forward(Tensor *input,Tensor *bn_mean, Tensor *bn_var, Tensor *mean, Ten
     cmean(input,bn_mean,ones);
 
     // in=in-mean
-    rdiff(input,bn_mean,ones,var);
+    Tensor::add(1.0,input,-1.0,bn_mean,input,0);
 
     Tensor::copy(input,var);
 
@@ -160,14 +90,14 @@ void BN_forward(Tensor *input,Tensor *bn_mean, Tensor *bn_var, Tensor *mean, Ten
     bn_var->sqrt_();
 
     // in/sd
-    rdiv(input,bn_var,ones,var); //in=(x-mean)/sd
+    Tensor::el_div(input,bn_var,input,0); //in=(x-mean)/sd
   }
   else {
-    rdiff(input,mean,ones,var);
+    Tensor::add(1.0,input,-1.0,mean,input,0);
     Tensor::copy(variance,bn_var);
     bn_var->add_(epsilon);
     bn_var->sqrt_();
-    rdiv(input,bn_var,ones,var);
+    Tensor::el_div(input,bn_var,input,0);
   }
 
 
@@ -213,20 +143,20 @@ void BN_backward(Tensor *delta,Tensor *bn_var, Tensor *opa)
   cmean(A,m,ones);
 
   //3
-  rmult(opa,m,ones,A);
+  Tensor::el_mult(opa,m,opa,0);
 
   //4
   cmean(delta,m,ones);
 
   //5
-  rsum(opa,m,ones,A);
+  Tensor::add(1,opa,1,m,opa,0);
 
   // 6
   Tensor::add(1,delta,-1,opa,delta,0);
 
   // from forward bn_var=sqrt(var(X) + eps
   // 7
-  rdiv(delta,bn_var,ones,A);
+  Tensor::el_div(delta,bn_var,delta,0);
 
 
   delete ones;
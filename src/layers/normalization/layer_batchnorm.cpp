@@ -89,15 +89,29 @@ void LBatchNorm::initialize() {
 
 void LBatchNorm::resize(int batch){
     if (batch!=output->shape[0]) {
-        opa->reshape_(output->getShape());
+        if (opa != nullptr) opa->reshape_(output->getShape());
         output->resize(batch);
-        opa->resize(batch);
+        if (opa != nullptr) opa->resize(batch);
+    }
+}
+
+void LBatchNorm::set_storage(int s){
+    Layer::set_storage(s);
+    if (dev != DEV_CPU) return;
+
+    if (storage != MP_FP32) {
+        delete opa;
+        opa = nullptr;
+    } else if (opa == nullptr) {
+        opa = new Tensor(output->getShape(), dev);
+        vector<uint16_t>().swap(opa16);
     }
 }
 
 // Batchnorm works over 2D Tensors
 // Essentialy 4D Tensors are reshaped as 2D and
 // Permute 4D tensors and set N,M values.
+// The NHWC tensors (see Net::set_layout) are already {b*r*c, z}
 void LBatchNorm::forward() {
     // Input = Output = opa = {Batch,Channels,H,W} OR {Batch,Dim}
     // bn_mean = bn_var = mean = variance = bn_g = bn_b = {Channels} or {Dim}
@@ -118,30 +132,32 @@ void LBatchNorm::forward() {
         c=input->shape[3];
         N=b*r*c;
 
-        in=new Tensor({b*r*c*z},input->device);
-        tensorNN::permute_channels_last(input,in);
+        if (parent[0]->layout==LAYOUT_NHWC) in=input->clone();
+        else {
+            in=new Tensor({b*r*c*z},input->device);
+            tensorNN::permute_channels_last(input,in);
+        }
         in->reshape_({N,M});
-        opa->reshape_({N,M});
+        if (opa != nullptr) opa->reshape_({N,M});
     }
 
     BN_forward(in,bn_mean,bn_var,mean,variance,momentum,epsilon,mode==TRMODE);
 
 
-    Tensor::copy(in,opa);
+    if (opa != nullptr) Tensor::copy(in,opa);
+    else pack(in, opa16);
     if (affine) {
-        Tensor *var=new Tensor({N,M},input->device);
-        Tensor *ones=new Tensor({N,1},input->device);
-        ones->fill_(1.0);
-
         // apply affine transform in=gamma*in+beta
-        rmult(in,bn_g,ones,var);
-        rsum(in,bn_b,ones,var);
-        delete var;
-        delete ones;
+        Tensor::el_mult(in,bn_g,in,0);
+        Tensor::add(1.0,in,1.0,bn_b,in,0);
     }
 
     // copy in to ouput
-    if (input->ndim==4) {
+    if (input->ndim==4 && layout==LAYOUT_NHWC) {
+        in->reshape_(output->getShape());
+        Tensor::copy(in,output);
+    }
+    else if (input->ndim==4) {
         tensorNN::permute_channels_first(in,output);
     }
     else Tensor::copy(in,output);
@@ -171,14 +187,18 @@ void LBatchNorm::backward(){
         N=b*r*c;
 
         // permute input and delta
-        dp=new Tensor({b,r,c,z},input->device);
-
-        tensorNN::permute_channels_last(delta,dp);
+        if (layout==LAYOUT_NHWC) dp=delta->clone();
+        else {
+            dp=new Tensor({b,r,c,z},input->device);
+            tensorNN::permute_channels_last(delta,dp);
+        }
 
         dp->reshape_({N,M});
 
     }
 
+    Tensor *opa = this->opa != nullptr ? this->opa : unpack(opa16, {N, M});
+
     // Affine
     if (affine) {
         Tensor *A=new Tensor({N,M},delta->device);
@@ -196,16 +216,21 @@ void LBatchNorm::backward(){
 
         // delta=dE/dY
         // Obtain dE/dY from delta:
-        rmult(dp,bn_g,ones,A);
+        Tensor::el_mult(dp,bn_g,dp,0);
         delete A;
         delete ones;
         delete m;
     }
 
     BN_backward(dp,bn_var,opa);
+    if (opa != this->opa) delete opa;
 
     // Inc parent delta
-    if (input->ndim==4) {
+    if (input->ndim==4 && parent[0]->layout==LAYOUT_NHWC) {
+        dp->reshape_(delta->getShape());
+        Tensor::inc(dp, parent[0]->delta);
+    }
+    else if (input->ndim==4) {
         tensorNN::permute_channels_first(dp,delta);
         Tensor::inc(delta, parent[0]->delta);
     }
@@ -142,13 +142,9 @@ void LGroupNorm::forward()
 
         in->reshape_({N2,M2});
 
-        Tensor *var=new Tensor({N2,M2},input->device);
-        Tensor *ones=new Tensor({N2,1},input->device);
-        ones->fill_(1.0);
-
         // apply affine transform in=gamma*in+beta
-        rmult(in,bn_g,ones,var);
-        rsum(in,bn_b,ones,var);
+        Tensor::el_mult(in,bn_g,in,0);
+        Tensor::add(1.0,in,1.0,bn_b,in,0);
 
         in2->reshape_({b,z,r,c});
         tensorNN::permute_channels_first(in,in2);
@@ -157,8 +153,6 @@ void LGroupNorm::forward()
         in->reshape_({N,M});
 
         delete in2;
-        delete var;
-        delete ones;
     }
 
     // copy in to ouput
@@ -231,8 +225,7 @@ void LGroupNorm::backward()
 
         // delta=dE/dY
         // Obtain dE/dY from delta:
-        A2->reshape_({N2,M2});
-        rmult(A,bn_g,ones,A2);
+        Tensor::el_mult(A,bn_g,A,0);
 
         A2->reshape_({b,z,r,c});
         dp->reshape_({b,z,r,c});
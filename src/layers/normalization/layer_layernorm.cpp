@@ -52,10 +52,11 @@ LLayerNorm::LLayerNorm(Layer *parent,  float epsilon, bool affine,  string name,
         //for each entire channel/plane with the affine option,
         //Layer Normalization applies per-element scale and bias with
         //elementwise_affine.
-        bn_g=new Tensor({size},dev);
-        bn_b=new Tensor({size},dev);
-        gbn_g=new Tensor({size},dev);
-        gbn_b=new Tensor({size},dev);
+        // Columns, so that they broadcast over the {N,M} tensors of forward and backward
+        bn_g=new Tensor({size,1},dev);
+        bn_b=new Tensor({size,1},dev);
+        gbn_g=new Tensor({size,1},dev);
+        gbn_b=new Tensor({size,1},dev);
 
         params.push_back(bn_g);
         params.push_back(bn_b);
@@ -139,15 +140,9 @@ void LLayerNorm::forward() {
     Tensor::copy(in,opa);
 
     if (affine) {
-        Tensor *var=new Tensor({N,M},input->device);
-        Tensor *ones=new Tensor({1,M},input->device);
-        ones->fill_(1.0);
-
-        // apply affine transform in=gamma*in+beta
-        rmult(in,bn_g,ones,var,0);
-        rsum(in,bn_b,ones,var,0);
-        delete var;
-        delete ones;
+        // apply affine transform in=gamma*in+beta (gamma and beta are broadcast as columns)
+        Tensor::el_mult(in,bn_g,in,0);
+        Tensor::add(1.0,in,1.0,bn_b,in,0);
     }
 
     // copy in to ouput
@@ -214,7 +209,7 @@ void LLayerNorm::backward()
         // delta=dE/dY
         // Obtain dE/dY from delta:
 
-        rmult(dp,bn_g,ones,A,0);
+        Tensor::el_mult(dp,bn_g,dp,0);
 
         delete A;
         delete ones;
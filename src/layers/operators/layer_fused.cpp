@@ -0,0 +1,139 @@
+/*
+* EDDL Library - European Distributed Deep Learning Library.
+* Version: 0.7
+* copyright (c) 2020, Universidad Politécnica de Valencia (UPV), PRHLT Research Centre
+* Date: April 2020
+* Author: PRHLT Research Centre, UPV, (rparedes@prhlt.upv.es), (jon@prhlt.upv.es)
+* All rights reserved
+*/
+
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+
+#include "eddl/layers/operators/layer_operators.h"
+#include "eddl/layers/core/layer_core.h"
+#include "eddl/tensor/nn/tensor_nn.h"
+
+
+using namespace std;
+
+
+LFused::LFused(vector<Layer *> layers, vector<FusedOp> ops, Layer *head, vector<Layer *> sides) :
+        Layer("fused_" + layers.back()->name, layers.back()->dev, layers.back()->mem_level) {
+    this->layers = layers;
+    this->ops = ops;
+    this->head = head;
+    this->sides = sides;
+
+    // The chain writes the output of its last layer. The graph is not modified: the parents are
+    // only known by this layer, so that their deltas are reserved before the backward
+    input = head->output;
+    output = layers.back()->output;
+
+    parent.push_back(head);
+    for (auto l : sides) {
+        bool found = false;
+        for (auto p : parent) found = found || (p == l);
+        if (!found) parent.push_back(l);
+    }
+}
+
+LFused::~LFused(){
+    // Owned by the last layer of the chain
+    output = nullptr;
+    delta = nullptr;
+}
+
+
+bool LFused::get_op(Layer *l, Layer *in, FusedOp &op, Layer *&side){
+    side = nullptr;
+    op = FusedOp();
+
+    if (l->parent.size() == 2) {
+        // The running value must reach the layer through a single operand
+        if (l->parent[0] == l->parent[1]) return false;
+        if (l->parent[0] == in) side = l->parent[1];
+        else if (l->parent[1] == in) side = l->parent[0];
+        else return false;
+
+        op.right = (l->parent[1] == in);
+        if (side->output->shape != l->output->shape) return false;
+    } else if (l->parent.size() != 1 || l->parent[0] != in) {
+        return false;
+    }
+    if (in->output->shape != l->output->shape) return false;
+
+    if (auto *s = dynamic_cast<LSum *>(l)) {
+        if (s->binary) op.code = FUSED_ADD;
+        else { op.code = FUSED_ADD_SCALAR; op.val = s->val; }
+
+    } else if (auto *s = dynamic_cast<LDiff *>(l)) {
+        if (s->binary) op.code = FUSED_DIFF;
+        else if (s->left) { op.code = FUSED_ADD_SCALAR; op.val = -s->val; }
+        else { op.code = FUSED_RDIFF_SCALAR; op.val = s->val; }
+
+    } else if (auto *s = dynamic_cast<LMult *>(l)) {
+        if (s->binary) op.code = FUSED_MULT;
+        else { op.code = FUSED_MULT_SCALAR; op.val = s->val; }
+
+    } else if (auto *s = dynamic_cast<LDiv *>(l)) {
+        if (s->binary) op.code = FUSED_DIV;
+        else if (s->left) { op.code = FUSED_MULT_SCALAR; op.val = 1.0f / s->val; }
+        else { op.code = FUSED_RDIV_SCALAR; op.val = s->val; }
+
+    } else if (dynamic_cast<LExp *>(l)) op.code = FUSED_EXP;
+    else if (dynamic_cast<LLog *>(l)) op.code = FUSED_LOG;
+    else if (dynamic_cast<LLog2 *>(l)) op.code = FUSED_LOG2;
+    else if (dynamic_cast<LLog10 *>(l)) op.code = FUSED_LOG10;
+    else if (dynamic_cast<LSqrt *>(l)) op.code = FUSED_SQRT;
+    else if (dynamic_cast<LAbs *>(l)) op.code = FUSED_ABS;
+
+    else if (auto *a = dynamic_cast<LActivation *>(l)) {
+        // The output layers trained with soft_cross_entropy pass the delta through
+        if (a->delta_bp) return false;
+
+        if (a->act == "relu") op.code = FUSED_RELU;
+        else if (a->act == "thresholded_relu") { op.code = FUSED_THRESHOLDED_RELU; op.val = a->params[0]; }
+        else if (a->act == "leaky_relu") { op.code = FUSED_LEAKY_RELU; op.val = a->params[0]; }
+        else if (a->act == "elu") { op.code = FUSED_ELU; op.val = a->params[0]; }
+        else if (a->act == "linear") { op.code = FUSED_LINEAR; op.val = a->params[0]; }
+        else if (a->act == "exp") op.code = FUSED_EXP;
+        else if (a->act == "sigmoid") op.code = FUSED_SIGMOID;
+        else if (a->act == "hard_sigmoid") op.code = FUSED_HARD_SIGMOID;
+        else if (a->act == "tanh") op.code = FUSED_TANH;
+        else return false;  // Not elementwise (softmax), or with a backward of its own (selu, softplus, softsign)
+
+    } else {
+        return false;
+    }
+
+    if ((side != nullptr) != (op.code == FUSED_ADD || op.code == FUSED_DIFF || op.code == FUSED_MULT || op.code == FUSED_DIV)) {
+        return false;
+    }
+    return true;
+}
+
+
+void LFused::free_delta(){
+    layers.back()->free_delta();
+}
+
+void LFused::forward(){
+    vector<Tensor *> S;
+    for (auto l : sides) S.push_back(l->output);
+
+    tensorNN::fused_forward(ops, head->output, S, layers.back()->output);
+}
+
+void LFused::backward(){
+    vector<Tensor *> S, SD;
+    for (auto l : sides) {
+        S.push_back(l->output);
+        SD.push_back(l->delta);
+    }
+
+    Layer *last = layers.back();
+    tensorNN::fused_backward(ops, head->output, S, last->output, last->delta, head->delta, SD);
+}
@@ -166,24 +166,6 @@ void reduced_abs_sum(Tensor * input, Tensor *output)
 
 }
 
-// {nx1} --> {nxd}
-Tensor *replicate_tensor(Tensor *input,int d)
-{
-
-  Tensor *ones=new Tensor({1,d},input->device);
-  ones->fill_(1.0);
-
-  Tensor *output=new Tensor({input->shape[0],d},input->device);
-
-  // {nx1} x {1xd} --> {nxd}
-  Tensor::mult2D(input,0,ones,0,output,0);
-
-  delete ones;
-
-  return output;
-}
-
-
 // virtual
 void LLSTM::forward() {
   if (mask_zeros) {
@@ -192,14 +174,11 @@ void LLSTM::forward() {
 
     Tensor::logical_not(mask,mask);
     if (parent.size()>1) {
-      Tensor *A=replicate_tensor(mask,units);
-
       psh=parent[1]->states[0]->clone(); //prev state_h
       psc=parent[1]->states[1]->clone(); //prev state_c
 
-      Tensor::el_mult(A,psh,psh,0);
-      Tensor::el_mult(A,psc,psc,0);
-      delete A;
+      Tensor::el_mult(mask,psh,psh,0);
+      Tensor::el_mult(mask,psc,psc,0);
     }
 
   }
@@ -207,35 +186,27 @@ void LLSTM::forward() {
 
   // input=parent[0]->output
   in=new Tensor({input->shape[0], units}, dev);
+  fn=new Tensor({input->shape[0], units}, dev);
+  on=new Tensor({input->shape[0], units}, dev);
+  cn=new Tensor({input->shape[0], units}, dev);
 
-  Tensor::mult2D(parent[0]->output, 0, Wix, 0, in, 0);
+  // The four gates are independent products, batched in a single call
+  Tensor *x=parent[0]->output;
+  Tensor::mult2D_batched({x, x, x, x}, 0, {Wix, Wfx, Wox, Wcx}, 0, {in, fn, on, cn}, 0);
   if (parent.size()>1) {
-    Tensor::mult2D(parent[1]->states[0], 0, Wih, 0, in, 1);
+    Tensor *h=parent[1]->states[0];
+    Tensor::mult2D_batched({h, h, h, h}, 0, {Wih, Wfh, Woh, Wch}, 0, {in, fn, on, cn}, 1);
   }
+
   Tensor::sum2D_rowwise(in, inbias, in);
   tensorNN::Sigmoid(in, in);
 
-  fn=new Tensor({input->shape[0], units}, dev);
-  Tensor::mult2D(parent[0]->output, 0, Wfx, 0, fn, 0);
-  if (parent.size()>1) {
-    Tensor::mult2D(parent[1]->states[0], 0, Wfh, 0, fn, 1);
-  }
   Tensor::sum2D_rowwise(fn, fnbias, fn);
   tensorNN::Sigmoid(fn, fn);
 
-  on=new Tensor({input->shape[0], units}, dev);
-  Tensor::mult2D(parent[0]->output, 0, Wox, 0, on, 0);
-  if (parent.size()>1) {
-    Tensor::mult2D(parent[1]->states[0], 0, Woh, 0, on, 1);
-  }
   Tensor::sum2D_rowwise(on, onbias, on);
   tensorNN::Sigmoid(on, on);
 
-  cn=new Tensor({input->shape[0], units}, dev);
-  Tensor::mult2D(parent[0]->output, 0, Wcx, 0, cn, 0);
-  if (parent.size()>1) {
-    Tensor::mult2D(parent[1]->states[0], 0, Wch, 0, cn, 1);
-  }
   Tensor::sum2D_rowwise(cn, cnbias, cn);
   tensorNN::Tanh(cn,cn);
 
@@ -262,12 +233,8 @@ void LLSTM::forward() {
   if (mask_zeros) {
     Tensor::logical_not(mask,mask);
 
-    Tensor *A=replicate_tensor(mask,units);
-
-    Tensor::el_mult(A,state_h,state_h,0);
-    Tensor::el_mult(A,state_c,state_c,0);
-
-    delete A;
+    Tensor::el_mult(mask,state_h,state_h,0);
+    Tensor::el_mult(mask,state_c,state_c,0);
 
     if (parent.size()>1) {
       Tensor::inc(psh,state_h); //output=prev output when in=0
@@ -278,6 +245,16 @@ void LLSTM::forward() {
     }
   }
 
+  if (mode && storage != MP_FP32 && dev == DEV_CPU) {
+    // Kept for the backward in 16 bits
+    Tensor **kept[5] = {&in, &fn, &on, &cn, &sh};
+    for (int i = 0; i < 5; i++) {
+      pack(*kept[i], packed[i]);
+      delete *kept[i];
+      *kept[i] = nullptr;
+    }
+  }
+
   if (!mode) { // eval mode
     delete in;
     delete fn;
@@ -295,46 +272,38 @@ void LLSTM::forward() {
 void LLSTM::backward() {
   //delta_h=delta;
   //delta_c
+  if (in == nullptr) {
+    Tensor **kept[5] = {&in, &fn, &on, &cn, &sh};
+    for (int i = 0; i < 5; i++) *kept[i] = unpack(packed[i], {input->shape[0], units});
+  }
+
   if (mask_zeros) {
     if (parent.size()>1) {
       Tensor::logical_not(mask,mask);
 
-      Tensor *A=replicate_tensor(mask,units);
-
       psh=delta_h->clone();
       psc=delta_c->clone();
 
-      Tensor::el_mult(A,psh,psh,0);
-      Tensor::el_mult(A,psc,psc,0);
-
-      delete A;
-
+      Tensor::el_mult(mask,psh,psh,0);
+      Tensor::el_mult(mask,psc,psc,0);
     }
   }
 
   Tensor *d1=new Tensor(delta->getShape(),dev);
   Tensor *d2=new Tensor(delta->getShape(),dev);
-  Tensor *daux=new Tensor(delta->getShape(),dev);
+
+  // Deltas of the gate pre-activations
+  Tensor *don=new Tensor(delta->getShape(),dev);
+  Tensor *dfn=nullptr;
+  Tensor *din=new Tensor(delta->getShape(),dev);
+  Tensor *dcn=new Tensor(delta->getShape(),dev);
 
   Tensor::el_mult(delta,on,d1,0);
   Tensor::el_mult(delta,sh,d2,0);
 
   // output gate
-  daux->fill_(0.0);
-    tensorNN::D_Sigmoid(d2, on, daux);
-  Tensor::copy(daux,d2);
-
-  if (trainable) {
-    Tensor::mult2D(parent[0]->output, 1, d2, 0, gWox, 1);
-    if (parent.size()>1)
-      Tensor::mult2D(parent[1]->states[0], 1, d2, 0, gWoh, 1);
-    Tensor::reduce_sum2D(d2, gonbias, 0, 1);
-  }
-
-  Tensor::mult2D(d2, 0, Wox, 1, parent[0]->delta, 1);
-  if (parent.size()>1)
-    Tensor::mult2D(d2, 0, Woh, 1, parent[1]->delta_states[0], 1);
-
+  don->fill_(0.0);
+    tensorNN::D_Sigmoid(d2, on, don);
 
   d2->fill_(0.0);
     tensorNN::D_Tanh(d1, sh, d2);
@@ -345,64 +314,63 @@ void LLSTM::backward() {
     Tensor::el_mult(delta_c, fn, parent[1]->delta_states[1], 1);
     Tensor::el_mult(delta_c, parent[1]->states[1], d2, 0);
 
-    daux->fill_(0.0);
-      tensorNN::D_Sigmoid(d2, fn, daux);
-    Tensor::copy(daux,d2);
-
-    if (trainable) {
-      Tensor::mult2D(parent[0]->output, 1, d2, 0, gWfx, 1);
-      Tensor::mult2D(parent[1]->states[0], 1, d2, 0, gWfh, 1);
-      Tensor::reduce_sum2D(d2, gfnbias, 0, 1);
-    }
-    Tensor::mult2D(d2, 0, Wfx, 1, parent[0]->delta, 1);
-    Tensor::mult2D(d2, 0, Wfh, 1, parent[1]->delta_states[0], 1);
+    dfn=new Tensor(delta->getShape(),dev);
+    dfn->fill_(0.0);
+      tensorNN::D_Sigmoid(d2, fn, dfn);
   }
 
   Tensor::el_mult(delta_c, in, d1, 0);
   Tensor::el_mult(delta_c, cn, d2, 0);
 
   // Input gate
-  daux->fill_(0.0);
-    tensorNN::D_Sigmoid(d2, in, daux);
-  Tensor::copy(daux,d2);
+  din->fill_(0.0);
+    tensorNN::D_Sigmoid(d2, in, din);
 
+  // Cn
+  dcn->fill_(0.0);
+    tensorNN::D_Tanh(d1, cn, dcn);
+
+  // The forget gate only exists with a previous state
+  vector<Tensor*> dg={don, din, dcn};
+  vector<Tensor*> Wx={Wox, Wix, Wcx};
+  vector<Tensor*> Wh={Woh, Wih, Wch};
+  vector<Tensor*> gWx={gWox, gWix, gWcx};
+  vector<Tensor*> gWh={gWoh, gWih, gWch};
+  vector<Tensor*> gbias={gonbias, ginbias, gcnbias};
+  if (dfn!=nullptr) {
+    dg.push_back(dfn); Wx.push_back(Wfx); Wh.push_back(Wfh);
+    gWx.push_back(gWfx); gWh.push_back(gWfh); gbias.push_back(gfnbias);
+  }
+
+  Tensor *x=parent[0]->output;
   if (trainable) {
-    Tensor::mult2D(parent[0]->output, 1, d2, 0, gWix, 1);
+    Tensor::mult2D_batched(vector<Tensor*>(dg.size(), x), 1, dg, 0, gWx, 1);
     if (parent.size()>1)
-      Tensor::mult2D(parent[1]->states[0], 1, d2, 0, gWih, 1);
-    Tensor::reduce_sum2D(d2, ginbias, 0, 1);
+      Tensor::mult2D_batched(vector<Tensor*>(dg.size(), parent[1]->states[0]), 1, dg, 0, gWh, 1);
+    for(int i=0;i<dg.size();i++)
+      Tensor::reduce_sum2D(dg[i], gbias[i], 0, 1);
   }
 
-  Tensor::mult2D(d2, 0, Wix, 1, parent[0]->delta, 1);
-  if (parent.size()>1)
-    Tensor::mult2D(d2, 0, Wih, 1, parent[1]->delta_states[0], 1);
-
-  // Cn
-  daux->fill_(0.0);
-    tensorNN::D_Tanh(d1, cn, daux);
-  Tensor::copy(daux,d1);
-
-  if (trainable) {
-    Tensor::mult2D(parent[0]->output, 1, d1, 0, gWcx, 1);
+  // Every gate adds to the same parent deltas
+  for(int i=0;i<dg.size();i++) {
     if (parent.size()>1)
-      Tensor::mult2D(parent[1]->states[0], 1, d1, 0, gWch, 1);
-    Tensor::reduce_sum2D(d1, gcnbias, 0, 1);
+      Tensor::mult2D_batched({dg[i], dg[i]}, 0, {Wx[i], Wh[i]}, 1, {parent[0]->delta, parent[1]->delta_states[0]}, 1);
+    else
+      Tensor::mult2D(dg[i], 0, Wx[i], 1, parent[0]->delta, 1);
   }
 
-  Tensor::mult2D(d1, 0, Wcx, 1, parent[0]->delta, 1);
-  if (parent.size()>1)
-    Tensor::mult2D(d1, 0, Wch, 1, parent[1]->delta_states[0], 1);
+  delete don;
+  delete din;
+  delete dcn;
+  if (dfn!=nullptr) delete dfn;
 
 
   if (mask_zeros) {
     if (parent.size()>1) {
       Tensor::logical_not(mask,mask);
 
-      Tensor *A=replicate_tensor(mask,units);
-
-      Tensor::el_mult(A,parent[1]->delta_states[0],parent[1]->delta_states[0],0);
-      Tensor::el_mult(A,parent[1]->delta_states[1],parent[1]->delta_states[1],0);
-      delete A;
+      Tensor::el_mult(mask,parent[1]->delta_states[0],parent[1]->delta_states[0],0);
+      Tensor::el_mult(mask,parent[1]->delta_states[1],parent[1]->delta_states[1],0);
 
       Tensor::inc(psh,parent[1]->delta_states[0]);
       Tensor::inc(psc,parent[1]->delta_states[1]);
@@ -417,7 +385,6 @@ void LLSTM::backward() {
 
   delete d1;
   delete d2;
-  delete daux;
   delete in;
   delete fn;
   delete cn;
@@ -49,6 +49,7 @@ LRNN::LRNN(vector<Layer *> parent, int units, string activation, bool use_bias,
 
     gWy = new Tensor(vector<int>{units, units}, dev);
     gradients.push_back(gWy);
+    reg_params = 2;
 
 
     if (use_bias) {
@@ -114,21 +115,20 @@ void LRNN::backward() {
 
    delete daux;
 
+    // Input and recurrent products are independent, so each pair goes in a single batch
     if (trainable) {
-        Tensor::mult2D(parent[0]->output, 1, delta, 0, gWx, 1);
         if (parent.size()>1)
-            Tensor::mult2D(parent[1]->output, 1, delta, 0, gWy, 1);
+            Tensor::mult2D_batched({parent[0]->output, parent[1]->output}, 1, {delta, delta}, 0, {gWx, gWy}, 1);
+        else
+            Tensor::mult2D(parent[0]->output, 1, delta, 0, gWx, 1);
         if (use_bias) Tensor::reduce_sum2D(delta, gbias, 0, 1);
 
     }
 
-    Tensor::mult2D(delta, 0, Wx, 1, parent[0]->delta, 1);
     if (parent.size()>1)
-        Tensor::mult2D(delta, 0, Wy, 1, parent[1]->delta, 1);
-
-
-    // Regularizer
-    if (trainable) if(reg != nullptr) {reg->apply(this->Wx);reg->apply(this->Wy);}
+        Tensor::mult2D_batched({delta, delta}, 0, {Wx, Wy}, 1, {parent[0]->delta, parent[1]->delta}, 1);
+    else
+        Tensor::mult2D(delta, 0, Wx, 1, parent[0]->delta, 1);
 
 }
 
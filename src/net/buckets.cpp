@@ -0,0 +1,161 @@
+/*
+* EDDL Library - European Distributed Deep Learning Library.
+* Version: 0.7
+* copyright (c) 2020, Universidad Politécnica de Valencia (UPV), PRHLT Research Centre
+* Date: April 2020
+* Author: PRHLT Research Centre, UPV, (rparedes@prhlt.upv.es), (jon@prhlt.upv.es)
+* All rights reserved
+*/
+
+
+#include <string>
+#include <vector>
+
+#include "eddl/net/buckets.h"
+#include "eddl/net/net.h"
+#include "eddl/layers/normalization/layer_normalization.h"
+#include "eddl/utils.h"
+
+using namespace std;
+
+
+GradientBuckets::GradientBuckets(const vector<Net *> &replicas){
+    this->replicas = replicas;
+    reduced = arrived = 0;
+    generation = 0;
+    stop = false;
+
+    if (replicas.empty()) msg("No replicas", "GradientBuckets");
+    for (int j = 0; j < replicas[0]->layers.size(); j++) {
+        if (bucket_tensors(replicas[0]->layers[j]).empty()) continue;
+
+        int b = tensors.size();
+        tensors.push_back(vector<vtensor>());
+        for (int r = 0; r < replicas.size(); r++) {
+            if (replicas[r]->layers.size() != replicas[0]->layers.size())
+                msg("Replicas with different layers", "GradientBuckets");
+            Layer *l = replicas[r]->layers[j];
+            index[l] = b;
+            tensors[b].push_back(bucket_tensors(l));
+        }
+
+        sum.push_back(vtensor());
+        tmp.push_back(vtensor());
+        for (auto t : tensors[b][0]) {
+            sum[b].push_back(new Tensor(t->shape));
+            tmp[b].push_back(new Tensor(t->shape));
+        }
+    }
+    count.assign(tensors.size(), 0);
+
+    worker = thread(&GradientBuckets::run, this);
+}
+
+GradientBuckets::~GradientBuckets(){
+    {
+        unique_lock<mutex> lock(mtx);
+        stop = true;
+    }
+    cv.notify_all();
+    worker.join();
+
+    for (auto &ts : sum) for (auto t : ts) delete t;
+    for (auto &ts : tmp) for (auto t : ts) delete t;
+}
+
+// The gradients of the layer, and the params that are not trained but are state of the replica:
+// the running statistics of BatchNorm (the mean and variance of LayerNorm are per sample)
+vtensor GradientBuckets::bucket_tensors(Layer *l){
+    vtensor ts = l->gradients;
+    auto *bn = dynamic_cast<LBatchNorm *>(l);
+    if (bn != nullptr) {
+        ts.push_back(bn->mean);
+        ts.push_back(bn->variance);
+    }
+    return ts;
+}
+
+void GradientBuckets::ready(Layer *l){
+    auto it = index.find(l);
+    if (it == index.end()) return;  // Nothing to average
+
+    {
+        unique_lock<mutex> lock(mtx);
+        int b = it->second;
+        if (++count[b] != replicas.size()) return;
+        queue.push_back(b);
+    }
+    cv.notify_all();
+}
+
+void GradientBuckets::wait(){
+    unique_lock<mutex> lock(mtx);
+    unsigned long g = generation;
+
+    if (++arrived == replicas.size()) {
+        // Every backward is done: the layers without backward in this step are averaged as well
+        for (int b = 0; b < count.size(); b++) {
+            if (count[b] < replicas.size()) {
+                count[b] = replicas.size();
+                queue.push_back(b);
+            }
+        }
+        if (reduced == tensors.size()) finish();
+        cv.notify_all();
+    }
+
+    cv.wait(lock, [&] { return generation != g; });
+    if (!error.empty()) msg(error, "GradientBuckets");
+}
+
+// Next step (with the lock)
+void GradientBuckets::finish(){
+    count.assign(count.size(), 0);
+    reduced = arrived = 0;
+    generation++;
+}
+
+// Average of the replicas, weighted by their part of the batch
+void GradientBuckets::reduce(int b){
+    int total = 0;
+    for (auto n : replicas) total += n->batch_size;
+
+    for (int k = 0; k < sum[b].size(); k++) {
+        sum[b][k]->fill_(0.0f);
+        for (int r = 0; r < replicas.size(); r++) {
+            Tensor::copy(tensors[b][r][k], tmp[b][k]);
+            Tensor::add(1.0f, sum[b][k], (float)replicas[r]->batch_size / total, tmp[b][k], sum[b][k], 0);
+        }
+        for (int r = 0; r < replicas.size(); r++) Tensor::copy(sum[b][k], tensors[b][r][k]);
+    }
+}
+
+void GradientBuckets::run(){
+    while (true) {
+        int b;
+        bool failed;
+        {
+            unique_lock<mutex> lock(mtx);
+            cv.wait(lock, [this] { return stop || !queue.empty(); });
+            if (queue.empty()) return;
+            b = queue.front();
+            queue.pop_front();
+            failed = !error.empty();
+        }
+
+        if (!failed) {
+            try {
+                reduce(b);
+            } catch (std::exception &e) {
+                unique_lock<mutex> lock(mtx);
+                error = e.what();
+            }
+        }
+
+        {
+            unique_lock<mutex> lock(mtx);
+            if (++reduced == tensors.size() && arrived == replicas.size()) finish();
+        }
+        cv.notify_all();
+    }
+}
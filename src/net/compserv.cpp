@@ -9,20 +9,37 @@
 
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
 #include <string>
 #include <vector>
 #include <thread>
+#include <unistd.h>
+#include <sys/wait.h>
 
 #include <stdexcept>
 #include "eddl/net/compserv.h"
+#include "eddl/net/ring.h"
+
+extern char **environ;
 
 CompServ::CompServ()
 {
+    rank = 0;
+    world = 1;
+    timeout = 60;
+    isshared = false;
+    ring = nullptr;
+}
 
+CompServ::~CompServ()
+{
+    if (!isshared) delete ring;
 }
 
 // for local
-CompServ::CompServ(int t, const vector<int> g, const vector<int> &f,int lsb, int mem) {
+CompServ::CompServ(int t, const vector<int> g, const vector<int> &f,int lsb, int mem) : CompServ() {
     type = "local";
     isshared=false;
 
@@ -61,6 +78,12 @@ CompServ * CompServ::share() {
   n->lsb=lsb;
   n->isshared=true;
   n->mem_level=mem_level;
+  n->rank=rank;
+  n->world=world;
+  n->transport=transport;
+  n->addresses=addresses;
+  n->timeout=timeout;
+  n->ring=ring;
 
   return n;
 }
@@ -68,6 +91,102 @@ CompServ * CompServ::share() {
 
 
 // for Distributed
-CompServ::CompServ(string filename) {
-     //TODO: Implement
+// The setup file has one "key value" per line (# starts a comment):
+//   ranks 4                        number of processes
+//   transport unix                 unix (one host) or tcp
+//   address /tmp/eddl_ring         unix: prefix of the socket files (one per rank)
+//   hosts h0:5000 h1:5000 ...      tcp: host:port of each rank
+//   threads 2                      CPU threads of each process
+//   timeout 60                     seconds waiting for the other ranks
+//   spawn 1                        rank 0 runs the ranks of its host (all for unix, localhost for tcp)
+//   command prog args...           command of the spawned ranks (default: the same program and arguments)
+// The rank of a process is taken from the environment (EDDL_RANK), and is 0 if it is not set
+CompServ::CompServ(string filename) : CompServ() {
+    type = "distributed";
+    isshared = false;
+    local_threads = std::thread::hardware_concurrency();
+    local_gpus = {};
+    local_fpgas = {};
+    lsb = 1;
+    mem_level = 0;
+    transport = "unix";
+
+    std::ifstream ifs(filename);
+    if (!ifs.good()) throw std::runtime_error("Cannot open " + filename + " in CompServ::CompServ");
+
+    bool spawn = true;
+    string line;
+    while (std::getline(ifs, line)) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream iss(line);
+        string key, value;
+        if (!(iss >> key)) continue;
+
+        vector<string> values;
+        while (iss >> value) values.push_back(value);
+        if (values.empty()) throw std::runtime_error("Missing value of " + key + " in CompServ::CompServ");
+
+        if (key == "ranks") world = std::stoi(values[0]);
+        else if (key == "transport") transport = values[0];
+        else if (key == "address" || key == "hosts") addresses = values;
+        else if (key == "threads") local_threads = std::stoi(values[0]);
+        else if (key == "timeout") timeout = std::stoi(values[0]);
+        else if (key == "spawn") spawn = std::stoi(values[0]) != 0;
+        else if (key == "command") command = values;
+        else throw std::runtime_error("Unknown key " + key + " in CompServ::CompServ");
+    }
+
+    const char *env = getenv("EDDL_RANK");
+    if (env != nullptr) rank = std::stoi(env);
+    if (world < 1 || rank < 0 || rank >= world) throw std::runtime_error("Wrong rank or number of ranks in CompServ::CompServ");
+
+    // Same command line by default
+    if (command.empty()) {
+        std::ifstream cmdline("/proc/self/cmdline");
+        string arg;
+        while (std::getline(cmdline, arg, '\0')) command.push_back(arg);
+        if (command.empty()) throw std::runtime_error("Unknown command line in CompServ::CompServ");
+        command[0] = "/proc/self/exe";
+    }
+
+    if (rank == 0 && spawn) {
+        for (int r = 1; r < world; r++) {
+            if (transport == "tcp") {
+                string host = r < addresses.size() ? addresses[r].substr(0, addresses[r].rfind(':')) : "";
+                if (host != "localhost" && host != "127.0.0.1") continue;
+            }
+
+            // The arguments and environment are prepared before the fork
+            vector<char *> argv;
+            for (auto &a : command) argv.push_back(const_cast<char *>(a.c_str()));
+            argv.push_back(nullptr);
+
+            string rank_var = "EDDL_RANK=" + to_string(r);
+            vector<char *> envp;
+            for (char **e = environ; *e != nullptr; e++)
+                if (strncmp(*e, "EDDL_RANK=", 10) != 0) envp.push_back(*e);
+            envp.push_back(const_cast<char *>(rank_var.c_str()));
+            envp.push_back(nullptr);
+
+            pid_t pid = fork();
+            if (pid == 0) {
+                execve(argv[0], argv.data(), envp.data());
+                _exit(127);
+            }
+            if (pid < 0) throw std::runtime_error("Cannot spawn rank " + to_string(r) + " in CompServ::CompServ");
+            workers.push_back(pid);
+        }
+    }
+
+    ring = new Ring(rank, world, transport, addresses, timeout);
+}
+
+int CompServ::wait_workers() {
+    int failed = 0;
+    for (auto pid : workers) {
+        int status;
+        if (waitpid(pid, &status, 0) != pid || !WIFEXITED(status) || WEXITSTATUS(status) != 0) failed++;
+    }
+    workers.clear();
+    return failed;
 }
@@ -18,6 +18,7 @@
 #include <thread>
 #include "eddl/net/net.h"
 #include <pthread.h>
+#include <sys/mman.h>
 #include "eddl/utils.h"
 #include "eddl/random.h"
 
@@ -68,7 +69,29 @@ Net::Net() {
     batch_size=1;
     optimizer = nullptr;
     name="model";
+    tr_epochs=0;
     tr_batches=0;
+    inferenced_samples=0;
+    ckpt_pending=false;
+    mmap_ptr=nullptr;
+    mmap_size=0;
+    xchg_codec=XCHG_FP32;
+    xchg_ratio=0.01f;
+    xchg_round=0;
+    cs=nullptr;
+    ring=nullptr;
+    buckets=nullptr;
+    da_workers=2;
+    da_pending=false;
+    da_running=false;
+    da_slot=0;
+    profiler=nullptr;
+    micro_batches=1;
+    mp_storage=MP_FP32;
+    layout=LAYOUT_NCHW;
+    acc_first=true;
+    acc_last=true;
+    acc_scale=1.0f;
     flog_tr=nullptr;
     flog_ts=nullptr;
     rnet=nullptr;
@@ -159,6 +182,18 @@ Net::Net(vector <Net *> vnets):Net()
 
 Net::~Net()
 {
+    wait_checkpoint();
+    free_prefetch();
+
+    for (auto l : vfused) delete l;
+
+    // Shared with the computing services
+    if (profiler != nullptr) {
+        Profiler *p = profiler;  // snets[0] is this net on CPU
+        for (auto n : snets) n->profiler = nullptr;
+        delete p;
+    }
+
     for(int i=0;i<snets.size();i++){
 
         for(int j=0;j<snets[i]->layers.size();j++) {
@@ -183,6 +218,17 @@ Net::~Net()
 
     delete optimizer;
     optimizer= nullptr;
+
+    if (buckets != nullptr) {
+        for (auto n : snets) n->buckets = nullptr;
+        delete buckets;
+    }
+
+    for (auto t : xchg_residuals) delete t;
+    for (auto &ts : sync_stage) for (auto t : ts) delete t;
+
+    // Parameters are gone, the mapped weights can be released
+    if (mmap_ptr!=nullptr) munmap(mmap_ptr, mmap_size);
 }
 
 /////////////////////////////////////////
@@ -312,8 +358,41 @@ void Net::setlogfile(string fname)
     if (flog_ts==nullptr) msg("error creating ts log file","Net.setlogfile");
 }
 
+/////////////////////////////////////////
+void Net::set_micro_batches(int chunks)
+{
+    if (chunks < 1) msg("The number of micro-batches must be at least 1","Net.set_micro_batches");
+    if (isrecurrent && chunks > 1) msg("Gradient accumulation is not available for recurrent nets","Net.set_micro_batches");
+
+    micro_batches=chunks;
+}
+
+void Net::set_mixed_precision(const string& storage, float loss_scale, bool dynamic)
+{
+    int s=MP_FP32;
+    if (storage=="fp32") s=MP_FP32;
+    else if (storage=="bf16") s=MP_BF16;
+    else if (storage=="fp16") s=MP_FP16;
+    else msg("Unknown storage " + storage + " (fp32, bf16 or fp16)","Net.set_mixed_precision");
+    if (snets.empty()) msg("The net has to be built first","Net.set_mixed_precision");
+
+    mp_storage=s;
+    for (auto n : snets) {
+        n->mp_storage=s;
+        for (auto l : n->layers) l->set_storage(s);
+        n->optimizer->set_loss_scale(loss_scale, dynamic);
+    }
+    if (rnet!=nullptr) {
+        rnet->mp_storage=s;
+        for (auto l : rnet->layers) l->set_storage(s);
+    }
+}
+
 
 void Net::save(const string& filename, string format){
+    if (format=="mmap") { save_mmap(filename); return; }
+    if (format=="int8") { save_int8(filename); return; }
+
     // Open file stream
     std::ofstream ofs(filename, std::ios::out | std::ios::binary);
 
@@ -331,6 +410,10 @@ void Net::save(const string& filename, string format){
 }
 
 void Net::load(const string& filename, string format){
+    if (format=="int8") { load_int8(filename); return; }
+    drop_quantization();
+    if (format=="mmap") { load_mmap(filename); return; }
+
     // Open file stream
     std::ifstream ifs(filename, std::ios::in | std::ios::binary);
     if (!ifs.good()){
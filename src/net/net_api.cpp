@@ -40,13 +40,13 @@ void *train_batch_t(void *t) {
 
   Net *net = targs->net;
   net->do_reset();
-  net->do_reset_grads();
+  if (net->acc_first) net->do_reset_grads();
   net->do_forward();
   net->do_compute_loss();
 
   net->do_delta();
   net->do_backward();
-  net->do_applygrads();
+  if (net->acc_last) net->do_applygrads();
 
   return nullptr;
 }
@@ -623,7 +623,7 @@ void Net::update()
 
     }
 
-    if ((snets[0]->dev != DEV_CPU) && (comp > 1) && (tr_batches%cs->lsb==1)) {
+    if ((buckets == nullptr) && (snets[0]->dev != DEV_CPU) && (comp > 1) && (tr_batches%cs->lsb==1)) {
       sync_weights();
     }
   }
@@ -677,12 +677,12 @@ void Net::fit(vtensor tin, vtensor tout, int batch, int epochs) {
     msg("different number of samples in output tensor", "Net.fit");
 
 
-    // Set batch size
-    resize(batch);
+    // Set batch size (with gradient accumulation, train_batch resizes the net to the chunks)
+    if (micro_batches <= 1) resize(batch);
 
     // Create array to store batch indices (later random)
     vind sind;
-    for (i = 0; i < batch_size; i++)
+    for (i = 0; i < batch; i++)
     sind.push_back(0);
 
 
@@ -690,26 +690,50 @@ void Net::fit(vtensor tin, vtensor tout, int batch, int epochs) {
     setmode(TRMODE);
 
     // Set some parameters
-    int num_batches = n / batch_size;
+    int num_batches = n / batch;
+
+    // With input augmentation, batch j+1 is selected and augmented in the background while
+    // batch j is trained. The prefetched batches are already in order
+    bool prefetch = !da_specs.empty();
+    vind pind;
+    for (i = 0; i < batch; i++)
+    pind.push_back(i);
 
     // Train network
-    fprintf(stdout, "%d epochs of %d batches of size %d\n", epochs, num_batches, batch_size);
+    fprintf(stdout, "%d epochs of %d batches of size %d\n", epochs, num_batches, batch);
     for (i = 0; i < epochs; i++) {
       high_resolution_clock::time_point e1 = high_resolution_clock::now();
       fprintf(stdout, "Epoch %d\n", i + 1);
 
       reset_loss();
 
+      if (prefetch && num_batches > 0) {
+        for (k = 0; k < batch; k++) sind[k] = rng() % n;
+        prefetch_batch(tin, tout, sind, 0);
+      }
+
       // For each batch
       for (j = 0; j < num_batches; j++) {
 
-        // Set random indices
-        for (k = 0; k < batch_size; k++) sind[k] = rand() % n;
-
         // Train batch
         tr_batches++;
 
-        train_batch(tin, tout, sind);
+        if (prefetch) {
+          wait_prefetch();
+          int slot = j % 2;
+
+          if (j + 1 < num_batches) {
+            for (k = 0; k < batch; k++) sind[k] = rng() % n;
+            prefetch_batch(tin, tout, sind, 1 - slot);
+          }
+
+          train_batch(da_X[slot], da_Y[slot], pind);
+        } else {
+          // Set random indices
+          for (k = 0; k < batch; k++) sind[k] = rng() % n;
+
+          train_batch(tin, tout, sind);
+        }
 
         print_loss(j+1);
 
@@ -723,6 +747,7 @@ void Net::fit(vtensor tin, vtensor tout, int batch, int epochs) {
       high_resolution_clock::time_point e2 = high_resolution_clock::now();
       duration<double> epoch_time_span = e2 - e1;
       fprintf(stdout, "\n%1.3f secs/epoch\n", epoch_time_span.count());
+      tr_epochs++;
     }
     fflush(stdout);
   }
@@ -747,54 +772,62 @@ void Net::prepare_recurrent(vtensor tin, vtensor tout, int &inl, int &outl, vten
 
   inl=outl=1;
 
+  // On CPU the time steps are strided views of the (batch x time x dim) tensors, so no
+  // permuted copies are needed. Other devices still unroll from a (time x batch x dim) copy
+  for(i=0;i<tin.size();i++)
+    if (tin[i]->is_compact()) msg("Compact datasets are not supported by recurrent nets","fit_recurrent");
+  for(i=0;i<tout.size();i++)
+    if (tout[i]->is_compact()) msg("Compact datasets are not supported by recurrent nets","fit_recurrent");
+
   if (tin.size()) {
     if (isencoder) {
-      for(i=0;i<tin.size();i++)
-        xt.push_back(Tensor::permute(tin[i],{1,0,2})); // time x batch x dim
-
-      inl=xt[0]->shape[0];
-      for(i=0;i<xt.size();i++) {
-        if (xt[i]->shape[0]!=inl)
+      inl=tin[0]->shape[1];
+      for(i=0;i<tin.size();i++) {
+        if (tin[i]->shape[1]!=inl)
           msg("Input tensors with different time steps","fit_recurrent");
       }
+      for(i=0;i<tin.size();i++)
+        if (!tin[i]->isCPU())
+          xt.push_back(Tensor::permute(tin[i],{1,0,2})); // time x batch x dim
     }
   }
 
   if (tout.size()) {
     if (isdecoder) {
-      for(i=0;i<tout.size();i++)
-      yt.push_back(Tensor::permute(tout[i],{1,0,2})); // time x batch x dim
-      outl=yt[0]->shape[0];
-      for(i=0;i<yt.size();i++) {
-        if (yt[i]->shape[0]!=outl)
+      outl=tout[0]->shape[1];
+      for(i=0;i<tout.size();i++) {
+        if (tout[i]->shape[1]!=outl)
         msg("Output tensors with different time steps","fit_recurrent");
       }
+      for(i=0;i<tout.size();i++)
+        if (!tout[i]->isCPU())
+          yt.push_back(Tensor::permute(tout[i],{1,0,2})); // time x batch x dim
     }
   }
   // prepare data for unroll net
   if (isencoder) {
-    int offset;
-    for(i=0;i<xt.size();i++) {
-      offset=xt[i]->size/xt[i]->shape[0];
-      vector<int>shape;
-      for(j=1;j<xt[i]->ndim;j++)
-        shape.push_back(xt[i]->shape[j]);
-      for(j=0;j<inl;j++)
-        tinr.push_back(new Tensor(shape,xt[i]->ptr+(j*offset),xt[i]->device));
+    if (xt.size()) {
+      for(i=0;i<xt.size();i++)
+        for(j=0;j<inl;j++)
+          tinr.push_back(Tensor::select_view(xt[i],0,j));
+    }
+    else {
+      for(i=0;i<tin.size();i++)
+        for(j=0;j<inl;j++)
+          tinr.push_back(Tensor::select_view(tin[i],1,j));
     }
   }
 
-  if (isdecoder) {
-    int offset;
-    for(i=0;i<yt.size();i++) {
-      offset=yt[i]->size/yt[i]->shape[0];
-      vector<int>shape;
-      for(j=1;j<yt[i]->ndim;j++)
-        shape.push_back(yt[i]->shape[j]);
-
-      if (tout.size())
+  if ((isdecoder)&&(tout.size())) {
+    if (yt.size()) {
+      for(i=0;i<yt.size();i++)
         for(j=0;j<outl;j++)
-          toutr.push_back(new Tensor(shape,yt[i]->ptr+(j*offset),yt[i]->device));
+          toutr.push_back(Tensor::select_view(yt[i],0,j));
+    }
+    else {
+      for(i=0;i<tout.size();i++)
+        for(j=0;j<outl;j++)
+          toutr.push_back(Tensor::select_view(tout[i],1,j));
     }
   }
 }
@@ -816,12 +849,15 @@ void Net::fit_recurrent(vtensor tin, vtensor tout, int batch, int epochs) {
 
   build_rnet(inl,outl);
 
+  // The batches are drawn from the generator of this net (the one saved in checkpoints)
+  rnet->rng = rng;
   if ((isencoder)&&(isdecoder))
     rnet->fit(tinr,toutr,batch,epochs);
   else if (isencoder)
     rnet->fit(tinr,tout,batch,epochs);
   else if (isdecoder)
     rnet->fit(tin,toutr,batch,epochs);
+  rng = rnet->rng;
 
   if (snets[0]->dev!=DEV_CPU) rnet->sync_weights();
 
@@ -840,6 +876,43 @@ void Net::fit_recurrent(vtensor tin, vtensor tout, int batch, int epochs) {
 // TODO:  train_batch_recurrent
 /////////////////////////////////////////
 void Net::train_batch(vtensor X, vtensor Y, vind sind, int eval) {
+  int total = sind.size();
+  int chunks = std::min(micro_batches, total);
+
+  if (eval || isrecurrent || chunks <= 1) {
+    train_step(X, Y, sind, eval);
+    return;
+  }
+
+  // Gradient accumulation: the net is resized to the chunks (sizes differ at most by one), so
+  // the activations only take the memory of a chunk. The deltas are scaled by the size of each
+  // chunk, so that the accumulated gradients are those of the whole batch.
+  // Chunks of the same size go together, starting with the size the net already has, so
+  // train_step resizes at most once per batch (and never when the chunks are even)
+  int q = total / chunks, r = total % chunks;
+  bool small_first = (r > 0) && (batch_size == q);
+  int start = 0;
+  for (int c = 0; c < chunks; c++) {
+    int size = small_first ? q + (c >= chunks - r) : q + (c < r);
+    int end = start + size;
+    vind cind(sind.begin() + start, sind.begin() + end);
+
+    for (auto n : snets) {
+      n->acc_first = (c == 0);
+      n->acc_last = (c == chunks - 1);
+      n->acc_scale = (float)(end - start) / total;
+    }
+    train_step(X, Y, cind, 0);
+    start = end;
+  }
+
+  for (auto n : snets) {
+    n->acc_first = n->acc_last = true;
+    n->acc_scale = 1.0f;
+  }
+}
+
+void Net::train_step(vtensor X, vtensor Y, vind sind, int eval) {
 
   if (batch_size!=sind.size()) resize(sind.size());
 
@@ -855,7 +928,7 @@ void Net::train_batch(vtensor X, vtensor Y, vind sind, int eval) {
   else setmode(TRMODE);
 
   // Check indices
-  if (sind.size() == 0) msg("error void index","Net::train_batch");
+  if (sind.size() == 0) msg("error void index","Net::train_step");
   // Split data for each network
   for (int i = 0; i < comp; i++) {
     int start = i * thread_batch_size;
@@ -899,9 +972,9 @@ void Net::train_batch(vtensor X, vtensor Y, vind sind, int eval) {
          snets[i]->lout[j-1]->detach(snets[i]->din[j]);
 
   // If training (eval==0), apply gradients
-  if (!eval) {
-    // In case of multiple GPUS or FPGA synchronize params
-    if ((snets[0]->dev != DEV_CPU) && (comp > 1) && (tr_batches%cs->lsb==0)) {
+  if (!eval && acc_last) {
+    // In case of multiple GPUS or FPGA synchronize params (unless the gradients were averaged)
+    if ((buckets == nullptr) && (snets[0]->dev != DEV_CPU) && (comp > 1) && (tr_batches%cs->lsb==0)) {
       sync_weights();
     }
   }
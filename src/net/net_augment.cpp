@@ -0,0 +1,180 @@
+/*
+* EDDL Library - European Distributed Deep Learning Library.
+* Version: 0.7
+* copyright (c) 2020, Universidad Politécnica de Valencia (UPV), PRHLT Research Centre
+* Date: April 2020
+* Author: PRHLT Research Centre, UPV, (rparedes@prhlt.upv.es), (jon@prhlt.upv.es)
+* All rights reserved
+*/
+
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#include "eddl/net/net.h"
+#include "eddl/utils.h"
+
+using namespace std;
+
+
+// Selects the samples of the next batch and augments them, while the training thread runs the
+// current batch. Only the host copies are touched here
+static void da_prefetch(Net *net){
+    int slot = net->da_slot;
+    int bs = net->da_sind.size();
+
+#ifdef _OPENMP
+    // The threads of this pipeline do not compete with the ones of the computing service
+    omp_set_num_threads(net->da_workers);
+#endif
+
+    for (int j = 0; j < net->da_src_X.size(); j++) {
+        int k = 0;
+        while (k < net->da_inputs.size() && net->da_inputs[k] != j) k++;
+
+        if (k == net->da_inputs.size()) {
+            Tensor::select(net->da_src_X[j], net->da_X[slot][j], net->da_sind, 0, bs);
+        } else {
+            AffineDescriptor &spec = net->da_specs[k];
+            Tensor::select(net->da_src_X[j], net->da_raw[k], net->da_sind, 0, bs);
+            Tensor::affine(net->da_raw[k], net->da_X[slot][j], net->da_matrices[k], spec.bilinear, spec.da_mode, spec.cval);
+        }
+    }
+
+    for (int j = 0; j < net->da_src_Y.size(); j++) {
+        Tensor::select(net->da_src_Y[j], net->da_Y[slot][j], net->da_sind, 0, bs);
+    }
+}
+
+// Persistent worker: fills a batch each time prefetch_batch requests one. The errors are kept
+// for wait_prefetch, since an exception can not leave the thread
+static void da_worker_t(Net *net){
+    std::unique_lock<std::mutex> lock(net->da_mtx);
+    while (true) {
+        net->da_cv.wait(lock, [net]{ return net->da_pending || !net->da_running; });
+        if (!net->da_running) return;
+        lock.unlock();
+
+        std::exception_ptr error = nullptr;
+        try {
+            da_prefetch(net);
+        } catch (...) {
+            error = std::current_exception();
+        }
+
+        lock.lock();
+        net->da_error = error;
+        net->da_pending = false;
+        net->da_cv.notify_all();
+    }
+}
+
+// Batch buffers with the shape of the samples of "data"
+static void da_resize(vtensor &buffers, const vtensor &data, int batch){
+    for (int j = 0; j < data.size(); j++) {
+        vector<int> shape = data[j]->shape;
+        shape[0] = batch;
+        if (j < buffers.size() && buffers[j]->shape == shape) continue;
+
+        if (j < buffers.size()) {
+            delete buffers[j];
+            buffers[j] = new Tensor(shape, DEV_CPU);
+        } else {
+            buffers.push_back(new Tensor(shape, DEV_CPU));
+        }
+    }
+}
+
+
+void Net::set_augmentation(const AffineDescriptor &spec, int input, int workers){
+    if (input < 0 || input >= lin.size()) msg("Invalid input (" + to_string(input) + ")", "Net::set_augmentation");
+    if (lin[input]->output->ndim != 4) msg("The augmentation requires 4D inputs (NCHW)", "Net::set_augmentation");
+    if (workers < 1) msg("At least one worker is needed", "Net::set_augmentation");
+
+    wait_prefetch();
+    da_workers = workers;
+
+    for (int k = 0; k < da_inputs.size(); k++) {
+        if (da_inputs[k] == input) {
+            da_specs[k] = spec;
+            return;
+        }
+    }
+    da_specs.push_back(spec);
+    da_inputs.push_back(input);
+}
+
+
+void Net::prefetch_batch(vtensor X, vtensor Y, vind sind, int slot){
+    wait_prefetch();
+
+    int bs = sind.size();
+    da_resize(da_X[slot], X, bs);
+    da_resize(da_Y[slot], Y, bs);
+
+    // The random parameters are drawn by the training thread (the generators are not thread-safe)
+    vtensor raw_src;
+    da_matrices.resize(da_inputs.size());
+    for (int k = 0; k < da_inputs.size(); k++) {
+        Tensor *x = X[da_inputs[k]];
+        if (x->ndim != 4) msg("The augmentation requires 4D inputs (NCHW)", "Net::prefetch_batch");
+        da_matrices[k] = da_specs[k].sample_batch(bs, x->shape[2], x->shape[3]);
+        raw_src.push_back(x);
+    }
+    da_resize(da_raw, raw_src, bs);
+
+    da_src_X = X;
+    da_src_Y = Y;
+    da_sind = sind;
+    da_slot = slot;
+
+    if (!da_running) {
+        da_running = true;
+        da_thread = std::thread(da_worker_t, this);
+    }
+    {
+        std::lock_guard<std::mutex> lock(da_mtx);
+        da_pending = true;
+    }
+    da_cv.notify_all();
+}
+
+
+void Net::wait_prefetch(){
+    std::exception_ptr error;
+    {
+        std::unique_lock<std::mutex> lock(da_mtx);
+        da_cv.wait(lock, [this]{ return !da_pending; });
+        error = da_error;
+        da_error = nullptr;
+    }
+    if (error) std::rethrow_exception(error);
+}
+
+
+void Net::free_prefetch(){
+    // The pending error (if any) is dropped: this also runs in the destructor
+    {
+        std::unique_lock<std::mutex> lock(da_mtx);
+        da_cv.wait(lock, [this]{ return !da_pending; });
+        da_error = nullptr;
+        da_running = false;
+    }
+    da_cv.notify_all();
+    if (da_thread.joinable()) da_thread.join();
+
+    for (int s = 0; s < 2; s++) {
+        for (auto t : da_X[s]) delete t;
+        for (auto t : da_Y[s]) delete t;
+        da_X[s].clear();
+        da_Y[s].clear();
+    }
+    for (auto t : da_raw) delete t;
+    da_raw.clear();
+}
@@ -193,6 +193,7 @@ void Net::build(Optimizer *opt, vloss lo, vmetrics me, CompServ *cs, bool initia
 
   build(opt, lo, me, initialize);
 
+  rng.seed(rand());
   set_compserv(cs);
 
   if (VERBOSE) {
@@ -205,6 +206,7 @@ void Net::build(Optimizer *opt, vloss lo, vmetrics me, CompServ *cs, bool initia
         cout << "Net running on FPGA " << snets[0]->dev - DEV_FPGA << "\n";
     }
   }
+  propagate_layout();
   isbuild=true;
 
 }
@@ -325,6 +327,13 @@ void Net::set_compserv(CompServ *cs){
 
         if (!cs->isshared) {
             split(devsel.size(),DEV_GPU);
+
+            // The replicas start with the same weights, and apply the same averaged gradients
+            if (snets.size() > 1) {
+                sync_weights();
+                buckets = new GradientBuckets(snets);
+                for (auto n : snets) n->buckets = buckets;
+            }
         }
 
 
@@ -332,10 +341,33 @@ void Net::set_compserv(CompServ *cs){
         } else {
             // split on multiple FPGAs
         }
+    } else if (cs->type == "distributed") {
+        // One process per rank on CPU. The gradients are averaged around the ring (see do_backward)
+        if (dev != DEV_CPU) msg("Net and Layers device missmatch", "Net.set_compserv");
+
+        Eigen::initParallel();
+        Eigen::setNbThreads(cs->local_threads);
+        snets.push_back(this);
+        ring = cs->ring;
+
+        // Same initial weights on every rank, and different batches (fit draws them with the generator
+        // of the net, so the global one stays the same on every rank)
+        if (!cs->isshared) {
+            for (auto l : layers)
+                for (auto p : l->params) ring->broadcast(p->ptr, p->size, 0);
+            std::seed_seq seq{(unsigned)rng(), (unsigned)cs->rank};
+            rng.seed(seq);
+        }
     } else {
-        msg("Distributed version not yet implemented", "Net.set_compserv");
+        msg("Unknown computing service " + cs->type, "Net.set_compserv");
     }
 
+    // fuse the elementwise chains of the nets that will run
+    for (int i = 0; i < snets.size(); i++) snets[i]->fuse();
+
+    // the computing services record into the profiler of the net (if any)
+    for (int i = 0; i < snets.size(); i++) snets[i]->profiler = profiler;
+
     // create input and output tensors (X,Y)
     for (int i = 0; i < snets.size(); i++) {
       for (int j = 0; j < snets[i]->lin.size(); j++)
@@ -449,6 +481,8 @@ void Net::resize(int b)
   }
 
   for(i=0; i<c; i++) {
+    for (auto t : Xs[i]) delete t;
+    for (auto t : Ys[i]) delete t;
     Xs[i].clear();
     Ys[i].clear();
 
@@ -456,6 +490,8 @@ void Net::resize(int b)
     snets[i]->batch_size=bs;
     for (j = 0; j < snets[i]->layers.size(); j++) {
         snets[i]->layers[j]->resize(bs);
+        // The deltas are reserved again, with the new batch, by the next backward
+        if (snets[i]->layers[j]->delta != nullptr) snets[i]->layers[j]->free_delta();
       }
 
     for (j = 0; j < snets[i]->lin.size(); j++)
@@ -0,0 +1,222 @@
+/*
+* EDDL Library - European Distributed Deep Learning Library.
+* Version: 0.7
+* copyright (c) 2020, Universidad Politécnica de Valencia (UPV), PRHLT Research Centre
+* Date: April 2020
+* Author: PRHLT Research Centre, UPV, (rparedes@prhlt.upv.es), (jon@prhlt.upv.es)
+* All rights reserved
+*/
+
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <sstream>
+#include <pthread.h>
+
+#include "eddl/net/net.h"
+#include "eddl/utils.h"
+#include "eddl/random.h"
+
+using namespace std;
+
+// Checkpoint layout (all fields are little-endian, tensors are row-major float32):
+//   magic "EDDLCKPT", int version
+//   int tr_epochs, int tr_batches
+//   int rng_len, char rng[rng_len] (padded to 4 bytes)  (generators of the library and of fit)
+//   int n_counters, int counters[n_counters]          (optimizer step counters)
+//   int n_tensors, n_tensors x {int ndim, int shape[ndim], float data[size]}
+//                                                      (params of all layers, then optimizer state)
+#define CKPT_MAGIC "EDDLCKPT"
+#define CKPT_VERSION 1
+
+
+static void ckpt_write(vector<char> &buffer, const void *data, size_t n){
+    const char *p = reinterpret_cast<const char *>(data);
+    buffer.insert(buffer.end(), p, p + n);
+}
+
+static void ckpt_write_int(vector<char> &buffer, int v){
+    ckpt_write(buffer, &v, sizeof(int));
+}
+
+// Copies the tensor (from any device) into the staging buffer
+static void ckpt_write_tensor(vector<char> &buffer, Tensor *t){
+    ckpt_write_int(buffer, t->ndim);
+    ckpt_write(buffer, t->shape.data(), t->ndim * sizeof(int));
+
+    size_t offset = buffer.size();
+    buffer.resize(offset + t->size * sizeof(float));
+    auto *dst = reinterpret_cast<float *>(&buffer[offset]);
+
+    if (t->isCPU() && t->is_contiguous()) {
+        memcpy(dst, t->ptr, t->size * sizeof(float));
+    } else {
+        // Wrap the staging memory so that devices copy straight into it
+        auto *tmp = new Tensor(t->shape, dst, DEV_CPU);
+        Tensor::copy(t, tmp);
+        tmp->ptr = nullptr;
+        delete tmp;
+    }
+}
+
+static int ckpt_read_int(std::ifstream &ifs){
+    int v;
+    ifs.read(reinterpret_cast<char *>(&v), sizeof(int));
+    return v;
+}
+
+static vtensor ckpt_optimizer_state(Net *net){
+    if (net->optimizer == nullptr) return vtensor();
+    return net->optimizer->get_state();
+}
+
+static void *ckpt_writer_t(void *t){
+    auto *net = (Net *)t;
+
+    // Write to a temporary file first so that an interrupted write never corrupts the previous checkpoint
+    string tmp_name = net->ckpt_filename + ".tmp";
+    std::ofstream ofs(tmp_name, std::ios::out | std::ios::binary);
+    if (ofs.good()) {
+        ofs.write(net->ckpt_buffer.data(), net->ckpt_buffer.size());
+        ofs.close();
+        if (rename(tmp_name.c_str(), net->ckpt_filename.c_str()) != 0) {
+            fprintf(stderr, "Error renaming checkpoint %s\n", tmp_name.c_str());
+        }
+    } else {
+        fprintf(stderr, "Error creating checkpoint %s\n", tmp_name.c_str());
+    }
+
+    // Release the staging memory
+    vector<char>().swap(net->ckpt_buffer);
+    return nullptr;
+}
+
+
+void Net::save_checkpoint(const string& filename, bool async){
+    if (!isbuild) msg("Net is not build", "Net::save_checkpoint");
+
+    // Only one checkpoint in flight
+    wait_checkpoint();
+
+    // Snapshot into the staging buffer. The weights and the optimizer state are read from the
+    // first computing service, so no synchronisation between devices is needed
+    vector<char> &buffer = ckpt_buffer;
+    buffer.clear();
+
+    ckpt_write(buffer, CKPT_MAGIC, 8);
+    ckpt_write_int(buffer, CKPT_VERSION);
+    ckpt_write_int(buffer, tr_epochs);
+    ckpt_write_int(buffer, tr_batches);
+
+    std::ostringstream oss;
+    oss << get_rng_state() << "\n" << this->rng;
+    string rng = oss.str();
+    ckpt_write_int(buffer, rng.size());
+    ckpt_write(buffer, rng.data(), rng.size());
+    buffer.resize((buffer.size() + 3) & ~(size_t)3, 0);
+
+    vector<int> counters;
+    if (snets[0]->optimizer != nullptr) counters = snets[0]->optimizer->get_counters();
+    ckpt_write_int(buffer, counters.size());
+    ckpt_write(buffer, counters.data(), counters.size() * sizeof(int));
+
+    vtensor state = ckpt_optimizer_state(snets[0]);
+    int n_params = 0;
+    for (auto l : snets[0]->layers) n_params += l->params.size();
+    ckpt_write_int(buffer, n_params + state.size());
+
+    for (auto l : snets[0]->layers)
+        for (auto p : l->params) ckpt_write_tensor(buffer, p);
+    for (auto t : state) ckpt_write_tensor(buffer, t);
+
+    ckpt_filename = filename;
+    if (async) {
+        if (pthread_create(&ckpt_thread, nullptr, ckpt_writer_t, (void *)this) != 0) {
+            msg("Error creating checkpoint thread", "Net::save_checkpoint");
+        }
+        ckpt_pending = true;
+    } else {
+        ckpt_writer_t((void *)this);
+    }
+}
+
+
+void Net::wait_checkpoint(){
+    if (ckpt_pending) {
+        pthread_join(ckpt_thread, nullptr);
+        ckpt_pending = false;
+    }
+}
+
+
+void Net::load_checkpoint(const string& filename){
+    if (!isbuild) msg("Net is not build", "Net::load_checkpoint");
+
+    // The file could be the one being written
+    wait_checkpoint();
+
+    std::ifstream ifs(filename, std::ios::in | std::ios::binary);
+    if (!ifs.good()){
+        throw std::runtime_error(std::string("File not found. Check the file name and try again (Net::load_checkpoint)"));
+    }
+
+    char magic[8];
+    ifs.read(magic, 8);
+    if (strncmp(magic, CKPT_MAGIC, 8) != 0) msg("Not a checkpoint file", "Net::load_checkpoint");
+    int version = ckpt_read_int(ifs);
+    if (version != CKPT_VERSION) msg("Unsupported checkpoint version (" + to_string(version) + ")", "Net::load_checkpoint");
+
+    tr_epochs = ckpt_read_int(ifs);
+    tr_batches = ckpt_read_int(ifs);
+
+    int rng_len = ckpt_read_int(ifs);
+    string rng(rng_len, '\0');
+    ifs.read(&rng[0], rng_len);
+    ifs.seekg((4 - rng_len % 4) % 4, std::ios::cur);
+    size_t sep = rng.find('\n');
+    if (sep == string::npos) msg("Invalid random state", "Net::load_checkpoint");
+    set_rng_state(rng.substr(0, sep));
+    std::istringstream iss(rng.substr(sep + 1));
+    iss >> this->rng;
+    if (iss.fail()) msg("Invalid random state", "Net::load_checkpoint");
+
+    int n_counters = ckpt_read_int(ifs);
+    vector<int> counters(n_counters);
+    ifs.read(reinterpret_cast<char *>(counters.data()), n_counters * sizeof(int));
+
+    // Params are read in place and then distributed to the devices
+    vtensor targets;
+    for (auto l : layers)
+        for (auto p : l->params) targets.push_back(p);
+
+    vtensor state = ckpt_optimizer_state(snets[0]);
+    for (auto t : state) targets.push_back(t);
+
+    int n_tensors = ckpt_read_int(ifs);
+    if (n_tensors != targets.size()) msg("The checkpoint does not match the network or its optimizer", "Net::load_checkpoint");
+
+    for (auto t : targets) t->loadfs_(ifs, "bin");
+    if (!ifs.good()) msg("Truncated checkpoint", "Net::load_checkpoint");
+    ifs.close();
+    drop_quantization();
+
+    if (snets[0]->dev != DEV_CPU) {
+        for (int i = 0; i < snets.size(); i++)
+            for (int j = 0; j < layers.size(); j++)
+                layers[j]->copy(snets[i]->layers[j]);
+    }
+
+    // Every computing service resumes from the same optimizer state
+    for (int i = 0; i < snets.size(); i++) {
+        if (snets[i]->optimizer == nullptr) continue;
+        snets[i]->optimizer->set_counters(counters);
+        if (i == 0) continue;
+
+        vtensor si = ckpt_optimizer_state(snets[i]);
+        for (int k = 0; k < si.size(); k++) Tensor::copy(state[k], si[k]);
+    }
+}
@@ -0,0 +1,385 @@
+/*
+* EDDL Library - European Distributed Deep Learning Library.
+* Version: 0.7
+* copyright (c) 2020, Universidad Politécnica de Valencia (UPV), PRHLT Research Centre
+* Date: April 2020
+* Author: PRHLT Research Centre, UPV, (rparedes@prhlt.upv.es), (jon@prhlt.upv.es)
+* All rights reserved
+*/
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <numeric>
+#include <string>
+
+#include "eddl/net/net.h"
+#include "eddl/hardware/cpu/cpu_tensor.h"
+#include "eddl/utils.h"
+
+using namespace std;
+
+// Exchange layout of the weights or accumulated gradients (distributed training):
+//   header   {char magic[8] "EDDLXCHG", int32 version, int32 gradients, int32 n_records, int32 codec, int64 size}
+//   records  n_records x {int32 layer, int32 index, int32 size, int32 bytes} followed by the encoded values,
+//            padded to a multiple of XCHG_ALIGN bytes
+// The header and the records are written field by field in little-endian, so the layout does not depend
+// on the padding of the structs or the size of long. The values are in the byte order of the host
+// (little-endian on the supported platforms).
+// The layer is the position in Net::layers and the index the position in its params (or acc_gradients).
+// The values are encoded with the codec of the header (the weights are always XCHG_FP32):
+//   XCHG_FP32        size float32
+//   XCHG_FP16/BF16   size uint16
+//   XCHG_INT8        float32 scale, size int8 (value = q * scale)
+//   XCHG_TOPK        int32 k, k int32 positions, k float32 values (the rest are 0)
+#define XCHG_MAGIC "EDDLXCHG"
+#define XCHG_VERSION 2
+#define XCHG_ALIGN 16
+#define XCHG_HEADER_BYTES 32
+#define XCHG_RECORD_BYTES 16
+
+struct XchgHeader {
+    char magic[8];
+    int32_t version;
+    int32_t gradients;
+    int32_t n_records;
+    int32_t codec;
+    int64_t size;
+};
+
+struct XchgRecord {
+    int32_t layer;
+    int32_t index;
+    int32_t size;
+    int32_t bytes;
+};
+
+static void xchg_put(char *&p, uint64_t v, int bytes){
+    for (int i = 0; i < bytes; i++) *p++ = (char)(v >> (8 * i));
+}
+
+static int64_t xchg_get(const char *&p, int bytes){
+    uint64_t v = 0;
+    for (int i = 0; i < bytes; i++) v |= (uint64_t)(uint8_t)*p++ << (8 * i);
+    return bytes == 4 ? (int64_t)(int32_t)(uint32_t)v : (int64_t)v;
+}
+
+static void xchg_write_header(char *p, const XchgHeader &h){
+    memcpy(p, h.magic, 8);
+    p += 8;
+    xchg_put(p, (uint32_t)h.version, 4);
+    xchg_put(p, (uint32_t)h.gradients, 4);
+    xchg_put(p, (uint32_t)h.n_records, 4);
+    xchg_put(p, (uint32_t)h.codec, 4);
+    xchg_put(p, (uint64_t)h.size, 8);
+}
+
+static XchgHeader xchg_read_header(const char *p){
+    XchgHeader h;
+    memcpy(h.magic, p, 8);
+    p += 8;
+    h.version = xchg_get(p, 4);
+    h.gradients = xchg_get(p, 4);
+    h.n_records = xchg_get(p, 4);
+    h.codec = xchg_get(p, 4);
+    h.size = xchg_get(p, 8);
+    return h;
+}
+
+static void xchg_write_record(char *p, const XchgRecord &r){
+    xchg_put(p, (uint32_t)r.layer, 4);
+    xchg_put(p, (uint32_t)r.index, 4);
+    xchg_put(p, (uint32_t)r.size, 4);
+    xchg_put(p, (uint32_t)r.bytes, 4);
+}
+
+static XchgRecord xchg_read_record(const char *p){
+    XchgRecord r;
+    r.layer = xchg_get(p, 4);
+    r.index = xchg_get(p, 4);
+    r.size = xchg_get(p, 4);
+    r.bytes = xchg_get(p, 4);
+    return r;
+}
+
+static size_t xchg_align(size_t v){
+    return (v + XCHG_ALIGN - 1) / XCHG_ALIGN * XCHG_ALIGN;
+}
+
+static vtensor &xchg_tensors(Layer *l, bool gradients){
+    return gradients ? l->acc_gradients : l->params;
+}
+
+static long xchg_topk(long size, float ratio){
+    return std::min(size, std::max(1L, (long)std::ceil(ratio * size)));
+}
+
+// Bytes of the encoded values of a tensor
+static size_t xchg_bytes(long size, int codec, float ratio){
+    if (codec == XCHG_FP16 || codec == XCHG_BF16) return size * sizeof(uint16_t);
+    if (codec == XCHG_INT8) return sizeof(float) + size * sizeof(int8_t);
+    if (codec == XCHG_TOPK) return sizeof(int32_t) + xchg_topk(size, ratio) * (sizeof(int32_t) + sizeof(float));
+    return size * sizeof(float);
+}
+
+// Uniform [0, 1) from the position, without state, so that the quantization loop is vectorized
+static inline float xchg_uniform(uint64_t seed, long i){
+    uint64_t z = seed + (uint64_t)i * 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    z ^= z >> 31;
+    return (float)(z >> 40) * (1.0f / 16777216.0f);
+}
+
+static void xchg_encode_int8(const float *A, char *out, long size, uint64_t seed){
+    float amax = 0.0f;
+#pragma omp parallel for reduction(max:amax)
+    for (long i = 0; i < size; i++) amax = std::max(amax, std::fabs(A[i]));
+
+    // Unbiased: the value is rounded up with probability equal to its fraction
+    float scale = amax / 127.0f;
+    float inv = scale > 0.0f ? 1.0f / scale : 0.0f;
+    memcpy(out, &scale, sizeof(float));
+    int8_t *q = (int8_t *)(out + sizeof(float));
+#pragma omp parallel for
+    for (long i = 0; i < size; i++) {
+        float v = std::floor(A[i] * inv + xchg_uniform(seed, i));
+        q[i] = (int8_t)std::min(std::max(v, -127.0f), 127.0f);
+    }
+}
+
+static void xchg_decode_int8(const char *in, float *B, long size){
+    float scale;
+    memcpy(&scale, in, sizeof(float));
+    const int8_t *q = (const int8_t *)(in + sizeof(float));
+#pragma omp parallel for
+    for (long i = 0; i < size; i++) B[i] = (float)q[i] * scale;
+}
+
+// The largest values of the gradients plus the residual of the previous rounds. The values not sent
+// stay in the residual (error feedback)
+static void xchg_encode_topk(const float *A, float *residual, char *out, long size, float ratio){
+#pragma omp parallel for
+    for (long i = 0; i < size; i++) residual[i] += A[i];
+
+    int32_t k = xchg_topk(size, ratio);
+    vector<int32_t> pos(size);
+    std::iota(pos.begin(), pos.end(), 0);
+    std::nth_element(pos.begin(), pos.begin() + (k - 1), pos.end(),
+                     [residual](int32_t a, int32_t b){ return std::fabs(residual[a]) > std::fabs(residual[b]); });
+    std::sort(pos.begin(), pos.begin() + k);
+
+    memcpy(out, &k, sizeof(int32_t));
+    int32_t *idx = (int32_t *)(out + sizeof(int32_t));
+    float *val = (float *)(idx + k);
+    for (int i = 0; i < k; i++) {
+        idx[i] = pos[i];
+        val[i] = residual[pos[i]];
+        residual[pos[i]] = 0.0f;
+    }
+}
+
+// The positions are checked by xchg_check_topk before
+static void xchg_decode_topk(const char *in, float *B, long size){
+    int32_t k;
+    memcpy(&k, in, sizeof(int32_t));
+    const int32_t *idx = (const int32_t *)(in + sizeof(int32_t));
+    const float *val = (const float *)(idx + k);
+
+    std::fill(B, B + size, 0.0f);
+    for (int i = 0; i < k; i++) B[idx[i]] = val[i];
+}
+
+static bool xchg_check_topk(const char *in, long size, long bytes){
+    if (bytes < (long)sizeof(int32_t)) return false;
+    int32_t k;
+    memcpy(&k, in, sizeof(int32_t));
+    if (k < 0 || k > size || bytes != sizeof(int32_t) + (long)k * (sizeof(int32_t) + sizeof(float))) return false;
+    const int32_t *idx = (const int32_t *)(in + sizeof(int32_t));
+    for (int i = 0; i < k; i++)
+        if (idx[i] < 0 || idx[i] >= size) return false;
+    return true;
+}
+
+
+void Net::set_exchange_codec(const string& codec, float ratio){
+    if (codec == "fp32") xchg_codec = XCHG_FP32;
+    else if (codec == "fp16") xchg_codec = XCHG_FP16;
+    else if (codec == "bf16") xchg_codec = XCHG_BF16;
+    else if (codec == "int8") xchg_codec = XCHG_INT8;
+    else if (codec == "topk") xchg_codec = XCHG_TOPK;
+    else msg("Unknown codec " + codec + " (fp32, fp16, bf16, int8 or topk)", "Net::set_exchange_codec");
+
+    if (ratio <= 0.0f || ratio > 1.0f) msg("The ratio must be in (0, 1]", "Net::set_exchange_codec");
+    xchg_ratio = ratio;
+
+    for (auto t : xchg_residuals) delete t;
+    xchg_residuals.clear();
+}
+
+size_t Net::exchange_size(bool gradients){
+    int codec = gradients ? xchg_codec : XCHG_FP32;
+    size_t size = XCHG_HEADER_BYTES;
+    for (auto l : layers)
+        for (auto t : xchg_tensors(l, gradients))
+            size += XCHG_RECORD_BYTES + xchg_align(xchg_bytes(t->size, codec, xchg_ratio));
+    return size;
+}
+
+size_t Net::serialize_exchange(void *buffer, size_t size, bool gradients){
+    if (!gradients && snets[0]->dev!=DEV_CPU)
+        sync_weights();
+
+    size_t total = exchange_size(gradients);
+    if (size < total) msg("Buffer too small (" + to_string(size) + " < " + to_string(total) + " bytes)", "Net::serialize_exchange");
+
+    int codec = gradients ? xchg_codec : XCHG_FP32;
+    uint64_t seed = ++xchg_round * 0x2545f4914f6cdd1dULL;
+
+    char *base = (char *)buffer;
+    XchgHeader header;
+    memcpy(header.magic, XCHG_MAGIC, 8);
+    header.version = XCHG_VERSION;
+    header.gradients = gradients;
+    header.n_records = 0;
+    header.codec = codec;
+    header.size = total;
+
+    // One residual per tensor for the error feedback of top-k
+    int n = 0;
+    if (codec == XCHG_TOPK && xchg_residuals.empty()) {
+        for (auto l : layers)
+            for (auto t : xchg_tensors(l, gradients))
+                xchg_residuals.push_back(Tensor::zeros(t->shape, DEV_CPU));
+    }
+
+    // The tensors are encoded straight to the buffer
+    size_t offset = XCHG_HEADER_BYTES;
+    for (int i = 0; i < layers.size(); i++) {
+        vtensor &tensors = xchg_tensors(layers[i], gradients);
+        for (int j = 0; j < tensors.size(); j++, n++) {
+            Tensor *t = tensors[j];
+            size_t bytes = xchg_bytes(t->size, codec, xchg_ratio);
+            XchgRecord r;
+            r.layer = i;
+            r.index = j;
+            r.size = t->size;
+            r.bytes = bytes;
+            xchg_write_record(base + offset, r);
+            offset += XCHG_RECORD_BYTES;
+
+            char *data = base + offset;
+            if (codec == XCHG_FP32 && !t->isCPU()) {
+                Tensor view(t->shape, (float *)data, DEV_CPU);
+                view.isview = true;
+                Tensor::copy(t, &view);
+            } else {
+                Tensor *src = t;
+                if (!t->isCPU()) {
+                    src = new Tensor(t->shape, DEV_CPU);
+                    Tensor::copy(t, src);
+                }
+
+                if (codec == XCHG_FP32) memcpy(data, src->ptr, bytes);
+                else if (codec == XCHG_FP16) cpu_to_half(src->ptr, (uint16_t *)data, t->size, false);
+                else if (codec == XCHG_BF16) cpu_to_half(src->ptr, (uint16_t *)data, t->size, true);
+                else if (codec == XCHG_INT8) xchg_encode_int8(src->ptr, data, t->size, seed + n);
+                else xchg_encode_topk(src->ptr, xchg_residuals[n]->ptr, data, t->size, xchg_ratio);
+
+                if (src != t) delete src;
+            }
+            offset += xchg_align(bytes);
+            header.n_records++;
+        }
+    }
+    xchg_write_header(base, header);
+    return total;
+}
+
+// Decodes the values of a record, or reads them in place for float32
+static Tensor *xchg_decode(const XchgRecord &r, const char *data, int codec, Tensor *like){
+    if (codec == XCHG_FP32) {
+        Tensor *view = new Tensor(like->shape, (float *)data, DEV_CPU);
+        view->isview = true;
+        return view;
+    }
+    Tensor *t = new Tensor(like->shape, DEV_CPU);
+    if (codec == XCHG_FP16) cpu_from_half((const uint16_t *)data, t->ptr, r.size, false);
+    else if (codec == XCHG_BF16) cpu_from_half((const uint16_t *)data, t->ptr, r.size, true);
+    else if (codec == XCHG_INT8) xchg_decode_int8(data, t->ptr, r.size);
+    else xchg_decode_topk(data, t->ptr, r.size);
+    return t;
+}
+
+void Net::apply_exchange(const void *buffer, size_t size){
+    const char *base = (const char *)buffer;
+    if (size < XCHG_HEADER_BYTES) msg("Truncated buffer", "Net::apply_exchange");
+
+    XchgHeader header = xchg_read_header(base);
+    if (memcmp(header.magic, XCHG_MAGIC, 8) != 0) msg("Not an exchange buffer", "Net::apply_exchange");
+    if (header.version != XCHG_VERSION) msg("Unsupported version " + to_string(header.version), "Net::apply_exchange");
+    if (header.size < XCHG_HEADER_BYTES || (uint64_t)header.size > size || header.n_records < 0)
+        msg("Truncated buffer", "Net::apply_exchange");
+    if (header.codec < XCHG_FP32 || header.codec > XCHG_TOPK || (!header.gradients && header.codec != XCHG_FP32))
+        msg("Unknown codec " + to_string(header.codec), "Net::apply_exchange");
+    bool gradients = header.gradients != 0;
+
+    // The whole buffer is checked before anything is applied, so a bad record leaves the net untouched.
+    // records[i][j] is the offset of the record of the tensor j of the layer i (0 if not sent)
+    vector<vector<size_t>> records(layers.size());
+    size_t offset = XCHG_HEADER_BYTES;
+    for (int k = 0; k < header.n_records; k++) {
+        if (offset + XCHG_RECORD_BYTES > (uint64_t)header.size) msg("Truncated buffer", "Net::apply_exchange");
+        XchgRecord r = xchg_read_record(base + offset);
+
+        if (r.layer < 0 || r.layer >= layers.size()) msg("Unknown layer " + to_string(r.layer), "Net::apply_exchange");
+        vtensor &tensors = xchg_tensors(layers[r.layer], gradients);
+        if (r.index < 0 || r.index >= tensors.size() || r.size != tensors[r.index]->size)
+            msg("The buffer does not match the layer " + layers[r.layer]->name, "Net::apply_exchange");
+        vector<size_t> &v = records[r.layer];
+        v.resize(tensors.size(), 0);
+        if (v[r.index]) msg("Repeated record of the layer " + layers[r.layer]->name, "Net::apply_exchange");
+
+        const char *data = base + offset + XCHG_RECORD_BYTES;
+        if (r.bytes < 0 || offset + XCHG_RECORD_BYTES + r.bytes > (uint64_t)header.size)
+            msg("Truncated buffer", "Net::apply_exchange");
+        bool valid = header.codec == XCHG_TOPK ? xchg_check_topk(data, r.size, r.bytes)
+                                               : r.bytes == xchg_bytes(r.size, header.codec, 1.0f);
+        if (!valid) msg("Wrong size of the record of the layer " + layers[r.layer]->name, "Net::apply_exchange");
+
+        v[r.index] = offset;
+        offset += XCHG_RECORD_BYTES + xchg_align(r.bytes);
+    }
+    if (gradients)
+        for (int i = 0; i < layers.size(); i++)
+            if (!records[i].empty() && !records[i][0])
+                msg("Missing gradients of the layer " + layers[i]->name, "Net::apply_exchange");
+
+    // The weights are copied to the params, and the gradients of a layer are accumulated together
+    for (int i = 0; i < layers.size(); i++) {
+        vtensor &tensors = xchg_tensors(layers[i], gradients);
+        vtensor v(records[i].size(), nullptr);
+        for (int j = 0; j < records[i].size(); j++) {
+            if (!records[i][j]) continue;
+            const char *rec = base + records[i][j];
+            v[j] = xchg_decode(xchg_read_record(rec), rec + XCHG_RECORD_BYTES, header.codec, tensors[j]);
+            if (!gradients) Tensor::copy(v[j], tensors[j]);
+        }
+        if (gradients && !v.empty())
+            layers[i]->accumulate_accumulated_gradients(v[0], v.size() > 1 ? v[1] : nullptr);
+        for (auto t : v) delete t;
+    }
+
+    // Copy to CS devices layers
+    if (!gradients && snets[0]->dev!=DEV_CPU) {
+        for(int i=0; i!=snets.size(); i++)
+            for(int j=0;j<layers.size();j++)
+                layers[j]->copy(snets[i]->layers[j]);
+    }
+    drop_quantization();
+}
@@ -15,11 +15,13 @@
 #include <string>
 #include <chrono>
 #include <thread>
+#include <unordered_map>
 #include "eddl/net/net.h"
 #include <pthread.h>
 #include "eddl/utils.h"
 #include "eddl/random.h"
 #include "eddl/layers/core/layer_core.h"
+#include "eddl/hardware/cpu/cpu_tensor.h"
 
 #define VERBOSE 0
 
@@ -52,16 +54,25 @@ void Net::do_forward() {
   if (VERBOSE) {
     cout<<"START FORWARD\n";
   }
-  for (int i = 0; i < vfts.size(); i++) {
+  // Elementwise chains are run by their fused layers (if any)
+  vlayer &order = ffts.empty() ? vfts : ffts;
+  for (int i = 0; i < order.size(); i++) {
     if (VERBOSE) {
-      cout << vfts[i]->name << " Shape: ";
-      for(int j=0;j<vfts[i]->parent.size();j++)
-      fprintf(stdout, "  %s In[%d,%s]:%f\n", vfts[i]->name.c_str(), j, vfts[i]->parent[j]->name.c_str(),vfts[i]->parent[j]->output->sum());
+      cout << order[i]->name << " Shape: ";
+      for(int j=0;j<order[i]->parent.size();j++)
+      fprintf(stdout, "  %s In[%d,%s]:%f\n", order[i]->name.c_str(), j, order[i]->parent[j]->name.c_str(),order[i]->parent[j]->output->sum());
     }
 
-    vfts[i]->forward();
+    if (profiler != nullptr) {
+      double t0 = profiler->now();
+      unsigned long long b0 = get_fmem_total();
+      order[i]->forward();
+      profiler->record(this, order[i]->name, "forward", t0, b0, Profiler::estimate_flops(order[i], false));
+    } else {
+      order[i]->forward();
+    }
     if (VERBOSE) {
-      fprintf(stdout, "  %s Out:%f\n", vfts[i]->name.c_str(), vfts[i]->output->sum());
+      fprintf(stdout, "  %s Out:%f\n", order[i]->name.c_str(), order[i]->output->sum());
     }
   }
   if (VERBOSE) {
@@ -74,24 +85,50 @@ void Net::do_backward() {
   if (VERBOSE) {
     cout<<"START BACKWARD\n";
   }
-  for (int i = 0; i < vbts.size(); i++) {
+  vlayer &order = fbts.empty() ? vbts : fbts;
+
+  // The gradients shared by several layers (the timesteps of an unrolled net) are ready after the last one
+  std::unordered_map<Tensor *, int> last;
+  if (ring != nullptr && acc_last)
+    for (int i = 0; i < order.size(); i++)
+      for (auto g : order[i]->gradients) last[g] = i;
+
+  for (int i = 0; i < order.size(); i++) {
     if(this->verbosity_level >= 1){
-      std::cout << vbts[i]->name << std::endl;
+      std::cout << order[i]->name << std::endl;
     }
 
     // Reserve parent's delta (if reserved, ignored)
-    vbts[i]->mem_delta_parent();
+    order[i]->mem_delta_parent();
 
     // Do backward
     if (VERBOSE) {
-      cout << "backward "<<vbts[i]->name << " delta="<<vbts[i]->delta->sum()<<"\n";
+      // The fused layers have no delta of their own
+      if (order[i]->delta != nullptr) cout << "backward "<<order[i]->name << " delta="<<order[i]->delta->sum()<<"\n";
+      else cout << "backward "<<order[i]->name << "\n";
+    }
+
+    if (profiler != nullptr) {
+      double t0 = profiler->now();
+      unsigned long long b0 = get_fmem_total();
+      order[i]->backward();
+      profiler->record(this, order[i]->name, "backward", t0, b0, Profiler::estimate_flops(order[i], true));
+    } else {
+      order[i]->backward();
     }
 
-    vbts[i]->backward();
 
+    // The gradients of the layer are ready: they are averaged across the ranks while the backward goes on
+    if (ring != nullptr && acc_last) {
+      vtensor ready;
+      for (auto g : order[i]->gradients)
+        if (last[g] == i) ready.push_back(g);
+      if (!ready.empty()) ring->post(ready);
+    }
+    if (buckets != nullptr && acc_last) buckets->ready(order[i]);
 
     // Delete this delta
-    if(vbts[i]->mem_level) { vbts[i]->free_delta(); }
+    if(order[i]->mem_level) { order[i]->free_delta(); }
   }
   if (VERBOSE) {
     cout<<"END BACKWARD\n";
@@ -108,6 +145,9 @@ void Net::do_delta() {
     lout[i]->mem_delta();
     if (losses.size()>=(i+1)) {
       losses[i]->delta(lout[i]->target, lout[i]->output, lout[i]->delta);
+      // Chunk of a batch (see train_batch), and loss scaling (see set_mixed_precision)
+      float scale = acc_scale * optimizer->get_loss_scale();
+      if (scale != 1.0f) lout[i]->delta->mult_(scale);
       if (VERBOSE) cout<<"Delta: "<<lout[i]->name<<" delta:"<<lout[i]->delta->sum()<<"\n";
     }
   }
@@ -140,29 +180,88 @@ void Net::do_compute_loss() {
 }
 
 void Net::do_applygrads() {
-  optimizer->applygrads(batch_size);
+  if (ring != nullptr) ring->wait();
+  if (buckets != nullptr) buckets->wait();
+
+  // Overflow of the scaled gradients: the step is skipped
+  if (!optimizer->unscale()) return;
+
+  if (profiler != nullptr) {
+    double t0 = profiler->now();
+    unsigned long long b0 = get_fmem_total();
+    optimizer->applygrads(batch_size);
+    profiler->record(this, "update", "update", t0, b0, 0.0);
+  } else {
+    optimizer->applygrads(batch_size);
+  }
+
+  // The int8 weights are of the old fp32 ones
+  drop_quantization();
 }
 
 
 
 
+// Average of the params of the snets, in three steps run by a thread per snet: copy of the
+// params of the snet to the host, reduction of a chunk of every param (reduce-scatter), and
+// copy of the average back to the snet (all-gather). The host copies are allocated by the
+// first sync and reused by the next ones
 void Net::sync_weights() {
-  //cout<<"\nSync weights...\n";
-  for (int j = 0; j < layers.size(); j++)
-  for (int k = 0; k < layers[j]->params.size(); k++) {
-    // Taking average
-    layers[j]->params[k]->fill_(0.0);
-    for (int i = 0; i < snets.size(); i++) {
-      Tensor::inc(snets[i]->layers[j]->params[k], layers[j]->params[k]);
-    }
-    layers[j]->params[k]->div_(snets.size());
-
-    // copy-back to devices
-    for (int i = 0; i < snets.size(); i++) {
-      Tensor::copy(layers[j]->params[k], snets[i]->layers[j]->params[k]);
-    }
+  int comp = snets.size();
+  vector<vtensor> &stage = sync_stage;
+  vector<thread> threads;
 
+  if (stage.size() != comp) {
+    for (auto &ts : stage) for (auto t : ts) delete t;
+    stage.assign(comp, vtensor());
   }
+
+  // Params of each snet on the host
+  for (int i = 0; i < comp; i++)
+    threads.push_back(thread([&, i] {
+      int p = 0;
+      for (int j = 0; j < layers.size(); j++)
+        for (int k = 0; k < layers[j]->params.size(); k++, p++) {
+          Tensor *w = snets[i]->layers[j]->params[k];
+          if (p == stage[i].size()) stage[i].push_back(nullptr);
+          if (stage[i][p] == nullptr || stage[i][p]->shape != w->shape) {  // Per sample stats follow the batch
+            delete stage[i][p];
+            stage[i][p] = new Tensor(w->shape);
+          }
+          Tensor::copy(w, stage[i][p]);
+        }
+    }));
+  for (auto &t : threads) t.join();
+  threads.clear();
+
+  // Chunk i of every param is averaged by thread i
+  for (int i = 0; i < comp; i++)
+    threads.push_back(thread([&, i] {
+      int p = 0;
+      for (int j = 0; j < layers.size(); j++)
+        for (int k = 0; k < layers[j]->params.size(); k++, p++) {
+          Tensor *w = layers[j]->params[k];
+          long start = w->size * i / comp;
+          long end = w->size * (i + 1) / comp;
+          for (long n = start; n < end; n++) {
+            float sum = 0.0f;
+            for (int r = 0; r < comp; r++) sum += stage[r][p]->ptr[n];
+            w->ptr[n] = sum / comp;
+          }
+        }
+    }));
+  for (auto &t : threads) t.join();
+  threads.clear();
+
+  // copy-back to devices
+  for (int i = 0; i < comp; i++)
+    threads.push_back(thread([&, i] {
+      for (int j = 0; j < layers.size(); j++)
+        for (int k = 0; k < layers[j]->params.size(); k++)
+          if (snets[i]->layers[j]->params[k] != layers[j]->params[k])
+            Tensor::copy(layers[j]->params[k], snets[i]->layers[j]->params[k]);
+    }));
+  for (auto &t : threads) t.join();
 }
 
 
@@ -0,0 +1,102 @@
+/*
+* EDDL Library - European Distributed Deep Learning Library.
+* Version: 0.7
+* copyright (c) 2020, Universidad Politécnica de Valencia (UPV), PRHLT Research Centre
+* Date: April 2020
+* Author: PRHLT Research Centre, UPV, (rparedes@prhlt.upv.es), (jon@prhlt.upv.es)
+* All rights reserved
+*/
+
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <set>
+#include <string>
+
+#include "eddl/net/net.h"
+#include "eddl/layers/operators/layer_operators.h"
+#include "eddl/layers/core/layer_core.h"
+#include "eddl/utils.h"
+
+using namespace std;
+
+#define VERBOSE 0
+
+
+// Groups the chains of two or more elementwise layers (operators and activations) into LFused
+// layers, so that each chain is computed in a single pass. A layer joins the chain of its parent
+// when it is the only child of that parent, and every other operand (side input) has the same
+// shape. The layers inside a chain do not compute their outputs nor reserve their deltas. The graph
+// is not modified: the fused layers only replace the chains in the execution orders (ffts, fbts)
+void Net::fuse(){
+    for (auto l : vfused) delete l;
+    vfused.clear();
+    ffts.clear();
+    fbts.clear();
+
+    // The fused kernels run on CPU. The recurrent nets are unrolled from the original layers
+    if (dev != DEV_CPU || isrecurrent) return;
+
+    int ind;
+    set<Layer *> inner;           // Layers inside a chain (not executed)
+    map<Layer *, Layer *> fused;  // Last layer of a chain -> fused layer
+
+    for (auto l : vfts) {
+        if (inner.count(l) || fused.count(l) || l->parent.empty()) continue;
+
+        FusedOp op;
+        Layer *side;
+        if (!LFused::get_op(l, l->parent[0], op, side)) continue;
+
+        vector<Layer *> chain = {l};
+        vector<FusedOp> ops;
+        vector<Layer *> sides;
+
+        auto add_op = [&](FusedOp &op, Layer *side) {
+            if (side != nullptr) {
+                if (!isIn(side, sides, op.side)) {
+                    op.side = sides.size();
+                    sides.push_back(side);
+                }
+            }
+            ops.push_back(op);
+        };
+        add_op(op, side);
+
+        // Extend the chain while the output is only used by the next op
+        Layer *last = l;
+        while (last->child.size() == 1 && !isIn(last, lout, ind)) {
+            Layer *next = last->child[0];
+            if (inner.count(next) || fused.count(next)) break;  // Already in the chain of its other operand
+            if (!LFused::get_op(next, last, op, side)) break;
+            chain.push_back(next);
+            add_op(op, side);
+            last = next;
+        }
+
+        // A single layer is already computed in one pass
+        if (chain.size() < 2) continue;
+
+        auto *f = new LFused(chain, ops, l->parent[0], sides);
+        f->verbosity_level = verbosity_level;
+        vfused.push_back(f);
+
+        for (int i = 0; i < chain.size() - 1; i++) inner.insert(chain[i]);
+        fused[last] = f;
+
+        if (VERBOSE) cout << "Fused " << chain.size() << " layers into " << f->name << "\n";
+    }
+
+    if (vfused.empty()) return;
+
+    for (auto l : vfts) {
+        if (inner.count(l)) continue;
+        ffts.push_back(fused.count(l) ? fused[l] : l);
+    }
+    for (auto l : vbts) {
+        if (inner.count(l)) continue;
+        fbts.push_back(fused.count(l) ? fused[l] : l);
+    }
+}
@@ -0,0 +1,97 @@
+/*
+* EDDL Library - European Distributed Deep Learning Library.
+* Version: 0.7
+* copyright (c) 2020, Universidad Politécnica de Valencia (UPV), PRHLT Research Centre
+* Date: April 2020
+* Author: PRHLT Research Centre, UPV, (rparedes@prhlt.upv.es), (jon@prhlt.upv.es)
+* All rights reserved
+*/
+
+
+#include <string>
+
+#include "eddl/net/net.h"
+#include "eddl/layers/conv/layer_conv.h"
+#include "eddl/layers/core/layer_core.h"
+#include "eddl/layers/merge/layer_merge.h"
+#include "eddl/layers/normalization/layer_normalization.h"
+#include "eddl/layers/operators/layer_operators.h"
+#include "eddl/layers/pool/layer_pool.h"
+#include "eddl/utils.h"
+
+using namespace std;
+
+
+// Conv, pooling and batchnorm read their input in the layout of the parent and write the output in
+// their own one, so they convert at the borders of the NHWC regions. The int8 kernels are NCHW
+static bool layout_converting(Layer *l){
+    if (l->output->ndim != 4 || l->parent.size() != 1 || l->quant != nullptr) return false;
+    return dynamic_cast<LConv *>(l) != nullptr || dynamic_cast<LPool *>(l) != nullptr ||
+           dynamic_cast<LBatchNorm *>(l) != nullptr;
+}
+
+// The elementwise layers work in any layout, the one of their operands
+static bool layout_elementwise(Layer *l){
+    if (l->output->ndim != 4 || l->parent.empty()) return false;
+
+    FusedOp op;
+    Layer *side;
+    if (LFused::get_op(l, l->parent[0], op, side)) return true;
+
+    if (dynamic_cast<LAdd *>(l) == nullptr && dynamic_cast<LDropout *>(l) == nullptr) return false;
+    for (auto p : l->parent)
+        if (p->output->shape != l->output->shape) return false;
+    return true;
+}
+
+
+void Net::set_layout(const string& layout){
+    if (layout == "nchw") this->layout = LAYOUT_NCHW;
+    else if (layout == "nhwc") this->layout = LAYOUT_NHWC;
+    else msg("Unknown layout " + layout + " (nchw or nhwc)", "Net::set_layout");
+
+    if (isbuild) propagate_layout();
+}
+
+// Every layer starts in NHWC if it can work in it, and goes back to NCHW while its output is read
+// by a layer that can not: the inputs, the outputs and the other layers stay in NCHW, and the data
+// is converted by the first and the last layers of each NHWC region
+void Net::propagate_layout(){
+    int ind;
+    bool nhwc = layout == LAYOUT_NHWC && !snets.empty() && snets[0]->dev == DEV_CPU && !isrecurrent;
+
+    for (auto l : layers) {
+        l->layout = LAYOUT_NCHW;
+        if (nhwc && !isIn(l, lin, ind) && !isIn(l, lout, ind) && (layout_converting(l) || layout_elementwise(l)))
+            l->layout = LAYOUT_NHWC;
+    }
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (auto l : layers) {
+            if (l->layout != LAYOUT_NHWC) continue;
+
+            bool nchw = l->child.empty();
+            for (auto c : l->child)
+                if (c->layout != LAYOUT_NHWC && !layout_converting(c)) nchw = true;
+            if (layout_elementwise(l))
+                for (auto p : l->parent)
+                    if (p->layout != LAYOUT_NHWC) nchw = true;
+
+            if (nchw) {
+                l->layout = LAYOUT_NCHW;
+                changed = true;
+            }
+        }
+    }
+
+    for (auto l : layers) {
+        ConvolDescriptor *d = nullptr;
+        if (auto *c = dynamic_cast<LConv *>(l)) d = c->cd;
+        else if (auto *p = dynamic_cast<LPool *>(l)) d = p->pd;
+        if (d == nullptr) continue;
+        d->layout = l->layout;
+        d->in_layout = l->parent[0]->layout;
+    }
+}
@@ -0,0 +1,171 @@
+/*
+* EDDL Library - European Distributed Deep Learning Library.
+* Version: 0.7
+* copyright (c) 2020, Universidad Politécnica de Valencia (UPV), PRHLT Research Centre
+* Date: April 2020
+* Author: PRHLT Research Centre, UPV, (rparedes@prhlt.upv.es), (jon@prhlt.upv.es)
+* All rights reserved
+*/
+
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "eddl/net/net.h"
+#include "eddl/utils.h"
+
+using namespace std;
+
+// Aligned weights layout (format "mmap"):
+//   header   {char magic[8] "EDDLWMAP", int version, int n_tensors, long data_offset}
+//   index    n_tensors x {int ndim, int shape[MMAP_MAX_DIMS], long offset}
+//   data     row-major float32. Every tensor starts at a multiple of MMAP_ALIGN bytes and
+//            the data section starts at a page boundary
+#define MMAP_MAGIC "EDDLWMAP"
+#define MMAP_VERSION 1
+#define MMAP_MAX_DIMS 8
+#define MMAP_ALIGN 64
+#define MMAP_PAGE 4096
+
+struct MMapHeader {
+    char magic[8];
+    int version;
+    int n_tensors;
+    long data_offset;
+};
+
+struct MMapEntry {
+    int ndim;
+    int shape[MMAP_MAX_DIMS];
+    long offset;
+};
+
+static long mmap_align(long v, long alignment){
+    return (v + alignment - 1) / alignment * alignment;
+}
+
+
+void Net::save_mmap(const string& filename){
+    // Copy from CS devices to layers
+    if (snets[0]->dev!=DEV_CPU)
+        sync_weights();
+
+    vtensor tensors;
+    for (auto l : layers)
+        for (auto p : l->params) tensors.push_back(p);
+
+    // Build the index
+    MMapHeader header;
+    memcpy(header.magic, MMAP_MAGIC, 8);
+    header.version = MMAP_VERSION;
+    header.n_tensors = tensors.size();
+    header.data_offset = mmap_align(sizeof(MMapHeader) + tensors.size() * sizeof(MMapEntry), MMAP_PAGE);
+
+    vector<MMapEntry> index(tensors.size());
+    long offset = header.data_offset;
+    for (int i = 0; i < tensors.size(); i++) {
+        if (tensors[i]->ndim > MMAP_MAX_DIMS) msg("Too many dimensions", "Net::save_mmap");
+        memset(&index[i], 0, sizeof(MMapEntry));
+        index[i].ndim = tensors[i]->ndim;
+        for (int d = 0; d < tensors[i]->ndim; d++) index[i].shape[d] = tensors[i]->shape[d];
+        index[i].offset = offset;
+        offset = mmap_align(offset + tensors[i]->size * sizeof(float), MMAP_ALIGN);
+    }
+
+    std::ofstream ofs(filename, std::ios::out | std::ios::binary);
+    if (!ofs.good()) msg("Error creating " + filename, "Net::save_mmap");
+    ofs.write(reinterpret_cast<const char *>(&header), sizeof(MMapHeader));
+    ofs.write(reinterpret_cast<const char *>(index.data()), index.size() * sizeof(MMapEntry));
+
+    vector<char> padding(MMAP_PAGE, 0);
+    for (int i = 0; i < tensors.size(); i++) {
+        long pos = ofs.tellp();
+        ofs.write(padding.data(), index[i].offset - pos);
+
+        Tensor *t = tensors[i]->is_contiguous() ? tensors[i] : Tensor::contiguous(tensors[i]);
+        ofs.write(reinterpret_cast<const char *>(t->ptr), t->size * sizeof(float));
+        if (t != tensors[i]) delete t;
+    }
+    ofs.close();
+}
+
+
+void Net::load_mmap(const string& filename){
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error(std::string("File not found. Check the file name and try again (Net::load_mmap)"));
+    }
+
+    struct stat st;
+    fstat(fd, &st);
+    size_t size = st.st_size;
+    if (size < sizeof(MMapHeader)) { close(fd); msg("Not a weights file", "Net::load_mmap"); }
+
+    // Private mapping: pages are shared between processes until a parameter is written (copy-on-write)
+    void *addr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (addr == MAP_FAILED) msg("Error mapping " + filename, "Net::load_mmap");
+
+    auto *base = static_cast<char *>(addr);
+    auto *header = reinterpret_cast<MMapHeader *>(base);
+    auto *index = reinterpret_cast<MMapEntry *>(base + sizeof(MMapHeader));
+
+    vtensor tensors;
+    for (auto l : layers)
+        for (auto p : l->params) tensors.push_back(p);
+
+    if (strncmp(header->magic, MMAP_MAGIC, 8) != 0 || header->version != MMAP_VERSION) {
+        munmap(addr, size);
+        msg("Not a weights file (or unsupported version)", "Net::load_mmap");
+    }
+    if (header->n_tensors != tensors.size()) {
+        munmap(addr, size);
+        msg("The weights do not match the network", "Net::load_mmap");
+    }
+
+    for (int i = 0; i < tensors.size(); i++) {
+        vector<int> shape(index[i].shape, index[i].shape + index[i].ndim);
+        if (shape != tensors[i]->shape || index[i].offset + tensors[i]->size * sizeof(float) > size) {
+            munmap(addr, size);
+            msg("The weights do not match the network", "Net::load_mmap");
+        }
+    }
+
+    // Point the parameters at the mapped pages. They become non-owning tensors
+    for (int i = 0; i < tensors.size(); i++) {
+        Tensor *t = tensors[i];
+        auto *data = reinterpret_cast<float *>(base + index[i].offset);
+        if (t->isCPU()) {
+            t->deleteData();
+            delete (Eigen::Map<Eigen::MatrixXf> *)t->ptr2;  // updateData maps the new data of 2D tensors
+            t->ptr2 = nullptr;
+            t->isview = true;
+            t->updateData(data);
+        } else {
+            auto *tmp = new Tensor(t->shape, data, DEV_CPU);
+            Tensor::copy(tmp, t);
+            tmp->ptr = nullptr;
+            delete tmp;
+        }
+    }
+
+    // Previous mapping (if any) is no longer referenced
+    if (mmap_ptr != nullptr) munmap(mmap_ptr, mmap_size);
+    mmap_ptr = addr;
+    mmap_size = size;
+
+    // Copy to CS devices layers
+    if (snets[0]->dev!=DEV_CPU) {
+        for(int i=0; i!=snets.size(); i++)
+            for(int j=0;j<layers.size();j++)
+                layers[j]->copy(snets[i]->layers[j]);
+    }
+}
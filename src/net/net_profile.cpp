@@ -0,0 +1,184 @@
+/*
+* EDDL Library - European Distributed Deep Learning Library.
+* Version: 0.7
+* copyright (c) 2020, Universidad Politécnica de Valencia (UPV), PRHLT Research Centre
+* Date: April 2020
+* Author: PRHLT Research Centre, UPV, (rparedes@prhlt.upv.es), (jon@prhlt.upv.es)
+* All rights reserved
+*/
+
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "eddl/net/profiler.h"
+#include "eddl/net/net.h"
+#include "eddl/layers/core/layer_core.h"
+#include "eddl/layers/conv/layer_conv.h"
+#include "eddl/layers/operators/layer_operators.h"
+#include "eddl/utils.h"
+
+using namespace std;
+
+
+Profiler::Profiler(long max_events){
+    this->max_events = max_events;
+    origin = std::chrono::steady_clock::now();
+}
+
+double Profiler::now() const {
+    return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - origin).count();
+}
+
+void Profiler::record(Net *net, const string &name, const string &phase, double start, unsigned long long bytes0, double flops){
+    double duration = now() - start;
+    unsigned long long bytes = get_fmem_total() - bytes0;
+
+    std::lock_guard<std::mutex> lock(mtx);
+
+    int tid = 0;
+    while (tid < nets.size() && nets[tid] != net) tid++;
+    if (tid == nets.size()) nets.push_back(net);
+
+    if (events.size() < max_events) events.push_back({name, phase, tid, start, duration, bytes, flops});
+
+    string key = name + "/" + phase;
+    auto it = index.find(key);
+    if (it == index.end()) {
+        index[key] = totals.size();
+        totals.push_back({name, phase, 1, duration, bytes, flops});
+    } else {
+        Total &t = totals[it->second];
+        t.calls++;
+        t.duration += duration;
+        t.bytes += bytes;
+        t.flops += flops;
+    }
+}
+
+void Profiler::clear(){
+    std::lock_guard<std::mutex> lock(mtx);
+    events.clear();
+    totals.clear();
+    index.clear();
+}
+
+
+string Profiler::summary(){
+    std::lock_guard<std::mutex> lock(mtx);
+
+    vector<Total> sorted(totals);
+    std::stable_sort(sorted.begin(), sorted.end(), [](const Total &a, const Total &b){ return a.duration > b.duration; });
+
+    double total = 0.0;
+    for (auto &t : sorted) total += t.duration;
+
+    std::stringstream ss;
+    ss << "-------------------------------------------------------------------------------------------------" << endl;
+    ss << setw(30) << left << "Layer" << "|  " << setw(10) << left << "Phase" << setw(8) << right << "Calls";
+    ss << setw(12) << right << "Total ms" << setw(10) << right << "Mean ms" << setw(8) << right << "%";
+    ss << setw(12) << right << "MB alloc" << setw(10) << right << "GFLOP/s" << endl;
+    ss << "-------------------------------------------------------------------------------------------------" << endl;
+
+    for (auto &t : sorted) {
+        ss << setw(30) << left << t.name << "|  " << setw(10) << left << t.phase << setw(8) << right << t.calls;
+        ss << fixed << setprecision(3);
+        ss << setw(12) << right << t.duration / 1000.0;
+        ss << setw(10) << right << t.duration / 1000.0 / t.calls;
+        ss << setprecision(1) << setw(8) << right << (total > 0.0 ? 100.0 * t.duration / total : 0.0);
+        ss << setprecision(2) << setw(12) << right << t.bytes / (1024.0 * 1024.0);
+        if (t.flops > 0.0 && t.duration > 0.0) ss << setw(10) << right << t.flops / t.duration / 1000.0;
+        else ss << setw(10) << right << "-";
+        ss << endl;
+        ss.unsetf(std::ios::fixed);
+    }
+    ss << "-------------------------------------------------------------------------------------------------" << endl;
+    ss << "Total: " << fixed << setprecision(3) << total / 1000.0 << " ms" << endl;
+
+    return ss.str();
+}
+
+
+static string json_string(const string &s){
+    string out = "\"";
+    for (char c : s) {
+        if (c == '"' || c == '\\') out += '\\';
+        if ((unsigned char)c < 0x20) continue;
+        out += c;
+    }
+    return out + "\"";
+}
+
+void Profiler::save_trace(const string &filename){
+    std::lock_guard<std::mutex> lock(mtx);
+
+    std::ofstream ofs(filename, std::ios::out);
+    if (!ofs.good()) msg("Error creating " + filename, "Profiler::save_trace");
+
+    // Complete events ("ph":"X"), one row per computing service
+    ofs << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [";
+    ofs << fixed << setprecision(3);
+    for (int i = 0; i < events.size(); i++) {
+        const Event &e = events[i];
+        if (i > 0) ofs << ",";
+        ofs << "\n{\"name\": " << json_string(e.name) << ", \"cat\": " << json_string(e.phase);
+        ofs << ", \"ph\": \"X\", \"ts\": " << e.start << ", \"dur\": " << e.duration;
+        ofs << ", \"pid\": 0, \"tid\": " << e.tid;
+        ofs << ", \"args\": {\"bytes\": " << e.bytes << ", \"flops\": " << setprecision(0) << e.flops << "}}";
+        ofs << setprecision(3);
+    }
+    ofs << "\n]}\n";
+    ofs.close();
+}
+
+
+double Profiler::estimate_flops(Layer *l, bool backward){
+    // Backward of layers with weights: gradients of the input and of the weights
+    double f;
+    if (auto *d = dynamic_cast<LDense *>(l)) {
+        f = 2.0 * l->input->size * d->ndim;
+        return backward ? 2.0 * f : f;
+    }
+    if (auto *c = dynamic_cast<LConv *>(l)) {
+        ConvolDescriptor *cd = c->cd;
+        f = 2.0 * l->input->shape[0] * cd->nk * cd->r * cd->c * cd->kr * cd->kc * cd->kz;
+        return backward ? 2.0 * f : f;
+    }
+    if (auto *u = dynamic_cast<LFused *>(l)) {
+        // The backward recomputes the chain
+        f = (double)u->output->size * u->ops.size();
+        return backward ? 2.0 * f : f;
+    }
+
+    // Elementwise estimate
+    return (l->output != nullptr) ? (double)l->output->size : 0.0;
+}
+
+
+/////////////////////////////////////////
+void Net::enable_profiling(bool enable){
+    if (enable) {
+        if (profiler == nullptr) profiler = new Profiler();
+    } else if (profiler != nullptr) {
+        delete profiler;
+        profiler = nullptr;
+    }
+
+    // Every computing service records into the same profiler
+    for (auto n : snets) n->profiler = profiler;
+}
+
+string Net::profile_summary(){
+    if (profiler == nullptr) msg("Profiling is not enabled", "Net::profile_summary");
+    return profiler->summary();
+}
+
+void Net::save_profile(const string &filename){
+    if (profiler == nullptr) msg("Profiling is not enabled", "Net::save_profile");
+    profiler->save_trace(filename);
+}
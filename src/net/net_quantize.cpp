@@ -0,0 +1,209 @@
+/*
+* EDDL Library - European Distributed Deep Learning Library.
+* Version: 0.7
+* copyright (c) 2020, Universidad Politécnica de Valencia (UPV), PRHLT Research Centre
+* Date: April 2020
+* Author: PRHLT Research Centre, UPV, (rparedes@prhlt.upv.es), (jon@prhlt.upv.es)
+* All rights reserved
+*/
+
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <string>
+
+#include "eddl/net/net.h"
+#include "eddl/utils.h"
+#include "eddl/layers/core/layer_core.h"
+#include "eddl/layers/conv/layer_conv.h"
+
+using namespace std;
+
+// Quantized weights (format "int8"):
+//   header   {char magic[8] "EDDLINT8", int version, int n_records}
+//   records  one per param, in the order of the layers: {int kind, int channels, int k, float input_scale}
+//            followed by the data. QUANT_INT8: channels x k int8 weights and channels float scales,
+//            QUANT_FP32: channels x k floats (channels=1, k=size)
+#define QUANT_MAGIC "EDDLINT8"
+#define QUANT_VERSION 1
+#define QUANT_FP32 0
+#define QUANT_INT8 1
+
+struct QuantHeader {
+    char magic[8];
+    int version;
+    int n_records;
+};
+
+struct QuantRecord {
+    int kind;
+    int channels;
+    int k;
+    float input_scale;
+};
+
+// Weights of the layers with an int8 path: Dense W is {k, channels}, Conv K is {channels, k}
+static Tensor *quant_weights(Layer *l, bool &transposed){
+    if (auto *d = dynamic_cast<LDense *>(l)) { transposed = true; return d->W; }
+    if (auto *c = dynamic_cast<LConv *>(l)) {
+        transposed = false;
+        return c->cd->groups == 1 ? c->cd->K : nullptr;  // Grouped convolutions stay in fp32
+    }
+    return nullptr;
+}
+
+
+void Net::quantize(vtensor tin, int batch_size){
+    if (snets[0]->dev != DEV_CPU) msg("INT8 inference is only available on CPU", "Net::quantize");
+    if (isrecurrent) msg("Recurrent nets can not be quantized", "Net::quantize");
+    if (tin.size() != lin.size()) msg("size missmatch in list of tensors", "Net::quantize");
+    if (batch_size <= 0) msg("Wrong batch size", "Net::quantize");
+
+    vector<Layer *> ql;
+    for (auto l : layers) {
+        bool transposed;
+        if (quant_weights(l, transposed) == nullptr) continue;
+        delete l->quant;  // Calibrated in fp32
+        l->quant = nullptr;
+        ql.push_back(l);
+    }
+
+    // Calibration: max |input| of every quantized layer over the samples
+    int m = trmode;
+    setmode(TSMODE);
+    vector<float> amax(ql.size(), 0.0f);
+    int n = tin[0]->shape[0];
+    vind sind(n);
+    for (int i = 0; i < n; i++) sind[i] = i;
+    for (int start = 0; start < n; start += batch_size) {
+        int end = std::min(n, start + batch_size);
+        vtensor X;
+        for (auto t : tin) {
+            vector<int> shape = t->shape;
+            shape[0] = end - start;
+            X.push_back(new Tensor(shape, DEV_CPU));
+            Tensor::select(t, X.back(), sind, start, end);
+        }
+        forward(X);
+        for (int i = 0; i < ql.size(); i++)
+            amax[i] = std::max(amax[i], std::max(ql[i]->input->max(), -ql[i]->input->min()));
+        for (auto t : X) delete t;
+    }
+    setmode(m);
+
+    for (int i = 0; i < ql.size(); i++) {
+        bool transposed;
+        Tensor *W = quant_weights(ql[i], transposed);
+        int channels = transposed ? W->shape[1] : W->shape[0];
+        int k = W->size / channels;
+        float input_scale = amax[i] > 0.0f ? amax[i] / 127.0f : 1.0f;
+        ql[i]->quant = new Quantization(W->ptr, channels, k, transposed, input_scale);
+    }
+    propagate_layout();
+}
+
+
+// The int8 weights, and the kernels of the convolutions lowered for channels last, are stale once the
+// fp32 weights change (a step, a load or an exchange)
+void Net::drop_quantization(){
+    bool dropped = false;
+    for (auto l : layers) {
+        auto *conv = dynamic_cast<LConv *>(l);
+        if (conv != nullptr) conv->cd->Kt_stale = true;
+
+        if (l->quant == nullptr) continue;
+        delete l->quant;
+        l->quant = nullptr;
+        dropped = true;
+    }
+    if (dropped) propagate_layout();
+}
+
+
+void Net::save_int8(const string& filename){
+    vector<pair<Layer *, int>> records;
+    bool quantized = false;
+    for (auto l : layers)
+        for (int j = 0; j < l->params.size(); j++) {
+            records.push_back({l, j});
+            quantized |= l->quant != nullptr;
+        }
+    if (!quantized) msg("The net is not quantized (see quantize)", "Net::save_int8");
+
+    std::ofstream ofs(filename, std::ios::out | std::ios::binary);
+    if (!ofs.good()) msg("Error creating " + filename, "Net::save_int8");
+
+    QuantHeader header;
+    memcpy(header.magic, QUANT_MAGIC, 8);
+    header.version = QUANT_VERSION;
+    header.n_records = records.size();
+    ofs.write(reinterpret_cast<const char *>(&header), sizeof(QuantHeader));
+
+    for (auto &r : records) {
+        Layer *l = r.first;
+        bool transposed;
+        QuantRecord rec;
+        if (l->quant != nullptr && l->params[r.second] == quant_weights(l, transposed)) {
+            Quantization *q = l->quant;
+            rec = {QUANT_INT8, q->channels, q->k, q->input_scale};
+            ofs.write(reinterpret_cast<const char *>(&rec), sizeof(QuantRecord));
+            ofs.write(reinterpret_cast<const char *>(q->weights.data()), q->weights.size());
+            ofs.write(reinterpret_cast<const char *>(q->scales.data()), q->scales.size() * sizeof(float));
+        } else {
+            Tensor *t = l->params[r.second];
+            rec = {QUANT_FP32, 1, (int)t->size, 0.0f};
+            ofs.write(reinterpret_cast<const char *>(&rec), sizeof(QuantRecord));
+            Tensor *c = t->is_contiguous() ? t : Tensor::contiguous(t);
+            ofs.write(reinterpret_cast<const char *>(c->ptr), c->size * sizeof(float));
+            if (c != t) delete c;
+        }
+    }
+    ofs.close();
+}
+
+
+void Net::load_int8(const string& filename){
+    if (snets[0]->dev != DEV_CPU) msg("INT8 inference is only available on CPU", "Net::load_int8");
+
+    std::ifstream ifs(filename, std::ios::in | std::ios::binary);
+    if (!ifs.good()){
+        throw std::runtime_error(std::string("File not found. Check the file name and try again (Net::load_int8)"));
+    }
+
+    int n_params = 0;
+    for (auto l : layers) n_params += l->params.size();
+
+    QuantHeader header;
+    ifs.read(reinterpret_cast<char *>(&header), sizeof(QuantHeader));
+    if (!ifs || strncmp(header.magic, QUANT_MAGIC, 8) != 0 || header.version != QUANT_VERSION)
+        msg("Not a quantized weights file (or unsupported version)", "Net::load_int8");
+    if (header.n_records != n_params) msg("The weights do not match the network", "Net::load_int8");
+
+    for (auto l : layers) {
+        delete l->quant;
+        l->quant = nullptr;
+        for (auto t : l->params) {
+            QuantRecord rec;
+            ifs.read(reinterpret_cast<char *>(&rec), sizeof(QuantRecord));
+            if (!ifs || (long)rec.channels * rec.k != t->size) msg("The weights do not match the network", "Net::load_int8");
+
+            bool transposed;
+            if (rec.kind == QUANT_INT8) {
+                if (t != quant_weights(l, transposed)) msg("The weights do not match the network", "Net::load_int8");
+                auto *q = new Quantization(rec.channels, rec.k, rec.input_scale);
+                ifs.read(reinterpret_cast<char *>(q->weights.data()), q->weights.size());
+                ifs.read(reinterpret_cast<char *>(q->scales.data()), q->scales.size() * sizeof(float));
+                // The fp32 weights are the dequantized ones, for the paths without int8 kernels
+                q->dequantize(t->ptr, transposed);
+                l->quant = q;
+            } else {
+                ifs.read(reinterpret_cast<char *>(t->ptr), t->size * sizeof(float));
+            }
+            if (!ifs) msg("Truncated file", "Net::load_int8");
+        }
+    }
+    ifs.close();
+    propagate_layout();
+}
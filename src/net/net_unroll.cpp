@@ -498,6 +498,10 @@ void Net::build_rnet(int inl,int outl) {
    rnet->plot("rmodel.pdf","LR");
    rnet->name="rnet";
 
+   // Mixed precision of the net (see set_mixed_precision)
+   rnet->mp_storage=mp_storage;
+   for(i=0;i<rnet->layers.size();i++) rnet->layers[i]->set_storage(mp_storage);
+
 
    //getchar();
    //cout<<rnet->summary();
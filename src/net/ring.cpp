@@ -0,0 +1,291 @@
+/*
+* EDDL Library - European Distributed Deep Learning Library.
+* Version: 0.7
+* copyright (c) 2020, Universidad Politécnica de Valencia (UPV), PRHLT Research Centre
+* Date: April 2020
+* Author: PRHLT Research Centre, UPV, (rparedes@prhlt.upv.es), (jon@prhlt.upv.es)
+* All rights reserved
+*/
+
+
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <fcntl.h>
+#include <netdb.h>
+#include <poll.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+#include "eddl/net/ring.h"
+#include "eddl/utils.h"
+
+using namespace std;
+
+
+static void ring_nonblocking(int fd){
+    fcntl(fd, F_SETFL, fcntl(fd, F_GETFL, 0) | O_NONBLOCK);
+}
+
+// Address of a rank: "prefix.rank" for unix sockets, "host:port" for tcp
+static int ring_socket(const string &transport, const string &address, bool listening,
+                       struct sockaddr_storage &sa, socklen_t &len){
+    memset(&sa, 0, sizeof(sa));
+    if (transport == "unix") {
+        auto *su = (struct sockaddr_un *)&sa;
+        if (address.size() >= sizeof(su->sun_path)) msg("Socket path too long: " + address, "Ring");
+        su->sun_family = AF_UNIX;
+        strcpy(su->sun_path, address.c_str());
+        len = sizeof(struct sockaddr_un);
+        return socket(AF_UNIX, SOCK_STREAM, 0);
+    }
+
+    size_t colon = address.rfind(':');
+    if (colon == string::npos) msg("Expected host:port, found " + address, "Ring");
+    string host = address.substr(0, colon);
+    string port = address.substr(colon + 1);
+
+    struct addrinfo hints, *res;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_STREAM;
+    if (listening) hints.ai_flags = AI_PASSIVE;
+    if (getaddrinfo(listening ? nullptr : host.c_str(), port.c_str(), &hints, &res) != 0)
+        msg("Unknown host " + address, "Ring");
+    memcpy(&sa, res->ai_addr, res->ai_addrlen);
+    len = res->ai_addrlen;
+    freeaddrinfo(res);
+
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    int one = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    if (listening) setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    return fd;
+}
+
+
+Ring::Ring(int rank, int world, const string &transport, const vector<string> &addresses, int timeout){
+    this->rank = rank;
+    this->world = world;
+    this->timeout = timeout;
+    fd_next = fd_prev = -1;
+    pending = 0;
+    stop = false;
+
+    if (rank < 0 || rank >= world) msg("Rank " + to_string(rank) + " out of range", "Ring");
+    if (world > 1) connect_ring(transport, addresses);
+
+    worker = thread(&Ring::run, this);
+}
+
+Ring::~Ring(){
+    {
+        unique_lock<mutex> lock(mtx);
+        stop = true;
+    }
+    cv.notify_all();
+    worker.join();
+
+    if (fd_next >= 0) close(fd_next);
+    if (fd_prev >= 0) close(fd_prev);
+    if (!socket_path.empty()) unlink(socket_path.c_str());
+}
+
+void Ring::connect_ring(const string &transport, const vector<string> &addresses){
+    if (transport != "unix" && transport != "tcp") msg("Unknown transport " + transport + " (unix or tcp)", "Ring");
+    if (transport == "unix" && addresses.size() != 1) msg("Expected the prefix of the socket files", "Ring");
+    if (transport == "tcp" && addresses.size() != world) msg("Expected host:port of each rank", "Ring");
+
+    auto address = [&](int r) {
+        return transport == "unix" ? addresses[0] + "." + to_string(r) : addresses[r];
+    };
+    int next = (rank + 1) % world;
+    int prev = (rank + world - 1) % world;
+
+    // Listen for the previous rank
+    struct sockaddr_storage sa;
+    socklen_t len;
+    int fd_listen = ring_socket(transport, address(rank), true, sa, len);
+    if (transport == "unix") {
+        socket_path = address(rank);
+        unlink(socket_path.c_str());
+    }
+    if (fd_listen < 0 || ::bind(fd_listen, (struct sockaddr *)&sa, len) != 0 || listen(fd_listen, 1) != 0)
+        msg("Cannot listen on " + address(rank) + ": " + strerror(errno), "Ring");
+
+    // Connect to the next one, which may not be listening yet
+    auto start = chrono::steady_clock::now();
+    while (true) {
+        fd_next = ring_socket(transport, address(next), false, sa, len);
+        if (connect(fd_next, (struct sockaddr *)&sa, len) == 0) break;
+        close(fd_next);
+        if (chrono::steady_clock::now() - start > chrono::seconds(timeout))
+            msg("Cannot connect to rank " + to_string(next) + " at " + address(next), "Ring");
+        this_thread::sleep_for(chrono::milliseconds(10));
+    }
+    if (write(fd_next, &rank, sizeof(int)) != sizeof(int)) msg("Cannot write to rank " + to_string(next), "Ring");
+
+    struct pollfd pfd = {fd_listen, POLLIN, 0};
+    if (poll(&pfd, 1, timeout * 1000) <= 0) msg("Rank " + to_string(prev) + " did not connect", "Ring");
+    fd_prev = accept(fd_listen, nullptr, nullptr);
+    close(fd_listen);
+    if (!socket_path.empty()) {
+        unlink(socket_path.c_str());  // Connected, the file is no longer needed
+        socket_path.clear();
+    }
+
+    int peer = -1;
+    if (fd_prev < 0 || read(fd_prev, &peer, sizeof(int)) != sizeof(int) || peer != prev)
+        msg("Unexpected connection (rank " + to_string(peer) + ")", "Ring");
+
+    ring_nonblocking(fd_next);
+    ring_nonblocking(fd_prev);
+}
+
+// Sends to the next rank while receiving from the previous one
+void Ring::sendrecv(const char *sbuf, size_t sbytes, char *rbuf, size_t rbytes){
+    size_t sent = 0, received = 0;
+    while (sent < sbytes || received < rbytes) {
+        struct pollfd pfd[2];
+        int n = 0;
+        if (sent < sbytes) pfd[n++] = {fd_next, POLLOUT, 0};
+        if (received < rbytes) pfd[n++] = {fd_prev, POLLIN, 0};
+        int r = poll(pfd, n, timeout * 1000);
+        if (r == 0) msg("Timeout waiting for the ring", "Ring");
+        if (r < 0) {
+            if (errno == EINTR) continue;
+            msg(string("Poll error: ") + strerror(errno), "Ring");
+        }
+
+        for (int i = 0; i < n; i++) {
+            if (pfd[i].revents == 0) continue;
+            ssize_t k;
+            if (pfd[i].fd == fd_next && sent < sbytes) {
+                k = send(fd_next, sbuf + sent, sbytes - sent, MSG_NOSIGNAL);
+                if (k > 0) sent += k;
+            } else {
+                k = recv(fd_prev, rbuf + received, rbytes - received, 0);
+                if (k == 0) msg("Rank " + to_string((rank + world - 1) % world) + " closed the connection", "Ring");
+                if (k > 0) received += k;
+            }
+            if (k < 0 && errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+                msg(string("Socket error: ") + strerror(errno), "Ring");
+        }
+    }
+}
+
+void Ring::allreduce(float *data, long size){
+    if (world == 1 || size == 0) return;
+
+    // Chunk c is [c * size / world, (c + 1) * size / world)
+    auto first = [&](int c) { return (long)c * size / world; };
+    auto count = [&](int c) { return first(c + 1) - first(c); };
+    recv_buffer.resize(count(0) + 1);
+
+    // Reduce-scatter: after world-1 steps, rank r has the sum of chunk r+1
+    for (int s = 0; s < world - 1; s++) {
+        int cs = (rank - s + world) % world;
+        int cr = (rank - s - 1 + world) % world;
+        sendrecv((const char *)(data + first(cs)), count(cs) * sizeof(float),
+                 (char *)recv_buffer.data(), count(cr) * sizeof(float));
+        float *dst = data + first(cr);
+        long n = count(cr);
+        for (long i = 0; i < n; i++) dst[i] += recv_buffer[i];
+    }
+
+    // All-gather: the reduced chunks go around the ring
+    for (int s = 0; s < world - 1; s++) {
+        int cs = (rank + 1 - s + world) % world;
+        int cr = (rank - s + world) % world;
+        sendrecv((const char *)(data + first(cs)), count(cs) * sizeof(float),
+                 (char *)(data + first(cr)), count(cr) * sizeof(float));
+    }
+}
+
+void Ring::broadcast(float *data, long size, int root){
+    if (world == 1 || size == 0) return;
+
+    // Received from the previous rank, and passed to the next one (unless it is the root)
+    size_t bytes = size * sizeof(float);
+    if (rank != root) sendrecv(nullptr, 0, (char *)data, bytes);
+    if ((rank + 1) % world != root) sendrecv((const char *)data, bytes, nullptr, 0);
+}
+
+
+void Ring::post(const vector<Tensor *> &tensors){
+    vector<Tensor *> ts;
+    {
+        unique_lock<mutex> lock(mtx);
+        for (auto t : tensors)
+            if (posted.insert(t).second) ts.push_back(t);
+        if (ts.empty()) return;
+        queue.push_back(ts);
+        pending++;
+    }
+    cv.notify_all();
+}
+
+void Ring::wait(){
+    unique_lock<mutex> lock(mtx);
+    cv.wait(lock, [this] { return pending == 0; });
+    posted.clear();
+    if (!error.empty()) {
+        string e = error;
+        error.clear();
+        msg(e, "Ring");
+    }
+}
+
+// The tensors of a post are averaged as a single bucket
+void Ring::run(){
+    while (true) {
+        vector<Tensor *> ts;
+        bool failed;
+        {
+            unique_lock<mutex> lock(mtx);
+            cv.wait(lock, [this] { return stop || !queue.empty(); });
+            if (queue.empty()) return;
+            ts = queue.front();
+            queue.pop_front();
+            failed = !error.empty();
+        }
+
+        if (!failed) {
+            try {
+                long size = 0;
+                for (auto t : ts) size += t->size;
+                bucket.resize(size);
+
+                long offset = 0;
+                for (auto t : ts) {
+                    memcpy(bucket.data() + offset, t->ptr, t->size * sizeof(float));
+                    offset += t->size;
+                }
+                allreduce(bucket.data(), size);
+
+                float scale = 1.0f / world;
+                offset = 0;
+                for (auto t : ts) {
+                    for (long i = 0; i < t->size; i++) t->ptr[i] = bucket[offset + i] * scale;
+                    offset += t->size;
+                }
+            } catch (std::exception &e) {
+                unique_lock<mutex> lock(mtx);
+                error = e.what();
+            }
+        }
+
+        {
+            unique_lock<mutex> lock(mtx);
+            pending--;
+        }
+        cv.notify_all();
+    }
+}
@@ -7,6 +7,8 @@
 * All rights reserved
 */
 
+#include <algorithm>
+#include <cmath>
 #include <cstdio>
 #include <cstdlib>
 #include <iostream>
@@ -19,6 +21,10 @@ using namespace std;
 Optimizer::Optimizer() {
   isshared=false;
   clip_val=-1;
+  loss_scale=1.0f;
+  dynamic_scale=false;
+  scale_window=2000;
+  good_steps=0;
 }
 
 void Optimizer::set_clip_val(float v)
@@ -26,6 +32,68 @@ void Optimizer::set_clip_val(float v)
   clip_val=v;
 }
 
+void Optimizer::get_decay(Layer *l, int j, float &l1, float &l2)
+{
+  l1 = l2 = 0.0f;
+  if (l->reg == nullptr || j >= l->reg_params) return;
+
+  l1 = l->reg->l1;
+  l2 = l->reg->l2;
+}
+
+void Optimizer::set_loss_scale(float scale, bool dynamic, int window)
+{
+  if (scale <= 0.0f) msg("The loss scale must be > 0", "Optimizer::set_loss_scale");
+  if (window < 1) msg("The scale window must be >= 1", "Optimizer::set_loss_scale");
+
+  loss_scale=scale;
+  dynamic_scale=dynamic;
+  scale_window=window;
+  good_steps=0;
+}
+
+float Optimizer::get_loss_scale()
+{
+  if (isshared) return orig->get_loss_scale();
+  return loss_scale;
+}
+
+// Every element is finite (the sum of large finite values may overflow)
+static bool all_finite(Tensor *A)
+{
+  Tensor *B = Tensor::empty_like(A);
+  Tensor::isfinite(A, B);
+  bool finite = Tensor::all(B);
+  delete B;
+  return finite;
+}
+
+bool Optimizer::unscale()
+{
+  if (isshared) return orig->unscale();
+  if (loss_scale == 1.0f && !dynamic_scale) return true;
+
+  if (dynamic_scale) {
+    for (int i = 0; i < layers.size(); i++)
+      for (int j = 0; j < layers[i]->get_trainable_params_count(); j++)
+        if (!all_finite(layers[i]->gradients[j])) {
+          loss_scale = std::max(loss_scale / 2.0f, 1.0f);
+          good_steps = 0;
+          return false;
+        }
+  }
+
+  for (int i = 0; i < layers.size(); i++)
+    for (int j = 0; j < layers[i]->get_trainable_params_count(); j++)
+      layers[i]->gradients[j]->mult_(1.0f / loss_scale);
+
+  if (dynamic_scale && ++good_steps >= scale_window) {
+    loss_scale *= 2.0f;
+    good_steps = 0;
+  }
+  return true;
+}
+
 void Optimizer::clip()
 {
   if (clip_val<0) return;
@@ -12,6 +12,7 @@
 #include <iostream>
 
 #include "eddl/optimizers/optim.h"
+#include "eddl/tensor/nn/tensor_nn.h"
 
 using namespace std;
 
@@ -53,6 +54,21 @@ Optimizer *Adam::share() {
     n->clip_val=clip_val;
     return n;
 }
+vtensor Adam::get_state() {
+    // mCap and vCap are scratch tensors
+    vtensor state(mT);
+    state.insert(state.end(), vT.begin(), vT.end());
+    return state;
+}
+
+vector<int> Adam::get_counters() {
+    return {t};
+}
+
+void Adam::set_counters(const vector<int> &c) {
+    if (c.size()>0) t = c[0];
+}
+
 void Adam::setlayers(vlayer l) {
     layers = l;
 
@@ -65,10 +81,15 @@ void Adam::setlayers(vlayer l) {
             mT.back()->fill_(0.0);
             vT.push_back(new Tensor(layers[i]->gradients[j]->getShape(), layers[i]->dev));
             vT.back()->fill_(0.0);
-            mCap.push_back(new Tensor(layers[i]->gradients[j]->getShape(), layers[i]->dev));
-            mCap.back()->fill_(0.0);
-            vCap.push_back(new Tensor(layers[i]->gradients[j]->getShape(), layers[i]->dev));
-            vCap.back()->fill_(0.0);
+
+            // Scratch tensors, only needed where the update is not fused
+            if (layers[i]->dev != DEV_CPU) {
+                mCap.push_back(new Tensor(layers[i]->gradients[j]->getShape(), layers[i]->dev));
+                vCap.push_back(new Tensor(layers[i]->gradients[j]->getShape(), layers[i]->dev));
+            } else {
+                mCap.push_back(nullptr);
+                vCap.push_back(nullptr);
+            }
         }
 
 }
@@ -84,21 +105,10 @@ void Adam::applygrads(int batch) {
     for (int i = 0; i < layers.size(); i++)
       if (layers[i]->trainable) {
         for (int j = 0; j < layers[i]->get_trainable_params_count(); j++, p++) {
-            Tensor::add(beta_1,mT[p],(1-beta_1),layers[i]->gradients[j],mT[p],0);
-            layers[i]->gradients[j]->sqr_();
-            Tensor::add(beta_2,vT[p],(1-beta_2),layers[i]->gradients[j],vT[p],0);
-
-            Tensor::copy(mT[p],mCap[p]);
-            mCap[p]->div_(1-pow(beta_1,t));
-
-            Tensor::copy(vT[p],vCap[p]);
-            vCap[p]->div_(1-pow(beta_2,t));
-            vCap[p]->add_(epsilon);
-            vCap[p]->sqrt_();
-
-            Tensor::el_div(mCap[p],vCap[p],mCap[p],0);
-
-            Tensor::add(-lr, mCap[p],1.0,layers[i]->params[j], layers[i]->params[j], 0);
+            float l1, l2;
+            get_decay(layers[i], j, l1, l2);
+            tensorNN::adam_step(layers[i]->params[j], layers[i]->gradients[j], mT[p], vT[p], mCap[p], vCap[p],
+                                lr, beta_1, beta_2, epsilon, t, l1, l2);
         }
     }
     else p+=layers[i]->get_trainable_params_count();
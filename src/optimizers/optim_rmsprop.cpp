@@ -12,6 +12,7 @@
 #include <iostream>
 
 #include "eddl/optimizers/optim.h"
+#include "eddl/tensor/nn/tensor_nn.h"
 
 using namespace std;
 
@@ -49,6 +50,11 @@ Optimizer *RMSProp::share() {
     n->clip_val=clip_val;
     return n;
 }
+vtensor RMSProp::get_state() {
+    // gT1 keeps the gradient of the previous step, gT is a scratch tensor
+    return gT1;
+}
+
 void RMSProp::setlayers(vlayer l) {
     layers = l;
 
@@ -59,8 +65,10 @@ void RMSProp::setlayers(vlayer l) {
         for (int j = 0; j < layers[i]->get_trainable_params_count(); j++) {
             gT1.push_back(new Tensor(layers[i]->gradients[j]->getShape(), layers[i]->dev));
             gT1.back()->fill_(0.0);
-            gT.push_back(new Tensor(layers[i]->gradients[j]->getShape(), layers[i]->dev));
-            gT.back()->fill_(0.0);
+
+            // Scratch tensor, only needed where the update is not fused
+            if (layers[i]->dev != DEV_CPU) gT.push_back(new Tensor(layers[i]->gradients[j]->getShape(), layers[i]->dev));
+            else gT.push_back(nullptr);
         }
 
 }
@@ -77,26 +85,9 @@ void RMSProp::applygrads(int batch) {
     for (int i = 0; i < layers.size(); i++)
       if (layers[i]->trainable) {
         for (int j = 0; j < layers[i]->get_trainable_params_count(); j++, p++) {
-            Tensor::copy(layers[i]->gradients[j],gT[p]);
-            gT[p]->sqr_();
-            gT[p]->mult_(1.0f-rho);
-
-            gT1[p]->sqr_();
-            gT1[p]->mult_(rho);
-            Tensor::add(1.0,gT1[p],1.0,gT[p],gT[p],0);
-
-            gT[p]->add_(epsilon);
-            gT[p]->sqrt_();
-            Tensor::el_div(layers[i]->gradients[j],gT[p],gT[p],0);
-
-            Tensor::copy(layers[i]->gradients[j],gT1[p]);
-
-            Tensor::add(-lr, gT[p],1.0,layers[i]->params[j], layers[i]->params[j], 0);
-
-      			/*if (layers[i]->acc_gradients.size() > 0) {
-        				Tensor::add(-lr, gT[p],1.0,layers[i]->acc_gradients[j], layers[i]->acc_gradients[j], 0);
-      			}
-            */
+            float l1, l2;
+            get_decay(layers[i], j, l1, l2);
+            tensorNN::rmsprop_step(layers[i]->params[j], layers[i]->gradients[j], gT1[p], gT[p], lr, rho, epsilon, l1, l2);
         }
     }
     else p+=layers[i]->get_trainable_params_count();
@@ -12,6 +12,7 @@
 #include <iostream>
 
 #include "eddl/optimizers/optim.h"
+#include "eddl/tensor/nn/tensor_nn.h"
 
 using namespace std;
 
@@ -48,6 +49,10 @@ Optimizer *SGD::share() {
     return n;
 }
 
+vtensor SGD::get_state() {
+    return mT;
+}
+
 void SGD::setlayers(vlayer l) {
     layers = l;
 
@@ -73,8 +78,9 @@ void SGD::applygrads(int batch) {
       for (int i = 0; i < layers.size(); i++) {
         if (layers[i]->trainable) {
           for (int j = 0; j < layers[i]->get_trainable_params_count(); j++, p++) {
-            Tensor::add(lr , layers[i]->gradients[j], mu, mT[p], mT[p], 0);
-            Tensor::add(1.0, layers[i]->params[j], -1.0, mT[p], layers[i]->params[j], 0);
+            float l1, l2;
+            get_decay(layers[i], j, l1, l2);
+            tensorNN::sgd_step(layers[i]->params[j], layers[i]->gradients[j], mT[p], lr, mu, l1, l2);
           }
         }
         else p+=layers[i]->get_trainable_params_count();
@@ -9,6 +9,7 @@
 #include <cstdio>
 #include <cmath>
 #include <random>
+#include <sstream>
 
 #include "eddl/random.h"
 #include "eddl/utils.h"
@@ -31,6 +32,10 @@ float uniform(float min, float max) {
     return distr(gen);
 }
 
+int rand_int() {
+    return (int)(gen() >> 1);
+}
+
 float signed_uniform() {
     return (2.0 * uniform()) - 1.0;
 }
@@ -66,3 +71,16 @@ float fast_randn(float mean, float sd, int seed) {
     if (posTable<0) posTable=-posTable;
     return (RTable[posTable] * sd) + mean;
 }
+
+std::string get_rng_state() {
+    // Read only: saving the state does not change the sequence
+    std::ostringstream oss;
+    oss << posTable << " " << gen;
+    return oss.str();
+}
+
+void set_rng_state(const std::string &state) {
+    std::istringstream iss(state);
+    iss >> posTable >> gen;
+    if (iss.fail()) msg("Invalid random state", "set_rng_state");
+}
@@ -16,7 +16,13 @@
 
 using namespace std;
 
-Regularizer::Regularizer(string name) {
+Regularizer::Regularizer(string name, float l1, float l2) {
     this->name = name;
+    this->l1 = l1;
+    this->l2 = l2;
+}
+
+void Regularizer::apply(Tensor *T) {
+    Tensor::regularize(T, T, this->l1, this->l2);
 }
 
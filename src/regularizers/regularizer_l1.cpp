@@ -17,15 +17,5 @@
 using namespace std;
 
 
-RL1::RL1(float l1) : Regularizer("l1") {
-    this->l1 = l1;
-}
-
-void RL1::apply(Tensor* T) {
-    Tensor *S = T->clone();
-
-    S->sign_();
-    Tensor::add(1.0f, T, -this->l1, S, T, 0);
-
-    delete S;
+RL1::RL1(float l1) : Regularizer("l1", l1, 0.0f) {
 }
@@ -17,20 +17,5 @@
 using namespace std;
 
 
-RL1L2::RL1L2(float l1, float l2) : Regularizer("l1_l2") {
-    this->l1 = l1;
-    this->l2 = l2;
-}
-
-void RL1L2::apply(Tensor* T) {
-  Tensor *S = T->clone();
-  Tensor *A = T->clone();
-
-  S->sign_();
-  Tensor::add(1.0f, T, -this->l1, S, T, 0);
-
-  Tensor::add(1.0f, T, -this->l2, A, T, 0);
-
-  delete A;
-  delete S;
+RL1L2::RL1L2(float l1, float l2) : Regularizer("l1_l2", l1, l2) {
 }
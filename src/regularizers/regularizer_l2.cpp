@@ -17,14 +17,5 @@
 using namespace std;
 
 
-RL2::RL2(float l2) : Regularizer("l2") {
-    this->l2 = l2;
-}
-
-void RL2::apply(Tensor* T) {
-    Tensor *B = T->clone();
-
-    Tensor::add(1.0f, T, -this->l2, B, T, 0);
-
-    delete B;
+RL2::RL2(float l2) : Regularizer("l2", 0.0f, l2) {
 }
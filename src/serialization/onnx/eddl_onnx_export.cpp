@@ -355,7 +355,7 @@ using namespace std;
 		onnx::AttributeProto* conv_group = node->add_attribute();
 		conv_group->set_name( "group" );
 		conv_group->set_type( onnx::AttributeProto::INT );
-		conv_group->set_i( 1 ); // ????????????????????????????????????????????????????
+		conv_group->set_i( layer->cd->groups );
 		// Attr kernel_shape
 		onnx::AttributeProto* conv_kernel_shape = node->add_attribute();
 		conv_kernel_shape->set_name( "kernel_shape" );
@@ -9,7 +9,6 @@
 #include <set>
 #include <algorithm>
 
-#define NEW_FROM_VECTOR_PTR(v) (copy((v)->begin(), (v)->end(), new float[(v)->size()]) - (v)->size())
 std::vector<int> vf2vi(const std::vector<float>& vf)
 {
     std::vector<int> vi;
@@ -22,14 +21,20 @@ std::vector<int> vf2vi(const std::vector<float>& vf)
 
 #if defined(cPROTO)
 #include "onnx.pb.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <climits>
+#include <cstring>
+#include <google/protobuf/io/coded_stream.h>
+#include <google/protobuf/io/zero_copy_stream_impl.h>
 #endif
 
 #if defined(cPROTO)
-	Net* build_net_onnx(onnx::ModelProto model, int mem);
+	Net* build_net_onnx(const onnx::ModelProto &model, int mem);
 #endif
 
 #if defined(cPROTO)
-	map<string, vector<Tensor*> > get_tensors_from_onnx(onnx::ModelProto model);
+	map<string, vector<Tensor*> > get_tensors_from_onnx(const onnx::ModelProto &model);
 #endif
 
 
@@ -82,12 +87,92 @@ using namespace std;
 
 
 	int verbose=0;
-	//Gets the initializers from the onnx layer graph
-	vector<onnx::TensorProto> get_initializers(onnx::GraphProto graph) {
-		vector<onnx::TensorProto> initializers;
-		for(int i = 0; i < graph.initializer_size(); i++) initializers.push_back(graph.initializer(i));
-		return initializers;
-	}
+
+	vector<float> parseTensorValues(const onnx::TensorProto &t);
+
+	//Initializers of the graph, indexed by name. The tensors are not copied out of the model: the weights
+	//are copied once, from the proto to the tensors of the net, and only the ones used as values (shapes,
+	//scales) are converted to vectors, when they are first accessed.
+	class OnnxInitializers {
+	public:
+		map<string, const onnx::TensorProto*> protos;
+		map<string, vector<float>> values;
+
+		explicit OnnxInitializers(const onnx::GraphProto &graph) {
+			for(int i = 0; i < graph.initializer_size(); i++) protos[graph.initializer(i).name()] = &graph.initializer(i);
+		}
+
+		size_t count(const string &name) const {
+			return protos.count(name) || values.count(name);
+		}
+
+		//Values of the initializer, converted on first access (empty for unknown names, like a map)
+		vector<float>& operator[](const string &name) {
+			auto it = values.find(name);
+			if(it != values.end()) return it->second;
+
+			auto p = protos.find(name);
+			if(p != protos.end()) return values[name] = parseTensorValues(*p->second);
+			return values[name];
+		}
+
+		//Makes name refer to the data of another initializer (reshaped parameters)
+		void alias(const string &name, const string &src) {
+			if(values.count(src)) values[name] = values[src];
+			else protos[name] = protos[src];
+		}
+
+		//Copies the values of the initializer to a tensor of the same size. Float data is copied straight
+		//from the proto (raw_data or float_data) to the tensor
+		void copy_to(const string &name, Tensor *dst) {
+			const float *src = nullptr;
+			size_t size = 0;
+
+			auto p = protos.find(name);
+			const onnx::TensorProto *t = (p != protos.end() && !values.count(name)) ? p->second : nullptr;
+			if(t != nullptr && t->data_type() == onnx::TensorProto::FLOAT && t->has_raw_data()) {
+				src = reinterpret_cast<const float *>(t->raw_data().data());
+				size = t->raw_data().size() / sizeof(float);
+			}
+			else if(t != nullptr && t->data_type() == onnx::TensorProto::FLOAT) {
+				src = t->float_data().data();
+				size = t->float_data_size();
+			}
+			else {
+				if(!count(name)) msg("Initializer " + name + " not found", "ONNX::ImportNet");
+				vector<float> &v = (*this)[name];
+				src = v.data();
+				size = v.size();
+			}
+			if(size != dst->size) msg("Initializer " + name + " has " + to_string(size) + " values, expected " + to_string(dst->size), "ONNX::ImportNet");
+
+			if(dst->isCPU()) {
+				memcpy(dst->ptr, src, size * sizeof(float));
+			}
+			else {
+				Tensor view(dst->shape, const_cast<float *>(src), DEV_CPU);
+				view.isview = true;
+				Tensor::copy(&view, dst);
+			}
+		}
+
+		//New tensor with the values of the initializer
+		Tensor* new_tensor(const string &name, const vector<int> &shape, int dev) {
+			Tensor *t = new Tensor(shape, dev);
+			copy_to(name, t);
+			return t;
+		}
+
+		//Shape of the initializer
+		vector<int> dims(const string &name) {
+			vector<int> dims;
+			auto p = protos.find(name);
+			if(p != protos.end()) {
+				for(int i = 0; i < p->second->dims_size(); i++) dims.push_back(p->second->dims(i));
+			}
+			return dims;
+		}
+	};
 
 	//Creates a map containing the name of the node as a key, and the value is a vector containing the nodes that have this node as a input.
 	map<string, vector<onnx::NodeProto*>> initialize_input_node_map(vector<onnx::NodeProto> &nodes){
@@ -194,17 +279,15 @@ using namespace std;
 		}
 
 		size_t num_elements = raw_size / sizeof(T);
-		printf("Converting tensor values\n");
 		const void* src_ptr = static_cast<const void*>(onnx_tensor.raw_data().data());
 		field.resize(num_elements, 0);
 		void* target_ptr = static_cast<void*>(field.data());
 		memcpy(target_ptr, src_ptr, raw_size);
-		printf("Tensor values converted succesfully\n");
 		return true;
 	}
 
 	//Parses the values of the onnx tensor to a c++ vector of that type
-	vector<float> parseTensorValues(onnx::TensorProto t){
+	vector<float> parseTensorValues(const onnx::TensorProto &t){
 		int data_type = t.data_type(); //Only works for non raw data for now
 		vector<float> values;
 		switch(data_type){
@@ -298,24 +381,16 @@ using namespace std;
 
 	}
 
-	//Creates two maps. Both have the name of the initializer node as key. The values are a vector containing the weights and a vector containing the shape of the vector, respectively.
-	void get_initializers_maps(vector<onnx::TensorProto> tensors, map<string, vector<float> > &values_map, map<string, vector<int> > &dims_map) {
-
-		for(onnx::TensorProto tensor : tensors){
+	//Creates a map with the name of the initializer node as key and the shape of the tensor as value.
+	void get_initializers_dims(const onnx::GraphProto &graph, map<string, vector<int> > &dims_map) {
+		for(int i = 0; i < graph.initializer_size(); i++){
+			const onnx::TensorProto &tensor = graph.initializer(i);
 			vector<int> dims;
-			for(int i = 0; i < tensor.dims_size(); i++) {
-				dims.push_back(tensor.dims(i));
+			for(int j = 0; j < tensor.dims_size(); j++) {
+				dims.push_back(tensor.dims(j));
 			}
-			string tensorName = tensor.name();
-			vector<float> values = parseTensorValues(tensor);
-
-
-			values_map[tensorName] = values;
-			dims_map[tensorName] = dims;
-
-
+			dims_map[tensor.name()] = dims;
 		}
-		return;
 	}
 
 	//Parses one TensorProto pointer (Input or output) to eddl Tensor pointer
@@ -354,7 +429,7 @@ using namespace std;
 	}
 
 	//Returns a vector with the input names of the net
-	vector<onnx::ValueInfoProto> get_inputs(onnx::GraphProto graph){
+	vector<onnx::ValueInfoProto> get_inputs(const onnx::GraphProto &graph){
 		set<string> input_names;
 		set<string> initializer_names;//We make the substraction of both sets to find the true inputs
 
@@ -362,9 +437,9 @@ using namespace std;
 			input_names.insert(graph.input(i).name());
 		}
 
-		vector<onnx::TensorProto> initializers = get_initializers(graph); for(int i = 0; i < initializers.size(); i++){ //Construct set of initializer names
-			if(initializers[i].has_name())
-				initializer_names.insert(initializers[i].name());
+		for(int i = 0; i < graph.initializer_size(); i++){ //Construct set of initializer names
+			if(graph.initializer(i).has_name())
+				initializer_names.insert(graph.initializer(i).name());
 		}
 
 		vector<string> true_inputs(100);
@@ -383,7 +458,7 @@ using namespace std;
 
 
 	//Returns a vector containing the output names of the net
-	vector<string> get_outputs(onnx::GraphProto graph){
+	vector<string> get_outputs(const onnx::GraphProto &graph){
 		vector<string> output_names;
 
 		for(int i = 0; i < graph.output_size(); i++){ //Construct set of output names
@@ -393,11 +468,11 @@ using namespace std;
 	}
 
 	//Returns a vector containing all nodes of the graph in onnx containers.
-	vector<onnx::NodeProto> get_graph_nodes(onnx::GraphProto graph) {
+	vector<onnx::NodeProto> get_graph_nodes(const onnx::GraphProto &graph) {
 		vector<onnx::NodeProto> nodes;
+		nodes.reserve(graph.node_size());
 		for( int i = 0; i < graph.node_size(); i++) {
-			onnx::NodeProto node = graph.node(i);
-			nodes.push_back(node);
+			nodes.push_back(graph.node(i));
 		}
 
 		return nodes;
@@ -412,12 +487,25 @@ using namespace std;
 		onnx::ModelProto model;
 
 		{
-			// Read the existing net.
-			fstream input(path , ios::in | ios::binary);
-			if (!model.ParseFromIstream(&input)) {
-				cerr << "Failed to parse model." << endl;
-				//return;
+			// Read the existing net. The file is parsed as a stream, without loading it in memory first.
+			// Protobuf messages cannot exceed 2GB, so INT_MAX is the largest model that can be read;
+			// initializers stored as ONNX external data are not supported
+			int fd = open(path.c_str(), O_RDONLY);
+			if (fd < 0) {
+				msg("Cannot open " + path, "ONNX::ImportNet");
+			}
+			bool parsed;
+			{
+				google::protobuf::io::FileInputStream file_stream(fd);
+				file_stream.SetCloseOnDelete(true);
+				google::protobuf::io::CodedInputStream coded_stream(&file_stream);
+				coded_stream.SetTotalBytesLimit(INT_MAX);
+				parsed = model.ParseFromCodedStream(&coded_stream) && coded_stream.ConsumedEntireMessage();
 			}
+			if (!parsed) {
+				msg("Failed to parse " + path + " (ONNX files are limited to 2GB)", "ONNX::ImportNet");
+			}
+			else if (verbose >= 2) cout << "Model parsed succesfuly" << endl;
 		}
 		return build_net_onnx(model, mem);
 	}
@@ -455,7 +543,7 @@ using namespace std;
 
 
 	//Builds a eddl Net from an instance of the onnx container for model
-	Net* build_net_onnx(onnx::ModelProto model, int mem){
+	Net* build_net_onnx(const onnx::ModelProto &model, int mem){
 
 		long long int ir_version = model.ir_version();
 		// We have to check if the imported net has the
@@ -476,21 +564,17 @@ using namespace std;
 		cout << "Domain: " << model.domain() << endl;
 		cout << "Model_version: " << model.model_version() << endl;
 		int counter = 0;
-		onnx::GraphProto graph = model.graph(); //Get the graph of the model.
+		const onnx::GraphProto &graph = model.graph(); //Get the graph of the model.
 		//Model needs input in the constructor, so we start with that.
 
 		vector<onnx::ValueInfoProto> inputs_onnx = get_inputs(graph); //Get the inputs
 
 		vector<Layer*> inputs =  parse_IO_tensors(inputs_onnx, mem); //Parse ONNX inputs to EDDL inputs
 
-		vector<onnx::TensorProto> initializers = get_initializers(graph); // Retrieves the initializers from the graph.
-																		  // The weight for the layers can be found in the initializers.
-
-		map<string, vector<float>> map_init_values;
+		OnnxInitializers map_init_values(graph); // Retrieves the initializers from the graph.
+												 // The weight for the layers can be found in the initializers.
 		map<string, vector<int>>   map_init_dims;
-		get_initializers_maps(initializers, map_init_values, map_init_dims);// Creates 2 maps
-																			//  Key: Input Name . Value: Weights
-																			//  Key: Input Name . Value: Dims
+		get_initializers_dims(graph, map_init_dims); //  Key: Input Name . Value: Dims
 		vector<onnx::NodeProto> nodes = get_graph_nodes(graph);
 		//The methodology is the following:
 		//We create three maps:
@@ -619,20 +703,9 @@ using namespace std;
 						vector<int> parent_shape = parent->output->shape;
 
 						string scale_name = node->input(1); // Scale parameter
-						vector<float>* scale_weights = &(map_init_values[scale_name]);
-						vector<int> scale_dims = map_init_dims[scale_name];
-
 						string bias_name = node->input(2); // Bias parameter
-						vector<float>* bias_weights = &(map_init_values[bias_name]);
-						vector<int> bias_dims = map_init_dims[bias_name];
-
-						string mean_name = node->input(3); //Get weights and dims
-						vector<float>* mean_weights = &(map_init_values[mean_name]);
-						vector<int> mean_dims = map_init_dims[mean_name];
-
-						string variance_name = node->input(4); //Get weights and dims
-						vector<float>* variance_weights = &(map_init_values[variance_name]);
-						vector<int> variance_dims = map_init_dims[variance_name];
+						string mean_name = node->input(3); //Get weights
+						string variance_name = node->input(4); //Get weights
 
 						string name = node->name();
 
@@ -640,21 +713,10 @@ using namespace std;
 
 						actual_layer = new LBatchNorm(parent, momentum, epsilon, affine, name, dev, mem);
 
-						Tensor* scale_tensor = new Tensor(scale_dims, NEW_FROM_VECTOR_PTR(scale_weights), dev);
-						Tensor::copy(scale_tensor, ((LBatchNorm *)(actual_layer))->bn_g);
-						delete scale_tensor;
-
-						Tensor* bias_tensor = new Tensor(bias_dims, NEW_FROM_VECTOR_PTR(bias_weights), dev);
-						Tensor::copy(bias_tensor, ((LBatchNorm *)(actual_layer))->bn_b);
-						delete bias_tensor;
-
-						Tensor* mean_tensor = new Tensor(mean_dims, NEW_FROM_VECTOR_PTR(mean_weights), dev);
-						Tensor::copy(mean_tensor, ((LBatchNorm *)(actual_layer))->mean);
-						delete mean_tensor;
-
-						Tensor* variance_tensor = new Tensor(variance_dims, NEW_FROM_VECTOR_PTR(variance_weights), dev);
-						Tensor::copy(variance_tensor, ((LBatchNorm *)(actual_layer))->variance);
-						delete variance_tensor;
+						map_init_values.copy_to(scale_name, ((LBatchNorm *)(actual_layer))->bn_g);
+						map_init_values.copy_to(bias_name, ((LBatchNorm *)(actual_layer))->bn_b);
+						map_init_values.copy_to(mean_name, ((LBatchNorm *)(actual_layer))->mean);
+						map_init_values.copy_to(variance_name, ((LBatchNorm *)(actual_layer))->variance);
 
 					}
 					break;
@@ -668,7 +730,7 @@ using namespace std;
 						//bool explicit_padding;
 						string auto_pad_option = "";
 						bool auto_pad = false;
-						vector<float> *bias;
+						int groups = 1;
 
 						for ( int j = 0; j < node->attribute_size(); j++ ) { //Set the attributes
 							onnx::AttributeProto attribute = node->attribute(j);
@@ -687,8 +749,8 @@ using namespace std;
 							else if (!attr_name.compare("dilations")) { //It isn't implemented in eddl
 
 							}
-							else if (!attr_name.compare("group")) { //We don't know if this exists in eddl
-
+							else if (!attr_name.compare("group")) {
+								groups = attribute.i();
 							}
 							else if (!attr_name.compare("kernel_shape")) { //
 								for( int h = 0; h<attribute.ints_size(); h++){
@@ -720,7 +782,6 @@ using namespace std;
 						vector<int> parent_shape = parent->output->shape;
 
 						string weights_name = node->input(1); //Get weights and dims
-						vector<float>* weights = &(map_init_values[weights_name]);
 						vector<int> dims = map_init_dims[weights_name];
 
 
@@ -730,25 +791,17 @@ using namespace std;
 						ConvolDescriptor* convol_descriptor;
 						if(!auto_pad){
 							kernel_shape.insert(kernel_shape.begin(), filters); //Add number of filters to kernel shape
-							convol_descriptor = new ConvolDescriptor(kernel_shape, strides, pads);
+							convol_descriptor = new ConvolDescriptor(kernel_shape, strides, pads, mem, groups);
 						}
-						else convol_descriptor = new ConvolDescriptor(filters, kernel_shape, strides, auto_pad_option, node->input_size() > 2, mem);
+						else convol_descriptor = new ConvolDescriptor(filters, kernel_shape, strides, auto_pad_option, node->input_size() > 2, mem, groups);
 
 						actual_layer = new LConv(parent, convol_descriptor, name, dev, mem);
 
 						if(node->input_size() > 2){
 							string bias_name = node->input(2);
-							bias = &(map_init_values[bias_name]);
-							vector<int> bias_shape;
-							bias_shape.push_back(bias->size());
-							Tensor* bias_tensor = new Tensor(bias_shape, NEW_FROM_VECTOR_PTR(bias), dev);
-							Tensor::copy(bias_tensor , convol_descriptor->bias);
-							delete bias_tensor;
-
+							map_init_values.copy_to(bias_name, convol_descriptor->bias);
 						}
-						Tensor* weights_tensor = new Tensor(dims, NEW_FROM_VECTOR_PTR(weights), dev);
-						Tensor::copy(weights_tensor, convol_descriptor->K);
-						delete weights_tensor;
+						map_init_values.copy_to(weights_name, convol_descriptor->K);
 						break;
 					}
 
@@ -760,8 +813,6 @@ using namespace std;
 						float beta;
 						int transA = 0;
 						int transB = 0;
-						vector<int> bias_dims;
-						vector <float>* bias;
 						for ( int j = 0; j < node->attribute_size(); j++ ) {
 							onnx::AttributeProto attribute = node->attribute(j);
 							string attr_name = attribute.name();
@@ -783,7 +834,6 @@ using namespace std;
 						Layer* parent;
 						string weights_name;
 						string bias_name;
-						vector<float> *weights;
 						vector<int> dims;
 
 						for(int i = 0; i < 2; i++){
@@ -794,7 +844,6 @@ using namespace std;
 							}
 							else { // weights
 								weights_name = node->input(i);
-								weights = &(map_init_values[input]);
 								dims = map_init_dims[input];
 								ndim = dims.size();
 							}
@@ -810,26 +859,15 @@ using namespace std;
 						Tensor * input_size = parent->output;
 						LDense* dense = new LDense(parent, neuronas, use_bias, name, dev, mem); 
 
-						Tensor* weights_tensor = new Tensor(dims, NEW_FROM_VECTOR_PTR(weights), dev);
 						if(transB){
-							vector<int> reverse_dims;
-							for(int h = dims.size()-1; h >= 0; h--){
-								reverse_dims.push_back(dims[h]);
-							}
-							Tensor* weights_tensor_T = new Tensor(reverse_dims, dev);
-							Tensor::transpose(weights_tensor, weights_tensor_T, {1,0});
-							Tensor::copy(weights_tensor_T, dense->W );
-							delete weights_tensor_T;
+							Tensor* weights_tensor = map_init_values.new_tensor(weights_name, dims, dev);
+							Tensor::transpose(weights_tensor, dense->W, {1,0});
+							delete weights_tensor;
 						}
-						else Tensor::copy(weights_tensor, dense->W );
-						delete weights_tensor;
+						else map_init_values.copy_to(weights_name, dense->W);
 						if(use_bias){
 							bias_name = node->input(2);
-							bias = &(map_init_values[bias_name]);
-							bias_dims = map_init_dims[bias_name];
-							Tensor* bias_tensor = new Tensor(bias_dims, NEW_FROM_VECTOR_PTR(bias), dev);
-							Tensor::copy(bias_tensor, dense->bias);
-							delete bias_tensor;
+							map_init_values.copy_to(bias_name, dense->bias);
 						}
 						actual_layer = dense;
 					}
@@ -999,7 +1037,7 @@ using namespace std;
 						}
 						else if(map_init_values.count(parent_name)){ //This means it is a parameter and not a layer
 							for( int i = 0; i < node->output_size(); i++ ) {
-								map_init_values[node->output(i)] = map_init_values[parent_name];
+								map_init_values.alias(node->output(i), parent_name);
 								map_init_dims[node->output(i)] = shape; 
 								vector<onnx::NodeProto*> child_nodes = input_node_map[node->output(i)];
 								for(onnx::NodeProto * child : child_nodes){
@@ -1259,10 +1297,7 @@ using namespace std;
 							if((conv = dynamic_cast<LConv*>(parents[0]) )){
 								ConvolDescriptor* convol_descriptor = conv->cd;
 								string bias_name = node->input(index_parameter);
-								vector<float> *bias = &(map_init_values[bias_name]);
-								vector<int> bias_shape;
-								bias_shape.push_back(bias->size());
-								Tensor* bias_tensor = new Tensor(bias_shape, NEW_FROM_VECTOR_PTR(bias), dev);
+								Tensor* bias_tensor = map_init_values.new_tensor(bias_name, convol_descriptor->bias->shape, dev);
 								if(!convol_descriptor->use_bias){
 									convol_descriptor->use_bias = true; //We need to enable the bias
 									Tensor::copy(bias_tensor , convol_descriptor->bias);
@@ -1279,14 +1314,13 @@ using namespace std;
 							}
 							else if((dense = dynamic_cast<LDense*>(parents[0]) )){
 								string bias_name = node->input(index_parameter);
-								vector<float> *bias = &(map_init_values[bias_name]);
 								vector<int> bias_dims = map_init_dims[bias_name];
 								if(!dense->use_bias){
 									dense->use_bias = true;
-									dense->bias = new Tensor(bias_dims, NEW_FROM_VECTOR_PTR(bias), dev);
+									dense->bias = map_init_values.new_tensor(bias_name, bias_dims, dev);
 								}
 								else{ //If dense already has a bias, we sum it in top of the bias
-									Tensor* add_to_bias = new Tensor(bias_dims, NEW_FROM_VECTOR_PTR(bias), dev);
+									Tensor* add_to_bias = map_init_values.new_tensor(bias_name, bias_dims, dev);
 									dense->bias = Tensor::add(dense->bias, add_to_bias);
 
 								}
@@ -1347,16 +1381,13 @@ using namespace std;
 						}
 						if(dense_detected){
 							string weights_name = node->input(index_parameter);
-							vector<float> *weights = &(map_init_values[weights_name]);
 							vector<int> dims = map_init_dims[weights_name];
 							int ndim = dims.size();
 							int neuronas = dims[1];
 							Layer *parent = parents[1-index_parameter];
 							bool use_bias = false;
 							LDense* dense = new LDense(parent, neuronas, use_bias, name, dev, mem); 
-							Tensor* weights_tensor = new Tensor(dims, NEW_FROM_VECTOR_PTR(weights), dev);
-							Tensor::copy(weights_tensor, dense->W );
-							delete weights_tensor;
+							map_init_values.copy_to(weights_name, dense->W);
 							actual_layer = dense;
 							break;
 						}
@@ -1689,20 +1720,17 @@ using namespace std;
 
 
 	//Returns a map containing the name of the layer as key and a tensor with the values of the model as value
-	map<string, vector<Tensor*> > get_tensors_from_onnx(onnx::ModelProto model){
+	map<string, vector<Tensor*> > get_tensors_from_onnx(const onnx::ModelProto &model){
 
 		map<string, vector<Tensor*> > tensors;
 
-		onnx::GraphProto graph = model.graph(); //Get the graph of the model.
+		const onnx::GraphProto &graph = model.graph(); //Get the graph of the model.
 		//Model needs input and output in the constructor, so we start with that.
 
-		vector<onnx::TensorProto> initializers = get_initializers(graph); // Retrieves the initializers from the graph.
-																		  // The weight for the layers can be found in the initializers.
-		map<string, vector<float>> map_init_values;
+		OnnxInitializers map_init_values(graph); // Retrieves the initializers from the graph.
+												 // The weight for the layers can be found in the initializers.
 		map<string, vector<int>>   map_init_dims;
-		get_initializers_maps(initializers, map_init_values, map_init_dims); // Creates 2 maps
-																			//  Key: Input Name . Value: Weights
-																			//  Key: Input Name . Value: Dims
+		get_initializers_dims(graph, map_init_dims); //  Key: Input Name . Value: Dims
 		vector<onnx::NodeProto> nodes = get_graph_nodes(graph);
 
 		map<string, ONNX_LAYERS> map_layers = create_enum_map();
@@ -1721,17 +1749,15 @@ using namespace std;
 
 
 						string weights_name = node.input(1); //Get weights and dims
-						vector<float>* weights = &(map_init_values[weights_name]);
 						vector<int> dims = map_init_dims[weights_name];
 
-						conv_tensors.push_back(new Tensor(dims, NEW_FROM_VECTOR_PTR(weights), dev));
+						conv_tensors.push_back(map_init_values.new_tensor(weights_name, dims, dev));
 
 						if(node.input_size() > 2){ //This means we also have a bias
 							string bias_name = node.input(2);
-							vector<float>* bias = &(map_init_values[bias_name]);
 							vector<int> bias_shape;
-							bias_shape.push_back(bias->size());
-							conv_tensors.push_back(new Tensor(bias_shape, NEW_FROM_VECTOR_PTR(bias), dev));
+							bias_shape.push_back(dims[0]);
+							conv_tensors.push_back(map_init_values.new_tensor(bias_name, bias_shape, dev));
 						}
 
 						tensors[name] = conv_tensors;
@@ -1744,16 +1770,14 @@ using namespace std;
 						vector<Tensor*> dense_tensors;
 
 						string weights_name = node.input(1); //Get weights and dims
-						vector<float>* weights = &(map_init_values[weights_name]);
 						vector<int> dims = map_init_dims[weights_name];
 
-						dense_tensors.push_back(new Tensor(dims, NEW_FROM_VECTOR_PTR(weights), dev));
+						dense_tensors.push_back(map_init_values.new_tensor(weights_name, dims, dev));
 
 						if(node.input_size() > 2){
 							string bias_name = node.input(2);
-							vector<float>* bias = &(map_init_values[bias_name]);
 							vector<int> bias_dims = map_init_dims[bias_name];
-							dense_tensors.push_back(new Tensor(bias_dims, NEW_FROM_VECTOR_PTR(bias), dev));
+							dense_tensors.push_back(map_init_values.new_tensor(bias_name, bias_dims, dev));
 						}
 
 						tensors[name] = dense_tensors;
@@ -29,7 +29,9 @@ void Conv2D(ConvolDescriptor *D) {
 
     D->O->tsem->lock();
     if (D->I->isCPU()) {
-        cpu_conv2D(D);
+        if (D->groups > 1) cpu_conv2D_grouped(D);
+        else if (D->layout != LAYOUT_NCHW || D->in_layout != LAYOUT_NCHW) cpu_conv2D_nhwc(D);
+        else cpu_conv2D(D);
     }
 #ifdef cGPU
     else if (D->I->isGPU())
@@ -57,7 +59,9 @@ void Conv2D_grad(ConvolDescriptor *D) {
 
     D->gK->tsem->lock();
     if (D->I->isCPU()) {
-        cpu_conv2D_grad(D);
+        if (D->groups > 1) cpu_conv2D_grad_grouped(D);
+        else if (D->layout != LAYOUT_NCHW || D->in_layout != LAYOUT_NCHW) cpu_conv2D_grad_nhwc(D);
+        else cpu_conv2D_grad(D);
     }
 #ifdef cGPU
     else if (D->I->isGPU())
@@ -84,7 +88,9 @@ void Conv2D_back(ConvolDescriptor *D) {
 
     D->ID->tsem->lock();
     if (D->I->isCPU()) {
-        cpu_conv2D_back(D);
+        if (D->groups > 1) cpu_conv2D_back_grouped(D);
+        else if (D->layout != LAYOUT_NCHW || D->in_layout != LAYOUT_NCHW) cpu_conv2D_back_nhwc(D);
+        else cpu_conv2D_back(D);
     }
 #ifdef cGPU
     else if (D->I->isGPU())
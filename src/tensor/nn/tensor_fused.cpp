@@ -0,0 +1,43 @@
+/*
+* EDDL Library - European Distributed Deep Learning Library.
+* Version: 0.7
+* copyright (c) 2020, Universidad Politécnica de Valencia (UPV), PRHLT Research Centre
+* Date: April 2020
+* Author: PRHLT Research Centre, UPV, (rparedes@prhlt.upv.es), (jon@prhlt.upv.es)
+* All rights reserved
+*/
+
+#include "eddl/tensor/nn/tensor_nn.h"
+#include "eddl/hardware/cpu/nn/cpu_tensor_nn.h"
+
+namespace tensorNN {
+
+    // The kernels walk all the buffers linearly
+    static void check_fused(const vector<Tensor *> &ts, const string &caller){
+        for (auto t : ts) {
+            if (!t->isCPU()) msg("Fused chains are only available on CPU", caller);
+            if (!t->is_contiguous() || t->size != ts[0]->size) msg("Incompatible tensors", caller);
+        }
+    }
+
+    void fused_forward(const vector<FusedOp> &ops, Tensor *X, const vector<Tensor *> &S, Tensor *Y) {
+        vector<Tensor *> ts = {X, Y};
+        ts.insert(ts.end(), S.begin(), S.end());
+        check_fused(ts, "tensorNN::fused_forward");
+        if (ops.empty()) msg("Empty chain", "tensorNN::fused_forward");
+
+        cpu_fused_forward(ops, X, S, Y);
+    }
+
+    void fused_backward(const vector<FusedOp> &ops, Tensor *X, const vector<Tensor *> &S, Tensor *Y, Tensor *D,
+                        Tensor *PD, const vector<Tensor *> &SD) {
+        vector<Tensor *> ts = {X, Y, D, PD};
+        ts.insert(ts.end(), S.begin(), S.end());
+        ts.insert(ts.end(), SD.begin(), SD.end());
+        check_fused(ts, "tensorNN::fused_backward");
+        if (ops.empty() || S.size() != SD.size()) msg("Invalid chain", "tensorNN::fused_backward");
+
+        cpu_fused_backward(ops, X, S, Y, D, PD, SD);
+    }
+
+}
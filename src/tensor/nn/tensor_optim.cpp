@@ -0,0 +1,88 @@
+/*
+* EDDL Library - European Distributed Deep Learning Library.
+* Version: 0.7
+* copyright (c) 2020, Universidad Politécnica de Valencia (UPV), PRHLT Research Centre
+* Date: April 2020
+* Author: PRHLT Research Centre, UPV, (rparedes@prhlt.upv.es), (jon@prhlt.upv.es)
+* All rights reserved
+*/
+
+#include <cmath>
+
+#include "eddl/tensor/nn/tensor_nn.h"
+#include "eddl/hardware/cpu/nn/cpu_tensor_nn.h"
+
+#ifdef cGPU
+#include "eddl/hardware/gpu/gpu_tensor.h"
+#include "eddl/hardware/gpu/gpu_hw.h"
+#include "eddl/hardware/gpu/nn/gpu_tensor_nn.h"
+#endif
+
+namespace tensorNN {
+
+    // The fused kernels walk the buffers linearly
+    static bool fused_step(const vector<Tensor *> &ts){
+        for (auto t : ts) {
+            if (!t->isCPU() || !t->is_contiguous() || t->size != ts[0]->size) return false;
+        }
+        return true;
+    }
+
+    void sgd_step(Tensor *W, Tensor *G, Tensor *M, float lr, float mu, float l1, float l2) {
+        if (fused_step({W, G, M})) {
+            cpu_sgd_step(W, G, M, lr, mu, l1, l2);
+        } else {
+            if (l1 != 0.0f || l2 != 0.0f) Tensor::regularize(W, W, l1, l2);
+            Tensor::add(lr, G, mu, M, M, 0);
+            Tensor::add(1.0, W, -1.0, M, W, 0);
+        }
+    }
+
+    void adam_step(Tensor *W, Tensor *G, Tensor *M, Tensor *V, Tensor *mCap, Tensor *vCap,
+                   float lr, float beta_1, float beta_2, float epsilon, int t, float l1, float l2) {
+        if (fused_step({W, G, M, V})) {
+            cpu_adam_step(W, G, M, V, lr, beta_1, beta_2, epsilon, t, l1, l2);
+        } else {
+            if (l1 != 0.0f || l2 != 0.0f) Tensor::regularize(W, W, l1, l2);
+            Tensor::add(beta_1, M, (1-beta_1), G, M, 0);
+            G->sqr_();
+            Tensor::add(beta_2, V, (1-beta_2), G, V, 0);
+
+            Tensor::copy(M, mCap);
+            mCap->div_(1-pow(beta_1, t));
+
+            Tensor::copy(V, vCap);
+            vCap->div_(1-pow(beta_2, t));
+            vCap->add_(epsilon);
+            vCap->sqrt_();
+
+            Tensor::el_div(mCap, vCap, mCap, 0);
+
+            Tensor::add(-lr, mCap, 1.0, W, W, 0);
+        }
+    }
+
+    void rmsprop_step(Tensor *W, Tensor *G, Tensor *G1, Tensor *S, float lr, float rho, float epsilon, float l1, float l2) {
+        if (fused_step({W, G, G1})) {
+            cpu_rmsprop_step(W, G, G1, lr, rho, epsilon, l1, l2);
+        } else {
+            if (l1 != 0.0f || l2 != 0.0f) Tensor::regularize(W, W, l1, l2);
+            Tensor::copy(G, S);
+            S->sqr_();
+            S->mult_(1.0f-rho);
+
+            G1->sqr_();
+            G1->mult_(rho);
+            Tensor::add(1.0, G1, 1.0, S, S, 0);
+
+            S->add_(epsilon);
+            S->sqrt_();
+            Tensor::el_div(G, S, S, 0);
+
+            Tensor::copy(G, G1);
+
+            Tensor::add(-lr, S, 1.0, W, W, 0);
+        }
+    }
+
+}
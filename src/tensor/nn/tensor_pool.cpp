@@ -29,7 +29,8 @@ namespace tensorNN {
 
         D->O->tsem->lock();
         if (D->I->isCPU()) {
-            cpu_mpool2D(D);
+            if (D->layout != LAYOUT_NCHW || D->in_layout != LAYOUT_NCHW) cpu_mpool2D_nhwc(D);
+            else cpu_mpool2D(D);
         }
 #ifdef cGPU
         else if (D->I->isGPU())
@@ -56,7 +57,8 @@ namespace tensorNN {
 
         D->ID->tsem->lock();
         if (D->I->isCPU()) {
-            cpu_mpool2D_back(D);
+            if (D->layout != LAYOUT_NCHW || D->in_layout != LAYOUT_NCHW) cpu_mpool2D_back_nhwc(D);
+            else cpu_mpool2D_back(D);
         }
 #ifdef cGPU
         else if (D->I->isGPU())
@@ -84,7 +86,8 @@ namespace tensorNN {
 
         D->O->tsem->lock();
         if (D->I->isCPU()) {
-            cpu_avgpool2D(D);
+            if (D->layout != LAYOUT_NCHW || D->in_layout != LAYOUT_NCHW) cpu_avgpool2D_nhwc(D);
+            else cpu_avgpool2D(D);
         }
 #ifdef cGPU
         else if (D->I->isGPU())
@@ -111,7 +114,8 @@ namespace tensorNN {
 
         D->ID->tsem->lock();
         if (D->I->isCPU()) {
-            cpu_avgpool2D_back(D);
+            if (D->layout != LAYOUT_NCHW || D->in_layout != LAYOUT_NCHW) cpu_avgpool2D_back_nhwc(D);
+            else cpu_avgpool2D_back(D);
         }
 #ifdef cGPU
         else if (D->I->isGPU())
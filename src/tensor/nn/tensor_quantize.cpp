@@ -0,0 +1,33 @@
+/*
+* EDDL Library - European Distributed Deep Learning Library.
+* Version: 0.7
+* copyright (c) 2020, Universidad Politécnica de Valencia (UPV), PRHLT Research Centre
+* Date: April 2020
+* Author: PRHLT Research Centre, UPV, (rparedes@prhlt.upv.es), (jon@prhlt.upv.es)
+* All rights reserved
+*/
+
+#include "eddl/tensor/nn/tensor_nn.h"
+#include "eddl/hardware/cpu/nn/cpu_tensor_nn.h"
+
+namespace tensorNN {
+
+    void Dense_s8(Tensor *A, const int8_t *W, const float *scales, float input_scale, Tensor *bias, Tensor *B) {
+        if (A->ndim != 2 || B->ndim != 2 || A->shape[0] != B->shape[0]) msg("Incompatible tensors", "tensorNN::Dense_s8");
+        if (!A->isCPU() || !B->isCPU()) msg("INT8 inference is only available on CPU", "tensorNN::Dense_s8");
+
+        B->tsem->lock();
+        cpu_dense_s8(A, W, scales, input_scale, bias, B);
+        B->tsem->unlock();
+    }
+
+    void Conv2D_s8(ConvolDescriptor *D, const int8_t *K, const float *scales, float input_scale) {
+        if (D->I->ndim != 4) msg("Tensors are not 4D", "tensorNN::Conv2D_s8");
+        if (!D->I->isCPU()) msg("INT8 inference is only available on CPU", "tensorNN::Conv2D_s8");
+
+        D->O->tsem->lock();
+        cpu_conv2D_s8(D, K, scales, input_scale);
+        D->O->tsem->unlock();
+    }
+
+}
@@ -45,7 +45,9 @@ void checkCompatibility(Tensor *A, Tensor *B, Tensor *C, const string &title){
 
 
 
-Tensor::Tensor() : device(DEV_CPU), ndim(0), size(0) {}
+Tensor::Tensor() : device(DEV_CPU), ndim(0), size(0), isview(false), dtype(DTYPE_FLOAT32), cptr(nullptr), cscale(1.0f), ptr(nullptr), ptr2(nullptr), gpu_device(0) {
+    this->tsem = new mutex();
+}
 
 
 Tensor::Tensor(const vector<int> &shape, float *fptr, int dev){
@@ -65,6 +67,11 @@ Tensor::Tensor(const vector<int> &shape, float *fptr, int dev){
 #endif
 
     // Update values
+    this->isview = false;
+    this->dtype = DTYPE_FLOAT32;
+    this->cptr = nullptr;
+    this->cscale = 1.0f;
+    this->ptr2 = nullptr;
     updateDevice(dev);
     updateShape(shape);
     updateSize();
@@ -124,10 +131,23 @@ void Tensor::updateStrides() {
 }
 
 void Tensor::deleteData(){
+    // Compact storage
+    if(this->cptr != nullptr){
+        delete[] (char *)this->cptr;
+        this->cptr = nullptr;
+        this->dtype = DTYPE_FLOAT32;
+    }
+
+    // Views do not own their data
+    if(this->isview){
+        this->ptr = nullptr;
+        return;
+    }
+
     // Careful, you can't know is a pointer is allocated
     if(this->ptr != nullptr){
         if (this->isCPU()) {
-            delete this->ptr;
+            free_fmem(this->ptr);
         }
 #ifdef cGPU
         else if (this->isGPU())
@@ -228,7 +248,7 @@ void Tensor::toGPU(int dev){
 
         this->ptr = gpu_ptr;
         gpu_copy_to_gpu(cpu_ptr, this);
-        delete cpu_ptr;
+        free_fmem(cpu_ptr);
     }
     else if (isGPU())
     {
@@ -279,6 +299,21 @@ unsigned int Tensor::numel(){
     return (unsigned int)this->size;
 }
 
+bool Tensor::is_contiguous(){
+    unsigned long int expected = 1;
+    for(int i=(int)this->ndim-1; i>=0; i--){
+        if(this->shape[i] != 1 && this->stride[i] != expected){
+            return false;
+        }
+        expected *= this->shape[i];
+    }
+    return true;
+}
+
+bool Tensor::is_compact(){
+    return this->dtype != DTYPE_FLOAT32;
+}
+
 void Tensor::info() {
     int cols = 15;
     cout << "-------------------------------" << endl;
@@ -287,10 +322,17 @@ void Tensor::info() {
     cout << setw(cols) << left << "shape: "        << "(" << printVector<int>(this->shape) << ")" << endl;
     cout << setw(cols) << left << "strides: "      << "(" << printVector<int>(this->stride) <<  ")" << endl;
     cout << setw(cols) << left << "itemsize: "     << this->size << endl;
-    cout << setw(cols) << left << "contiguous: "   << true << endl; // for future
+    cout << setw(cols) << left << "contiguous: "   << this->is_contiguous() << endl;
+    cout << setw(cols) << left << "view: "         << this->isview << endl;
     cout << setw(cols) << left << "order: "        << 'C' << endl;  // C=>C order, F=>Fortran order
     cout << setw(cols) << left << "data pointer: " << &this->ptr << endl;
-    cout << setw(cols) << left << "type: "         << "float" << " (" << sizeof(float) << " bytes)" << endl;
+    if (this->dtype == DTYPE_UINT8) {
+        cout << setw(cols) << left << "type: "     << "uint8 (1 byte, compact x" << this->cscale << ")" << endl;
+    } else if (this->dtype == DTYPE_UINT16) {
+        cout << setw(cols) << left << "type: "     << "uint16 (2 bytes, compact x" << this->cscale << ")" << endl;
+    } else {
+        cout << setw(cols) << left << "type: "     << "float" << " (" << sizeof(float) << " bytes)" << endl;
+    }
     cout << setw(cols) << left << "device: " << this->getDeviceName() << " (code = " << this->device << ")" << endl;
     cout << "-------------------------------" << endl;
 }
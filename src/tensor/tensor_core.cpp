@@ -7,6 +7,8 @@
 * All rights reserved
 */
 #include <utility>
+#include <algorithm>
+#include <numeric>
 
 #include "eddl/tensor/tensor.h"
 #include "eddl/hardware/cpu/cpu_tensor.h"
@@ -45,7 +47,14 @@ void Tensor::fill(Tensor* A, float v){
 void Tensor::permute_(const vector<int>& dims){
     Tensor* temp = Tensor::permute(this, dims);
     this->deleteData();
-    this->ptr = temp->ptr;
+
+    // Take the data (and the new shape) from the permuted tensor
+    updateShape(temp->shape);
+    updateSize();
+    updateStrides();
+    updateData(temp->ptr);
+    temp->ptr = nullptr;
+    delete temp;
 }
 
 
@@ -67,7 +76,14 @@ Tensor* Tensor::permute(Tensor* A, const vector<int>& dims){
 void Tensor::moveaxis_(int source, int destination){
     Tensor* temp = Tensor::moveaxis(this, source, destination);
     this->deleteData();
-    this->ptr = temp->ptr;
+
+    // Take the data (and the new shape) from the permuted tensor
+    updateShape(temp->shape);
+    updateSize();
+    updateStrides();
+    updateData(temp->ptr);
+    temp->ptr = nullptr;
+    delete temp;
 }
 
 
@@ -99,7 +115,14 @@ Tensor* Tensor::moveaxis(Tensor* A, int source, int destination){
 void Tensor::swapaxis_(int axis1, int axis2){
     Tensor* temp = Tensor::swapaxis(this, axis1, axis2);
     this->deleteData();
-    this->ptr = temp->ptr;
+
+    // Take the data (and the new shape) from the permuted tensor
+    updateShape(temp->shape);
+    updateSize();
+    updateStrides();
+    updateData(temp->ptr);
+    temp->ptr = nullptr;
+    delete temp;
 }
 
 
@@ -121,6 +144,137 @@ Tensor* Tensor::swapaxis(Tensor* A, int axis1, int axis2){
 }
 
 
+Tensor* Tensor::view(Tensor* A, const vector<int>& shape, const vector<int>& stride, int offset){
+    if(shape.size() != stride.size()){
+        msg("The shape and the stride must have the same number of dimensions", "Tensor::view");
+    }
+
+    auto *t = new Tensor();
+    t->isview = true;
+    t->updateDevice(A->device);
+    t->updateShape(shape);
+    t->updateSize();
+    t->stride = vector<int>(stride);
+    t->gpu_device = A->gpu_device;
+    t->ptr = A->ptr + offset;
+
+    // Only CPU kernels know how to walk strided data
+    if(!t->isCPU() && !t->is_contiguous()){
+        delete t;
+        msg("Non-contiguous views are only supported on CPU", "Tensor::view");
+    }
+
+    // Eigen mapping (only valid for contiguous data)
+    if(t->isCPU() && t->ndim == 2 && t->is_contiguous()){
+        t->ptr2=(Eigen::MatrixXf*)new Eigen::Map<Eigen::MatrixXf>(t->ptr, t->shape[1], t->shape[0]);
+    }
+
+    return t;
+}
+
+
+Tensor* Tensor::permute_view(Tensor* A, const vector<int>& dims){
+    if(dims.size() != A->ndim){
+        msg("The number of dimensions to permute does not match the tensor", "Tensor::permute_view");
+    }
+
+    vector<int> new_shape;
+    vector<int> new_stride;
+    for(auto &d : dims){
+        if(d < 0 || d >= A->ndim){ msg("Invalid axis", "Tensor::permute_view"); }
+        new_shape.push_back(A->shape[d]);
+        new_stride.push_back(A->stride[d]);
+    }
+
+    return Tensor::view(A, new_shape, new_stride, 0);
+}
+
+
+Tensor* Tensor::select_view(Tensor* A, int axis, int index){
+    if(axis < 0 || axis >= A->ndim){ msg("Invalid axis", "Tensor::select_view"); }
+    if(index < 0 || index >= A->shape[axis]){ msg("Index out of range", "Tensor::select_view"); }
+
+    vector<int> new_shape(A->shape);
+    vector<int> new_stride(A->stride);
+    new_shape.erase(new_shape.begin() + axis);
+    new_stride.erase(new_stride.begin() + axis);
+
+    return Tensor::view(A, new_shape, new_stride, index * A->stride[axis]);
+}
+
+
+Tensor* Tensor::slice_view(Tensor* A, int axis, int start, int end){
+    if(axis < 0 || axis >= A->ndim){ msg("Invalid axis", "Tensor::slice_view"); }
+    if(start < 0 || end > A->shape[axis] || start >= end){ msg("Invalid range", "Tensor::slice_view"); }
+
+    vector<int> new_shape(A->shape);
+    new_shape[axis] = end - start;
+
+    return Tensor::view(A, new_shape, A->stride, start * A->stride[axis]);
+}
+
+
+Tensor* Tensor::contiguous(Tensor* A){
+    auto *t_new = new Tensor(A->shape, A->device);
+    Tensor::copy(A, t_new);
+    return t_new;
+}
+
+
+Tensor* Tensor::expand(Tensor* A, const vector<int>& shape){
+    if (broadcast_shape(A->shape, shape) != shape) {
+        msg("The tensor can not be broadcast to the given shape", "Tensor::expand");
+    }
+
+    auto *t_new = new Tensor(shape, A->device);
+    if (A->isCPU()) {
+        cpu_copy(A, t_new);  // A is read with stride 0 along the broadcast dimensions
+        return t_new;
+    }
+
+    // Other devices: replicating rows or columns is a product with a vector of ones
+    int n = shape.size();
+    vector<int> a(n, 1);
+    for (int d = 0; d < A->ndim; d++) { a[n - A->ndim + d] = A->shape[d]; }
+
+    int k = 0;  // Leading broadcast dimensions
+    while (k < n && a[k] == 1) k++;
+    int j = n;  // Trailing broadcast dimensions
+    while (j > 0 && a[j-1] == 1) j--;
+
+    Tensor *ones = nullptr, *Av = nullptr, *Tv = nullptr;
+    if (std::equal(a.begin()+k, a.end(), shape.begin()+k)) {
+        int size = A->size;
+        int rows = t_new->size / size;
+        ones = new Tensor({rows, 1}, A->device);
+        Av = Tensor::view(A, {1, size}, {size, 1});
+        Tv = Tensor::view(t_new, {rows, size}, {size, 1});
+        ones->fill_(1.0);
+        Tensor::mult2D(ones, 0, Av, 0, Tv, 0);
+    } else if (std::equal(a.begin(), a.begin()+j, shape.begin())) {
+        int size = A->size;
+        int cols = t_new->size / size;
+        ones = new Tensor({1, cols}, A->device);
+        Av = Tensor::view(A, {size, 1}, {1, 1});
+        Tv = Tensor::view(t_new, {size, cols}, {cols, 1});
+        ones->fill_(1.0);
+        Tensor::mult2D(Av, 0, ones, 0, Tv, 0);
+    } else {
+        Tensor *Ac = new Tensor(A->shape, DEV_CPU);
+        Tensor::copy(A, Ac);
+        Tensor *Tc = Tensor::expand(Ac, shape);
+        Tensor::copy(Tc, t_new);
+        delete Ac;
+        delete Tc;
+    }
+    delete ones;
+    delete Av;
+    delete Tv;
+
+    return t_new;
+}
+
+
 void Tensor::reshape_(const vector<int> &new_shape){
     int new_size = 1;  // For checking
     vector<int> final_shape;
@@ -139,6 +293,11 @@ void Tensor::reshape_(const vector<int> &new_shape){
         msg("Not compatible shapes", "Tensor::reshape_");
     }
 
+    // Strided data cannot be reinterpreted with a new shape
+    if(!this->is_contiguous()){
+        msg("Non-contiguous views cannot be reshaped (use Tensor::contiguous)", "Tensor::reshape_");
+    }
+
     // Update attributes
     updateShape(final_shape);
     updateSize();
@@ -235,38 +394,45 @@ Tensor* Tensor::unsqueeze(Tensor *A){
 
 // ***** Core (static) *****************************
 void Tensor::transpose(Tensor *A, Tensor *B, vector<int> dims) {
-    // Transpose
-    // TODO: Review correctness
-    B->tsem->lock();
-    if (!Tensor::sameShape(A, B))
-        msg("Tensors with different shape", "Tensor::transpose");
+    // B = permutation of the dimensions of A (reverse order if no dims are given)
+    if (dims.empty()) {
+        for (int i = A->ndim - 1; i >= 0; i--) { dims.push_back(i); }
+    }
 
     if (A->device != B->device) msg("Tensors in different devices", "Tensor::transpose");
 
-    Tensor *N;
-    if (A == B) N = new Tensor(A->getShape(), A->device);
-    else N = B;
-
-
-    // Copy tensor data
-    if (A->isCPU()) {
-        cpu_transpose(A, N);
+    // Strided kernels are CPU-only, so other devices go through host copies
+    if (!A->isCPU()) {
+        Tensor *Ac = new Tensor(A->getShape(), DEV_CPU);
+        Tensor *Bc = new Tensor(B->getShape(), DEV_CPU);
+        Tensor::copy(A, Ac);
+        Tensor::transpose(Ac, Bc, dims);
+        Tensor::copy(Bc, B);
+        delete Ac;
+        delete Bc;
+        return;
     }
-#ifdef cGPU
-    else if (A->isGPU())
-      {
-
-      }
-#endif
-#ifdef cFPGA
-    else {
 
+    // Permuted view of A (no data is copied)
+    Tensor *At = Tensor::permute_view(A, dims);
+    if (At->shape != B->shape) {
+        delete At;
+        msg("Tensors with different shape", "Tensor::transpose");
     }
-#endif
-    B->tsem->unlock();
 
-    if (A == B) delete N;
+    Tensor *N;
+    if (A->ptr == B->ptr) N = new Tensor(B->getShape(), B->device);
+    else N = B;
+
+    N->tsem->lock();
+    cpu_transpose(At, N);
+    N->tsem->unlock();
 
+    if (N != B) {
+        Tensor::copy(N, B);
+        delete N;
+    }
+    delete At;
 }
 
 void Tensor::copy(Tensor *A, Tensor *B) {
@@ -281,6 +447,26 @@ void Tensor::copy(Tensor *A, Tensor *B) {
         msg("Tensors with different shape", "Tensor::copy");
     }
 
+    if (B->is_compact()) msg("Compact tensors can not be written", "Tensor::copy");
+
+    // Compact tensors are decoded as a whole selection
+    if (A->is_compact()) {
+        vector<int> sind(A->shape[0]);
+        std::iota(sind.begin(), sind.end(), 0);
+        Tensor::select(A, B, sind, 0, A->shape[0]);
+        return;
+    }
+
+    // Device transfers need contiguous data
+    if ((!A->isCPU() || !B->isCPU()) && !(A->is_contiguous() && B->is_contiguous())) {
+        Tensor *Ac = A->is_contiguous() ? A : Tensor::contiguous(A);
+        Tensor *Bc = B->is_contiguous() ? B : new Tensor(B->shape, B->device);
+        Tensor::copy(Ac, Bc);
+        if (Bc != B) { Tensor::copy(Bc, B); delete Bc; }
+        if (Ac != A) { delete Ac; }
+        return;
+    }
+
     B->tsem->lock();
     if ((A->isCPU()) && (B->isCPU())) {
         cpu_copy(A, B);
@@ -634,6 +820,21 @@ void Tensor::select(Tensor *A, Tensor *B, vector<int> sind, int ini, int end, bo
     }
 
 
+    if (B->is_compact()) msg("Compact tensors can not be written", "Tensor::select");
+
+    // Compact datasets are decoded (and scaled) only for the selected rows
+    if (A->is_compact()) {
+        if (B->isCPU()) {
+            cpu_select_compact(A, B, sind, ini, end, mask_zeros);
+        } else {
+            Tensor *Bc=new Tensor(B->shape, DEV_CPU);
+            cpu_select_compact(A, Bc, sind, ini, end, mask_zeros);
+            Tensor::copy(Bc,B);
+            delete Bc;
+        }
+        return;
+    }
+
     //B->tsem->lock();
     if ((A->isCPU()) && (B->isCPU())) {
         cpu_select(A, B, sind, ini, end,mask_zeros);
@@ -432,3 +432,50 @@ void Tensor::cutout_random(Tensor *A, Tensor *B, vector<float> factor_x, vector<
     }
 #endif
 }
+
+
+void Tensor::affine(Tensor *A, Tensor *B, const vector<float> &matrices, bool bilinear, WrappingMode mode, float cval) {
+    // Check dimensions
+    if(A->shape!=B->shape){
+        msg("Incompatible dimensions", "Tensor::affine");
+    } else if (A->ndim != 4 || B->ndim != 4){
+        msg("This method requires two 4D tensors", "Tensor::affine");
+    } else if (matrices.size() != 6 * A->shape[0]){
+        msg("A matrix (6 values) per sample is required", "Tensor::affine");
+    } else if (A->ptr == B->ptr){
+        msg("The output can not be the input", "Tensor::affine");
+    } else if (!B->is_contiguous()){
+        msg("The output must be contiguous", "Tensor::affine");
+    }
+
+    if (A->isCPU()) {
+        cpu_affine(A, B, matrices.data(), bilinear, mode, cval);
+    }
+#ifdef cGPU
+    else if (A->isGPU())
+      {
+        // Resampled on the host
+        Tensor *a = A->clone(); a->toCPU();
+        Tensor *b = new Tensor(B->shape, DEV_CPU);
+        cpu_affine(a, b, matrices.data(), bilinear, mode, cval);
+        Tensor::copy(b, B);
+        delete a; delete b;
+      }
+#endif
+#ifdef cFPGA
+    else {
+
+    }
+#endif
+}
+
+void Tensor::affine_random(Tensor *A, Tensor *B, const AffineDescriptor &D) {
+    // Check dimensions
+    if (A->ndim != 4){
+        msg("This method requires two 4D tensors", "Tensor::affine_random");
+    }
+
+    // The parameters are drawn here (serially) so the resample can run in parallel
+    vector<float> matrices = D.sample_batch(A->shape[0], A->shape[2], A->shape[3]);
+    Tensor::affine(A, B, matrices, D.bilinear, D.da_mode, D.cval);
+}
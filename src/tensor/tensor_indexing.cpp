@@ -47,7 +47,7 @@ Tensor* Tensor::nonzero(bool sort_indices){
     int indices_size = result.second;
 
     // Cast pointer (CPU only)
-    auto *new_ptr = new float[indices_size];
+    float *new_ptr = get_fmem(indices_size, "Tensor::nonzero");
     for(int i=0; i<indices_size; i++){
         new_ptr[i]= static_cast<float>(indices_ptr[i]);
     }
@@ -1691,6 +1691,23 @@ void Tensor::sign(Tensor *A, Tensor *B, float zero_sign) {
 #endif
 }
 
+void Tensor::regularize(Tensor *A, Tensor *B, float l1, float l2) {
+    if (A->isCPU() && B->isCPU()) {
+        cpu_regularize(A, B, l1, l2);
+    }
+#ifdef cGPU
+    else if (A->isGPU() && B->isGPU())
+      {
+        gpu_regularize(A, B, l1, l2);
+      }
+#endif
+#ifdef cFPGA
+    else {
+
+    }
+#endif
+}
+
 
 void Tensor::sin_(){
     Tensor::sin(this, this);
@@ -1932,8 +1949,9 @@ void Tensor::trunc(Tensor *A, Tensor *B){
 
 
 // Math operations (binary) ************************
+// Operands are broadcast (NumPy rules), so the result takes the broadcast shape
 Tensor* Tensor::add(Tensor *A, Tensor *B){
-    Tensor* C = Tensor::empty(A->getShape(), A->device);
+    Tensor* C = Tensor::empty(broadcast_shape(A->shape, B->shape), A->device);
     Tensor::add(A, B, C);
     return C;
 }
@@ -1944,7 +1962,7 @@ void Tensor::add(Tensor *A, Tensor *B, Tensor *C) {
 
 
 Tensor* Tensor::div(Tensor *A, Tensor *B){
-    Tensor* C = Tensor::empty(A->getShape(), A->device);
+    Tensor* C = Tensor::empty(broadcast_shape(A->shape, B->shape), A->device);
     Tensor::div(A, B, C);
     return C;
 }
@@ -1955,7 +1973,7 @@ void Tensor::div(Tensor *A, Tensor *B, Tensor *C) {
 
 
 Tensor* Tensor::mult(Tensor *A, Tensor *B){
-    Tensor* C = Tensor::empty(A->getShape(), A->device);
+    Tensor* C = Tensor::empty(broadcast_shape(A->shape, B->shape), A->device);
     Tensor::mult(A, B, C);
     return C;
 }
@@ -1978,7 +1996,7 @@ void Tensor::interpolate(float factor1, Tensor *A, float factor2, Tensor *B, Ten
 
 
 Tensor* Tensor::sub(Tensor *A, Tensor *B){
-    Tensor* C = Tensor::empty(A->getShape(), A->device);
+    Tensor* C = Tensor::empty(broadcast_shape(A->shape, B->shape), A->device);
     Tensor::sub(A, B, C);
     return C;
 }
@@ -2113,22 +2131,39 @@ Tensor& operator/ (float v, Tensor &A) {
 
 
 
+// A and B must have the shape of C or be broadcastable to it. Returns true when broadcasting is needed
+static bool check_broadcast(Tensor *A, Tensor *B, Tensor *C, const string &caller){
+    if (Tensor::sameShape(A, B) && Tensor::sameShape(A, C)) return false;
+
+    if (broadcast_shape(A->shape, B->shape) != C->shape) {
+        A->info();
+        B->info();
+        C->info();
+        msg("Incompatible dims", caller);
+    }
+    return true;
+}
+
+// CPU kernels walk broadcast operands with stride 0. The other devices get expanded copies
+static void expand_operands(Tensor *&A, Tensor *&B, Tensor *C){
+    if (!Tensor::sameShape(A, C)) A = Tensor::expand(A, C->shape);
+    if (!Tensor::sameShape(B, C)) B = Tensor::expand(B, C->shape);
+}
+
+static void delete_operands(Tensor *A, Tensor *B, Tensor *A_ori, Tensor *B_ori){
+    if (A != A_ori) delete A;
+    if (B != B_ori) delete B;
+}
+
+
 void Tensor::add(float scA, Tensor *A, float scB, Tensor *B, Tensor *C, int incC) {
     ///////////////////////////////////////
     //// sum C=(sca*A)+(scb*B)
     //// or C+=(sca*A)+(scb*B) if incC is 1
     //// Dimensions and types must be compatible
     ///////////////////////////////////////
-    int aux = 0;
-
-
     if ((A->device != B->device) || (A->device != C->device)) msg("Tensors in different devices", "Tensor::add_");
-    if ((!sameShape(A, B)) || (!sameShape(A, C))) {
-        A->info();
-        B->info();
-        C->info();
-        msg("Incompatible dims", "Tensor::add");
-    }
+    bool broadcast = check_broadcast(A, B, C, "Tensor::add");
 
     C->tsem->lock();
     if (A->isCPU()) {
@@ -2137,7 +2172,10 @@ void Tensor::add(float scA, Tensor *A, float scB, Tensor *B, Tensor *C, int incC
 #ifdef cGPU
     else if (A->isGPU())
       {
-        gpu_add(scA, A, scB, B, C, incC);
+        Tensor *Ae = A, *Be = B;
+        if (broadcast) expand_operands(Ae, Be, C);
+        gpu_add(scA, Ae, scB, Be, C, incC);
+        delete_operands(Ae, Be, A, B);
       }
 #endif
 #ifdef cFPGA
@@ -2189,7 +2227,7 @@ void Tensor::el_div(Tensor *A, Tensor *B, Tensor *C, int incC) {
     ///////////////////////////////////////
 
     if ((A->device != B->device) || (A->device != C->device)) msg("Tensors in different devices", "Tensor::el_div");
-    if ((!sameShape(A, B)) || (!sameShape(A, C))) msg("Incompatible dims", "Tensor::el_div");
+    bool broadcast = check_broadcast(A, B, C, "Tensor::el_div");
 
     C->tsem->lock();
     if (A->isCPU()) {
@@ -2198,7 +2236,10 @@ void Tensor::el_div(Tensor *A, Tensor *B, Tensor *C, int incC) {
 #ifdef cGPU
     else if (A->isGPU())
       {
-        gpu_el_div(A,B,C,incC);
+        Tensor *Ae = A, *Be = B;
+        if (broadcast) expand_operands(Ae, Be, C);
+        gpu_el_div(Ae,Be,C,incC);
+        delete_operands(Ae, Be, A, B);
       }
 #endif
 #ifdef cFPGA
@@ -2213,6 +2254,27 @@ void Tensor::el_div(Tensor *A, Tensor *B, Tensor *C, int incC) {
 
 
 
+// Checks the operands of C = A·B. The product is written straight into C, so C cannot be an operand
+static void check_mult2D(Tensor *A, int tA, Tensor *B, int tB, Tensor *C, const string &name){
+    if ((A->device != B->device) || (A->device != C->device)) {A->info();B->info();C->info();msg("Tensors in different devices", name);}
+    if ((A->ndim != 2) || (B->ndim != 2) || (C->ndim != 2)) msg("Only 2D tensors", name);
+    if (!tA) {
+        if (!tB) {
+            if ((A->shape[1] != B->shape[0]) || (A->shape[0] != C->shape[0]) || (B->shape[1] != C->shape[1]))
+                msg("Incompatible dims", name);
+        } else if ((A->shape[1] != B->shape[1]) || (A->shape[0] != C->shape[0]) || (B->shape[0] != C->shape[1]))
+            msg("Incompatible dims", name);
+    } else {
+        if (!tB) {
+            if ((A->shape[0] != B->shape[0]) || (A->shape[1] != C->shape[0]) || (B->shape[1] != C->shape[1]))
+                msg("Incompatible dims", name);
+        } else if ((A->shape[0] != B->shape[1]) || (A->shape[1] != C->shape[0]) || (B->shape[0] != C->shape[1]))
+            msg("Incompatible dims", name);
+    }
+    if ((C->ptr == A->ptr) || (C->ptr == B->ptr)) msg("The output cannot be an operand", name);
+    if (!C->is_contiguous()) msg("The output cannot be a strided view", name);
+}
+
 void Tensor::mult2D(Tensor *A, int tA, Tensor *B, int tB, Tensor *C, int incC) {
     ///////////////////////////////////////
     //// MULT2D C=A*B
@@ -2223,21 +2285,7 @@ void Tensor::mult2D(Tensor *A, int tA, Tensor *B, int tB, Tensor *C, int incC) {
     //// Only for 2D Tensors
     ///////////////////////////////////////
 
-    if ((A->device != B->device) || (A->device != C->device)) {A->info();B->info();C->info();msg("Tensors in different devices", "Tensor::mult2D");}
-    if ((A->ndim != 2) || (B->ndim != 2) || (C->ndim != 2)) msg("Only 2D tensors", "Tensor::mult2D");
-    if (!tA) {
-        if (!tB) {
-            if ((A->shape[1] != B->shape[0]) || (A->shape[0] != C->shape[0]) || (B->shape[1] != C->shape[1]))
-                msg("Incompatible dims", "Tensor::mult2D");
-        } else if ((A->shape[1] != B->shape[1]) || (A->shape[0] != C->shape[0]) || (B->shape[0] != C->shape[1]))
-            msg("Incompatible dims", "Tensor::mult2D");
-    } else {
-        if (!tB) {
-            if ((A->shape[0] != B->shape[0]) || (A->shape[1] != C->shape[0]) || (B->shape[1] != C->shape[1]))
-                msg("Incompatible dims", "Tensor::mult2D");
-        } else if ((A->shape[0] != B->shape[1]) || (A->shape[1] != C->shape[0]) || (B->shape[0] != C->shape[1]))
-            msg("Incompatible dims", "Tensor::mult2D");
-    }
+    check_mult2D(A, tA, B, tB, C, "Tensor::mult2D");
 
 
     C->tsem->lock();
@@ -2261,28 +2309,61 @@ void Tensor::mult2D(Tensor *A, int tA, Tensor *B, int tB, Tensor *C, int incC) {
 }
 
 
+void Tensor::mult2D_batched(const vector<Tensor*> &A, int tA, const vector<Tensor*> &B, int tB, const vector<Tensor*> &C, int incC) {
+    ///////////////////////////////////////
+    //// C[i] = A[i]*B[i] for independent products
+    //// (e.g. the gates of a recurrent cell), see mult2D
+    ///////////////////////////////////////
+
+    if ((A.size() != C.size()) || (B.size() != C.size())) msg("Different number of operands", "Tensor::mult2D_batched");
+    if (C.empty()) return;
+    for (int i = 0; i < C.size(); i++) {
+        check_mult2D(A[i], tA, B[i], tB, C[i], "Tensor::mult2D_batched");
+        if (A[i]->device != A[0]->device) msg("Tensors in different devices", "Tensor::mult2D_batched");
+        for (int j = 0; j < i; j++)
+            if (C[i] == C[j]) msg("Outputs must be different tensors", "Tensor::mult2D_batched");
+    }
+
+    for (auto t : C) t->tsem->lock();
+
+    if (A[0]->isCPU()) {
+        cpu_mult2D_batched(A, tA, B, tB, C, incC);
+    }
+#ifdef cGPU
+    else if (A[0]->isGPU())
+      {
+        for (int i = 0; i < C.size(); i++) gpu_mult2D(A[i],tA,B[i],tB,C[i],incC);
+      }
+#endif
+#ifdef cFPGA
+    else {
+
+    }
+#endif
+    for (auto t : C) t->tsem->unlock();
+}
+
+
 void Tensor::el_mult(Tensor *A, Tensor *B, Tensor *C, int incC) {
     ///////////////////////////////////////
     //// Element Mult C=A.*B
     //// incC 1 means C+=A.*B (increment over C)
     //// Dimensions must be compatible
     ///////////////////////////////////////
-    C->tsem->lock();
     if ((A->device != B->device) || (A->device != C->device)) msg("Tensors in different devices", "Tensor::el_mult");
-    if ((!sameShape(A, B)) || (!sameShape(A, C))) {
-        A->info();
-        B->info();
-        C->info();
-        msg("Incompatible dims", "Tensor::el_mult");
-    }
+    bool broadcast = check_broadcast(A, B, C, "Tensor::el_mult");
 
+    C->tsem->lock();
     if (A->isCPU()) {
         cpu_el_mult(A, B, C, incC);
     }
 #ifdef cGPU
     else if (A->isGPU())
       {
-         gpu_el_mult(A,B,C,incC);
+         Tensor *Ae = A, *Be = B;
+         if (broadcast) expand_operands(Ae, Be, C);
+         gpu_el_mult(Ae,Be,C,incC);
+         delete_operands(Ae, Be, A, B);
       }
 #endif
 #ifdef cFPGA
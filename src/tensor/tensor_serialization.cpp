@@ -8,6 +8,7 @@
 */
 
 #include <utility>
+#include <algorithm>
 
 #include "eddl/tensor/tensor.h"
 #include "eddl/hardware/cpu/cpu_tensor.h"
@@ -76,6 +77,94 @@ Tensor* Tensor::loadfs(std::ifstream &ifs, string format) {
     return nullptr; // To silent warnings
 }
 
+void Tensor::loadfs_(std::ifstream &ifs, string format) {
+    if (format!="bin") {
+        Tensor *t = Tensor::loadfs(ifs, format);
+        Tensor::copy(t, this);
+        delete t;
+        return;
+    }
+
+    int r_ndim;
+    ifs.read(reinterpret_cast<char *>(&r_ndim),  sizeof(int));
+    vector<int> r_shape(r_ndim);
+    ifs.read(reinterpret_cast<char *>(r_shape.data()), r_ndim * sizeof(int));
+
+    if (r_shape != this->shape) {
+        msg("The stored shape does not match the shape of the tensor", "Tensor::loadfs_");
+    }
+
+    if (this->isCPU() && this->is_contiguous()) {
+        // No intermediate allocation
+        ifs.read(reinterpret_cast<char*>(this->ptr), this->size * sizeof(float));
+    } else {
+        auto *t = new Tensor(r_shape, DEV_CPU);
+        ifs.read(reinterpret_cast<char*>(t->ptr), t->size * sizeof(float));
+        Tensor::copy(t, this);
+        delete t;
+    }
+}
+
+Tensor* Tensor::load_compact(const string& filename, int dtype, float scale, string format){
+    // Infer format from filename
+    if(format.empty()){
+        format = get_extension(filename);
+    }
+    if (format!="bin") msg("Format not supported for compact tensors: *.'" + format + "'", "Tensor::load_compact");
+    if (dtype!=DTYPE_UINT8 && dtype!=DTYPE_UINT16) msg("Unsupported storage type", "Tensor::load_compact");
+
+    std::ifstream ifs(filename.c_str(), std::ios::in | std::ios::binary);
+    if (!ifs.good()){
+        msg("File not found. Check the file name and try again.", "Tensor::load_compact");
+    }
+
+    int r_ndim;
+    ifs.read(reinterpret_cast<char *>(&r_ndim),  sizeof(int));
+    vector<int> r_shape(r_ndim);
+    ifs.read(reinterpret_cast<char *>(r_shape.data()), r_ndim * sizeof(int));
+
+    auto *t = new Tensor();
+    t->updateShape(r_shape);
+    t->updateSize();
+    t->updateStrides();
+
+    int esize = cpu_dtype_size(dtype);
+    auto *data = new char[t->size * esize];
+
+    // Convert the content by chunks, the float data is never fully in memory
+    const long chunk = 1 << 16;
+    vector<float> buffer(chunk);
+    for (long offset = 0; offset < (long)t->size; offset += chunk) {
+        long n = std::min(chunk, (long)t->size - offset);
+        ifs.read(reinterpret_cast<char*>(buffer.data()), n * sizeof(float));
+        cpu_compact(buffer.data(), data + offset * esize, n, dtype);
+    }
+    if (!ifs.good()) msg("Truncated file", "Tensor::load_compact");
+    ifs.close();
+
+    t->dtype = dtype;
+    t->cptr = data;
+    t->cscale = scale;
+    return t;
+}
+
+void Tensor::compact_(int dtype, float scale){
+    if (dtype!=DTYPE_UINT8 && dtype!=DTYPE_UINT16) msg("Unsupported storage type", "Tensor::compact_");
+    if (this->is_compact()) msg("The tensor is already compact", "Tensor::compact_");
+    if (!this->isCPU() || this->isview) msg("Only CPU tensors that own their data can be compacted", "Tensor::compact_");
+
+    auto *data = new char[this->size * cpu_dtype_size(dtype)];
+    cpu_compact(this->ptr, data, this->size, dtype);
+
+    this->deleteData();
+    delete (Eigen::Map<Eigen::MatrixXf> *)this->ptr2;  // Only the map of 2D tensors, not their data
+    this->ptr2 = nullptr;
+
+    this->dtype = dtype;
+    this->cptr = data;
+    this->cscale = scale;
+}
+
 Tensor* Tensor::load_from_bin(std::ifstream &ifs){
     int r_ndim;
 
@@ -91,7 +180,7 @@ Tensor* Tensor::load_from_bin(std::ifstream &ifs){
     for(int i=0; i<r_ndim; i++){ r_size *= r_shape[i]; }
 
     // Load content (row-major)
-    auto *r_ptr = new float[r_size];
+    float *r_ptr = get_fmem(r_size, "Tensor::load_from_bin");
     ifs.read(reinterpret_cast<char*>(r_ptr), r_size * sizeof(float));
 
     // Return new tensor
@@ -112,25 +201,19 @@ Tensor* Tensor::load_from_img(const string &filename, const string &format){
     Tensor* t = nullptr;
 
     try {
-        int t_width, t_height, t_channels, t_size;
+        int t_width, t_height, t_channels;
 
         // IMPORTANT! There might be problems if the image is grayscale, a png with 3 components,...
         // Set number of channels to read
         unsigned char *pixels = stbi_load(filename.c_str(), &t_width, &t_height, &t_channels, STBI_default);
 
-        // Cast pointer
-        // Data in row-major
-        t_size = t_width * t_height * t_channels;
-        auto *t_data = new float[t_size];
-        for (int i = 0; i < t_size; i++) { t_data[i] = (float) pixels[i]; }
+        // Data received as HxWxC, and has to be presented as CxHxW. Reordered while it is converted
+        t = new Tensor({t_channels, t_height, t_width}, DEV_CPU);
+        cpu_image_to_chw(pixels, t_height, t_width, t_channels, t->ptr, t_height, t_width, 1.0f);
 
         // Free image
         stbi_image_free(pixels);
 
-        // Re-order components. Data received as HxWxC, and has to be presented as CxHxW
-        t = new Tensor({t_height, t_width, t_channels}, t_data, DEV_CPU);
-        t = Tensor::permute(t, {2, 0, 1});
-
     } catch(const std::bad_array_new_length &e) {
         msg("There was an error opening the image", "Tensor::load_from_img");
     }
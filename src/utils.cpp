@@ -26,6 +26,10 @@
 #include <vector>
 #include <iomanip>
 #include <limits>
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "eddl/system_info.h"
 #include "eddl/utils.h"
@@ -64,44 +68,243 @@ void msg(const string& text, const string& title) {
 }
 
 
-float *get_fmem(unsigned long int size, const string &str){
-    // Careful with memory overcommitment:
-    // https://stackoverflow.com/questions/48585079/malloc-on-linux-without-overcommitting
-    // TODO: This function does not work properly (...but it does, at least most of the time -for linux and mac-)
-    float* ptr = nullptr;
-    bool error = false;
+// CPU tensor memory ********************
+// The blocks are 64-byte aligned and rounded up to a size class (4 classes per power of two). The
+// released blocks are kept in a cache of the thread that releases them (up to FMEM_THREAD_CACHE
+// bytes) or in a shared pool (up to FMEM_POOL_CACHE bytes, beyond which they go back to the system),
+// and reused by the next requests of the same class. The blocks of get_fmem are registered, so that
+// the pointers from new float[] given to a tensor are still released with delete[]
+
+#define FMEM_ALIGNMENT 64
+#define FMEM_MIN_BLOCK 256
+#define FMEM_THREAD_CACHE (64*1024*1024)
+#define FMEM_POOL_CACHE (256*1024*1024)
+#define FMEM_SHARDS 16
+
+struct FMemHeader {
+    void *raw;                  // Address returned by malloc
+    size_t bytes;               // Size class
+};
+
+struct FMemPool {
+    std::mutex mtx;
+    std::unordered_map<size_t, std::vector<float *>> blocks;
+    size_t bytes = 0;
+};
+
+// Blocks allocated by get_fmem (cached or not), sharded by address to keep the locks short
+struct FMemRegistry {
+    std::mutex mtx[FMEM_SHARDS];
+    std::unordered_set<float *> blocks[FMEM_SHARDS];
+
+    static int shard(float *ptr) { return (reinterpret_cast<uintptr_t>(ptr) / FMEM_ALIGNMENT) % FMEM_SHARDS; }
+
+    void add(float *ptr) {
+        int k = shard(ptr);
+        std::lock_guard<std::mutex> lock(mtx[k]);
+        blocks[k].insert(ptr);
+    }
+
+    bool remove(float *ptr) {
+        int k = shard(ptr);
+        std::lock_guard<std::mutex> lock(mtx[k]);
+        return blocks[k].erase(ptr) > 0;
+    }
+
+    bool contains(float *ptr) {
+        int k = shard(ptr);
+        std::lock_guard<std::mutex> lock(mtx[k]);
+        return blocks[k].count(ptr) > 0;
+    }
+};
+
+static std::atomic<unsigned long long> fmem_total(0);
+static std::atomic<unsigned long long> fmem_requests(0);
+static std::atomic<unsigned long long> fmem_hits(0);
+static std::atomic<unsigned long long> fmem_sys_allocs(0);
+static std::atomic<unsigned long long> fmem_sys_frees(0);
+static std::atomic<long long> fmem_in_use(0);
+static std::atomic<long long> fmem_cached(0);
+static std::atomic<long long> fmem_peak(0);
+
+// Never destroyed, so that the threads can release their caches at any time
+static FMemPool &fmem_pool(){
+    static auto *pool = new FMemPool();
+    return *pool;
+}
+
+static FMemRegistry &fmem_registry(){
+    static auto *registry = new FMemRegistry();
+    return *registry;
+}
 
+static inline FMemHeader *fmem_header(float *ptr){
+    return reinterpret_cast<FMemHeader *>(reinterpret_cast<char *>(ptr) - sizeof(FMemHeader));
+}
+
+// Gives a cached block back to the system
+static void fmem_release(float *ptr, size_t bytes){
+    fmem_registry().remove(ptr);
+    fmem_cached.fetch_sub(bytes, std::memory_order_relaxed);
+    fmem_sys_frees.fetch_add(1, std::memory_order_relaxed);
+    free(fmem_header(ptr)->raw);
+}
 
-    // Check if free memory is bigger than requested
-    unsigned long freemem = get_free_mem();
-    if (size*sizeof(float) > freemem) {
-        error=true;
+// Caches a released block in the shared pool, or frees it if the pool is full. Needs pool.mtx
+static void fmem_pool_push(FMemPool &pool, float *ptr, size_t bytes){
+    if (pool.bytes + bytes > FMEM_POOL_CACHE) {
+        fmem_release(ptr, bytes);
+        return;
     }
+    pool.blocks[bytes].push_back(ptr);
+    pool.bytes += bytes;
+}
+
+struct FMemThreadCache {
+    std::unordered_map<size_t, std::vector<float *>> blocks;
+    size_t bytes = 0;
 
-    // New vs Malloc *******************
-    // New is the C++ way of doing it
-    // New is type-safe, Malloc is not
-    // New calls your type constructor, Malloc not - Same for destructor
-    // New is an operator, Malloc a function (slower)
-    try{
-        ptr = new float[size];
-        //ptr=(float *)malloc(size*sizeof(float));
-        //ptr=aligned_alloc(64, size*sizeof(float));
+    ~FMemThreadCache(){
+        // Give the blocks to the other threads
+        FMemPool &pool = fmem_pool();
+        std::lock_guard<std::mutex> lock(pool.mtx);
+        for (auto &b : blocks)
+            for (auto ptr : b.second) fmem_pool_push(pool, ptr, b.first);
     }
-    catch (std::bad_alloc& badAlloc){
-        error=true;
+};
+
+static thread_local FMemThreadCache fmem_cache;
+
+static size_t fmem_size_class(size_t bytes){
+    if (bytes <= FMEM_MIN_BLOCK) return FMEM_MIN_BLOCK;
+
+    // 4 classes per power of two: at most 25% wasted
+    size_t p = 1;
+    while ((p << 1) < bytes) p <<= 1;
+    size_t step = p >> 2;
+    return (bytes + step - 1) / step * step;
+}
+
+static void fmem_update_peak(long long in_use){
+    long long peak = fmem_peak.load(std::memory_order_relaxed);
+    while (in_use > peak && !fmem_peak.compare_exchange_weak(peak, in_use, std::memory_order_relaxed)) {}
+}
+
+unsigned long long get_fmem_total(){
+    return fmem_total.load(std::memory_order_relaxed);
+}
+
+FMemStats get_fmem_stats(){
+    FMemStats stats;
+    stats.requests = fmem_requests.load();
+    stats.cache_hits = fmem_hits.load();
+    stats.system_allocs = fmem_sys_allocs.load();
+    stats.system_frees = fmem_sys_frees.load();
+    stats.bytes_in_use = fmem_in_use.load();
+    stats.bytes_cached = fmem_cached.load();
+    stats.peak_bytes_in_use = fmem_peak.load();
+    return stats;
+}
+
+float *get_fmem(unsigned long int size, const string &str){
+    size_t bytes = fmem_size_class(size * sizeof(float));
+    float *ptr = nullptr;
+
+    fmem_requests.fetch_add(1, std::memory_order_relaxed);
+    fmem_total.fetch_add(size * sizeof(float), std::memory_order_relaxed);
+
+    // Reuse a released block of the same class
+    auto it = fmem_cache.blocks.find(bytes);
+    if (it != fmem_cache.blocks.end() && !it->second.empty()) {
+        ptr = it->second.back();
+        it->second.pop_back();
+        fmem_cache.bytes -= bytes;
+    } else {
+        FMemPool &pool = fmem_pool();
+        std::lock_guard<std::mutex> lock(pool.mtx);
+        auto pit = pool.blocks.find(bytes);
+        if (pit != pool.blocks.end() && !pit->second.empty()) {
+            ptr = pit->second.back();
+            pit->second.pop_back();
+            pool.bytes -= bytes;
+        }
     }
 
-    // Check for errors
-    // Not enough free memory
-    if (error) {
-        delete ptr;
-        throw std::runtime_error("Error allocating " + string(bytes2human(size * sizeof(float))) + " in " + string(str));
+    if (ptr != nullptr) {
+        fmem_hits.fetch_add(1, std::memory_order_relaxed);
+        fmem_cached.fetch_sub(bytes, std::memory_order_relaxed);
+    } else {
+        // Careful with memory overcommitment:
+        // https://stackoverflow.com/questions/48585079/malloc-on-linux-without-overcommitting
+        // TODO: This check does not work properly (...but it does, at least most of the time -for linux and mac-)
+        bool error = bytes > get_free_mem();
+
+        void *raw = nullptr;
+        if (!error) {
+            raw = malloc(bytes + sizeof(FMemHeader) + FMEM_ALIGNMENT);
+            error = (raw == nullptr);
+        }
+
+        // Not enough free memory
+        if (error) {
+            free(raw);
+            throw std::runtime_error("Error allocating " + string(bytes2human(size * sizeof(float))) + " in " + string(str));
+        }
+
+        auto addr = reinterpret_cast<uintptr_t>(raw) + sizeof(FMemHeader);
+        addr = (addr + FMEM_ALIGNMENT - 1) & ~(uintptr_t)(FMEM_ALIGNMENT - 1);
+        ptr = reinterpret_cast<float *>(addr);
+
+        FMemHeader *h = fmem_header(ptr);
+        h->raw = raw;
+        h->bytes = bytes;
+        fmem_registry().add(ptr);
+        fmem_sys_allocs.fetch_add(1, std::memory_order_relaxed);
     }
 
+    fmem_update_peak(fmem_in_use.fetch_add(bytes, std::memory_order_relaxed) + bytes);
     return ptr;
 }
 
+void free_fmem(float *ptr){
+    if (ptr == nullptr) return;
+
+    if (!fmem_registry().contains(ptr)) {  // Not from get_fmem
+        delete[] ptr;
+        return;
+    }
+
+    size_t bytes = fmem_header(ptr)->bytes;
+    fmem_in_use.fetch_sub(bytes, std::memory_order_relaxed);
+    fmem_cached.fetch_add(bytes, std::memory_order_relaxed);
+
+    if (fmem_cache.bytes + bytes <= FMEM_THREAD_CACHE) {
+        fmem_cache.blocks[bytes].push_back(ptr);
+        fmem_cache.bytes += bytes;
+    } else {
+        FMemPool &pool = fmem_pool();
+        std::lock_guard<std::mutex> lock(pool.mtx);
+        fmem_pool_push(pool, ptr, bytes);
+    }
+}
+
+// The per-thread caches take no lock, so only the one of this thread can be trimmed
+void trim_fmem(){
+    auto release = [](std::unordered_map<size_t, std::vector<float *>> &blocks) {
+        for (auto &b : blocks)
+            for (auto ptr : b.second) fmem_release(ptr, b.first);
+        blocks.clear();
+    };
+
+    release(fmem_cache.blocks);
+    fmem_cache.bytes = 0;
+
+    FMemPool &pool = fmem_pool();
+    std::lock_guard<std::mutex> lock(pool.mtx);
+    release(pool.blocks);
+    pool.bytes = 0;
+}
+
 
 string bytes2human(unsigned long long int bytes, int decimals){
     vector<string> prefix = {"B", "KB", "MB", "GB", "TB", "PB", "EB", "ZB", "YB"};
@@ -285,6 +488,24 @@ vector<int> shape2stride(const vector<int>& shape){
     return stride;
 }
 
+vector<int> broadcast_shape(const vector<int>& ishape1, const vector<int>& ishape2){
+    // NumPy rules: shapes are aligned to the right and size-1 dimensions are stretched
+    int ndim = std::max(ishape1.size(), ishape2.size());
+    vector<int> oshape(ndim, 1);
+
+    for(int i=0; i<ndim; i++){
+        int d1 = i < (ndim-(int)ishape1.size()) ? 1 : ishape1[i-(ndim-ishape1.size())];
+        int d2 = i < (ndim-(int)ishape2.size()) ? 1 : ishape2[i-(ndim-ishape2.size())];
+
+        if(d1 != d2 && d1 != 1 && d2 != 1){
+            msg("Shapes can not be broadcast together", "utils::broadcast_shape");
+        }
+        oshape[i] = std::max(d1, d2);
+    }
+
+    return oshape;
+}
+
 vector<int> permute_shape(const vector<int>& ishape, const vector<int>& dims){
     vector<int> oshape;
     if(dims.size()!=ishape.size()){
@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+#include <string>
+#include <cstdio>
+#include <fstream>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "eddl/tensor/tensor.h"
+#include "eddl/dataset/image_folder.h"
+
+using namespace std;
+
+
+// Two classes of flat images (class 0: 50, class 1: 200) with different sizes
+static vector<string> write_image_folder(const string &root){
+    vector<string> files;
+    mkdir(root.c_str(), 0755);
+    mkdir((root + "/a").c_str(), 0755);
+    mkdir((root + "/b").c_str(), 0755);
+
+    for(int i=0; i<3; i++){
+        Tensor* t = Tensor::full({3, 6 + i, 8}, 50.0f);
+        string fname = root + "/a/img" + to_string(i) + ".png";
+        t->save(fname);
+        files.push_back(fname);
+        delete t;
+
+        t = Tensor::full({3, 10, 5 + i}, 200.0f);
+        fname = root + "/b/img" + to_string(i) + ".png";
+        t->save(fname);
+        files.push_back(fname);
+        delete t;
+    }
+    return files;
+}
+
+static void remove_image_folder(const string &root, const vector<string> &files){
+    for(auto &f : files) std::remove(f.c_str());
+    rmdir((root + "/a").c_str());
+    rmdir((root + "/b").c_str());
+    rmdir(root.c_str());
+}
+
+TEST(DatasetTestSuite, image_folder){
+    string root = "image_folder_test";
+    vector<string> files = write_image_folder(root);
+
+    ImageFolder data(root, 4, 4, 3, 2, true, 2, 2, 1.0f/255.0f);
+    ASSERT_EQ(data.num_samples(), 6);
+    ASSERT_EQ(data.num_classes(), 2);
+    ASSERT_EQ(data.num_batches(), 3);
+
+    Tensor* x = new Tensor({2, 3, 4, 4});
+    Tensor* y = new Tensor({2, 2});
+    for(int epoch=0; epoch<2; epoch++){
+        data.start();
+
+        int batches = 0, ones = 0;
+        while(data.next_batch(x, y)){
+            for(int i=0; i<2; i++){
+                int label = y->ptr[i*2 + 1] == 1.0f;
+                float value = label ? 200.0f/255.0f : 50.0f/255.0f;
+                for(int j=0; j<3*4*4; j++) ASSERT_NEAR(x->ptr[i*48 + j], value, 10e-4);
+                ones += label;
+            }
+            batches++;
+        }
+        ASSERT_EQ(batches, 3);
+        ASSERT_EQ(ones, 3);
+    }
+
+    // List file (one "image label" per line)
+    string list = root + "/list.txt";
+    std::ofstream ofs(list);
+    ofs << "a/img0.png 0\nb/img0.png 1\n";
+    ofs.close();
+
+    ImageFolder data_list(list, 4, 4, 1, 1, false, 1, 1);
+    ASSERT_EQ(data_list.num_samples(), 2);
+    Tensor* x1 = new Tensor({1, 1, 4, 4});
+    Tensor* y1 = new Tensor({1, 2});
+    data_list.start();
+    ASSERT_TRUE(data_list.next_batch(x1, y1));
+    ASSERT_NEAR(x1->ptr[0], 50.0f/255.0f, 10e-4);
+    ASSERT_TRUE(data_list.next_batch(x1, y1));
+    ASSERT_EQ(y1->ptr[1], 1.0f);
+    ASSERT_FALSE(data_list.next_batch(x1, y1));
+
+    // Augmented by the decode threads (shifted half the width, filled with 0)
+    data_list.set_augmentation(AffineDescriptor({0.5f, 0.5f}, {0.0f, 0.0f}, {0.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 0.0f}, {1.0f, 1.0f},
+                                                false, false, "nearest"));
+    data_list.start();
+    ASSERT_TRUE(data_list.next_batch(x1, y1));
+    ASSERT_NEAR(x1->ptr[1], 0.0f, 10e-4);
+    ASSERT_NEAR(x1->ptr[2], 50.0f/255.0f, 10e-4);
+    data_list.stop();
+
+    // An image that can not be decoded fails only its batch (decoded ahead or not), and its buffer
+    // is reused by the next ones
+    string missing = root + "/missing.txt";
+    ofs.open(missing);
+    ofs << "a/img0.png 0\nnone.png 1\na/img1.png 0\nb/img1.png 1\n";
+    ofs.close();
+    ImageFolder data_missing(missing, 4, 4, 1, 1, false, 2, 3);
+    data_missing.start();
+    ASSERT_TRUE(data_missing.next_batch(x1, y1));
+    ASSERT_EQ(y1->ptr[0], 1.0f);
+    ASSERT_ANY_THROW(data_missing.next_batch(x1, y1));
+    ASSERT_TRUE(data_missing.next_batch(x1, y1));
+    ASSERT_EQ(y1->ptr[0], 1.0f);
+    ASSERT_TRUE(data_missing.next_batch(x1, y1));
+    ASSERT_EQ(y1->ptr[1], 1.0f);
+    ASSERT_FALSE(data_missing.next_batch(x1, y1));
+    data_missing.stop();
+
+    files.push_back(list);
+    files.push_back(missing);
+    remove_image_folder(root, files);
+    delete x; delete y; delete x1; delete y1;
+}
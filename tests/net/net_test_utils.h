@@ -0,0 +1,50 @@
+#ifndef EDDL_NET_TEST_UTILS_H
+#define EDDL_NET_TEST_UTILS_H
+
+#include <gtest/gtest.h>
+#include <cmath>
+#include <string>
+
+#include "eddl/apis/eddl.h"
+
+using namespace std;
+
+using namespace eddl;
+
+
+// Small classifier of the net tests: Input({10}) -> ReLu(Dense(hidden)) -> Softmax(Dense(classes))
+inline model mlp_net(int hidden=16, int classes=3, optimizer opt=nullptr, compserv cs=nullptr){
+    layer in = Input({10});
+    layer l = ReLu(Dense(in, hidden));
+    layer out = Softmax(Dense(l, classes));
+    model net = Model({in}, {out});
+    build(net, opt != nullptr ? opt : sgd(0.1), {"soft_cross_entropy"}, {"categorical_accuracy"},
+          cs != nullptr ? cs : CS_CPU(1), true);
+    return net;
+}
+
+// Deterministic samples x[i] = sin(step * i), where sample i is of class i % classes
+inline void sin_batch(const vector<int> &shape, int classes, Tensor *&x, Tensor *&y, float step=0.37f){
+    x = Tensor::empty(shape);
+    y = Tensor::zeros({shape[0], classes});
+    for(int i=0; i<x->size; i++) x->ptr[i] = std::sin(step * i);
+    for(int i=0; i<shape[0]; i++) y->ptr[i * classes + i % classes] = 1.0f;
+}
+
+// Copies the params of every layer (nets of the same topology)
+inline void copy_params(model from, model to){
+    for(int i=0; i<from->layers.size(); i++)
+        for(int j=0; j<from->layers[i]->params.size(); j++)
+            Tensor::copy(from->layers[i]->params[j], to->layers[i]->params[j]);
+}
+
+// Same params in both nets, up to tol (absolute, as Tensor::equivalent)
+inline ::testing::AssertionResult same_params(model a, model b, float tol){
+    for(int i=0; i<a->layers.size(); i++)
+        for(int j=0; j<a->layers[i]->params.size(); j++)
+            if (!Tensor::equivalent(a->layers[i]->params[j], b->layers[i]->params[j], tol))
+                return ::testing::AssertionFailure() << a->layers[i]->name << ", param " << j;
+    return ::testing::AssertionSuccess();
+}
+
+#endif //EDDL_NET_TEST_UTILS_H
@@ -0,0 +1,85 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <cmath>
+
+#include "eddl/apis/eddl.h"
+#include "eddl/layers/da/layer_da.h"
+
+using namespace std;
+
+using namespace eddl;
+
+
+static Net* get_augment_network(){
+    layer in = Input({1, 6, 6});
+    layer l = ReLu(Conv(in, 2, {3, 3}));
+    layer out = Activation(Dense(Flatten(l), 2), "softmax");
+    model net = Model({in}, {out});
+
+    build(net,
+          sgd(0.01), // Optimizer
+          {"soft_cross_entropy"}, // Losses
+          {"categorical_accuracy"},  // Metrics
+          CS_CPU(1), true);
+
+    return net;
+}
+
+TEST(NetTestSuite, net_augment){
+    Net* net = get_augment_network();
+    Tensor* x = Tensor::randu({8, 1, 6, 6});
+    Tensor* y = Tensor::zeros({8, 2});
+    for(int i=0; i<8; i++) { y->ptr[i*2 + i%2] = 1.0f; }
+
+    // Vertical flip of every sample
+    set_augmentation(net, AffineDescriptor({0.0f, 0.0f}, {0.0f, 0.0f}, {180.0f, 180.0f}, {1.0f, 1.0f}, {0.0f, 0.0f}, {1.0f, 1.0f},
+                                           true, false, "nearest"));
+
+    // The prefetched batch holds the selected samples, augmented
+    net->prefetch_batch({x}, {y}, {3, 5}, 0);
+    net->wait_prefetch();
+    Tensor* xa = net->da_X[0][0];
+    ASSERT_EQ(xa->shape, vector<int>({2, 1, 6, 6}));
+    for(int i=0; i<6; i++){
+        for(int j=0; j<6; j++){
+            // 180 degrees (+ horizontal flip with probability 0.5) keep the rows reversed
+            float v = xa->ptr[36 + i*6 + j];
+            float a = x->ptr[5*36 + (5-i)*6 + j];
+            float b = x->ptr[5*36 + (5-i)*6 + (5-j)];
+            ASSERT_TRUE(std::fabs(v - a) < 10e-4 || std::fabs(v - b) < 10e-4);
+        }
+    }
+    ASSERT_EQ(net->da_Y[0][0]->ptr[1], 1.0f);  // Sample 3
+    ASSERT_EQ(net->da_Y[0][0]->ptr[3], 1.0f);  // Sample 5
+
+    // Training with the background pipeline
+    fit(net, {x}, {y}, 2, 2);
+    ASSERT_EQ(net->tr_batches, 8);
+
+    // An error of the worker is raised by wait_prefetch (here, a batch buffer that can not be written),
+    // and the worker goes on with the next batches
+    Tensor* yc = Tensor::zeros({2, 2});
+    yc->compact_(DTYPE_UINT8, 1.0f);
+    delete net->da_Y[0][0];
+    net->da_Y[0][0] = yc;
+    net->prefetch_batch({x}, {y}, {3, 5}, 0);
+    ASSERT_ANY_THROW(net->wait_prefetch());
+    net->prefetch_batch({x}, {y}, {3, 5}, 1);
+    net->wait_prefetch();
+    ASSERT_EQ(net->da_Y[1][0]->ptr[3], 1.0f);
+
+    delete net;
+    delete x; delete y;
+}
+
+TEST(NetTestSuite, net_random_affine_translate){
+    // Each axis has its own translation range
+    layer in = Input({1, 6, 6});
+    auto *l = (LAffineRandom *)RandomAffine(in, {0.0f, 0.0f}, {0.1f, 0.2f}, {-0.3f, 0.0f}, {1.0f, 1.0f}, {0.0f, 0.0f});
+    ASSERT_EQ(l->spec.factor_x, vector<float>({0.1f, 0.2f}));
+    ASSERT_EQ(l->spec.factor_y, vector<float>({-0.3f, 0.0f}));
+
+    delete l;
+    delete in;
+}
@@ -0,0 +1,94 @@
+#include <gtest/gtest.h>
+#include <thread>
+
+#include "eddl/apis/eddl.h"
+#include "eddl/net/buckets.h"
+#include "net_test_utils.h"
+
+using namespace std;
+
+using namespace eddl;
+
+
+// Two replicas on CPU (as the snets of several GPUs), each one with a part of the batch
+TEST(NetTestSuite, net_buckets){
+    model a = mlp_net();
+    model b = mlp_net();
+    model ref = mlp_net();
+    copy_params(a, b);
+    copy_params(a, ref);
+
+    auto *buckets = new GradientBuckets({a, b});
+    a->buckets = b->buckets = buckets;
+
+    Tensor *x, *y;
+    sin_batch({9, 10}, 3, x, y);
+
+    // Parts of different sizes, weighted by their size
+    vind pa = {0, 1, 2, 3}, pb = {4, 5, 6, 7, 8}, full = {0, 1, 2, 3, 4, 5, 6, 7, 8};
+    for(int step=0; step<3; step++){
+        thread ta([&] { a->train_batch({x}, {y}, pa); });
+        thread tb([&] { b->train_batch({x}, {y}, pb); });
+        ta.join();
+        tb.join();
+        ref->train_batch({x}, {y}, full);
+    }
+
+    ASSERT_TRUE(same_params(a, ref, 1e-5));
+    ASSERT_TRUE(same_params(b, ref, 1e-5));
+
+    a->buckets = b->buckets = nullptr;
+    delete buckets;
+    delete x; delete y;
+    delete a; delete b; delete ref;
+}
+
+
+static model bn_net(){
+    layer in = Input({10});
+    layer l = ReLu(BatchNormalization(Dense(in, 16)));
+    layer out = Softmax(Dense(l, 3));
+    model net = Model({in}, {out});
+    build(net, sgd(0.1), {"soft_cross_entropy"}, {"categorical_accuracy"}, CS_CPU(1), true);
+    return net;
+}
+
+// The running statistics of BatchNorm, which have no gradients, are averaged as well
+TEST(NetTestSuite, net_buckets_batchnorm){
+    model a = bn_net();
+    model b = bn_net();
+    model ref = bn_net();
+    copy_params(a, b);
+    copy_params(a, ref);
+
+    auto *buckets = new GradientBuckets({a, b});
+    a->buckets = b->buckets = buckets;
+
+    Tensor *x, *y;
+    sin_batch({9, 10}, 3, x, y);
+    vind pa = {0, 1, 2, 3}, pb = {4, 5, 6, 7, 8}, full = {0, 1, 2, 3, 4, 5, 6, 7, 8};
+    for(int step=0; step<3; step++){
+        thread ta([&] { a->train_batch({x}, {y}, pa); });
+        thread tb([&] { b->train_batch({x}, {y}, pb); });
+        ta.join();
+        tb.join();
+
+        // After the first step, the running mean is the one of the whole batch (the weighted
+        // average of the means of the parts)
+        if (step == 0) {
+            ref->train_batch({x}, {y}, full);
+            auto *bn_a = dynamic_cast<LBatchNorm *>(a->layers[2]);
+            auto *bn_ref = dynamic_cast<LBatchNorm *>(ref->layers[2]);
+            ASSERT_TRUE(bn_a != nullptr && bn_ref != nullptr);
+            ASSERT_TRUE(Tensor::equivalent(bn_a->mean, bn_ref->mean, 1e-5));
+        }
+    }
+
+    // Both replicas keep the same state
+    ASSERT_TRUE(same_params(a, b, 1e-6));
+
+    a->buckets = b->buckets = nullptr;
+    delete buckets;
+    delete x; delete y;
+    delete a; delete b; delete ref;
+}
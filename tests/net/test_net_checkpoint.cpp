@@ -0,0 +1,82 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <cstdio>
+
+#include "eddl/apis/eddl.h"
+#include "eddl/random.h"
+
+using namespace std;
+
+using namespace eddl;
+
+
+static Net* get_checkpoint_network(){
+    layer in = Input({16});
+    layer l = ReLu(Dense(in, 32));
+    layer out = Activation(Dense(l, 4), "softmax");
+    model net = Model({in}, {out});
+
+    build(net,
+          adam(0.001), // Optimizer
+          {"soft_cross_entropy"}, // Losses
+          {"categorical_accuracy"},  // Metrics
+          CS_CPU(1), true);
+
+    return net;
+}
+
+TEST(NetTestSuite, net_checkpoint){
+    string fname = "net_checkpoint_test.ckpt";
+
+    Net* net = get_checkpoint_network();
+    Tensor* x = Tensor::randn({8, 16});
+    Tensor* y = Tensor::zeros({8, 4});
+    for(int i=0; i<8; i++) { y->ptr[i*4 + i%4] = 1.0f; }
+
+    for(int i=0; i<3; i++) { train_batch(net, {x}, {y}); }
+    net->tr_epochs = 2;
+
+    // Saving does not advance the generators
+    string state = get_rng_state();
+    std::mt19937 fit_rng = net->rng;
+    save_checkpoint(net, fname);  // Background write
+    net->wait_checkpoint();
+    ASSERT_EQ(state, get_rng_state());
+    ASSERT_TRUE(fit_rng == net->rng);
+
+    // Restore into a fresh network
+    Net* net2 = get_checkpoint_network();
+    load_checkpoint(net2, fname);
+    std::remove(fname.c_str());
+
+    ASSERT_EQ(net->tr_epochs, net2->tr_epochs);
+    ASSERT_EQ(net->tr_batches, net2->tr_batches);
+    ASSERT_TRUE(net->rng == net2->rng);
+    ASSERT_EQ(((Adam*)net->optimizer)->t, ((Adam*)net2->optimizer)->t);
+
+    for(int i=0; i<net->layers.size(); i++){
+        for(int j=0; j<net->layers[i]->params.size(); j++){
+            ASSERT_TRUE(Tensor::equivalent(net->layers[i]->params[j], net2->layers[i]->params[j], 10e-6));
+        }
+    }
+
+    vtensor s1 = net->optimizer->get_state();
+    vtensor s2 = net2->optimizer->get_state();
+    ASSERT_EQ(s1.size(), s2.size());
+    for(int i=0; i<s1.size(); i++){
+        ASSERT_TRUE(Tensor::equivalent(s1[i], s2[i], 10e-6));
+    }
+
+    // Both networks continue the same way
+    train_batch(net, {x}, {y});
+    train_batch(net2, {x}, {y});
+    for(int i=0; i<net->layers.size(); i++){
+        for(int j=0; j<net->layers[i]->params.size(); j++){
+            ASSERT_TRUE(Tensor::equivalent(net->layers[i]->params[j], net2->layers[i]->params[j], 10e-5));
+        }
+    }
+
+    delete x;
+    delete y;
+}
@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <unistd.h>
+
+#include "eddl/apis/eddl.h"
+#include "net_test_utils.h"
+
+using namespace std;
+
+using namespace eddl;
+
+
+static model lstm_net(compserv cs){
+    layer in = Input({4});
+    layer l = LSTM(in, 8);
+    layer out = Softmax(Dense(l, 2));
+    model net = Model({in}, {out});
+    build(net, sgd(0.1), {"soft_cross_entropy"}, {"categorical_accuracy"}, cs, true);
+    return net;
+}
+
+// Rank 0 (this test) runs rank 1 as a new process of the tests, which only runs this test again
+TEST(NetTestSuite, net_distributed){
+    const char *env = getenv("EDDL_TEST_RING");
+    bool root = getenv("EDDL_RANK") == nullptr;
+    string config;
+    if (root) {
+        string prefix = "/tmp/eddl_ring_" + to_string(getpid());
+        config = prefix + ".cfg";
+        ofstream ofs(config);
+        ofs << "ranks 2\ntransport unix\naddress " << prefix << "\ntimeout 30\n";
+        ofs << "command /proc/self/exe --gtest_filter=NetTestSuite.net_distributed\n";
+        ofs.close();
+        setenv("EDDL_TEST_RING", config.c_str(), 1);
+    } else {
+        ASSERT_TRUE(env != nullptr);
+        config = env;
+    }
+
+    compserv cs = CS_COMPSS(config);
+    model net = mlp_net(16, 3, sgd(0.1), cs);
+    ASSERT_EQ(cs->world, 2);
+    ASSERT_EQ(cs->rank, root ? 0 : 1);
+
+    // Both ranks start with the weights of rank 0
+    model ref = mlp_net();
+    copy_params(net, ref);
+
+    // Same data on both ranks
+    Tensor *x, *y;
+    sin_batch({8, 10}, 3, x, y);
+
+    // Each rank trains on half of the batch, the reference on the whole batch
+    vind half, full;
+    for(int i=0; i<8; i++) {
+        full.push_back(i);
+        if (i / 4 == cs->rank) half.push_back(i);
+    }
+    for(int step=0; step<2; step++){
+        net->train_batch({x}, {y}, half);
+        ref->train_batch({x}, {y}, full);
+    }
+
+    ASSERT_TRUE(same_params(net, ref, 1e-5));
+
+    // Recurrent net: the timesteps share the gradients, which are averaged once all of them are done.
+    // Both ranks draw the same batches, so the average is the gradient of the reference
+    model rnn = lstm_net(cs);
+    model rref = lstm_net(CS_CPU(1));
+    copy_params(rnn, rref);
+    Tensor *xs, *ys;
+    sin_batch({8, 5, 4}, 2, xs, ys);  // batch x timesteps x input_dim
+    rnn->rng.seed(1);
+    fit(rnn, {xs}, {ys}, 4, 2);
+    rref->rng.seed(1);
+    fit(rref, {xs}, {ys}, 4, 2);
+    ASSERT_TRUE(same_params(rnn, rref, 1e-5));
+
+    if (root) {
+        ASSERT_EQ(cs->wait_workers(), 0);
+        unsetenv("EDDL_TEST_RING");
+        remove(config.c_str());
+    }
+
+    delete x; delete y; delete xs; delete ys;
+    delete net; delete ref;
+    delete rnn; delete rref;
+    delete cs;
+}
@@ -0,0 +1,157 @@
+#include <gtest/gtest.h>
+#include <string>
+
+#include "eddl/apis/eddl.h"
+#include "net_test_utils.h"
+
+using namespace std;
+
+using namespace eddl;
+
+
+static model exchange_net(){
+    layer in = Input({3, 8, 8});
+    layer l = ReLu(Conv(in, 4, {3, 3}));
+    l = Reshape(l, {-1});
+    layer out = Softmax(Dense(l, 5));
+    model net = Model({in}, {out});
+    build(net, sgd(0.01), {"soft_cross_entropy"}, {"categorical_accuracy"}, CS_CPU(1), true);
+    net->enable_distributed();
+    return net;
+}
+
+TEST(NetTestSuite, net_exchange){
+    model worker = exchange_net();
+    model server = exchange_net();
+
+    // A bad record is rejected before anything is applied. The last record is the one of the
+    // Dense bias, 5 floats padded to 32 bytes, after its 16 bytes of fields
+    void *buffer = nullptr;
+    size_t size = serialize_exchange(worker, buffer, false);
+    ((int32_t *)((char *)buffer + size - 48))[0] = 99;
+    vtensor before;
+    for(auto &l : server->layers)
+        for(auto p : l->params) before.push_back(p->clone());
+    ASSERT_ANY_THROW(apply_exchange(server, buffer, size));
+    int k = 0;
+    for(auto &l : server->layers)
+        for(auto p : l->params) ASSERT_TRUE(Tensor::equivalent(before[k++], p, 0.0f));
+    for(auto t : before) delete t;
+    delete[] (char *)buffer;
+
+    // Weights: the server receives the ones of the worker
+    buffer = nullptr;
+    size = serialize_exchange(worker, buffer, false);
+    ASSERT_EQ(size, exchange_size(worker, false));
+    apply_exchange(server, buffer, size);
+    ASSERT_TRUE(same_params(worker, server, 1e-6));
+    delete[] (char *)buffer;
+
+    // Gradients: accumulated to the weights of the server, reusing the buffer between rounds
+    buffer = new char[exchange_size(worker, true)];
+    vtensor expected;
+    for(int i=0; i<worker->layers.size(); i++){
+        for(int j=0; j<worker->layers[i]->acc_gradients.size(); j++){
+            Tensor *g = worker->layers[i]->acc_gradients[j];
+            g->rand_normal(0.0f, 1.0f);
+            Tensor *w = server->layers[i]->params[j]->clone();
+            w->add_(g);
+            w->add_(g);
+            expected.push_back(w);
+        }
+    }
+    ASSERT_EQ(expected.size(), 4);  // Conv and Dense, with bias
+
+    for(int round=0; round<2; round++){
+        size = serialize_exchange(worker, buffer, true);
+        apply_exchange(server, buffer, size);
+    }
+    k = 0;
+    for(int i=0; i<server->layers.size(); i++){
+        for(int j=0; j<server->layers[i]->acc_gradients.size(); j++){
+            ASSERT_TRUE(Tensor::equivalent(expected[k++], server->layers[i]->params[j], 1e-5));
+        }
+    }
+
+    // Other versions are rejected
+    ((int32_t *)buffer)[2] = 99;
+    ASSERT_ANY_THROW(apply_exchange(server, buffer, size));
+
+    delete[] (char *)buffer;
+    for(auto t : expected) delete t;
+    delete worker;
+    delete server;
+}
+
+
+TEST(NetTestSuite, net_exchange_codecs){
+    model worker = exchange_net();
+    model server = exchange_net();
+    size_t full = exchange_size(worker, true);
+
+    for(auto &l : worker->layers)
+        for(auto g : l->acc_gradients) g->rand_normal(0.0f, 1.0f);
+
+    // Applied gradient (new - old weights) against the sent one
+    vector<string> codecs = {"fp16", "bf16", "int8"};
+    vector<float> tolerances = {1e-3, 1e-2, 1e-2};  // int8: one step of amax / 127
+    for(int c=0; c<codecs.size(); c++){
+        set_exchange_codec(worker, codecs[c]);
+        size_t size = exchange_size(worker, true);
+        ASSERT_LT(size, full);
+
+        void *buffer = new char[size];
+        serialize_exchange(worker, buffer, true);
+        vtensor before;
+        for(auto &l : server->layers)
+            for(int j=0; j<l->acc_gradients.size(); j++) before.push_back(l->params[j]->clone());
+        apply_exchange(server, buffer, size);
+
+        int k = 0;
+        for(int i=0; i<server->layers.size(); i++){
+            for(int j=0; j<server->layers[i]->acc_gradients.size(); j++, k++){
+                Tensor *g = worker->layers[i]->acc_gradients[j];
+                Tensor *w = server->layers[i]->params[j];
+                float amax = g->max() > -g->min() ? g->max() : -g->min();
+                for(int p=0; p<g->size; p++){
+                    float applied = w->ptr[p] - before[k]->ptr[p];
+                    ASSERT_NEAR(applied, g->ptr[p], tolerances[c] * amax) << codecs[c];
+                }
+            }
+        }
+        for(auto t : before) delete t;
+        delete[] (char *)buffer;
+    }
+
+    // Top-k: the values not sent are kept, so that after several rounds everything has been applied
+    set_exchange_codec(worker, "topk", 0.1f);
+    size_t size = exchange_size(worker, true);
+    ASSERT_LT(size, full / 3);  // Position and value of 10% of the gradients
+
+    void *buffer = new char[size];
+    vtensor before;
+    for(auto &l : server->layers)
+        for(int j=0; j<l->acc_gradients.size(); j++) before.push_back(l->params[j]->clone());
+    int rounds = 20;
+    for(int r=0; r<rounds; r++){
+        serialize_exchange(worker, buffer, true);
+        apply_exchange(server, buffer, size);
+    }
+    int k = 0;
+    for(int i=0; i<server->layers.size(); i++){
+        for(int j=0; j<server->layers[i]->acc_gradients.size(); j++, k++){
+            Tensor *g = worker->layers[i]->acc_gradients[j];
+            Tensor *w = server->layers[i]->params[j];
+            Tensor *residual = worker->xchg_residuals[k];
+            for(int p=0; p<g->size; p++){
+                float applied = w->ptr[p] - before[k]->ptr[p];
+                ASSERT_NEAR(applied + residual->ptr[p], rounds * g->ptr[p], 1e-3 * rounds);
+            }
+        }
+    }
+    for(auto t : before) delete t;
+    delete[] (char *)buffer;
+
+    delete worker;
+    delete server;
+}
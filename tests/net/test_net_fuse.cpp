@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <cmath>
+
+#include "eddl/apis/eddl.h"
+#include "eddl/layers/operators/layer_operators.h"
+#include "eddl/tensor/nn/tensor_nn.h"
+
+using namespace std;
+
+using namespace eddl;
+
+
+TEST(NetTestSuite, net_fuse){
+    layer in1 = Input({6});
+    layer in2 = Input({6});
+    layer h = Dense(in1, 6);
+
+    // Chain on h, with the side inputs in2, h and s
+    layer s = Sum(in2, 3.0f);
+    layer l = Mult(h, 0.5f);
+    l = Sigmoid(Sum(l, in2));
+    l = Diff(1.0f, Mult(l, h));
+    l = Tanh(Div(l, s));
+    layer out = Dense(l, 3);
+    model net = Model({in1, in2}, {out});
+
+    build(net, sgd(0.01), {"mse"}, {"mse"}, CS_CPU(1), true);
+
+    // The chain. The scalar sum of in2 is alone, so it is not fused
+    ASSERT_EQ(net->vfused.size(), 1);
+    ASSERT_EQ(net->ffts.size(), net->vfts.size() - 6);
+
+    Tensor* x1 = Tensor::randn({4, 6});
+    Tensor* x2 = Tensor::randu({4, 6});
+    net->forward(vector<Tensor*>{x1, x2});
+    Tensor* y = net->lout[0]->output->clone();
+
+    // Reference: every layer on its own
+    for(auto k : net->vfts) k->forward();
+    ASSERT_TRUE(Tensor::equivalent(net->lout[0]->output, y, 10e-4));
+
+    // Backward of the fused net and of every layer
+    Tensor* d = Tensor::randn({4, 3});
+    Tensor* dh[2];
+    Tensor* din2[2];
+    for(int pass=0; pass<2; pass++){
+        net->do_reset();
+        net->do_reset_grads();
+        net->lout[0]->mem_delta();
+        Tensor::copy(d, net->lout[0]->delta);
+
+        if(pass == 0) {
+            net->do_backward();
+        } else {
+            for(auto k : net->vbts) { k->mem_delta_parent(); k->backward(); }
+        }
+        dh[pass] = h->gradients[0]->clone();
+        din2[pass] = in2->delta->clone();
+    }
+    ASSERT_TRUE(Tensor::equivalent(dh[0], dh[1], 10e-4));
+    ASSERT_TRUE(Tensor::equivalent(din2[0], din2[1], 10e-4));
+
+    delete net;
+    delete x1; delete x2; delete y; delete d;
+    for(int i=0; i<2; i++) { delete dh[i]; delete din2[i]; }
+}
+
+
+TEST(NetTestSuite, net_fuse_kernel){
+    // val / (|x| + 1), with the gradient of the side input
+    Tensor* x = Tensor::randn({3, 100});
+    Tensor* s = Tensor::randu({3, 100});
+    Tensor* y = Tensor::empty({3, 100});
+
+    FusedOp abs_op; abs_op.code = FUSED_ABS;
+    FusedOp add; add.code = FUSED_ADD_SCALAR; add.val = 1.0f;
+    FusedOp mult; mult.code = FUSED_MULT; mult.side = 0;
+    FusedOp div; div.code = FUSED_RDIV_SCALAR; div.val = 2.0f;
+    vector<FusedOp> ops = {abs_op, add, mult, div};
+    tensorNN::fused_forward(ops, x, {s}, y);
+
+    Tensor* y_ref = x->clone();
+    y_ref->abs_();
+    y_ref->add_(1.0f);
+    Tensor::el_mult(y_ref, s, y_ref, 0);
+    y_ref->inv_(2.0f);
+    ASSERT_TRUE(Tensor::equivalent(y_ref, y, 10e-4));
+
+    // d/ds = -2 (|x| + 1) / ((|x| + 1) s)^2
+    Tensor* d = Tensor::ones({3, 100});
+    Tensor* px = Tensor::zeros({3, 100});
+    Tensor* ps = Tensor::zeros({3, 100});
+    tensorNN::fused_backward(ops, x, {s}, y, d, px, {ps});
+    for(int i=0; i<x->size; i++){
+        float a = std::fabs(x->ptr[i]) + 1.0f;
+        float ref = -2.0f * a / (a * s->ptr[i] * a * s->ptr[i]);
+        ASSERT_NEAR(ps->ptr[i], ref, 10e-4 * std::fabs(ref));  // Large when s is close to 0
+    }
+
+    delete x; delete s; delete y; delete y_ref;
+    delete d; delete px; delete ps;
+}
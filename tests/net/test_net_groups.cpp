@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <string>
+
+#include "eddl/apis/eddl.h"
+#include "eddl/layers/conv/layer_conv.h"
+#include "net_test_utils.h"
+
+using namespace std;
+
+using namespace eddl;
+
+
+static model groups_net(int filters, const vector<int> &ks, const vector<int> &st, int groups,
+                        const string &layout, LConv *&conv){
+    layer in = Input({4, 7, 7});
+    layer l = ReLu(Conv(in, 4, {3, 3}));
+    l = Conv(l, filters, ks, st, "same", true, groups);
+    conv = (LConv *)l;
+    l = Reshape(l, {-1});
+    layer out = Softmax(Dense(l, 3));
+    model net = Model({in}, {out});
+    set_layout(net, layout);
+    build(net, sgd(0.1), {"soft_cross_entropy"}, {"categorical_accuracy"}, CS_CPU(1), true);
+    return net;
+}
+
+// A grouped convolution is a dense one whose filters are zero out of their group of channels
+static void expand_groups(LConv *grouped, LConv *dense, bool copy){
+    ConvolDescriptor *g = grouped->cd, *d = dense->cd;
+    int ks = g->kr * g->kc, ng = g->nk / g->groups;
+    for(int n=0; n<g->nk; n++)
+        for(int z=0; z<d->kz; z++)
+            for(int k=0; k<ks; k++){
+                int zg = z - (n / ng) * g->kz;
+                bool inside = zg >= 0 && zg < g->kz;
+                float *pd = d->K->ptr + ((long)n * d->kz + z) * ks + k;
+                float *pg = g->K->ptr + ((long)n * g->kz + zg) * ks + k;
+                if (copy) *pd = inside ? *pg : 0.0f;
+                else if (inside) ASSERT_NEAR(*pd, *pg, 1e-4) << n << " " << z << " " << k;
+            }
+}
+
+TEST(NetTestSuite, net_groups){
+    struct Case { int filters; vector<int> ks, st; int groups; string layout; };
+    vector<Case> cases = {
+        {6, {3, 3}, {1, 1}, 2, "nchw"},   // GEMM per group
+        {6, {3, 3}, {2, 2}, 2, "nhwc"},
+        {4, {3, 3}, {1, 1}, 4, "nchw"},   // Depthwise 3x3
+        {4, {3, 3}, {2, 2}, 4, "nhwc"},
+        {4, {5, 5}, {2, 2}, 4, "nchw"},   // Depthwise, other windows
+    };
+
+    Tensor *x, *y;
+    sin_batch({6, 4, 7, 7}, 3, x, y, 0.13f);
+    vind sind = {0, 1, 2, 3, 4, 5};
+
+    for(auto &c : cases){
+        LConv *cg, *cd;
+        model net = groups_net(c.filters, c.ks, c.st, c.groups, c.layout, cg);
+        model ref = groups_net(c.filters, c.ks, c.st, 1, "nchw", cd);
+        ASSERT_EQ(cg->cd->K->shape[1], 4 / c.groups);
+
+        for(int i=0; i<net->layers.size(); i++)
+            for(int j=0; j<net->layers[i]->params.size(); j++)
+                if (net->layers[i]->params[j] != cg->cd->K)
+                    Tensor::copy(net->layers[i]->params[j], ref->layers[i]->params[j]);
+        expand_groups(cg, cd, true);
+
+        vtensor a = predict(ref, {x});
+        vtensor b = predict(net, {x});
+        ASSERT_TRUE(Tensor::equivalent(a[0], b[0], 1e-5)) << c.groups << " " << c.layout;
+
+        // One step: the gradients of the grouped filters, of the bias and of the input are the same
+        net->train_batch({x}, {y}, sind);
+        ref->train_batch({x}, {y}, sind);
+        for(int i=0; i<net->layers.size(); i++)
+            for(int j=0; j<net->layers[i]->params.size(); j++)
+                if (net->layers[i]->params[j] != cg->cd->K)
+                    ASSERT_TRUE(Tensor::equivalent(ref->layers[i]->params[j], net->layers[i]->params[j], 1e-4))
+                        << net->layers[i]->name << " " << c.groups << " " << c.layout;
+        expand_groups(cg, cd, false);
+
+        for(auto t : a) delete t;
+        for(auto t : b) delete t;
+        delete net;
+        delete ref;
+    }
+
+    // The channels and the filters must be multiples of the groups
+    layer in = Input({4, 7, 7});
+    ASSERT_ANY_THROW(Conv(in, 6, {3, 3}, {1, 1}, "same", true, 4));
+    ASSERT_ANY_THROW(Conv(in, 6, {3, 3}, {1, 1}, "same", true, 3));
+
+    delete in;
+    delete x; delete y;
+}
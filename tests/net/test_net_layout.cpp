@@ -0,0 +1,78 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <string>
+
+#include "eddl/apis/eddl.h"
+#include "eddl/layers/conv/layer_conv.h"
+#include "net_test_utils.h"
+
+using namespace std;
+
+using namespace eddl;
+
+
+static model layout_net(const string &layout){
+    layer in = Input({3, 9, 9});
+    layer l = ReLu(BatchNormalization(Conv(in, 6, {3, 3})));
+    layer l2 = Conv(l, 6, {1, 1});  // Direct GEMM of the NHWC input
+    l = Sigmoid(Add({l, l2}));  // Positive for the max pooling
+    l = MaxPool(l, {3, 3}, {2, 2}, "same");
+    l = Conv(l, 4, {3, 3}, {2, 2});
+    l = AveragePool(l, {3, 3}, {1, 1}, "same");
+    l = Reshape(l, {-1});
+    layer out = Softmax(Dense(l, 5));
+    model net = Model({in}, {out});
+    set_layout(net, layout);
+    build(net, sgd(0.1), {"soft_cross_entropy"}, {"categorical_accuracy"}, CS_CPU(1), true);
+    return net;
+}
+
+TEST(NetTestSuite, net_layout_nhwc){
+    model ref = layout_net("nchw");
+    model net = layout_net("nhwc");
+    copy_params(ref, net);
+
+    // NHWC from the first conv to the last pooling, which converts for the reshape
+    vector<int> expected = {LAYOUT_NCHW, LAYOUT_NHWC, LAYOUT_NHWC, LAYOUT_NHWC, LAYOUT_NHWC, LAYOUT_NHWC, LAYOUT_NHWC,
+                            LAYOUT_NHWC, LAYOUT_NHWC, LAYOUT_NCHW, LAYOUT_NCHW, LAYOUT_NCHW, LAYOUT_NCHW};
+    ASSERT_EQ(net->layers.size(), expected.size());
+    for(int i=0; i<net->layers.size(); i++){
+        ASSERT_EQ(ref->layers[i]->layout, LAYOUT_NCHW);
+        ASSERT_EQ(net->layers[i]->layout, expected[i]) << net->layers[i]->name;
+    }
+
+    Tensor *x, *y;
+    sin_batch({8, 3, 9, 9}, 5, x, y, 0.11f);
+
+    vtensor a = predict(ref, {x});
+    vtensor b = predict(net, {x});
+    ASSERT_TRUE(Tensor::equivalent(a[0], b[0], 1e-5));
+
+    // Same training
+    vind sind = {0, 1, 2, 3, 4, 5, 6, 7};
+    for(int step=0; step<3; step++){
+        ref->train_batch({x}, {y}, sind);
+        net->train_batch({x}, {y}, sind);
+    }
+    ASSERT_TRUE(same_params(ref, net, 1e-4));
+
+    // The kernels lowered for channels last are kept between forwards, and rebuilt after the steps
+    vtensor a2 = predict(ref, {x});
+    vtensor b2 = predict(net, {x});
+    ASSERT_TRUE(Tensor::equivalent(a2[0], b2[0], 1e-4));
+    for(auto l : net->layers)
+        if (dynamic_cast<LConv *>(l) != nullptr) ASSERT_FALSE(((LConv *)l)->cd->Kt_stale) << l->name;
+    for(auto t : a2) delete t;
+    for(auto t : b2) delete t;
+
+    // Back to NCHW
+    set_layout(net, "nchw");
+    for(auto l : net->layers) ASSERT_EQ(l->layout, LAYOUT_NCHW);
+    ASSERT_ANY_THROW(set_layout(net, "chwn"));
+
+    delete x; delete y;
+    for(auto t : a) delete t;
+    for(auto t : b) delete t;
+    delete ref;
+    delete net;
+}
@@ -0,0 +1,33 @@
+#include <gtest/gtest.h>
+
+#include "eddl/apis/eddl.h"
+#include "net_test_utils.h"
+
+using namespace std;
+
+using namespace eddl;
+
+
+TEST(NetTestSuite, net_micro_batch){
+    model net1 = mlp_net(16, 4, sgd(0.1, 0.9));
+    model net2 = mlp_net(16, 4, sgd(0.1, 0.9));
+    copy_params(net1, net2);
+
+    // 10 samples in 3 chunks (3, 3 and 4 samples)
+    Tensor *x, *y;
+    sin_batch({10, 10}, 4, x, y);
+
+    set_micro_batches(net2, 3);
+    for(int i=0; i<2; i++) {
+        train_batch(net1, {x}, {y});
+        train_batch(net2, {x}, {y});
+    }
+
+    // Same steps, with the activations of a chunk
+    ASSERT_LE(net2->batch_size, 4);
+    ASSERT_EQ(net2->inferenced_samples, net1->inferenced_samples);
+    ASSERT_TRUE(same_params(net1, net2, 10e-4));
+
+    delete net1; delete net2;
+    delete x; delete y;
+}
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <limits>
+
+#include "eddl/apis/eddl.h"
+#include "eddl/layers/conv/layer_conv.h"
+#include "net_test_utils.h"
+
+using namespace std;
+
+using namespace eddl;
+
+
+static model precision_net(){
+    layer in = Input({3, 8, 8});
+    layer l = ReLu(BatchNormalization(Conv(in, 4, {3, 3})));
+    l = Reshape(l, {-1});
+    layer out = Softmax(Dense(l, 5));
+    model net = Model({in}, {out});
+    build(net, sgd(0.05), {"soft_cross_entropy"}, {"categorical_accuracy"}, CS_CPU(1), true);
+    return net;
+}
+
+// Trainable params (the batchnorm statistics are updated by the forward)
+static float max_diff(model a, model b){
+    float d = 0.0f;
+    for(int i=0; i<a->layers.size(); i++)
+        for(int j=0; j<a->layers[i]->get_trainable_params_count(); j++) {
+            Tensor *p = a->layers[i]->params[j];
+            Tensor *q = b->layers[i]->params[j];
+            for(int k=0; k<p->size; k++) d = std::max(d, std::fabs(p->ptr[k] - q->ptr[k]));
+        }
+    return d;
+}
+
+TEST(NetTestSuite, net_mixed_precision){
+    model ref = precision_net();
+    Tensor *x = Tensor::randn({6, 3, 8, 8});
+    Tensor *y = Tensor::zeros({6, 5});
+    for(int i=0; i<6; i++) y->ptr[i * 5 + i % 5] = 1.0f;
+    vind sind = {0, 1, 2, 3, 4, 5};
+
+    vector<string> storages = {"bf16", "fp16"};
+    vector<float> tolerances = {2e-2, 5e-3};
+    for(int s=0; s<storages.size(); s++){
+        model net = precision_net();
+        copy_params(ref, net);
+        set_mixed_precision(net, storages[s], s == 1 ? 1024.0f : 1.0f);
+
+        model fp32 = precision_net();
+        copy_params(ref, fp32);
+        for(int step=0; step<3; step++){
+            net->train_batch({x}, {y}, sind);
+            fp32->train_batch({x}, {y}, sind);
+        }
+        // The lowering of the convolution is kept in 16 bits
+        LConv *conv = nullptr;
+        for(auto l : net->layers) if (dynamic_cast<LConv *>(l) != nullptr) conv = (LConv *)l;
+        ASSERT_TRUE(conv != nullptr);
+        ASSERT_EQ(conv->cd->ptrI16.size(), 6 * conv->cd->r * conv->cd->c * conv->cd->kr * conv->cd->kc * conv->cd->kz);
+
+        ASSERT_GT(max_diff(net, ref), 1e-3);  // Both have been trained
+        ASSERT_LT(max_diff(net, fp32), tolerances[s]) << storages[s];
+
+        delete net;
+        delete fp32;
+    }
+
+    delete ref;
+    delete x; delete y;
+}
+
+TEST(NetTestSuite, net_loss_scale){
+    model a = precision_net();
+    model b = precision_net();
+    copy_params(a, b);
+    Tensor *x, *y;
+    sin_batch({4, 3, 8, 8}, 5, x, y);
+    vind sind = {0, 1, 2, 3};
+
+    // A static scale does not change the steps
+    a->optimizer->set_loss_scale(256.0f);
+    a->train_batch({x}, {y}, sind);
+    b->train_batch({x}, {y}, sind);
+    ASSERT_LT(max_diff(a, b), 1e-5);
+
+    // Overflow: the step is skipped and the scale halved
+    a->optimizer->set_loss_scale(std::numeric_limits<float>::max(), true, 2);
+    model c = precision_net();
+    copy_params(a, c);
+    Tensor *xo = x->clone();
+    xo->ptr[0] = std::numeric_limits<float>::infinity();
+    a->train_batch({xo}, {y}, sind);
+    ASSERT_EQ(max_diff(a, c), 0.0f);
+    ASSERT_EQ(a->optimizer->loss_scale, std::numeric_limits<float>::max() / 2.0f);
+
+    // Doubled after scale_window steps without overflow
+    a->optimizer->set_loss_scale(8.0f, true, 2);
+    a->train_batch({x}, {y}, sind);
+    a->train_batch({x}, {y}, sind);
+    ASSERT_EQ(a->optimizer->loss_scale, 16.0f);
+
+    delete a; delete b; delete c;
+    delete x; delete xo; delete y;
+}
+
+TEST(NetTestSuite, net_mixed_precision_lstm){
+    model nets[2];
+    for(int n=0; n<2; n++){
+        layer in = Input({4});
+        layer l = LSTM(in, 8);
+        layer out = Softmax(Dense(l, 2));
+        nets[n] = Model({in}, {out});
+        build(nets[n], sgd(0.1), {"soft_cross_entropy"}, {"categorical_accuracy"}, CS_CPU(1), true);
+    }
+    copy_params(nets[0], nets[1]);
+    set_mixed_precision(nets[1], "bf16");
+
+    Tensor *x = Tensor::randn({8, 5, 4});  // batch x timesteps x input_dim
+    Tensor *y = Tensor::zeros({8, 2});
+    for(int i=0; i<8; i++) y->ptr[i * 2 + i % 2] = 1.0f;
+
+    // Same batches
+    for(int n=0; n<2; n++){
+        nets[n]->rng.seed(1);
+        fit(nets[n], {x}, {y}, 8, 3);
+    }
+    ASSERT_GT(max_diff(nets[0], nets[1]), 0.0f);  // Rounded
+    ASSERT_LT(max_diff(nets[0], nets[1]), 2e-2);
+
+    delete nets[0]; delete nets[1];
+    delete x; delete y;
+}
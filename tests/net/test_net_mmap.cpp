@@ -0,0 +1,67 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <cstdio>
+
+#include "eddl/apis/eddl.h"
+
+using namespace std;
+
+using namespace eddl;
+
+
+static Net* get_mmap_network(){
+    layer in = Input({16});
+    layer l = ReLu(Dense(in, 33));
+    layer out = Activation(Dense(l, 4), "softmax");
+    model net = Model({in}, {out});
+
+    build(net,
+          sgd(0.01), // Optimizer
+          {"soft_cross_entropy"}, // Losses
+          {"categorical_accuracy"},  // Metrics
+          CS_CPU(1), true);
+
+    return net;
+}
+
+TEST(NetTestSuite, net_mmap_weights){
+    string fname = "net_mmap_test.bin";
+
+    Net* net = get_mmap_network();
+    save(net, fname, "mmap");
+
+    Net* net2 = get_mmap_network();
+    load(net2, fname, "mmap");
+    std::remove(fname.c_str());  // The mapping outlives the file name
+
+    ASSERT_TRUE(net2->mmap_ptr != nullptr);
+    for(int i=0; i<net->layers.size(); i++){
+        for(int j=0; j<net->layers[i]->params.size(); j++){
+            Tensor* p = net2->layers[i]->params[j];
+
+            // Parameters point into the mapping (aligned)
+            ASSERT_TRUE(p->isview);
+            ASSERT_EQ(((size_t)p->ptr) % 64, 0);
+            ASSERT_TRUE((char*)p->ptr >= (char*)net2->mmap_ptr && (char*)p->ptr < (char*)net2->mmap_ptr + net2->mmap_size);
+            ASSERT_TRUE(Tensor::equivalent(net->layers[i]->params[j], p, 10e-6));
+        }
+    }
+
+    // Mapped weights can be trained (copy-on-write)
+    Tensor* x = Tensor::randn({8, 16});
+    Tensor* y = Tensor::zeros({8, 4});
+    for(int i=0; i<8; i++) { y->ptr[i*4 + i%4] = 1.0f; }
+    train_batch(net, {x}, {y});
+    train_batch(net2, {x}, {y});
+    for(int i=0; i<net->layers.size(); i++){
+        for(int j=0; j<net->layers[i]->params.size(); j++){
+            ASSERT_TRUE(Tensor::equivalent(net->layers[i]->params[j], net2->layers[i]->params[j], 10e-5));
+        }
+    }
+
+    delete x;
+    delete y;
+    delete net;
+    delete net2;
+}
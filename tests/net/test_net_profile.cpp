@@ -0,0 +1,60 @@
+#include <gtest/gtest.h>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "eddl/apis/eddl.h"
+
+using namespace std;
+
+using namespace eddl;
+
+
+TEST(NetTestSuite, net_profile){
+    layer in = Input({8});
+    layer d = Dense(in, 16);
+    layer l = ReLu(d);
+    layer out = Softmax(Dense(l, 4));
+    model net = Model({in}, {out});
+    build(net, sgd(0.01), {"soft_cross_entropy"}, {"categorical_accuracy"}, CS_CPU(1), true);
+
+    Tensor* x = Tensor::randn({8, 8});
+    Tensor* y = Tensor::zeros({8, 4});
+    for(int i=0; i<8; i++) { y->ptr[i*4 + i%4] = 1.0f; }
+
+    profile(net);
+    fit(net, {x}, {y}, 4, 1);
+
+    // Two batches: forward and backward of every layer, and the updates
+    Profiler* p = net->profiler;
+    int forward = 0, backward = 0, update = 0;
+    for(auto &t : p->totals){
+        ASSERT_EQ(t.calls, 2);
+        if(t.phase == "forward") forward++;
+        if(t.phase == "backward") backward++;
+        if(t.phase == "update") update++;
+    }
+    ASSERT_EQ(forward, net->vfts.size());
+    ASSERT_EQ(backward, net->vbts.size());
+    ASSERT_EQ(update, 1);
+    ASSERT_EQ(p->events.size(), 2 * (forward + backward + update));
+
+    // 2 * batch * inputs * outputs
+    ASSERT_DOUBLE_EQ(Profiler::estimate_flops(d, false), 2.0 * 4 * 8 * 16);
+
+    ASSERT_NE(net->profile_summary().find(d->name), string::npos);
+
+    string fname = "profile_test.json";
+    net->save_profile(fname);
+    std::ifstream ifs(fname);
+    string content((std::istreambuf_iterator<char>(ifs)), std::istreambuf_iterator<char>());
+    ASSERT_EQ(content.find("{\"displayTimeUnit\""), 0);
+    ASSERT_NE(content.find("\"ph\": \"X\""), string::npos);
+    std::remove(fname.c_str());
+
+    profile(net, false);
+    ASSERT_TRUE(net->profiler == nullptr);
+
+    delete net;
+    delete x; delete y;
+}
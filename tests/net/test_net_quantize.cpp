@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include "eddl/apis/eddl.h"
+#include "eddl/hardware/cpu/nn/cpu_tensor_nn.h"
+
+using namespace std;
+
+using namespace eddl;
+
+
+static model quantize_net(){
+    layer in = Input({3, 8, 8});
+    layer l = ReLu(Conv(in, 8, {3, 3}));
+    l = ReLu(Conv(l, 8, {3, 3}, {2, 2}));
+    l = Reshape(l, {-1});
+    layer out = Dense(l, 10);
+    model net = Model({in}, {out});
+    build(net, sgd(0.01), {"mse"}, {"mse"}, CS_CPU(1), true);
+    return net;
+}
+
+static long file_size(const string &fname){
+    std::ifstream ifs(fname, std::ios::binary | std::ios::ate);
+    return ifs.tellg();
+}
+
+TEST(NetTestSuite, net_quantize){
+    model net = quantize_net();
+    Tensor *x = Tensor::empty({40, 3, 8, 8});
+    for(int i=0; i<x->size; i++) x->ptr[i] = std::sin(0.13f * i);
+
+    vtensor ref = predict(net, {x});
+    quantize(net, {x}, 16);
+    for(auto l : net->layers)
+        if (l->params.size()) ASSERT_TRUE(l->quant != nullptr) << l->name;
+    vtensor q = predict(net, {x});
+
+    // Within a few steps of the int8 scales, but computed by the int8 kernels
+    float amax = std::max(ref[0]->max(), -ref[0]->min());
+    float diff = 0.0f;
+    for(int i=0; i<ref[0]->size; i++) diff = std::max(diff, std::fabs(q[0]->ptr[i] - ref[0]->ptr[i]));
+    ASSERT_LT(diff, 0.05f * amax);
+    ASSERT_GT(diff, 0.0f);
+
+    // About 4x smaller than the fp32 weights
+    string fname = "net_quantize_test.bin";
+    string fname8 = "net_quantize_test.int8";
+    save(net, fname);
+    save(net, fname8, "int8");
+    ASSERT_LT(file_size(fname8) * 3, file_size(fname));
+
+    // A fresh model gets the same quantized predictions
+    model net2 = quantize_net();
+    load(net2, fname8, "int8");
+    vtensor q2 = predict(net2, {x});
+    ASSERT_TRUE(Tensor::equivalent(q[0], q2[0], 1e-6));
+
+    // Other formats are rejected
+    ASSERT_ANY_THROW(load(net2, fname, "int8"));
+
+    // The int8 weights are dropped when the fp32 ones change
+    load(net2, fname);
+    for(auto l : net2->layers) ASSERT_TRUE(l->quant == nullptr) << l->name;
+    Tensor *y = Tensor::zeros({40, 10});
+    vind sind = {0, 1, 2, 3};
+    net->train_batch({x}, {y}, sind);
+    for(auto l : net->layers) ASSERT_TRUE(l->quant == nullptr) << l->name;
+    delete y;
+    std::remove(fname.c_str());
+    std::remove(fname8.c_str());
+
+    delete x;
+    for(auto t : ref) delete t;
+    for(auto t : q) delete t;
+    for(auto t : q2) delete t;
+    delete net;
+    delete net2;
+}
+
+
+// Sizes beyond one block of each dimension, and partial panels
+TEST(NetTestSuite, net_quantize_gemm){
+    int m = 133, n = 300, k = 530, batch = 2;
+    vector<int8_t> A((long)m * k), B((long)batch * k * n);
+    for(long i=0; i<A.size(); i++) A[i] = (int8_t)((i * 37) % 255 - 127);
+    for(long i=0; i<B.size(); i++) B[i] = (int8_t)((i * 91 + 5) % 255 - 127);
+
+    for(int trans=0; trans<2; trans++){
+        vector<int32_t> C((long)batch * m * n);
+        cpu_gemm_s8(m, n, k, A.data(), B.data(), trans ? k : n, (long)k * n, trans, C.data(), (long)m * n, batch);
+        for(int b=0; b<batch; b++)
+            for(int i=0; i<m; i++)
+                for(int j=0; j<n; j++){
+                    int32_t s = 0;
+                    for(int l=0; l<k; l++){
+                        int8_t bv = trans ? B[b * k * n + (long)j * k + l] : B[b * k * n + (long)l * n + j];
+                        s += (int32_t)A[(long)i * k + l] * bv;
+                    }
+                    ASSERT_EQ(C[(long)b * m * n + (long)i * n + j], s) << trans << " " << b << " " << i << " " << j;
+                }
+    }
+}
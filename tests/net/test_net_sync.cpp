@@ -0,0 +1,54 @@
+#include <gtest/gtest.h>
+
+#include "eddl/apis/eddl.h"
+#include "net_test_utils.h"
+
+using namespace std;
+
+using namespace eddl;
+
+
+TEST(NetTestSuite, net_sync_weights){
+    // Three CPU nets as the snets of a master net
+    model master = mlp_net(7);
+    vector<model> replicas = {mlp_net(7), mlp_net(7), mlp_net(7)};
+    master->snets = {replicas[0], replicas[1], replicas[2]};
+
+    vtensor expected;
+    for(int j=0; j<master->layers.size(); j++)
+        for(int k=0; k<master->layers[j]->params.size(); k++) {
+            Tensor *e = Tensor::zeros(master->layers[j]->params[k]->shape);
+            for(auto r : replicas) e->add_(r->layers[j]->params[k]);
+            e->div_(3.0f);
+            expected.push_back(e);
+        }
+
+    master->sync_weights();
+
+    int p = 0;
+    for(int j=0; j<master->layers.size(); j++)
+        for(int k=0; k<master->layers[j]->params.size(); k++, p++) {
+            ASSERT_TRUE(Tensor::equivalent(master->layers[j]->params[k], expected[p], 1e-6));
+            for(auto r : replicas)
+                ASSERT_TRUE(Tensor::equivalent(r->layers[j]->params[k], expected[p], 1e-6));
+        }
+
+    // The next syncs reuse the host copies
+    vtensor staged = master->sync_stage[0];
+    for(auto r : replicas)
+        for(auto l : r->layers)
+            for(auto w : l->params) w->add_(1.0f);
+    master->sync_weights();
+    ASSERT_EQ(master->sync_stage[0], staged);
+    p = 0;
+    for(int j=0; j<master->layers.size(); j++)
+        for(int k=0; k<master->layers[j]->params.size(); k++, p++) {
+            expected[p]->add_(1.0f);
+            ASSERT_TRUE(Tensor::equivalent(master->layers[j]->params[k], expected[p], 1e-6));
+        }
+
+    master->snets = {master};
+    for(auto t : expected) delete t;
+    for(auto r : replicas) delete r;
+    delete master;
+}
@@ -129,3 +129,78 @@ TEST(ONNXTestSuite, onnx_import){
 
 }
 
+
+TEST(ONNXTestSuite, onnx_import_string){
+    layer in = Input({3, 8, 8});
+    layer l = ReLu(Conv(in, 4, {3, 3}));
+    l = BatchNormalization(l);
+    l = Reshape(l, {-1});
+    layer out = Softmax(Dense(l, 5));
+    model net_export = Model({in}, {out});
+    build(net_export, sgd(0.01), {"soft_cross_entropy"}, {"categorical_accuracy"}, CS_CPU(), true);
+    net_export->resize(1);
+
+    // The parameters are copied from the serialized initializers
+    string* model_string = serialize_net_to_onnx_string(net_export);
+    Net* net_import = import_net_from_onnx_string(model_string);
+    build(net_import, sgd(0.01), {"soft_cross_entropy"}, {"categorical_accuracy"}, CS_CPU(), false);
+    net_import->resize(1);
+
+    ASSERT_EQ(net_export->layers.size(), net_import->layers.size());
+    for(int i=0; i<net_export->layers.size(); i++){
+        ASSERT_EQ(net_export->layers[i]->params.size(), net_import->layers[i]->params.size());
+        for(int j=0; j<net_export->layers[i]->params.size(); j++){
+            ASSERT_TRUE(Tensor::equivalent(net_export->layers[i]->params[j], net_import->layers[i]->params[j]));
+        }
+    }
+
+    // Weights set on an existing net
+    for(auto p : net_import->layers[1]->params) p->fill_(0.0f);
+    set_weights_from_onnx(net_import, model_string);
+    for(int j=0; j<net_export->layers[1]->params.size(); j++){
+        ASSERT_TRUE(Tensor::equivalent(net_export->layers[1]->params[j], net_import->layers[1]->params[j]));
+    }
+
+    delete model_string;
+    delete net_export;
+    delete net_import;
+}
+
+
+TEST(ONNXTestSuite, onnx_import_file){
+    layer in = Input({3, 8, 8});
+    layer l = ReLu(Conv(in, 4, {3, 3}));
+    l = BatchNormalization(l);
+    l = Reshape(l, {-1});
+    layer out = Softmax(Dense(l, 5));
+    model net_export = Model({in}, {out});
+    build(net_export, sgd(0.01), {"soft_cross_entropy"}, {"categorical_accuracy"}, CS_CPU(), true);
+    net_export->resize(1);
+
+    // The file is parsed as a stream and the initializers copied into the parameters
+    string fname = "onnx_import_file_" + to_string(dist6(mt)) + ".onnx";
+    save_net_to_onnx_file(net_export, fname);
+    Net* net_import = import_net_from_onnx_file(fname);
+    std::remove(fname.c_str());
+    build(net_import, sgd(0.01), {"soft_cross_entropy"}, {"categorical_accuracy"}, CS_CPU(), false);
+    net_import->resize(1);
+
+    ASSERT_EQ(net_export->layers.size(), net_import->layers.size());
+    for(int i=0; i<net_export->layers.size(); i++){
+        ASSERT_EQ(net_export->layers[i]->params.size(), net_import->layers[i]->params.size());
+        for(int j=0; j<net_export->layers[i]->params.size(); j++){
+            ASSERT_TRUE(Tensor::equivalent(net_export->layers[i]->params[j], net_import->layers[i]->params[j]));
+        }
+    }
+
+    // Missing and malformed files are errors
+    ASSERT_ANY_THROW(import_net_from_onnx_file(fname));
+    FILE* f = fopen(fname.c_str(), "w");
+    fputs("not an onnx model", f);
+    fclose(f);
+    ASSERT_ANY_THROW(import_net_from_onnx_file(fname));
+    std::remove(fname.c_str());
+
+    delete net_export;
+    delete net_import;
+}
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <string>
+
+#include "eddl/tensor/tensor.h"
+#include "eddl/tensor/nn/tensor_nn.h"
+#include "eddl/regularizers/regularizer.h"
+
+using namespace std;
+
+
+// Decay of the regularizers as they were applied before the update (with temporaries)
+static void reference_decay(Tensor* W, float l1, float l2){
+    Tensor* S = W->clone();
+    Tensor* A = W->clone();
+    S->sign_();
+    Tensor::add(1.0f, W, -l1, S, W, 0);
+    Tensor::add(1.0f, W, -l2, A, W, 0);
+    delete S; delete A;
+}
+
+
+TEST(OptimizerTestSuite, regularizer_apply){
+    Tensor* W = Tensor::randn({5, 7});
+    Tensor* W_ref = W->clone();
+
+    RL1L2 reg(0.01f, 0.02f);
+    reg.apply(W);
+    reference_decay(W_ref, 0.01f, 0.02f);
+    ASSERT_TRUE(Tensor::equivalent(W_ref, W, 10e-5));
+
+    delete W; delete W_ref;
+}
+
+
+TEST(OptimizerTestSuite, sgd_step){
+    Tensor* W = Tensor::randn({5, 7});
+    Tensor* G = Tensor::randn({5, 7});
+    Tensor* M = Tensor::randn({5, 7});
+    Tensor* W_ref = W->clone();
+    Tensor* M_ref = M->clone();
+
+    tensorNN::sgd_step(W, G, M, 0.1f, 0.9f, 0.01f, 0.02f);
+
+    reference_decay(W_ref, 0.01f, 0.02f);
+    Tensor::add(0.1f, G, 0.9f, M_ref, M_ref, 0);
+    Tensor::add(1.0f, W_ref, -1.0f, M_ref, W_ref, 0);
+
+    ASSERT_TRUE(Tensor::equivalent(M_ref, M, 10e-5));
+    ASSERT_TRUE(Tensor::equivalent(W_ref, W, 10e-5));
+
+    delete W; delete G; delete M; delete W_ref; delete M_ref;
+}
+
+
+TEST(OptimizerTestSuite, adam_step){
+    Tensor* W = Tensor::randn({5, 7});
+    Tensor* G = Tensor::randn({5, 7});
+    Tensor* M = Tensor::randn({5, 7});
+    Tensor* V = Tensor::randu({5, 7});
+    Tensor* W_ref = W->clone();
+    Tensor* M_ref = M->clone();
+    Tensor* V_ref = V->clone();
+    Tensor* mCap = Tensor::empty({5, 7});
+    Tensor* vCap = Tensor::empty({5, 7});
+
+    int t = 3;
+    float lr = 0.01f, b1 = 0.9f, b2 = 0.999f, eps = 1e-8f;
+    tensorNN::adam_step(W, G, M, V, nullptr, nullptr, lr, b1, b2, eps, t, 0.0f, 0.01f);
+
+    // Unfused update
+    reference_decay(W_ref, 0.0f, 0.01f);
+    Tensor::add(b1, M_ref, (1-b1), G, M_ref, 0);
+    Tensor* G2 = G->clone(); G2->sqr_();
+    Tensor::add(b2, V_ref, (1-b2), G2, V_ref, 0);
+    Tensor::copy(M_ref, mCap); mCap->div_(1-pow(b1, t));
+    Tensor::copy(V_ref, vCap); vCap->div_(1-pow(b2, t)); vCap->add_(eps); vCap->sqrt_();
+    Tensor::el_div(mCap, vCap, mCap, 0);
+    Tensor::add(-lr, mCap, 1.0f, W_ref, W_ref, 0);
+
+    ASSERT_TRUE(Tensor::equivalent(M_ref, M, 10e-5));
+    ASSERT_TRUE(Tensor::equivalent(V_ref, V, 10e-5));
+    ASSERT_TRUE(Tensor::equivalent(W_ref, W, 10e-4));
+
+    delete W; delete G; delete G2; delete M; delete V;
+    delete W_ref; delete M_ref; delete V_ref; delete mCap; delete vCap;
+}
+
+
+TEST(OptimizerTestSuite, rmsprop_step){
+    Tensor* W = Tensor::randn({5, 7});
+    Tensor* G = Tensor::randn({5, 7});
+    Tensor* G1 = Tensor::randn({5, 7});
+    Tensor* W_ref = W->clone();
+    Tensor* G1_ref = G1->clone();
+    Tensor* S = Tensor::empty({5, 7});
+
+    float lr = 0.01f, rho = 0.9f, eps = 1e-8f;
+    tensorNN::rmsprop_step(W, G, G1, nullptr, lr, rho, eps, 0.01f, 0.0f);
+
+    reference_decay(W_ref, 0.01f, 0.0f);
+    Tensor::copy(G, S); S->sqr_(); S->mult_(1.0f-rho);
+    G1_ref->sqr_(); G1_ref->mult_(rho);
+    Tensor::add(1.0f, G1_ref, 1.0f, S, S, 0);
+    S->add_(eps); S->sqrt_();
+    Tensor::el_div(G, S, S, 0);
+    Tensor::add(-lr, S, 1.0f, W_ref, W_ref, 0);
+
+    ASSERT_TRUE(Tensor::equivalent(G, G1, 10e-5));
+    ASSERT_TRUE(Tensor::equivalent(W_ref, W, 10e-4));
+
+    delete W; delete G; delete G1; delete W_ref; delete G1_ref; delete S;
+}
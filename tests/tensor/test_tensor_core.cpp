@@ -88,3 +88,81 @@ TEST(TensorTestSuite, tensor_math_argsort) {
 }
 
 
+
+
+TEST(TensorTestSuite, tensor_views) {
+    Tensor *t1 = new Tensor({1, 2, 3,
+                             4, 5, 6}, {2, 3}, DEV_CPU);
+
+    // Permute (no copy)
+    Tensor *t1_ref = new Tensor({1, 4,
+                                 2, 5,
+                                 3, 6}, {3, 2}, DEV_CPU);
+    Tensor *v1 = Tensor::permute_view(t1, {1, 0});
+    ASSERT_TRUE(v1->isview);
+    ASSERT_FALSE(v1->is_contiguous());
+    ASSERT_EQ(v1->ptr, t1->ptr);
+    Tensor *c1 = Tensor::contiguous(v1);
+    ASSERT_TRUE(Tensor::equivalent(t1_ref, c1, 10e-4));
+
+    // Select
+    Tensor *t2_ref = new Tensor({2, 5}, {2}, DEV_CPU);
+    Tensor *v2 = Tensor::select_view(t1, 1, 1);
+    Tensor *c2 = Tensor::contiguous(v2);
+    ASSERT_TRUE(Tensor::equivalent(t2_ref, c2, 10e-4));
+
+    // Slice
+    Tensor *t3_ref = new Tensor({2, 3,
+                                 5, 6}, {2, 2}, DEV_CPU);
+    Tensor *v3 = Tensor::slice_view(t1, 1, 1, 3);
+    Tensor *c3 = Tensor::contiguous(v3);
+    ASSERT_TRUE(Tensor::equivalent(t3_ref, c3, 10e-4));
+
+    // Writes through a view reach the source tensor
+    Tensor::fill(v2, 0.0f);
+    Tensor *t4_ref = new Tensor({1, 0, 3,
+                                 4, 0, 6}, {2, 3}, DEV_CPU);
+    ASSERT_TRUE(Tensor::equivalent(t4_ref, t1, 10e-4));
+
+    // Deleting the views does not free the data of t1
+    delete v1; delete v2; delete v3;
+    ASSERT_TRUE(Tensor::equivalent(t4_ref, t1, 10e-4));
+
+    delete t1; delete t1_ref; delete t2_ref; delete t3_ref; delete t4_ref;
+    delete c1; delete c2; delete c3;
+}
+
+
+TEST(TensorTestSuite, tensor_views_math) {
+    Tensor *t1 = Tensor::randn({4, 5, 6});
+    Tensor *v1 = Tensor::permute_view(t1, {2, 0, 1});
+    Tensor *c1 = Tensor::contiguous(v1);
+
+    // Unary
+    Tensor *r1 = new Tensor(v1->shape, DEV_CPU);
+    Tensor *r1_ref = new Tensor(v1->shape, DEV_CPU);
+    Tensor::abs(v1, r1);
+    Tensor::abs(c1, r1_ref);
+    ASSERT_TRUE(Tensor::equivalent(r1_ref, r1, 10e-4));
+
+    // Binary (view and contiguous operands)
+    Tensor::add(1.0f, v1, 2.0f, c1, r1, 0);
+    Tensor::add(1.0f, c1, 2.0f, c1, r1_ref, 0);
+    ASSERT_TRUE(Tensor::equivalent(r1_ref, r1, 10e-4));
+
+    Tensor::el_mult(v1, v1, r1, 0);
+    Tensor::el_mult(c1, c1, r1_ref, 0);
+    ASSERT_TRUE(Tensor::equivalent(r1_ref, r1, 10e-4));
+
+    // Reductions
+    ASSERT_NEAR(v1->sum(), c1->sum(), 10e-3);
+    ASSERT_NEAR(v1->max(), c1->max(), 10e-4);
+
+    // Transpose
+    Tensor *r2 = new Tensor({6, 4, 5}, DEV_CPU);
+    Tensor::transpose(t1, r2, {2, 0, 1});
+    ASSERT_TRUE(Tensor::equivalent(c1, r2, 10e-4));
+
+    delete t1; delete v1; delete c1;
+    delete r1; delete r1_ref; delete r2;
+}
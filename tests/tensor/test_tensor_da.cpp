@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+
+#include "eddl/tensor/tensor.h"
+#include "eddl/tensor/nn/tensor_nn.h"
+#include "eddl/descriptors/descriptors.h"
+
+using namespace std;
+
+
+TEST(TensorTestSuite, tensor_da_affine){
+    Tensor* t1 = Tensor::randu({2, 3, 5, 7});
+    Tensor* r = Tensor::empty({2, 3, 5, 7});
+    Tensor* r_ref = Tensor::empty({2, 3, 5, 7});
+
+    // Identity
+    Tensor::affine_random(t1, r, AffineDescriptor());
+    ASSERT_TRUE(Tensor::equivalent(t1, r, 10e-4));
+
+    // Horizontal flip
+    vector<float> flip = {1, 0, 0,  0, -1, 6};
+    for (int i = 0; i < 6; i++) flip.push_back(flip[i]);
+    Tensor::affine(t1, r, flip, false);
+    Tensor::flip(t1, r_ref, 1);
+    ASSERT_TRUE(Tensor::equivalent(r_ref, r, 10e-4));
+
+    // Integer shift (same result with both interpolations)
+    vector<float> shift;
+    for (int b = 0; b < 2; b++) shift.insert(shift.end(), {1, 0, -1,  0, 1, -2});
+    Tensor::shift(t1, r_ref, {1, 2}, WrappingMode::Constant, 0.5f);
+    Tensor::affine(t1, r, shift, false, WrappingMode::Constant, 0.5f);
+    ASSERT_TRUE(Tensor::equivalent(r_ref, r, 10e-4));
+    Tensor::affine(t1, r, shift, true, WrappingMode::Constant, 0.5f);
+    ASSERT_TRUE(Tensor::equivalent(r_ref, r, 10e-4));
+
+    delete t1; delete r; delete r_ref;
+}
+
+
+TEST(TensorTestSuite, tensor_da_affine_bilinear){
+    Tensor* t1 = new Tensor({0, 2, 4, 6}, {1, 1, 1, 4}, DEV_CPU);
+    Tensor* r = Tensor::empty({1, 1, 1, 4});
+
+    // Half a pixel to the left
+    Tensor::affine(t1, r, {1, 0, 0,  0, 1, 0.5f}, true, WrappingMode::Nearest);
+    Tensor* r_ref = new Tensor({1, 3, 5, 6}, {1, 1, 1, 4}, DEV_CPU);
+    ASSERT_TRUE(Tensor::equivalent(r_ref, r, 10e-4));
+
+    // Wrapping modes (two pixels to the right)
+    vector<float> m = {1, 0, 0,  0, 1, -2};
+    Tensor::affine(t1, r, m, false, WrappingMode::Reflect);
+    Tensor* r_reflect = new Tensor({2, 0, 0, 2}, {1, 1, 1, 4}, DEV_CPU);
+    ASSERT_TRUE(Tensor::equivalent(r_reflect, r, 10e-4));
+
+    Tensor::affine(t1, r, m, false, WrappingMode::Mirror);
+    Tensor* r_mirror = new Tensor({4, 2, 0, 2}, {1, 1, 1, 4}, DEV_CPU);
+    ASSERT_TRUE(Tensor::equivalent(r_mirror, r, 10e-4));
+
+    Tensor::affine(t1, r, m, false, WrappingMode::Wrap);
+    Tensor* r_wrap = new Tensor({4, 6, 0, 2}, {1, 1, 1, 4}, DEV_CPU);
+    ASSERT_TRUE(Tensor::equivalent(r_wrap, r, 10e-4));
+
+    Tensor::affine(t1, r, m, false, WrappingMode::Original);
+    Tensor* r_orig = new Tensor({0, 2, 0, 2}, {1, 1, 1, 4}, DEV_CPU);
+    ASSERT_TRUE(Tensor::equivalent(r_orig, r, 10e-4));
+
+    delete t1; delete r; delete r_ref;
+    delete r_reflect; delete r_mirror; delete r_wrap; delete r_orig;
+}
+
+
+TEST(TensorTestSuite, tensor_da_affine_descriptor){
+    // Fixed shift
+    AffineDescriptor spec({0.2f, 0.2f}, {0.0f, 0.0f}, {0.0f, 0.0f}, {1.0f, 1.0f}, {0.0f, 0.0f}, {1.0f, 1.0f},
+                          false, false, "nearest");
+    float m[6];
+    spec.sample(10, 10, m);
+    ASSERT_NEAR(m[0], 1.0f, 10e-4); ASSERT_NEAR(m[1], 0.0f, 10e-4); ASSERT_NEAR(m[2], 0.0f, 10e-4);
+    ASSERT_NEAR(m[3], 0.0f, 10e-4); ASSERT_NEAR(m[4], 1.0f, 10e-4); ASSERT_NEAR(m[5], -2.0f, 10e-4);
+
+    // 90 degrees keep the center
+    AffineDescriptor rot({0.0f, 0.0f}, {0.0f, 0.0f}, {90.0f, 90.0f});
+    rot.sample(5, 5, m);
+    ASSERT_NEAR(m[0] * 2 + m[1] * 2 + m[2], 2.0f, 10e-4);
+    ASSERT_NEAR(m[3] * 2 + m[4] * 2 + m[5], 2.0f, 10e-4);
+}
@@ -336,4 +336,59 @@ TEST(TensorTestSuite, tensor_io_bin)
     if(hasFailed) { cout << "Error deleting file: " << fname << endl; }
 
     ASSERT_TRUE(Tensor::equivalent(t_iris, t_load, 10e-5));
-}
\ No newline at end of file
+}
+TEST(TensorTestSuite, tensor_io_compact)
+{
+    // Generate random name
+    int rdn_name = dist6(mt);
+    string fname = "dataset_" + to_string(rdn_name) + ".bin";
+
+    // Pixel-like dataset (4 samples)
+    Tensor* t_ref = Tensor::arange(0, 24);
+    t_ref->reshape_({4, 2, 3});
+    t_ref->mult_(10.0f);
+    t_ref->save(fname);
+
+    // Compact storage, normalised when it is read
+    Tensor* t_load = Tensor::load_compact(fname, DTYPE_UINT8, 1.0f/255.0f);
+    int hasFailed = std::remove(fname.c_str());
+    if(hasFailed) { cout << "Error deleting file: " << fname << endl; }
+
+    ASSERT_TRUE(t_load->is_compact());
+    ASSERT_EQ(t_load->shape, t_ref->shape);
+    ASSERT_TRUE(t_load->ptr == nullptr);
+
+    t_ref->clamp_(0.0f, 255.0f);  // uint8 saturates
+    t_ref->div_(255.0f);
+
+    // Batch of selected rows
+    Tensor* batch = new Tensor({2, 2, 3});
+    Tensor::select(t_load, batch, {3, 1}, 0, 2);
+    Tensor* batch_ref = new Tensor({2, 2, 3});
+    Tensor::select(t_ref, batch_ref, {3, 1}, 0, 2);
+    ASSERT_TRUE(Tensor::equivalent(batch_ref, batch, 10e-4));
+
+    // Full copy
+    Tensor* t_all = new Tensor(t_ref->shape);
+    Tensor::copy(t_load, t_all);
+    ASSERT_TRUE(Tensor::equivalent(t_ref, t_all, 10e-4));
+
+    // In-place conversion (uint16)
+    Tensor* t_16 = Tensor::arange(0, 24);
+    t_16->reshape_({4, 2, 3});
+    t_16->mult_(1000.0f);
+    Tensor* t_16_ref = t_16->clone();
+    t_16->compact_(DTYPE_UINT16);
+    Tensor::copy(t_16, t_all);
+    ASSERT_TRUE(Tensor::equivalent(t_16_ref, t_all, 10e-4));
+
+    // Other operations have no float data to work on
+    ASSERT_ANY_THROW(t_load->mult_(2.0f));
+    ASSERT_ANY_THROW(t_load->sum());
+    ASSERT_ANY_THROW(Tensor::add(t_load, t_all, t_all));
+    ASSERT_ANY_THROW(Tensor::copy(t_all, t_16));
+    ASSERT_ANY_THROW(Tensor::select(t_ref, t_16, {0, 1, 2, 3}, 0, 4));
+
+    delete t_ref; delete t_load; delete batch; delete batch_ref;
+    delete t_all; delete t_16; delete t_16_ref;
+}
@@ -0,0 +1,135 @@
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+
+#include "eddl/tensor/tensor.h"
+#include "eddl/tensor/nn/tensor_nn.h"
+#include "eddl/descriptors/descriptors.h"
+
+
+using namespace std;
+
+
+TEST(TensorTestSuite, tensor_math_binary_broadcast_shape){
+    ASSERT_EQ(broadcast_shape({2, 3}, {3}), vector<int>({2, 3}));
+    ASSERT_EQ(broadcast_shape({2, 1}, {1, 3}), vector<int>({2, 3}));
+    ASSERT_EQ(broadcast_shape({4, 1, 5}, {3, 1}), vector<int>({4, 3, 5}));
+    ASSERT_EQ(broadcast_shape({2, 3}, {2, 3}), vector<int>({2, 3}));
+}
+
+
+TEST(TensorTestSuite, tensor_math_binary_add_broadcast){
+    Tensor* t1 = new Tensor({1, 2, 3,
+                             4, 5, 6}, {2, 3}, DEV_CPU);
+
+    // Row vector
+    Tensor* t2 = new Tensor({10, 20, 30}, {3}, DEV_CPU);
+    Tensor* t2_ref = new Tensor({11, 22, 33,
+                                 14, 25, 36}, {2, 3}, DEV_CPU);
+    Tensor* r2 = Tensor::add(t1, t2);
+    ASSERT_TRUE(Tensor::equivalent(t2_ref, r2, 10e-4));
+
+    // Column vector (and increment)
+    Tensor* t3 = new Tensor({1, 2}, {2, 1}, DEV_CPU);
+    Tensor* t3_ref = new Tensor({13, 25, 37,
+                                 20, 32, 44}, {2, 3}, DEV_CPU);
+    Tensor::add(1.0f, t1, 1.0f, t3, r2, 1);
+    ASSERT_TRUE(Tensor::equivalent(t3_ref, r2, 10e-4));
+
+    // Both operands broadcast
+    Tensor* t4_ref = new Tensor({11, 21, 31,
+                                 12, 22, 32}, {2, 3}, DEV_CPU);
+    Tensor* r4 = Tensor::add(t3, t2);
+    ASSERT_TRUE(Tensor::equivalent(t4_ref, r4, 10e-4));
+
+    delete t1; delete t2; delete t3;
+    delete t2_ref; delete t3_ref; delete t4_ref;
+    delete r2; delete r4;
+}
+
+
+TEST(TensorTestSuite, tensor_math_binary_mult_div_broadcast){
+    Tensor* t1 = Tensor::randn({4, 3, 5});
+    Tensor* t2 = Tensor::randu({3, 1});
+    t2->add_(1.0f);
+
+    // Reference with materialised operands
+    Tensor* t2_exp = Tensor::expand(t2, t1->shape);
+    ASSERT_EQ(t2_exp->shape, t1->shape);
+
+    Tensor* r_ref = Tensor::mult(t1, t2_exp);
+    Tensor* r = Tensor::mult(t1, t2);
+    ASSERT_TRUE(Tensor::equivalent(r_ref, r, 10e-4));
+
+    Tensor::el_div(t1, t2_exp, r_ref, 0);
+    Tensor::el_div(t1, t2, r, 0);
+    ASSERT_TRUE(Tensor::equivalent(r_ref, r, 10e-4));
+
+    delete t1; delete t2; delete t2_exp;
+    delete r; delete r_ref;
+
+#ifdef cGPU
+    Tensor* t1_cpu = Tensor::randn({64, 32});
+    Tensor* t2_cpu = Tensor::randn({32});
+    Tensor* t1_gpu = t1_cpu->clone(); t1_gpu->toGPU();
+    Tensor* t2_gpu = t2_cpu->clone(); t2_gpu->toGPU();
+
+    Tensor* r_cpu = Tensor::add(t1_cpu, t2_cpu);
+    Tensor* r_gpu = Tensor::add(t1_gpu, t2_gpu); r_gpu->toCPU();
+    ASSERT_TRUE(Tensor::equivalent(r_cpu, r_gpu, 10e-4));
+#endif
+}
+
+
+// Naive C = op(A)·op(B)
+static Tensor* naive_mult2D(Tensor* A, int tA, Tensor* B, int tB){
+    int m = tA ? A->shape[1] : A->shape[0];
+    int k = tA ? A->shape[0] : A->shape[1];
+    int n = tB ? B->shape[0] : B->shape[1];
+    Tensor* C = Tensor::zeros({m, n});
+    for(int i=0; i<m; i++)
+        for(int j=0; j<n; j++)
+            for(int l=0; l<k; l++){
+                float a = tA ? A->ptr[l*m + i] : A->ptr[i*k + l];
+                float b = tB ? B->ptr[j*k + l] : B->ptr[l*n + j];
+                C->ptr[i*n + j] += a * b;
+            }
+    return C;
+}
+
+TEST(TensorTestSuite, tensor_math_binary_mult2D){
+    for(int tA=0; tA<2; tA++){
+        for(int tB=0; tB<2; tB++){
+            Tensor* A = tA ? Tensor::randn({7, 5}) : Tensor::randn({5, 7});
+            Tensor* B = tB ? Tensor::randn({3, 7}) : Tensor::randn({7, 3});
+            Tensor* C_ref = naive_mult2D(A, tA, B, tB);
+
+            Tensor* C = Tensor::ones({5, 3});
+            Tensor::mult2D(A, tA, B, tB, C, 0);
+            ASSERT_TRUE(Tensor::equivalent(C_ref, C, 10e-4));
+
+            Tensor::mult2D(A, tA, B, tB, C, 1);  // C += A·B
+            C_ref->mult_(2.0f);
+            ASSERT_TRUE(Tensor::equivalent(C_ref, C, 10e-4));
+
+            delete A; delete B; delete C; delete C_ref;
+        }
+    }
+}
+
+TEST(TensorTestSuite, tensor_math_binary_mult2D_batched){
+    Tensor* x = Tensor::randn({4, 6});
+    vector<Tensor*> W, C, C_ref;
+    for(int i=0; i<4; i++){
+        W.push_back(Tensor::randn({6, 8 + i}));
+        C.push_back(Tensor::zeros({4, 8 + i}));
+        C_ref.push_back(naive_mult2D(x, 0, W[i], 0));
+    }
+
+    Tensor::mult2D_batched({x, x, x, x}, 0, W, 0, C, 0);
+    for(int i=0; i<4; i++){
+        ASSERT_TRUE(Tensor::equivalent(C_ref[i], C[i], 10e-4));
+        delete W[i]; delete C[i]; delete C_ref[i];
+    }
+    delete x;
+}
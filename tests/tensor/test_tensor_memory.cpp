@@ -0,0 +1,59 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+
+#include "eddl/apis/eddl.h"
+#include "eddl/utils.h"
+
+using namespace std;
+
+using namespace eddl;
+
+
+TEST(TensorTestSuite, tensor_memory_cache){
+    // Aligned, and reused once released
+    Tensor* t1 = new Tensor({100, 33});
+    float* p1 = t1->ptr;
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(p1) % 64, 0);
+    delete t1;
+
+    FMemStats s0 = get_fmem_stats();
+    Tensor* t2 = new Tensor({33, 100});
+    FMemStats s1 = get_fmem_stats();
+    ASSERT_EQ(t2->ptr, p1);
+    ASSERT_EQ(s1.cache_hits, s0.cache_hits + 1);
+    ASSERT_EQ(s1.system_allocs, s0.system_allocs);
+    ASSERT_GE(s1.bytes_in_use, s0.bytes_in_use + 3300 * (long long)sizeof(float));
+    delete t2;
+
+    // Pointers from new[] are still owned by the tensor
+    Tensor* t3 = new Tensor({10}, new float[10], DEV_CPU);
+    delete t3;
+
+    trim_fmem();
+    ASSERT_EQ(get_fmem_stats().bytes_cached, 0);
+}
+
+
+TEST(TensorTestSuite, tensor_memory_steady_state){
+    layer in = Input({1, 8, 8});
+    layer l = BatchNormalization(Conv(in, 4, {3, 3}));
+    l = MaxPool(ReLu(l), {2, 2});
+    layer out = Softmax(Dense(Reshape(l, {-1}), 4));
+    model net = Model({in}, {out});
+    build(net, adam(0.001), {"soft_cross_entropy"}, {"categorical_accuracy"}, CS_CPU(1), true);
+
+    Tensor* x = Tensor::randn({8, 1, 8, 8});
+    Tensor* y = Tensor::zeros({8, 4});
+    for(int i=0; i<8; i++) { y->ptr[i*4 + i%4] = 1.0f; }
+
+    // After the first steps, every tensor reuses the memory of the previous step
+    for(int i=0; i<2; i++) train_batch(net, {x}, {y});
+    FMemStats s0 = get_fmem_stats();
+    for(int i=0; i<3; i++) train_batch(net, {x}, {y});
+    FMemStats s1 = get_fmem_stats();
+    ASSERT_GT(s1.requests, s0.requests);
+    ASSERT_EQ(s1.system_allocs, s0.system_allocs);
+
+    delete net;
+    delete x; delete y;
+}